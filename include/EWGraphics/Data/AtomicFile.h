@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <initializer_list>
+
+//replacing a file so a reader, or the next run after a crash, only ever sees the old contents or the new ones
+//the data goes to a temp file next to the target, is flushed to disk, then renamed over the target
+//the temp file is removed on any failure, the target is left as it was
+
+namespace EWE {
+	struct FileChunk {
+		const void* data;
+		std::size_t size;
+	};
+
+	//chunks are written back to back. safe for several threads writing the same path, the last rename wins
+	bool AtomicWriteFile(std::filesystem::path const& path, std::initializer_list<FileChunk> chunks);
+} //namespace EWE
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+//packing trivially copyable data into a byte vector, for the on-disk caches and cache keys
+//the reader never reads past the end, it sets failed instead and returns zeroed values from then on
+
+namespace EWE {
+	struct ByteWriter {
+		std::vector<uint8_t> bytes{};
+
+		void Write(const void* data, std::size_t size) {
+			const std::size_t offset = bytes.size();
+			bytes.resize(offset + size);
+			if (size > 0) {
+				memcpy(bytes.data() + offset, data, size);
+			}
+		}
+		template<typename T>
+		void Write(T const& value) {
+			static_assert(std::is_trivially_copyable_v<T>);
+			Write(&value, sizeof(T));
+		}
+		template<typename T>
+		void WriteVector(std::vector<T> const& vec) {
+			static_assert(std::is_trivially_copyable_v<T>);
+			Write(static_cast<uint32_t>(vec.size()));
+			Write(vec.data(), sizeof(T) * vec.size());
+		}
+		void WriteString(std::string_view str) {
+			Write(static_cast<uint32_t>(str.size()));
+			Write(str.data(), str.size());
+		}
+	};
+
+	struct ByteReader {
+		const uint8_t* data;
+		std::size_t size;
+		std::size_t offset{ 0 };
+		bool failed{ false };
+
+		bool Read(void* dst, std::size_t readSize) {
+			if (failed || (offset + readSize > size)) {
+				failed = true;
+				return false;
+			}
+			if (readSize > 0) {
+				memcpy(dst, data + offset, readSize);
+			}
+			offset += readSize;
+			return true;
+		}
+		template<typename T>
+		T Read() {
+			static_assert(std::is_trivially_copyable_v<T>);
+			T ret{};
+			Read(&ret, sizeof(T));
+			return ret;
+		}
+		template<typename T>
+		void ReadVector(std::vector<T>& vec) {
+			static_assert(std::is_trivially_copyable_v<T>);
+			const uint32_t count = Read<uint32_t>();
+			if (failed || (offset + sizeof(T) * count > size)) {
+				failed = true;
+				return;
+			}
+			vec.resize(count);
+			Read(vec.data(), sizeof(T) * count);
+		}
+		std::string ReadString() {
+			const uint32_t length = Read<uint32_t>();
+			if (failed || (offset + length > size)) {
+				failed = true;
+				return {};
+			}
+			std::string ret(reinterpret_cast<const char*>(data + offset), length);
+			offset += length;
+			return ret;
+		}
+		bool AtEnd() const {
+			return offset == size;
+		}
+	};
+} //namespace EWE
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//fixed capacity table indexed directly by ID, no hashing. for IDs the program hands out itself
+//each ID has a generation that goes up when its value is erased, a generation from before that is stale
+//the live IDs are kept packed for iterating. not thread safe, the owner locks
+
+namespace EWE {
+	template<typename ID, typename T, std::size_t Capacity>
+	class FlatRegistry {
+	public:
+		static constexpr std::size_t capacity = Capacity;
+
+		//the ID has to be below Capacity and not live. returns the generation
+		uint32_t Insert(ID id, T const& value) {
+			assert(static_cast<std::size_t>(id) < Capacity);
+			Slot& slot = slots[id];
+			assert(!slot.live && "ID is already registered");
+			slot.value = value;
+			slot.live = true;
+			slot.liveIndex = static_cast<uint32_t>(liveIDs.size());
+			liveIDs.push_back(id);
+			return slot.generation;
+		}
+		//false if it wasn't live
+		bool Erase(ID id) {
+			if (!Contains(id)) {
+				return false;
+			}
+			Slot& slot = slots[id];
+			//swap and pop
+			const ID movedID = liveIDs.back();
+			liveIDs[slot.liveIndex] = movedID;
+			slots[movedID].liveIndex = slot.liveIndex;
+			liveIDs.pop_back();
+
+			Retire(slot);
+			return true;
+		}
+
+		bool Contains(ID id) const {
+			return (static_cast<std::size_t>(id) < Capacity) && slots[id].live;
+		}
+		//nullptr if it isn't live
+		T* Get(ID id) {
+			return Contains(id) ? &slots[id].value : nullptr;
+		}
+		T& At(ID id) {
+			assert(Contains(id));
+			return slots[id].value;
+		}
+		uint32_t Generation(ID id) const {
+			assert(static_cast<std::size_t>(id) < Capacity);
+			return slots[id].generation;
+		}
+		bool IsValid(ID id, uint32_t generation) const {
+			return Contains(id) && (slots[id].generation == generation);
+		}
+
+		std::vector<ID> const& LiveIDs() const { return liveIDs; }
+
+		//erases everything, the generations still go up
+		void Clear() {
+			for (ID id : liveIDs) {
+				Retire(slots[id]);
+			}
+			liveIDs.clear();
+		}
+
+	private:
+		struct Slot {
+			T value{};
+			uint32_t generation{ 0 };
+			uint32_t liveIndex{ 0 }; //position in liveIDs
+			bool live{ false };
+		};
+
+		static void Retire(Slot& slot) {
+			slot.value = T{};
+			slot.live = false;
+			slot.generation++;
+		}
+
+		//fixed size, so inserting never moves a slot that's being read
+		std::array<Slot, Capacity> slots{};
+		std::vector<ID> liveIDs{};
+	};
+} //namespace EWE
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+//FNV-1a, the one hash the on-disk caches, their checksums and the cache keys all use
+//not for anything adversarial, only to tell content apart
+
+namespace EWE {
+	namespace Hash {
+		static constexpr uint64_t FNV_OFFSET = 14695981039346656037ULL;
+		static constexpr uint64_t FNV_PRIME = 1099511628211ULL;
+
+		//a byte at a time. seed with a previous result to chain
+		inline uint64_t FNV1a(const void* data, std::size_t size, uint64_t hash = FNV_OFFSET) {
+			const uint8_t* bytes = static_cast<const uint8_t*>(data);
+			for (std::size_t i = 0; i < size; i++) {
+				hash ^= bytes[i];
+				hash *= FNV_PRIME;
+			}
+			return hash;
+		}
+		//folds a whole word in at once, for keys that are already a list of words
+		constexpr uint64_t FNV1aWord(uint64_t word, uint64_t hash = FNV_OFFSET) {
+			hash ^= word;
+			hash *= FNV_PRIME;
+			return hash;
+		}
+	} //namespace Hash
+} //namespace EWE
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "EWGraphics/Data/RetireQueue.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+//first fit offset allocator over one fixed size range, for suballocating a buffer
+//a freed range isn't handed out again until retireDelay frames have passed, the GPU could still be reading it
+//returned ranges are merged with their neighbours when they're collected. no vulkan in here, the frame number is passed in
+
+namespace EWE {
+	class RangeAllocator {
+	public:
+		static constexpr uint64_t INVALID_OFFSET = UINT64_MAX;
+
+		explicit RangeAllocator(std::size_t retireDelay) : retiring{ retireDelay } {}
+
+		//everything becomes free, including what's retiring
+		void Reset(uint64_t size) {
+			Clear();
+			if (size > 0) {
+				freeRanges.push_back(Range{ 0, size });
+			}
+		}
+		void Clear() {
+			freeRanges.clear();
+			retiring.Flush([](Range) {});
+			live = 0;
+			liveBytes = 0;
+		}
+
+		//INVALID_OFFSET if no free range is big enough
+		uint64_t Allocate(uint64_t size) {
+			assert(size > 0);
+			for (std::size_t i = 0; i < freeRanges.size(); i++) {
+				if (freeRanges[i].size >= size) {
+					const uint64_t offset = freeRanges[i].offset;
+					freeRanges[i].offset += size;
+					freeRanges[i].size -= size;
+					if (freeRanges[i].size == 0) {
+						freeRanges.erase(freeRanges.begin() + static_cast<std::ptrdiff_t>(i));
+					}
+					live++;
+					liveBytes += size;
+					return offset;
+				}
+			}
+			return INVALID_OFFSET;
+		}
+		//frame is the frame the range was last possibly used in
+		void Free(uint64_t offset, uint64_t size, std::size_t frame) {
+			assert(live > 0);
+			live--;
+			liveBytes -= size;
+			retiring.Push(Range{ offset, size }, frame);
+		}
+		//returns the number of ranges that became free
+		uint32_t Collect(std::size_t currentFrame) {
+			const uint32_t returned = retiring.Collect(currentFrame, [this](Range range) { freeRanges.push_back(range); });
+			if (returned > 0) {
+				//merge neighbours, so the range doesn't fragment into allocation sized pieces
+				std::sort(freeRanges.begin(), freeRanges.end(), [](Range const& lhs, Range const& rhs) { return lhs.offset < rhs.offset; });
+				std::size_t merged = 0;
+				for (std::size_t i = 1; i < freeRanges.size(); i++) {
+					if (freeRanges[merged].offset + freeRanges[merged].size == freeRanges[i].offset) {
+						freeRanges[merged].size += freeRanges[i].size;
+					}
+					else {
+						freeRanges[++merged] = freeRanges[i];
+					}
+				}
+				freeRanges.resize(merged + 1);
+			}
+			return returned;
+		}
+
+		uint32_t LiveCount() const { return live; }
+		uint64_t LiveBytes() const { return liveBytes; }
+		uint32_t RetiringCount() const { return static_cast<uint32_t>(retiring.Size()); }
+		uint32_t FreeRangeCount() const { return static_cast<uint32_t>(freeRanges.size()); }
+
+	private:
+		struct Range {
+			uint64_t offset;
+			uint64_t size;
+		};
+
+		std::vector<Range> freeRanges{};
+		RetireQueue<Range> retiring;
+		uint32_t live{ 0 };
+		uint64_t liveBytes{ 0 };
+	};
+} //namespace EWE
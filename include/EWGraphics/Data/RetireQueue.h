@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+//objects that were replaced or freed, held until the frames that could still be using them are done
+//no vulkan in here, the frame number is passed in. not thread safe, the owner locks
+
+namespace EWE {
+	template<typename T>
+	class RetireQueue {
+	public:
+		explicit RetireQueue(std::size_t retireDelay) : retireDelay{ retireDelay } {}
+
+		//frame is the frame the object was last possibly used in
+		void Push(T const& object, std::size_t frame) {
+			entries.push_back(Entry{ object, frame });
+		}
+
+		//calls release on everything more than retireDelay frames old, returns how many
+		template<typename Release>
+		uint32_t Collect(std::size_t currentFrame, Release&& release) {
+			uint32_t collected = 0;
+			for (std::size_t i = 0; i < entries.size();) {
+				if ((currentFrame - entries[i].frame) > retireDelay) {
+					release(entries[i].object);
+					entries[i] = std::move(entries.back());
+					entries.pop_back();
+					collected++;
+				}
+				else {
+					i++;
+				}
+			}
+			return collected;
+		}
+
+		//everything, whatever the frame. for shutdown, once the device is idle
+		template<typename Release>
+		void Flush(Release&& release) {
+			for (auto& entry : entries) {
+				release(entry.object);
+			}
+			entries.clear();
+		}
+
+		std::size_t Size() const { return entries.size(); }
+		bool Empty() const { return entries.empty(); }
+
+	private:
+		struct Entry {
+			T object;
+			std::size_t frame;
+		};
+
+		const std::size_t retireDelay;
+		std::vector<Entry> entries{};
+	};
+} //namespace EWE
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+//hash map split into independently locked shards
+//readers only take a shared lock on one shard, so lookups from different threads don't serialize on one mutex
+//values are copied out, nothing hands out a reference past the lock
+
+namespace EWE {
+	template<typename Key, typename Value, std::size_t ShardCount = 16, typename Hash = std::hash<Key>>
+	class ShardedMap {
+		static_assert((ShardCount & (ShardCount - 1)) == 0, "shard count has to be a power of 2");
+	public:
+		bool Find(Key const& key, Value& out) const {
+			Shard const& shard = GetShard(key);
+			std::shared_lock<std::shared_mutex> lock{ shard.mutex };
+			auto findRet = shard.map.find(key);
+			if (findRet == shard.map.end()) {
+				return false;
+			}
+			out = findRet->second;
+			return true;
+		}
+		bool Contains(Key const& key) const {
+			Shard const& shard = GetShard(key);
+			std::shared_lock<std::shared_mutex> lock{ shard.mutex };
+			return shard.map.contains(key);
+		}
+
+		//false if the key already existed, the existing value is kept
+		bool Insert(Key const& key, Value const& value) {
+			Shard& shard = GetShard(key);
+			std::unique_lock<std::shared_mutex> lock{ shard.mutex };
+			return shard.map.try_emplace(key, value).second;
+		}
+		//make is only called if the key is missing, under the shard's lock. keep it cheap
+		template<typename MakeFunc>
+		Value FindOrInsert(Key const& key, MakeFunc&& make) {
+			Shard& shard = GetShard(key);
+			{
+				std::shared_lock<std::shared_mutex> lock{ shard.mutex };
+				auto findRet = shard.map.find(key);
+				if (findRet != shard.map.end()) {
+					return findRet->second;
+				}
+			}
+			std::unique_lock<std::shared_mutex> lock{ shard.mutex };
+			//another thread could have inserted it between the locks
+			auto findRet = shard.map.find(key);
+			if (findRet != shard.map.end()) {
+				return findRet->second;
+			}
+			return shard.map.emplace(key, make()).first->second;
+		}
+		//func(Value&) under the shard's exclusive lock. false if the key is missing
+		template<typename ModifyFunc>
+		bool Modify(Key const& key, ModifyFunc&& func) {
+			Shard& shard = GetShard(key);
+			std::unique_lock<std::shared_mutex> lock{ shard.mutex };
+			auto findRet = shard.map.find(key);
+			if (findRet == shard.map.end()) {
+				return false;
+			}
+			func(findRet->second);
+			return true;
+		}
+		bool Erase(Key const& key) {
+			Shard& shard = GetShard(key);
+			std::unique_lock<std::shared_mutex> lock{ shard.mutex };
+			return shard.map.erase(key) > 0;
+		}
+
+		//func(Key const&, Value&), one shard locked at a time
+		template<typename EachFunc>
+		void ForEach(EachFunc&& func) {
+			for (auto& shard : shards) {
+				std::unique_lock<std::shared_mutex> lock{ shard.mutex };
+				for (auto& entry : shard.map) {
+					func(entry.first, entry.second);
+				}
+			}
+		}
+		void Clear() {
+			for (auto& shard : shards) {
+				std::unique_lock<std::shared_mutex> lock{ shard.mutex };
+				shard.map.clear();
+			}
+		}
+		//not a snapshot, the shards are counted one after the other
+		std::size_t Size() const {
+			std::size_t ret = 0;
+			for (auto const& shard : shards) {
+				std::shared_lock<std::shared_mutex> lock{ shard.mutex };
+				ret += shard.map.size();
+			}
+			return ret;
+		}
+
+	private:
+		//each shard on its own cache line, neighbouring locks don't false share
+		struct alignas(64) Shard {
+			mutable std::shared_mutex mutex{};
+			std::unordered_map<Key, Value, Hash> map{};
+		};
+		std::array<Shard, ShardCount> shards{};
+
+		static std::size_t ShardIndex(Key const& key) {
+			//sequential keys (ImageID) would otherwise land in order, mix the bits first
+			uint64_t hash = static_cast<uint64_t>(Hash{}(key));
+			hash ^= hash >> 33;
+			hash *= 0xff51afd7ed558ccdULL;
+			hash ^= hash >> 33;
+			return static_cast<std::size_t>(hash) & (ShardCount - 1);
+		}
+		Shard& GetShard(Key const& key) {
+			return shards[ShardIndex(key)];
+		}
+		Shard const& GetShard(Key const& key) const {
+			return shards[ShardIndex(key)];
+		}
+	};
+} //namespace EWE
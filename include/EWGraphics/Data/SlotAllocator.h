@@ -0,0 +1,59 @@
+#pragma once
+
+#include "EWGraphics/Data/RetireQueue.h"
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+//fixed capacity index allocator, for descriptor array slots
+//a freed slot isn't handed out again until retireDelay frames have passed, the GPU could still be reading it
+//no vulkan in here, the frame number is passed in
+
+namespace EWE {
+	class SlotAllocator {
+	public:
+		static constexpr uint32_t INVALID_SLOT = UINT32_MAX;
+
+		SlotAllocator(uint32_t capacity, std::size_t retireDelay) : capacity{ capacity }, retiring{ retireDelay } {}
+
+		//INVALID_SLOT when every slot is live or still retiring
+		uint32_t Allocate() {
+			if (freeSlots.size() > 0) {
+				const uint32_t slot = freeSlots.back();
+				freeSlots.pop_back();
+				live++;
+				return slot;
+			}
+			if (highWater < capacity) {
+				live++;
+				return highWater++;
+			}
+			return INVALID_SLOT;
+		}
+		//frame is the frame the slot was last possibly used in
+		void Free(uint32_t slot, std::size_t frame) {
+			assert(slot < highWater);
+			assert(live > 0);
+			live--;
+			retiring.Push(slot, frame);
+		}
+		//returns the number of slots that became free
+		uint32_t Collect(std::size_t currentFrame) {
+			return retiring.Collect(currentFrame, [this](uint32_t slot) { freeSlots.push_back(slot); });
+		}
+
+		uint32_t Capacity() const { return capacity; }
+		uint32_t LiveCount() const { return live; }
+		uint32_t RetiringCount() const { return static_cast<uint32_t>(retiring.Size()); }
+		//the highest slot + 1 that's ever been handed out
+		uint32_t HighWater() const { return highWater; }
+
+	private:
+		const uint32_t capacity;
+		uint32_t highWater{ 0 };
+		uint32_t live{ 0 };
+		std::vector<uint32_t> freeSlots{};
+		RetireQueue<uint32_t> retiring;
+	};
+} //namespace EWE
@@ -166,6 +166,9 @@ namespace EWE {
         }
         static void WaitForCompletion();
         static bool CheckEmpty();
+        static std::size_t GetThreadCount() {
+            return singleton->threads.size();
+        }
 
         static std::vector<TaskType> const& GetThreadTasks() {
             return singleton->threadTasks;
@@ -73,6 +73,11 @@ namespace EWE {
         void BindAndDrawInstanceNoBuffer(int instanceCount);
         void BindAndDrawInstanceNoBufferNoIndex(int instanceCount);
 
+        //buffers created off the main thread are uploaded asynchronously
+        //the model shouldn't be drawn until this returns true, or WaitForUpload has returned
+        bool UploadComplete() const { return uploadToken.Poll(); }
+        void WaitForUpload() const { uploadToken.Wait(); }
+
         uint32_t GetVertexCount() { return vertexCount; }
         uint32_t GetIndexCount() { return indexCount; }
 
@@ -106,5 +111,8 @@ namespace EWE {
         bool hasInstanceBuffer = false;
         EWEBuffer* instanceBuffer{ nullptr };
         uint32_t instanceCount;
+
+        //uploads complete in order, the last one issued covers every buffer in the model
+        UploadToken uploadToken{};
     };
 } //namespace EWE
\ No newline at end of file
@@ -11,10 +11,16 @@
 #include <unordered_map>
 #include <memory>
 
+#ifndef PIPELINE_REGISTRY_CAPACITY
+#define PIPELINE_REGISTRY_CAPACITY 4096
+#endif
+
 namespace EWE {
 	struct Pipeline {
 		PipeLayout* pipeLayout;
-		VkPipeline vkPipe;
+		VkPipeline vkPipe = VK_NULL_HANDLE;
+		//PermutationCache upgrade generation that vkPipe was last checked against
+		uint32_t upgradeGeneration = 0;
 
 		const PipelineID myID;
 		PipelineID GetID() const { return myID; };
@@ -22,6 +28,8 @@ namespace EWE {
 		Pipeline(PipelineID id, PipeLayout* layout);
 		Pipeline(PipelineID id, PipeLayout* layout, std::vector<KeyValuePair<ShaderStage, std::vector<Shader::SpecializationEntry>>> const& specInfo);
 
+		~Pipeline();
+
 		Pipeline(Pipeline&) = delete;
 		Pipeline(Pipeline&&) = delete;
 		Pipeline& operator=(Pipeline&) = delete;
@@ -42,26 +50,50 @@ namespace EWE {
 		void BindPipelineWithVPScissor();
 
 		void Push(void* push, uint8_t pushIndex = 0);
+		//push is the data for the stage's range only, starting at the range's offset
+		void Push(ShaderStage stage, const void* push);
+		//pushes only [offset, offset + size), with the stages that overlap each piece of it. push starts at offset
+		void PushRange(uint32_t offset, uint32_t size, const void* push);
 #if DEBUG_NAMING
 		void SetDebugName(const char* name);
 #endif
 	};
 
+	/*
+	* the pipeline registry is a FlatRegistry indexed by PipelineID, IDs have to be below PIPELINE_REGISTRY_CAPACITY, registering one past it throws
+		At is an array access, no hashing. registering and destroying are locked, and can happen from any thread
+		each ID has a generation that goes up when the pipeline there is destroyed, a Handle from an older generation is stale
+		the kind is stored with the pipeline, for destruction and imgui without RTTI
+	*/
 	namespace PipelineSystem {
-
+		enum class Kind : uint8_t {
+			Graphics,
+			Compute,
+		};
+		struct Handle {
+			PipelineID id;
+			uint32_t generation;
+		};
 
 		Pipeline* At(PipelineID pipeID);
+		Pipeline* At(Handle handle);
+		//nullptr if it doesn't exist
+		Pipeline* OptionalAt(PipelineID pipeID);
+		bool IsValid(Handle handle);
+		Handle GetHandle(PipelineID pipeID);
+		Kind KindAt(PipelineID pipeID);
 
 #if PIPELINE_HOT_RELOAD
-		void Emplace(std::string const& pipeName, PipelineID pipeID, Pipeline* pipe);
+		Handle Emplace(std::string const& pipeName, PipelineID pipeID, Pipeline* pipe);
+		std::vector<Handle> GetPipelinesUsing(Shader const* shader);
 
 		template<typename T>
-		void Emplace(T pipeID, Pipeline* pipeSys) {
+		Handle Emplace(T pipeID, Pipeline* pipeSys) {
 			const std::string pipeName = std::string(magic_enum::enum_name(pipeID));
-			Emplace(pipeName, pipeID, pipeSys);
+			return Emplace(pipeName, pipeID, pipeSys);
 		}
 #else
-		void Emplace(PipelineID pipeID, PipelineSystem* pipeSys);
+		Handle Emplace(PipelineID pipeID, Pipeline* pipe);
 #endif
 		void DestructAll();
 
@@ -49,12 +49,42 @@
 #endif
 
 #define MIPMAP_ENABLED true
+//mip chains built on the CPU (MipGenerator) and uploaded with copies only, instead of blit chains on the graphics queue
+#ifndef CPU_MIPMAPS
+#define CPU_MIPMAPS true
+#endif
 
 #define THREAD_NAMING (true && EWE_DEBUG)
 #define DEBUGGING_MATERIAL_NORMALS (false && EWE_DEBUG)
 
 #define PIPELINE_HOT_RELOAD true
 
+//fast linked pipelines from cached part libraries, when VK_EXT_graphics_pipeline_library is available
+#ifndef GRAPHICS_PIPELINE_LIBRARY
+#define GRAPHICS_PIPELINE_LIBRARY true
+#endif
+//every fast linked pipeline is also built monolithically once and thrown away, PipelineLibrary::PrintStats compares the two first use times
+//only does anything when the library path is enabled. doubles pipeline creation, and the extra builds show in PipelineCache's creation stats
+#ifndef PIPELINE_LIBRARY_HITCH_REPORT
+#define PIPELINE_LIBRARY_HITCH_REPORT (false && EWE_DEBUG)
+#endif
+
+//descriptor set layouts with single buffer/image bindings get an update template, writes go through vkUpdateDescriptorSetWithTemplate
+#ifndef DESCRIPTOR_UPDATE_TEMPLATES
+#define DESCRIPTOR_UPDATE_TEMPLATES true
+#endif
+
+//VK_EXT_descriptor_buffer backend, opt in. pipelines using its layouts need DescriptorBuffer::PipelineCreateFlags, which the engine's pipelines don't set,
+//and every uniform/storage buffer gets a device address while it's on
+#ifndef DESCRIPTOR_BUFFER
+#define DESCRIPTOR_BUFFER false
+#endif
+
+//png/jpg/tga loaded by path are cooked once into block compressed, fully mipped ktx2 files, later runs load those instead
+#ifndef TEXTURE_COOKING
+#define TEXTURE_COOKING true
+#endif
+
 #if EWE_DEBUG
     #ifdef _MSC_VER
         #define EWE_UNREACHABLE assert(false)
@@ -7,6 +7,7 @@
 //#include "EWEngine/graphicsimGuiHandler.h"
 #include "EWGraphics/LeafSystem.h"
 #include "EWGraphics/PipelineSystem.h"
+#include "EWGraphics/Vulkan/PipelineCompiler.h"
 
 #include "EWGraphics/Texture/Image_Manager.h"
 
@@ -14,6 +15,7 @@
 #include <memory>
 #include <vector>
 #include <chrono>
+#include <atomic>
 
 #define EWF_VERSION "1.0.0.0"
 
@@ -40,7 +42,7 @@ namespace EWE {
 
 
 #if BENCHMARKING_GPU
-		VkQueryPool queryPool[MAX_FRAMES_IN_FLIGHT] = { VK_NULL_HANDLE, VK_NULL_HANDLE };
+		VkQueryPool queryPool[MAX_FRAMES_IN_FLIGHT]{};
 		float gpuTicksPerSecond = 0;
 #endif
 
@@ -53,6 +55,16 @@ namespace EWE {
 #endif
 			loadingEngine = false;
 		}
+		//callable from the loading thread. the batch is compiled on the thread pool and published by the loading screen as pipelines finish
+		//call it before EndEngineLoadScreen, the loading screen doesn't end until the batch is fully published
+		void CompileDuringLoadingScreen(PipelineBatch& batch, uint32_t threadCount = 0, PipelineBatch::CacheMode cacheMode = PipelineBatch::CacheMode::Shared) {
+			assert(loadingPipelines.load() == nullptr && "one batch at a time");
+			batch.Compile(threadCount, cacheMode);
+			loadingPipelines.store(&batch, std::memory_order_release);
+		}
+		bool LoadingPipelinesPublished() const {
+			return loadingPipelines.load(std::memory_order_acquire) == nullptr;
+		}
 		bool GetLoadingScreenProgress() {
 			return (!finishedLoadingScreen);// || (loadingTime < 2.0);
 		}
@@ -63,6 +75,8 @@ namespace EWE {
 		bool finishedLoadingScreen = false;
 		bool loadingEngine = true;
 		double loadingTime = 0.f;
+		std::atomic<PipelineBatch*> loadingPipelines{ nullptr };
+		void PublishLoadingPipelines(bool blocking);
 
 
 	};
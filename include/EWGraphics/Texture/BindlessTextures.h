@@ -0,0 +1,51 @@
+#pragma once
+
+#include "EWGraphics/Vulkan/Descriptors.h"
+#include "EWGraphics/Data/SlotAllocator.h"
+
+/*
+* global bindless texture table
+	one update-after-bind, partially bound array of combined image samplers, in a single descriptor set that's bound once
+	an ImageID gets a slot the first time it's asked for, and keeps it until Image_Manager removes the image
+	shaders index the array with the slot, instead of binding a set per material
+	a removed image's slot isn't reused until the frames that could have sampled it are done
+	the layout is built with DescriptorSetLayout::Builder::BuildBindless. it matches what reflection produces for
+		layout(set = N, binding = 0) uniform sampler2D textures[]; when nothing else is in set N and the stages match
+*/
+
+namespace EWE {
+	namespace BindlessTextures {
+		static constexpr uint32_t INVALID_INDEX = SlotAllocator::INVALID_SLOT;
+
+		struct Stats {
+			uint32_t capacity;
+			uint32_t live;
+			uint32_t retiring; //freed, waiting on frames in flight
+			uint32_t highWater;
+			uint32_t pendingWrites; //acquired before the image finished its layout transition
+		};
+
+		//main thread, after the global descriptor pool exists
+		void Initialize(VkShaderStageFlags stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT);
+		//main thread, before Image_Manager::Cleanup
+		void Destroy();
+
+		//any thread. the same ImageID always gets the same index while it's alive
+		//the descriptor is written once the image is in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, don't sample the index before then
+		uint32_t Acquire(ImageID imageID, VkDescriptorImageInfo* imageInfo);
+		//INVALID_INDEX if the image doesn't have one
+		uint32_t Find(ImageID imageID);
+		//called by Image_Manager when the image is removed
+		void Release(ImageID imageID);
+
+		//main thread, at the end of every frame. writes pending descriptors and recycles retired slots
+		void Update();
+
+		DescriptorSetLayout* GetLayout();
+		VkDescriptorSet GetSet();
+		void Bind(VkPipelineBindPoint bindPoint, VkPipelineLayout pipeLayout, uint32_t setIndex);
+
+		Stats GetStats();
+		void PrintStats();
+	} //namespace BindlessTextures
+} //namespace EWE
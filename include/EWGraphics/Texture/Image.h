@@ -1,6 +1,7 @@
 #pragma once
 
 #include "EWGraphics/Vulkan/VulkanHeader.h"
+#include "EWGraphics/Vulkan/ResourceState.h"
 
 namespace EWE {
 
@@ -38,6 +39,8 @@ namespace EWE {
 		uint32_t height;
 
 		VkImageLayout destinationImageLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		//last owner/layout/access, kept up to date by ResourceTracker
+		ResourceState state{};
 #if IMAGE_DEBUGGING
 		std::string imageName{};
 #endif
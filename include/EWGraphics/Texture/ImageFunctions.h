@@ -1,6 +1,7 @@
 #pragma once
 
 #include "EWGraphics/Texture/Image.h"
+#include "EWGraphics/Vulkan/UploadQueue.h"
 
 namespace EWE {
 	namespace Image {
@@ -10,6 +11,8 @@ namespace EWE {
 		void CreateImageWithInfo(const VkImageCreateInfo& imageCreateInfo, const VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory);
 #endif
 		void CopyBufferToImage(CommandBuffer& cmdBuf, VkBuffer& buffer, VkImage& image, uint32_t width, uint32_t height, uint32_t layerCount);
+		//one region per prebuilt mip level
+		void CopyBufferToImage(CommandBuffer& cmdBuf, VkBuffer buffer, VkImage image, std::vector<VkBufferImageCopy> const& regions);
 
 
 		//only for transfer -> graphics
@@ -18,7 +21,10 @@ namespace EWE {
 		void GenerateMipMapsForMultipleImagesTransferQueue(CommandBuffer& cmdBuf, std::vector<ImageInfo*>& imageInfo);
 		void GenerateMipmaps(CommandBuffer& cmdBuf, ImageInfo* imageInfo, Queue::Enum srcQueue);
 
-		void CreateImageCommands(ImageInfo& imageInfo, VkImageCreateInfo const& imageCreateInfo, StagingBuffer* stagingBuffer, bool mipmapping);
+		//off the main thread, this goes through the UploadQueue and returns without waiting on the copy
+		UploadToken CreateImageCommands(ImageInfo& imageInfo, VkImageCreateInfo const& imageCreateInfo, StagingBuffer* stagingBuffer, bool mipmapping);
+		//every mip level is already in the staging buffer, nothing is generated. works for block compressed formats
+		UploadToken CreateImageCommands(ImageInfo& imageInfo, StagingBuffer* stagingBuffer, std::vector<VkBufferImageCopy>&& regions);
 
 		[[nodiscard("this staging buffer needs to be handled outside of this function")]]
 		StagingBuffer* StageImage(PixelPeek& pixelPeek);
@@ -30,6 +36,8 @@ namespace EWE {
 		VkImageSubresourceRange CreateSubresourceRange(ImageInfo const& imageInfo);
 
 
+		//.ktx2 paths are loaded as stored, compressed formats and prebuilt mips included. mipmap is ignored for them
+		//anything else goes through the TextureCooker's cache when it's enabled, and is decoded from the source if that fails
 		void CreateImage(ImageInfo* imageInfo, std::string const& path, bool mipmap);
 		void CreateImage(ImageInfo* imageInfo, PixelPeek& pixelPeek, bool mipmap);
 
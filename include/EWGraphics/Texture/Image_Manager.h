@@ -3,6 +3,7 @@
 #include <EWGraphics/Data/EngineDataTypes.h>
 #include <EWGraphics/Texture/ImageFunctions.h>
 #include <EWGraphics/Data/MemoryTypeBucket.h>
+#include <EWGraphics/Data/ShardedMap.h>
 #include <EWGraphics/Vulkan/Descriptors.h>
 
 
@@ -11,13 +12,27 @@
 #include <string>
 #include <functional>
 #include <unordered_set>
+#include <atomic>
+#include <future>
+#include <thread>
 
 namespace EWE {
 
+	//what a path was loaded with. a later request for the same path has to ask for the same thing, it gets the same image
+	struct PathOptions {
+		VkSampler sampler{ VK_NULL_HANDLE }; //null is the default sampler
+		bool mipmap;
+		bool zeroUsageDelete;
+		bool operator==(PathOptions const&) const = default;
+	};
+
 	struct ImageTracker {
 		ImageInfo imageInfo;
-		uint8_t usageCount;
+		uint32_t usageCount;
 		bool zeroUsageDelete;
+		//empty unless it was loaded through the path registry
+		std::string path{};
+		PathOptions pathOptions{};
 		ImageTracker(std::string const& path, bool mipmap, bool zeroUsageDelete) : usageCount{ 1 }, zeroUsageDelete{ zeroUsageDelete } {
 			Image::CreateImage(&imageInfo, path, mipmap);
 		}
@@ -35,26 +50,88 @@ namespace EWE {
 		//MemoryTypeBucket<1024> imageTrackerBucket;
 
 	protected:
+		//only guards simpleTextureLayouts now, the registries below are sharded
 		std::mutex imageMutex{};
 
 		std::vector<ImageID> sceneIDs; //keeping track so i can remove them later
 
-		std::unordered_map<ImageID, ImageTracker*> imageTrackerIDMap{};
-		std::unordered_map<std::string, ImageID> imageStringToIDMap{};
-		std::unordered_map<ImageID, MaterialInfo> existingMaterialsByID{};
+		ShardedMap<ImageID, ImageTracker*> imageTrackerIDMap{};
+		//the future is ready once the path's image is in imageTrackerIDMap
+		ShardedMap<std::string, std::shared_future<ImageID>> imageStringToIDMap{};
+		ShardedMap<ImageID, MaterialInfo> existingMaterialsByID{};
 		std::unordered_map<VkShaderStageFlags, DescriptorSetLayout*> simpleTextureLayouts{};
 		
 		//ImageInfo* skybox_image;
 		//ImageInfo* UI_image;
-		ImageID currentImageCount{ 0 };
+		std::atomic<ImageID> currentImageCount{ 0 };
 
 		friend class Material_Image;
 
 		static Image_Manager* imgMgrPtr;
 		static ImageID ConstructImageTracker(std::string const& imagePath, bool mipmap, bool zeroUsageDelete = false);
 		static ImageID ConstructImageTracker(std::string const& imagePath, VkSampler sampler, bool mipmap, bool zeroUsageDelete = false);
+		static ImageID AddImageTracker(ImageTracker* imageTracker);
 		static DescriptorSetLayout* GetSimpleTextureDSL(VkShaderStageFlags stageFlags);
 
+		//single flight, the first request for a path runs create, concurrent requests for the same path wait on it
+		//every request after the first is another use of the image, and has to match the options it was created with
+		template<typename CreateFunc>
+		static ImageID GetOrCreateByPath(std::string const& path, PathOptions const& options, CreateFunc&& create) {
+			while (true) {
+				std::promise<ImageID> promise{};
+				bool creator = false;
+				std::shared_future<ImageID> future = imgMgrPtr->imageStringToIDMap.FindOrInsert(path,
+					[&]() {
+						creator = true;
+						return promise.get_future().share();
+					}
+				);
+				if (creator) {
+					ImageID ret;
+					try {
+						ret = create();
+					}
+					catch (...) {
+						//the waiters get the exception, the next request tries again
+						promise.set_exception(std::current_exception());
+						imgMgrPtr->imageStringToIDMap.Erase(path);
+						throw;
+					}
+					imgMgrPtr->imageTrackerIDMap.Modify(ret, [&](ImageTracker*& tracker) {
+						tracker->path = path;
+						tracker->pathOptions = options;
+					});
+					promise.set_value(ret);
+					return ret;
+				}
+
+				const ImageID ret = future.get();
+				bool alive = false;
+				imgMgrPtr->imageTrackerIDMap.Modify(ret, [&](ImageTracker*& tracker) {
+					//RemoveImage decided to delete it, the path is about to be erased
+					if ((tracker->usageCount == 0) && tracker->zeroUsageDelete) {
+						return;
+					}
+					alive = true;
+					tracker->usageCount++;
+#if EWE_DEBUG
+					if (tracker->pathOptions != options) {
+						printf("image %s was requested with different options than it was loaded with - same sampler %d, mipmap %d:%d, zeroUsageDelete %d:%d\n", path.c_str(),
+							tracker->pathOptions.sampler == options.sampler,
+							tracker->pathOptions.mipmap, options.mipmap,
+							tracker->pathOptions.zeroUsageDelete, options.zeroUsageDelete
+						);
+					}
+#endif
+					assert((tracker->pathOptions == options) && "the same path can't be loaded with different options");
+				});
+				if (alive) {
+					return ret;
+				}
+				std::this_thread::yield();
+			}
+		}
+
 	public:
 		struct ImageReturn {
 			ImageID imgID;
@@ -81,10 +158,14 @@ namespace EWE {
 #if EWE_DEBUG
 			assert(imgID != IMAGE_INVALID);
 #endif
-			std::unique_lock<std::mutex> uniq_lock(imgMgrPtr->imageMutex);
-			return imgMgrPtr->imageTrackerIDMap.at(imgID)->imageInfo.GetDescriptorImageInfo();
+			ImageTracker* tracker{ nullptr };
+			imgMgrPtr->imageTrackerIDMap.Find(imgID, tracker);
+			assert(tracker != nullptr && "image doesn't exist");
+			return tracker->imageInfo.GetDescriptorImageInfo();
 		}
 		static ImageID FindByPath(std::string const& path);
+		//the image's index in the global bindless texture table, see BindlessTextures.h. stable until the image is removed
+		static uint32_t GetBindlessIndex(ImageID imgID);
 
 		//void ClearSceneImages();
 		//void RemoveMaterialImage(TextureDesc removeID);
@@ -0,0 +1,74 @@
+#pragma once
+
+//only the enums are used, nothing in here touches a device
+#include <vulkan/vulkan_core.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+* KTX2 container parsing
+	the texture data is used as it's stored, block compressed formats go to the GPU without being decoded
+	the prebuilt mip chain in the file is uploaded as is
+	supercompressed files (BasisLZ, Zstd, zlib) and VK_FORMAT_UNDEFINED (UASTC) aren't supported, they need a transcoder
+	2D textures only, no arrays, cubemaps or 3D
+	Image::CreateImage picks this up for any path ending in .ktx2
+	Write produces the same kind of file, it's what the TextureCooker stores
+*/
+
+namespace EWE {
+	namespace KTX2 {
+		struct FormatBlock {
+			uint32_t width;
+			uint32_t height;
+			uint32_t bytes;
+		};
+		//false for formats this loader doesn't handle
+		bool GetFormatBlock(VkFormat format, FormatBlock& block);
+		bool IsBlockCompressed(VkFormat format);
+
+		struct Level {
+			//into Texture::data
+			uint64_t offset;
+			uint64_t size;
+			uint32_t width;
+			uint32_t height;
+		};
+		struct Texture {
+			VkFormat format{ VK_FORMAT_UNDEFINED };
+			uint32_t width{ 0 };
+			uint32_t height{ 0 };
+			//level 0 is the full size image
+			std::vector<Level> levels{};
+			//the whole file
+			std::vector<uint8_t> data{};
+		};
+
+		enum class ParseResult : uint8_t {
+			Success,
+			FileError,
+			BadIdentifier,
+			Truncated,
+			Malformed,
+			Unsupported,
+		};
+		const char* ToString(ParseResult result);
+
+		//takes the file contents. out is only valid on Success
+		ParseResult Parse(std::vector<uint8_t>&& fileData, Texture& out);
+		ParseResult Load(std::string const& path, Texture& out);
+
+		bool IsKTX2Path(std::string const& path);
+
+		//level offsets in a staging buffer, each level aligned so the copy offset is valid for any supported format
+		static constexpr uint64_t LEVEL_ALIGNMENT = 16;
+		//fills packedOffsets and returns the total size
+		uint64_t PackLevels(Texture const& texture, std::vector<uint64_t>& packedOffsets);
+
+		//2D, 1 layer, no supercompression. levels[0] is the full size image, each level tightly packed in the format's blocks
+		//written to a temp file and renamed over path, a reader never sees a partial file
+		//only BC1, BC3, BC4, BC5 and RGBA8 have a data format descriptor here, false for anything else or if the file couldn't be written
+		bool Write(std::string const& path, VkFormat format, uint32_t width, uint32_t height, std::vector<std::vector<uint8_t>> const& levels);
+	} //namespace KTX2
+} //namespace EWE
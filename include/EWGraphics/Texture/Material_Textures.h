@@ -7,7 +7,20 @@ namespace EWE {
 	private:
 
 	public:
+		//the maps are found through a cached scan of the directory, and decoded in parallel on the thread pool
 		static MaterialInfo CreateMaterialImage(std::string texPath, bool mipmapping, bool global);
+		//the directory scans are cached, call this if texture files were added or removed at runtime
+		static void ClearDirectoryIndex();
+
+		struct MaterialMaps {
+			//in Material::Attributes::Texture order, only the ones that were found
+			std::vector<std::string> paths{};
+			MaterialFlags flags{ 0 };
+		};
+		//the file lookup half of CreateMaterialImage, nothing is decoded or uploaded. texPath is relative to TEXTURE_DIR
+		static MaterialMaps FindMaps(std::string const& texPath);
+		//the decode half, one PixelPeek per path in the same order. the calling thread helps, the pixels are the caller's to free
+		static std::vector<PixelPeek> DecodeMaps(std::vector<std::string>&& paths);
 	protected:
 
 	};
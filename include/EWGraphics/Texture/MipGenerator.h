@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/*
+* CPU mip chain generation for RGBA8 images
+	each level is filtered from the one above it, separably. color is filtered in linear space when srgb, alpha is always linear
+	box is the 2x2 average, kaiser is an 8 tap kaiser windowed sinc, sharper and without the box's aliasing, it can ring so the output is clamped
+	alpha coverage preservation scales each level's alpha so the fraction of texels passing alphaCutoff matches level 0,
+		alpha tested foliage and fences don't thin out in the distance
+	the rows of a level are split across the thread pool, the calling thread takes part, so it's safe to call from inside the pool
+	SSE2 on x64 (AVX2 when the build enables it), scalar elsewhere
+	the whole chain ends up in CPU memory, uploading it is copies only. no blits, no graphics queue, and it works for anything that's compressed afterwards
+*/
+
+namespace EWE {
+	namespace MipGenerator {
+		enum class Filter : uint8_t {
+			Box,
+			Kaiser,
+		};
+		struct Options {
+			Filter filter{ Filter::Box };
+			bool srgb{ true };
+			bool preserveAlphaCoverage{ false };
+			float alphaCutoff{ 0.5f };
+		};
+
+		struct Level {
+			//from the start of the chain
+			uint64_t offset;
+			uint32_t width;
+			uint32_t height;
+		};
+
+		//down to 1x1
+		uint32_t LevelCount(uint32_t width, uint32_t height);
+		//levels tightly packed, level 0 first, 4 bytes per texel. returns the total size
+		uint64_t Layout(uint32_t width, uint32_t height, uint32_t levelCount, std::vector<Level>& levels);
+
+		//dst is Layout's size, level 0 is copied in from src
+		//dst is read back while generating, it should be regular memory, not a mapped staging buffer
+		void Generate(const uint8_t* src, uint32_t width, uint32_t height, uint32_t levelCount, uint8_t* dst, Options const& options);
+
+		struct Stats {
+			uint32_t chains;
+			uint64_t texelsGenerated; //level 0 isn't counted
+			double totalMS;
+		};
+		Stats GetStats();
+		void PrintStats();
+	} //namespace MipGenerator
+} //namespace EWE
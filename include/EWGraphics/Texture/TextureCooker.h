@@ -0,0 +1,74 @@
+#pragma once
+
+#include "EWGraphics/Preprocessor.h"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+/*
+* texture cooker, source images (png, jpg, tga) into GPU ready ktx2 files
+	the cooked file is block compressed with every mip level built on the CPU, loading it is one read and a copy, no decoding and no blits
+	the cache is content addressed, cooked files are named by a hash of the source bytes and the cook options
+		a small stamp per source path holds the source's size and write time, and the hash it cooked to
+		a warm load only stats the source and reads the stamp, the source is never opened
+		if the stamp doesn't match, the source is hashed again. unchanged content (a touched file) reuses the cooked file, changed content cooks again
+	cooking happens the first time a path is loaded, or ahead of time with CookDirectory
+	Image::CreateImage goes through here when TEXTURE_COOKING is on and the device has BC support, anything that fails falls back to the source
+*/
+
+namespace EWE {
+	namespace TextureCooker {
+		enum class Encoding : uint8_t {
+			Auto, //BC1 if every pixel is opaque, BC3 otherwise
+			BC1,
+			BC3,
+			BC4, //red only
+			BC5, //red and green, normal maps
+		};
+		struct Options {
+			Encoding encoding{ Encoding::Auto };
+			//BC1 and BC3 only
+			bool srgb{ true };
+			bool mipmap{ true };
+		};
+
+		enum class Result : uint8_t {
+			Warm, //the stamp matched
+			Rehashed, //the stamp was stale, the content hash was already cooked
+			Cooked, //cold
+			Failed, //load the source instead
+		};
+
+		struct Stats {
+			uint32_t warmLoads;
+			double warmLoadMS;
+			uint32_t rehashedLoads;
+			double rehashedLoadMS;
+			uint32_t coldLoads;
+			double coldLoadMS;
+			//the part of the cold loads spent decoding, building mips and compressing
+			double cookMS;
+			uint32_t failures;
+		};
+
+		//set by the device, textureCompressionBC was enabled
+		void SetSupport(bool supported);
+		bool Enabled();
+
+		//any thread. cookedPath is only set when the result isn't Failed
+		//two calls for the same path shouldn't overlap, Image_Manager's single flight takes care of that
+		Result GetCooked(std::string const& sourcePath, Options const& options, std::string& cookedPath);
+		//the cooked file couldn't be loaded, corrupt or in a format the device can't sample. removes it and the source's stamp
+		//the next GetCooked for the source cooks it again
+		void Discard(std::string const& sourcePath, Options const& options, std::string const& cookedPath);
+		//build time or loading screen pass, cooks everything under directory that isn't already cooked. returns how many were cooked
+		uint32_t CookDirectory(std::string const& directory, Options const& options);
+
+		//wraps the whole load, cooking and the image creation included
+		void RecordLoad(Result result, std::chrono::steady_clock::duration duration);
+
+		Stats GetStats();
+		void PrintStats();
+	} //namespace TextureCooker
+} //namespace EWE
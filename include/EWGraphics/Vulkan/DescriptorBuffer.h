@@ -0,0 +1,77 @@
+#pragma once
+
+#include "EWGraphics/Vulkan/Descriptors.h"
+
+#ifndef DESCRIPTOR_BUFFER_HEAP_SIZE
+#define DESCRIPTOR_BUFFER_HEAP_SIZE (4 * 1024 * 1024)
+#endif
+
+/*
+* descriptor buffer backend, VK_EXT_descriptor_buffer
+	descriptors are written straight into one mapped buffer with vkGetDescriptorEXT, and bound by offset
+	there's no pool, no set allocation, and no tracker. transient allocations are a lock free bump in the frame's region
+	off unless DESCRIPTOR_BUFFER is defined true
+	layouts have to be built with DescriptorSetLayout::Builder::BuildForDescriptorBuffer,
+		and pipelines that use them need VK_PIPELINE_CREATE_DESCRIPTOR_BUFFER_BIT_EXT (PipelineCreateFlags)
+		PipeLayout's layouts are classic ones and GraphicsPipeline/ComputePipeline don't set the flag, so those pipelines are created by the user
+	EWEDescriptorWriter::BuildInDescriptorBuffer takes the same writes as Build
+	when it's off, or the extension or bufferDeviceAddress isn't available, Enabled() is false and the classic descriptor set path is the one to use
+*/
+
+namespace EWE {
+	namespace DescriptorBuffer {
+		struct Allocation {
+			VkDeviceSize offset{ 0 };
+			VkDeviceSize size{ 0 }; //0 if the allocation failed
+
+			bool Valid() const { return size > 0; }
+		};
+
+		struct Stats {
+			//the last completed frame
+			uint32_t transientAllocations;
+			VkDeviceSize transientBytes;
+			uint32_t transientFailures; //the frame's region was full
+			//current
+			uint32_t persistentLive;
+			VkDeviceSize persistentBytes;
+			uint32_t persistentRetiring;
+		};
+
+		//set by the device, the extension and the descriptorBuffer + bufferDeviceAddress features were enabled
+		void SetSupport(bool supported);
+		bool Enabled();
+		//the usage buffers need to be described, only adds anything when Enabled
+		VkBufferUsageFlags BufferUsage(VkBufferUsageFlags usage);
+		//0 when not Enabled
+		VkPipelineCreateFlags PipelineCreateFlags();
+
+		//main thread, after the allocator exists. does nothing if not Enabled
+		void Initialize();
+		//main thread, after the device is idle
+		void Destroy();
+
+		//fills in the layout's size and binding offsets, called from BuildVkDSL
+		void QueryLayout(DescriptorSetLayout& layout);
+
+		//main thread, right after the frame's fence wait. resets this frame's transient region
+		void BeginFrame();
+		//main thread, at the end of every frame. returns persistent allocations that are out of flight
+		void Update();
+
+		//any thread, valid for the frame being recorded. never locks or waits
+		Allocation AllocateTransient(DescriptorSetLayout const& layout);
+		//any thread, until FreePersistent
+		Allocation AllocatePersistent(DescriptorSetLayout const& layout);
+		void FreePersistent(Allocation allocation);
+
+		//writes has to be in binding order, the way EWEDescriptorWriter builds it
+		void Write(DescriptorSetLayout const& layout, Allocation allocation, std::vector<VkWriteDescriptorSet> const& writes);
+
+		//binds the heap to the frame's command buffer if it isn't yet, then sets the offset for setIndex
+		void Bind(VkPipelineBindPoint bindPoint, VkPipelineLayout pipeLayout, uint32_t setIndex, Allocation allocation);
+
+		Stats GetStats();
+		void PrintStats();
+	} //namespace DescriptorBuffer
+} //namespace EWE
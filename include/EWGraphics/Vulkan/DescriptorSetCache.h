@@ -0,0 +1,215 @@
+#pragma once
+
+#include "EWGraphics/Vulkan/Descriptors.h"
+#include "EWGraphics/Data/Hash.h"
+
+#include <algorithm>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+/*
+* descriptor set content cache
+	the key is the layout and the contents of every write - buffers, offsets, ranges, image views, samplers, layouts
+	writing the same thing to the same layout again gives back the set that already has it, no allocation or vkUpdateDescriptorSets
+	cached sets are owned by the cache and never freed by the caller
+	destroying a buffer, image view, sampler or layout evicts every set that referenced it, the set is freed once it's out of flight
+	Index and MakeKey don't touch the device
+*/
+
+namespace EWE {
+	namespace DescriptorSetCache {
+		template<typename Handle>
+		inline uint64_t HandleBits(Handle handle) {
+			if constexpr (std::is_pointer_v<Handle>) {
+				return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(handle));
+			}
+			else {
+				return static_cast<uint64_t>(handle);
+			}
+		}
+
+		struct Key {
+			std::vector<uint64_t> words{};
+			std::vector<uint64_t> resources{}; //every handle the set references, for eviction
+			std::size_t hash{ 0 };
+
+			bool operator==(Key const& other) const {
+				return (hash == other.hash) && (words == other.words);
+			}
+		};
+
+		//pure, the writes aren't dereferenced past their infos. dstSet is ignored
+		inline Key MakeKey(VkDescriptorSetLayout layout, VkWriteDescriptorSet const* writes, uint32_t writeCount) {
+			Key key{};
+			key.words.push_back(HandleBits(layout));
+			key.resources.push_back(HandleBits(layout));
+			for (uint32_t i = 0; i < writeCount; i++) {
+				VkWriteDescriptorSet const& write = writes[i];
+				key.words.push_back((static_cast<uint64_t>(write.dstBinding) << 32) | write.dstArrayElement);
+				key.words.push_back((static_cast<uint64_t>(write.descriptorType) << 32) | write.descriptorCount);
+				for (uint32_t desc = 0; desc < write.descriptorCount; desc++) {
+					if (write.pBufferInfo != nullptr) {
+						VkDescriptorBufferInfo const& bufferInfo = write.pBufferInfo[desc];
+						key.words.push_back(HandleBits(bufferInfo.buffer));
+						key.words.push_back(bufferInfo.offset);
+						key.words.push_back(bufferInfo.range);
+						key.resources.push_back(HandleBits(bufferInfo.buffer));
+					}
+					else if (write.pImageInfo != nullptr) {
+						VkDescriptorImageInfo const& imageInfo = write.pImageInfo[desc];
+						key.words.push_back(HandleBits(imageInfo.sampler));
+						key.words.push_back(HandleBits(imageInfo.imageView));
+						key.words.push_back(static_cast<uint64_t>(imageInfo.imageLayout));
+						if (imageInfo.sampler != VK_NULL_HANDLE) {
+							key.resources.push_back(HandleBits(imageInfo.sampler));
+						}
+						if (imageInfo.imageView != VK_NULL_HANDLE) {
+							key.resources.push_back(HandleBits(imageInfo.imageView));
+						}
+					}
+					else {
+						//texel buffer views and acceleration structures aren't cached
+						key.words.clear();
+						return key;
+					}
+				}
+			}
+			std::sort(key.resources.begin(), key.resources.end());
+			key.resources.erase(std::unique(key.resources.begin(), key.resources.end()), key.resources.end());
+
+			//FNV-1a over the words
+			uint64_t hash = Hash::FNV_OFFSET;
+			for (uint64_t word : key.words) {
+				hash = Hash::FNV1aWord(word, hash);
+			}
+			key.hash = static_cast<std::size_t>(hash);
+			return key;
+		}
+		//an uncacheable write leaves the key empty
+		inline bool Cacheable(Key const& key) {
+			return key.words.size() > 0;
+		}
+
+		//the bookkeeping, not thread safe on its own
+		class Index {
+		public:
+			//VK_NULL_HANDLE on a miss
+			VkDescriptorSet Find(Key const& key) {
+				auto range = byHash.equal_range(key.hash);
+				for (auto iter = range.first; iter != range.second; iter++) {
+					if (entries.at(iter->second) == key) {
+						hits++;
+						return iter->second;
+					}
+				}
+				misses++;
+				return VK_NULL_HANDLE;
+			}
+			void Insert(Key&& key, VkDescriptorSet set) {
+				assert(!entries.contains(set));
+				byHash.emplace(key.hash, set);
+				for (uint64_t resource : key.resources) {
+					byResource[resource].push_back(set);
+				}
+				entries.emplace(set, std::move(key));
+			}
+			//the sets that referenced resource. they're out of the index, the caller frees them
+			std::vector<VkDescriptorSet> Evict(uint64_t resource) {
+				std::vector<VkDescriptorSet> ret{};
+				auto findRet = byResource.find(resource);
+				if (findRet == byResource.end()) {
+					return ret;
+				}
+				ret = std::move(findRet->second);
+				byResource.erase(findRet);
+				for (VkDescriptorSet set : ret) {
+					Remove(set, resource);
+				}
+				evictions += static_cast<uint32_t>(ret.size());
+				return ret;
+			}
+			std::vector<VkDescriptorSet> Clear() {
+				std::vector<VkDescriptorSet> ret{};
+				ret.reserve(entries.size());
+				for (auto const& entry : entries) {
+					ret.push_back(entry.first);
+				}
+				entries.clear();
+				byHash.clear();
+				byResource.clear();
+				return ret;
+			}
+
+			uint32_t Live() const { return static_cast<uint32_t>(entries.size()); }
+			uint32_t hits{ 0 };
+			uint32_t misses{ 0 };
+			uint32_t evictions{ 0 };
+
+		private:
+			//skipResource's list was already taken
+			void Remove(VkDescriptorSet set, uint64_t skipResource) {
+				auto entryIter = entries.find(set);
+				assert(entryIter != entries.end());
+				Key const& key = entryIter->second;
+
+				auto range = byHash.equal_range(key.hash);
+				for (auto iter = range.first; iter != range.second; iter++) {
+					if (iter->second == set) {
+						byHash.erase(iter);
+						break;
+					}
+				}
+				for (uint64_t resource : key.resources) {
+					if (resource == skipResource) {
+						continue;
+					}
+					auto resourceIter = byResource.find(resource);
+					if (resourceIter == byResource.end()) {
+						continue;
+					}
+					auto& sets = resourceIter->second;
+					sets.erase(std::remove(sets.begin(), sets.end(), set), sets.end());
+					if (sets.size() == 0) {
+						byResource.erase(resourceIter);
+					}
+				}
+				entries.erase(entryIter);
+			}
+
+			std::unordered_map<VkDescriptorSet, Key> entries{};
+			std::unordered_multimap<std::size_t, VkDescriptorSet> byHash{};
+			std::unordered_map<uint64_t, std::vector<VkDescriptorSet>> byResource{};
+		};
+
+		struct Stats {
+			uint32_t hits;
+			uint32_t misses;
+			uint32_t live;
+			uint32_t evictions;
+			uint32_t pendingFrees; //evicted, waiting on frames in flight
+			float hitRate;
+		};
+
+		//any thread. allocates from pool and writes on a miss. writes have to be buffer or image infos
+		//EWEDescriptorWriter::BuildCached is the usual way in
+		VkDescriptorSet Acquire(DescriptorSetLayout* eDSL, EWEDescriptorPool& pool, std::vector<VkWriteDescriptorSet>& writes);
+
+		//called where the handle is destroyed
+		void EvictResource(uint64_t resource);
+		template<typename Handle>
+		void Evict(Handle handle) {
+			if (handle != VK_NULL_HANDLE) {
+				EvictResource(HandleBits(handle));
+			}
+		}
+
+		//main thread, at the end of every frame. frees evicted sets that are out of flight
+		void Update();
+		//main thread, after the device is idle
+		void Destroy();
+
+		Stats GetStats();
+		void PrintStats();
+	} //namespace DescriptorSetCache
+} //namespace EWE
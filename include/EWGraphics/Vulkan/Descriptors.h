@@ -25,6 +25,8 @@ namespace EWE {
             Builder& AddGlobalBindings();
             DescriptorSetLayout* Build();
             DescriptorSetLayout* BuildBindless();
+            //for DescriptorBuffer, only valid when DescriptorBuffer::Enabled()
+            DescriptorSetLayout* BuildForDescriptorBuffer();
 
             //the vkDSL wont be built automatically, DescriptorSetLayout::BuildVkDSL needs to be called explicitly
             DescriptorSetLayout BuildInPlace(); 
@@ -35,18 +37,48 @@ namespace EWE {
         DescriptorSetLayout();
         DescriptorSetLayout(std::vector<VkDescriptorSetLayoutBinding>& bindings, bool bindless = false);
         DescriptorSetLayout(std::vector<VkDescriptorSetLayoutBinding> const& bindings, bool bindless = false);
+        //bindingFlags is parallel to bindings
+        DescriptorSetLayout(std::vector<VkDescriptorSetLayoutBinding> const& bindings, std::vector<VkDescriptorBindingFlags> const& bindingFlags);
         ~DescriptorSetLayout();
         DescriptorSetLayout(const DescriptorSetLayout&) = delete;
         DescriptorSetLayout& operator=(const DescriptorSetLayout&) = delete;
 
         void BuildVkDSL();
+        //writes has to be in binding order, the way EWEDescriptorWriter builds it. dstSet is filled in
+        void WriteSet(VkDescriptorSet set, std::vector<VkWriteDescriptorSet>& writes) const;
+
+        //one packed slot per binding, the template reads straight out of an array of these
+        union TemplateData {
+            VkDescriptorBufferInfo buffer;
+            VkDescriptorImageInfo image;
+        };
+        //the template's entries, one per binding. false if a binding can't be templated. no device
+        static bool BuildTemplateEntries(std::vector<VkDescriptorSetLayoutBinding> const& bindings, std::vector<VkDescriptorUpdateTemplateEntry>& entries);
+        //data has a slot per write
+        static void PackTemplateData(std::vector<VkWriteDescriptorSet> const& writes, TemplateData* data);
 
         VkDescriptorSetLayout vkDSL;
+        //VK_NULL_HANDLE if a binding can't be templated (arrays, texel buffers, bindless)
+        VkDescriptorUpdateTemplate updateTemplate{ VK_NULL_HANDLE };
         operator VkDescriptorSetLayout() const {
             return vkDSL;
         }
         std::vector<VkDescriptorSetLayoutBinding> bindings;
+        //empty if none of the bindings have flags
+        std::vector<VkDescriptorBindingFlags> bindingFlags;
         const bool bindless;
+
+        //set before BuildVkDSL. the layout can't be used with descriptor sets
+        bool descriptorBuffer{ false };
+        //filled by DescriptorBuffer::QueryLayout
+        VkDeviceSize bufferSize{ 0 };
+        //indexed by binding
+        std::vector<VkDeviceSize> bindingOffsets{};
+
+    private:
+#if DESCRIPTOR_UPDATE_TEMPLATES
+        void BuildUpdateTemplate();
+#endif
     };
 
     class DescriptorLayoutPack{
@@ -62,6 +94,8 @@ namespace EWE {
         [[nodiscard]] VkDescriptorSetLayout* GetDescriptorSetLayout(uint8_t index);
 
         KeyValueContainer<uint8_t, DescriptorSetLayout*> setLayouts{};
+        //the layouts came from LayoutCache, and are released to it instead of deconstructed
+        bool interned{ false };
     };
     
     typedef uint16_t DescriptorPool_ID;
@@ -152,6 +186,10 @@ namespace EWE {
         friend class EWEDescriptorWriter;
     };
 
+    namespace DescriptorBuffer {
+        struct Allocation;
+    } //namespace DescriptorBuffer
+
     class EWEDescriptorWriter {
     public:
         EWEDescriptorWriter(DescriptorSetLayout* setLayout, EWEDescriptorPool& pool);
@@ -161,7 +199,12 @@ namespace EWE {
         EWEDescriptorWriter& WriteImage(VkDescriptorImageInfo* imgInfo);
         EWEDescriptorWriter& WriteImage(ImageID imageID);
         VkDescriptorSet Build();
+        //an identical set that was already built is returned instead, see DescriptorSetCache.h. the caller doesn't free it
+        VkDescriptorSet BuildCached();
         void Overwrite(VkDescriptorSet& set);
+        //the layout has to be built with BuildForDescriptorBuffer, the pool isn't touched
+        //transient is only valid for the frame being recorded, otherwise free it with DescriptorBuffer::FreePersistent
+        DescriptorBuffer::Allocation BuildInDescriptorBuffer(bool transient = true);
 
     private:
         VkDescriptorSet BuildPrint();
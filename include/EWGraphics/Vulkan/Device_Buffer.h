@@ -1,6 +1,7 @@
 #pragma once
 
 #include "EWGraphics/Vulkan/Device.hpp"
+#include "EWGraphics/Vulkan/ResourceState.h"
 
 namespace EWE {
 
@@ -44,6 +45,8 @@ namespace EWE {
         VkBufferUsageFlags GetUsageFlags() const { return usageFlags; }
         VkMemoryPropertyFlags GetMemoryPropertyFlags() const { return memoryPropertyFlags; }
         VkDeviceSize GetBufferSize() const { return bufferSize; }
+        //last owner/access, kept up to date by ResourceTracker
+        ResourceState& GetState() { return state; }
 
         //allocated with new, up to the user to delete, or put it in a unique_ptr
         static EWEBuffer* CreateAndInitBuffer(void* data, uint64_t dataSize, uint64_t dataCount, VkBufferUsageFlags usageFlags, VkMemoryPropertyFlags memoryPropertyFlags);
@@ -62,6 +65,7 @@ namespace EWE {
         VkBufferUsageFlags usageFlags;
         VkMemoryPropertyFlags memoryPropertyFlags;
         VkDeviceSize minOffsetAlignment = 1;
+        ResourceState state{};
 
 #if USING_VMA
         VmaAllocation vmaAlloc{};
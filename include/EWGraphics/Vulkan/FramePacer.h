@@ -0,0 +1,74 @@
+#pragma once
+
+#include "EWGraphics/Vulkan/VulkanHeader.h"
+
+#include <array>
+#include <chrono>
+
+/*
+* frame pacing, owned by EWERenderer and driven from BeginFrame
+	the time spent blocked on the frame's in flight fence is how far the CPU is running ahead of the GPU
+	Throughput - no sleeping, the CPU queues as deep as framesInFlight allows
+	LowLatency - sleeps before the fence wait, for the predicted fence wait minus a margin
+		input sampled after BeginFrame is that much fresher, at the cost of some risk of starving the GPU
+	Adaptive - LowLatency, and framesInFlight is adjusted over time
+		deeper if the CPU never waits and frame times are spiky, shallower if the CPU spends a lot of the frame waiting
+*/
+
+namespace EWE {
+	class FramePacer {
+	public:
+		enum class Mode : uint8_t {
+			Throughput,
+			LowLatency,
+			Adaptive,
+		};
+
+		//over the last windowSize frames, in milliseconds
+		struct Stats {
+			double frameTimeMean;
+			double frameTimeVariance;
+			double frameTimeStdDev;
+			double frameTimeMax;
+			double fenceWaitMean;
+			double sleepMean;
+			double predictedWait;
+			uint8_t framesInFlight;
+			uint16_t sampleCount;
+		};
+
+		static constexpr uint16_t windowSize = 128;
+
+	private:
+		using Clock = std::chrono::steady_clock;
+
+		Mode mode{ Mode::Throughput };
+		double safetyMargin{ 0.5 };
+		//exponential moving average of the slack, sleep + fence wait
+		double predictedWait{ 0.0 };
+
+		Clock::time_point lastFrameStart{};
+		bool hasLastFrame{ false };
+
+		std::array<float, windowSize> frameTimes{};
+		std::array<float, windowSize> fenceWaits{};
+		std::array<float, windowSize> sleeps{};
+		uint16_t sampleIndex{ 0 };
+		uint16_t sampleCount{ 0 };
+		uint16_t framesSinceDepthChange{ 0 };
+
+		void AdjustDepth(Stats const& stats);
+
+	public:
+		void SetMode(Mode mode);
+		Mode GetMode() const { return mode; }
+		//how much of the predicted wait is left unslept, in milliseconds
+		void SetSafetyMargin(double milliseconds) { safetyMargin = milliseconds; }
+
+		//sleeps if pacing for latency, then waits on the current frame's in flight fence
+		void BeginFrame();
+
+		Stats GetStats() const;
+		void PrintStats() const;
+	};
+} //namespace EWE
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "EWGraphics/Vulkan/Descriptors.h"
+
+#include <vector>
+
+/*
+* interning for descriptor set layouts and pipeline layouts
+	identical binding descriptions give back the same DescriptorSetLayout, identical set layouts + push ranges give back the same VkPipelineLayout
+	pipelines that share layouts can keep their bound sets across vkCmdBindPipeline
+	everything is ref counted, each Acquire needs a matching Release. the vulkan object is destroyed when the count hits 0
+	thread safe
+*/
+
+namespace EWE {
+	namespace LayoutCache {
+		struct Stats {
+			uint32_t dslHits;
+			uint32_t dslMisses; //every miss creates a unique layout
+			uint32_t dslLive;
+			uint32_t pipeLayoutHits;
+			uint32_t pipeLayoutMisses;
+			uint32_t pipeLayoutLive;
+		};
+
+		//bindingFlags is parallel to bindings, or empty. the returned layout is built
+		DescriptorSetLayout* AcquireDSL(std::vector<VkDescriptorSetLayoutBinding> const& bindings, std::vector<VkDescriptorBindingFlags> const& bindingFlags);
+		void ReleaseDSL(DescriptorSetLayout* dsl);
+
+		//setLayouts should be interned handles, otherwise identical layouts won't match
+		VkPipelineLayout AcquirePipelineLayout(std::vector<VkDescriptorSetLayout> const& setLayouts, std::vector<VkPushConstantRange> const& pushRanges);
+		//another reference to a layout that was acquired from the cache, for work that outlives the PipeLayout
+		void RetainPipelineLayout(VkPipelineLayout pipeLayout);
+		void ReleasePipelineLayout(VkPipelineLayout pipeLayout);
+
+		Stats GetStats();
+		void PrintStats();
+
+		//the keying, no device. empty bindingFlags are the same as all zero
+		std::size_t HashDSL(std::vector<VkDescriptorSetLayoutBinding> const& bindings, std::vector<VkDescriptorBindingFlags> const& bindingFlags);
+		bool SameDSL(std::vector<VkDescriptorSetLayoutBinding> const& bindingsA, std::vector<VkDescriptorBindingFlags> const& bindingFlagsA,
+			std::vector<VkDescriptorSetLayoutBinding> const& bindingsB, std::vector<VkDescriptorBindingFlags> const& bindingFlagsB
+		);
+		std::size_t HashPipeLayout(std::vector<VkDescriptorSetLayout> const& setLayouts, std::vector<VkPushConstantRange> const& pushRanges);
+		bool SamePipeLayout(std::vector<VkDescriptorSetLayout> const& setLayoutsA, std::vector<VkPushConstantRange> const& pushRangesA,
+			std::vector<VkDescriptorSetLayout> const& setLayoutsB, std::vector<VkPushConstantRange> const& pushRangesB
+		);
+	} //namespace LayoutCache
+} //namespace EWE
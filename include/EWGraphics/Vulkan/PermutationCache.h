@@ -0,0 +1,64 @@
+#pragma once
+
+#include "EWGraphics/Vulkan/PipelineLibrary.h"
+
+#include <vector>
+
+/*
+* pipeline permutation cache
+	a permutation is the shader modules (by content hash), the packed spec constant values, and the fixed function state for graphics
+	the layout isn't part of the key, it's derived from the shaders
+	an identical permutation returns the existing VkPipeline instead of compiling again, ref counted
+	every permutation whose shaders came from files is recorded. the list is written out on Destroy,
+		and Prewarm compiles that list on the thread pool at startup
+	a permutation's handle can be upgraded once (fast linked -> optimized, see PipelineLibrary.h)
+		pipelines pick up the new handle through Refresh, and the old one is destroyed once nothing holds it and the frames using it are done
+*/
+
+namespace EWE {
+	namespace PermutationCache {
+		struct Key {
+			std::vector<uint8_t> bytes; //module hashes, packed spec data, packed state
+			std::size_t hash;
+			std::vector<uint8_t> record; //the same, with shader file paths instead of hashes. empty if a shader didn't come from a file
+		};
+
+		struct Stats {
+			uint32_t hits;
+			uint32_t misses;
+			uint32_t live;
+			uint32_t prewarmed;
+			uint32_t prewarmHits; //hits on a permutation that only exists because it was prewarmed
+			float hitRate;
+		};
+
+		Key MakeComputeKey(PipeLayout const& layout, std::vector<KeyValuePair<ShaderStage, std::vector<Shader::SpecializationEntry>>> const& specInfo);
+		Key MakeGraphicsKey(PipeLayout const& layout, PipelineConfigInfo const& configInfo, std::vector<KeyValuePair<ShaderStage, std::vector<Shader::SpecializationEntry>>> const& specInfo);
+
+		//VK_NULL_HANDLE on a miss. a hit adds a reference
+		VkPipeline Acquire(Key const& key);
+		//call after a miss, with the freshly compiled pipeline. if another thread inserted the same key first, pipeline is destroyed and theirs is returned
+		//libraryParts are the references from PipelineLibrary::FastLink, the permutation holds them until it's destroyed (or drops them right away if it lost the race)
+		VkPipeline Insert(Key const& key, VkPipeline pipeline, PipelineLibrary::LinkedParts const& libraryParts = {});
+		//destroys the pipeline when the last reference is released
+		void Release(VkPipeline pipeline);
+
+		//replaces pipeline with upgraded for future Acquires. if pipeline has already been released, upgraded is destroyed
+		void Upgrade(VkPipeline pipeline, VkPipeline upgraded);
+		//changes every time a permutation is upgraded
+		uint32_t GetUpgradeGeneration();
+		//the current handle for the permutation pipeline belongs to, moving the reference over
+		VkPipeline Refresh(VkPipeline pipeline);
+		//main thread, once per frame. destroys upgraded handles that are no longer in flight
+		void Update();
+
+		//main thread, after PipelineConfigInfo::pipelineRenderingInfoStatic is set. compiles on the thread pool and returns immediately
+		void Prewarm();
+		void WaitForPrewarm();
+		//main thread. waits for prewarming, writes the permutation list, and destroys every cached pipeline
+		void Destroy();
+
+		Stats GetStats();
+		void PrintStats();
+	} //namespace PermutationCache
+} //namespace EWE
@@ -76,8 +76,17 @@ namespace EWE {
 
 		DescriptorLayoutPack* descriptorSets;
 		std::vector<VkPushConstantRange> pushConstantRanges{};
+		//disjoint pieces of the push ranges, each with every stage that overlaps it. sorted by offset
+		struct PushSegment {
+			uint32_t offset;
+			uint32_t size;
+			VkShaderStageFlags stageFlags;
+		};
+		std::vector<PushSegment> pushSegments{};
 		VkPipelineLayout vkLayout;
 		PipelineType pipelineType;
+		//null uses a shared layout from LayoutCache
+		VkAllocationCallbacks* allocCallbacks{ nullptr };
 
 		std::vector<VkPipelineShaderStageCreateInfo> GetStageData() const;
 		std::vector<VkPipelineShaderStageCreateInfo> GetStageData(std::vector<KeyValuePair<ShaderStage, Shader::VkSpecInfo_RAII>> const& specInfo) const;
@@ -86,9 +95,15 @@ namespace EWE {
 
 		PipeLayout(std::initializer_list<Shader*> shaders, VkAllocationCallbacks* allocCallbacks = nullptr);
 		PipeLayout(std::initializer_list<std::string_view> shaderFileLocations, VkAllocationCallbacks* allocCallbacks = nullptr);
+		PipeLayout(std::vector<Shader*> const& shaders, VkAllocationCallbacks* allocCallbacks = nullptr);
+		~PipeLayout();
+		PipeLayout(PipeLayout const&) = delete;
+		PipeLayout& operator=(PipeLayout const&) = delete;
 
 #if PIPELINE_HOT_RELOAD
 		void HotReload();
+		//everything but the address, for swapping a rebuilt layout into one a user holds
+		void SwapContents(PipeLayout& other);
 		void DrawImgui();
 #endif
 #if DEBUG_NAMING
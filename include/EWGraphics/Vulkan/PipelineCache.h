@@ -0,0 +1,68 @@
+#pragma once
+
+#include "EWGraphics/Vulkan/VulkanHeader.h"
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <mutex>
+#include <vector>
+
+/*
+* device wide VkPipelineCache, VK::Object->pipelineCache
+	loaded from disk when the device is created, and saved when it's destroyed (or from SavePeriodically)
+	the file is prefixed with its own header, vendor/device/driver version and the cache uuid all have to match the current device
+	the data is checksummed, anything that doesn't match is thrown out and the cache starts empty (cold)
+	saving writes to a temp file, flushes it to disk and renames it over the old one, so a crash mid-save never leaves a half written cache
+*/
+
+namespace EWE {
+	namespace PipelineCache {
+		struct Stats {
+			bool warm; //valid data was loaded from disk
+			uint32_t pipelinesCreated;
+			double totalCreationMS;
+			double maxCreationMS;
+			double loadMS;
+			std::size_t loadedBytes;
+		};
+
+		//what a cache file has to match, VkPhysicalDeviceProperties for the current device
+		struct DeviceIdentity {
+			uint32_t vendorID;
+			uint32_t deviceID;
+			uint32_t driverVersion;
+			uint8_t pipelineCacheUUID[VK_UUID_SIZE];
+		};
+
+		//called from EWEDevice, after the logical device is created
+		void Initialize();
+		//called from EWEDevice, before the logical device is destroyed. saves first
+		void Destroy();
+
+		//safe to call from any thread, pipelines can be created while this is running
+		bool Save();
+		//saves on the thread pool, if the last save was more than interval ago
+		void SavePeriodically(std::chrono::seconds interval = std::chrono::seconds(60));
+
+		//the cache pipeline creation should use on this thread. the device cache, unless overridden
+		VkPipelineCache Get();
+		//for a thread compiling into its own cache, to be merged later. VK_NULL_HANDLE goes back to the device cache
+		void SetThreadCache(VkPipelineCache cache);
+		//creates a cache seeded with the device cache's current contents
+		VkPipelineCache CreateSeededCache();
+		//merges into the device cache, then destroys the source caches. main thread
+		void MergeAndDestroy(std::vector<VkPipelineCache>& srcCaches);
+
+		//wraps the pipeline creation calls, for cold vs warm timing
+		void RecordCreation(std::chrono::steady_clock::duration duration);
+
+		//the file half of Initialize and Save, no device needed
+		//returns the cache data if the file header, the checksum and the vulkan header in the data all match device, otherwise empty
+		std::vector<uint8_t> ReadValidatedFile(std::filesystem::path const& path, DeviceIdentity const& device);
+		bool WriteFile(std::filesystem::path const& path, DeviceIdentity const& device, const void* data, std::size_t dataSize);
+
+		Stats GetStats();
+		void PrintStats();
+	} //namespace PipelineCache
+} //namespace EWE
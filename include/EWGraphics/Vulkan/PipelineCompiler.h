@@ -0,0 +1,131 @@
+#pragma once
+
+#include "EWGraphics/Vulkan/GraphicsPipeline.h"
+#include "EWGraphics/Vulkan/ComputePipeline.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
+/*
+* batch pipeline compilation on the thread pool
+	fill a batch with descriptions, Compile, and keep rendering (the loading screen)
+	PublishReady moves finished pipelines into PipelineSystem, it has to be called from the main thread
+	the batch has to outlive its tasks, it can be destroyed once Finished is true
+	the layouts (and the config info for graphics pipelines) need to stay alive until the batch is published
+	pipeline creation writes into the config info, so a config info can't be shared by two pipelines in the same batch
+
+	the work is split into threadCount tasks that pull from a shared index, so thread count can be varied for measurement
+	CacheMode::Shared - every thread compiles against the device cache, which is internally synchronized
+	CacheMode::Merged - every task gets its own cache, merged into the device cache when the batch is published
+		less contention on the cache's internal lock, at the cost of a merge
+	CacheMode::Isolated - every task gets its own empty cache, thrown away with the batch. for timing cold compiles
+	ThreadSweep compiles the same pipelines once per thread count, to find where adding threads stops paying off
+*/
+
+namespace EWE {
+	class PipelineBatch {
+	public:
+		enum class CacheMode : uint8_t {
+			Shared,
+			Merged,
+			Isolated,
+		};
+
+		struct Stats {
+			uint32_t pipelineCount;
+			uint32_t threadCount;
+			double wallMS; //from Compile to the last pipeline finishing
+			double creationSumMS; //sum of the individual pipeline creation times
+		};
+
+	private:
+		struct GraphicsDesc {
+			std::string name;
+			PipelineID pipeID;
+			PipeLayout* layout;
+			PipelineConfigInfo* configInfo;
+			std::vector<KeyValuePair<ShaderStage, std::vector<Shader::SpecializationEntry>>> specInfo;
+		};
+		struct ComputeDesc {
+			std::string name;
+			PipelineID pipeID;
+			PipeLayout* layout;
+			std::vector<Shader::SpecializationEntry> specInfo;
+		};
+		struct Result {
+			Pipeline* pipeline{ nullptr };
+			std::atomic<bool> ready{ false };
+			bool published{ false };
+		};
+
+		std::vector<GraphicsDesc> graphicsDescs{};
+		std::vector<ComputeDesc> computeDescs{};
+		std::vector<Result> results{};
+		std::vector<VkPipelineCache> taskCaches{};
+
+		CacheMode cacheMode{ CacheMode::Shared };
+		uint32_t threadCount{ 0 };
+		std::atomic<uint32_t> nextIndex{ 0 };
+		std::atomic<uint32_t> finishedCount{ 0 };
+		std::atomic<uint32_t> finishedTasks{ 0 };
+		std::atomic<uint64_t> creationSumNS{ 0 };
+		std::chrono::steady_clock::time_point compileStart{};
+		std::atomic<int64_t> wallNS{ 0 };
+		uint32_t publishedCount{ 0 };
+		bool compiling{ false };
+
+		void RunTask(uint32_t taskIndex);
+		void CompileIndex(uint32_t index);
+
+	public:
+		PipelineBatch() = default;
+		~PipelineBatch();
+		PipelineBatch(PipelineBatch const&) = delete;
+		PipelineBatch& operator=(PipelineBatch const&) = delete;
+
+		void AddGraphics(std::string const& name, PipelineID pipeID, PipeLayout* layout, PipelineConfigInfo& configInfo);
+		void AddGraphics(std::string const& name, PipelineID pipeID, PipeLayout* layout, PipelineConfigInfo& configInfo, std::vector<KeyValuePair<ShaderStage, std::vector<Shader::SpecializationEntry>>> const& specInfo);
+		void AddCompute(std::string const& name, PipelineID pipeID, PipeLayout* layout);
+		void AddCompute(std::string const& name, PipelineID pipeID, PipeLayout* layout, std::vector<Shader::SpecializationEntry> const& specInfo);
+
+#if PIPELINE_HOT_RELOAD
+		template<typename T>
+		void AddGraphics(T pipeID, PipeLayout* layout, PipelineConfigInfo& configInfo) {
+			AddGraphics(std::string(magic_enum::enum_name(pipeID)), pipeID, layout, configInfo);
+		}
+		template<typename T>
+		void AddCompute(T pipeID, PipeLayout* layout) {
+			AddCompute(std::string(magic_enum::enum_name(pipeID)), pipeID, layout);
+		}
+#endif
+
+		uint32_t Size() const {
+			return static_cast<uint32_t>(graphicsDescs.size() + computeDescs.size());
+		}
+
+		//returns immediately. 0 threads uses every thread in the pool
+		void Compile(uint32_t threadCount = 0, CacheMode cacheMode = CacheMode::Shared);
+
+		//every task has exited, everything is published and the task caches are merged. the batch can be destroyed after this
+		//the last pipeline finishing isn't enough, its task can still be inside the batch
+		bool Finished() const {
+			return (finishedTasks.load(std::memory_order_acquire) == threadCount) && (publishedCount == Size()) && taskCaches.empty();
+		}
+		//main thread. returns how many pipelines haven't been published yet. merges the task caches once every task has exited
+		uint32_t PublishReady();
+		//main thread, blocks until Finished
+		void PublishAll();
+
+		Stats GetStats() const;
+		void PrintStats() const;
+
+		//main thread, blocks. fill adds the same pipelines to a fresh batch for every thread count, 1 up to the pool size
+		//nothing is published, the pipelines are destroyed after each run. returns one Stats per thread count
+		//the pool is hardware_concurrency - 1 threads, the calling thread doesn't compile
+		//with graphics pipeline libraries the parts stay cached after the first run, so later runs time the link
+		static std::vector<Stats> ThreadSweep(std::function<void(PipelineBatch&)> const& fill, CacheMode cacheMode = CacheMode::Isolated);
+	};
+} //namespace EWE
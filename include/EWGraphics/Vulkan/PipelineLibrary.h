@@ -0,0 +1,77 @@
+#pragma once
+
+#include "EWGraphics/Vulkan/GraphicsPipeline.h"
+
+#include <array>
+#include <vector>
+
+/*
+* graphics pipeline libraries, VK_EXT_graphics_pipeline_library
+	a graphics pipeline is split into 4 parts - vertex input, pre-rasterization, fragment shader, fragment output
+	each part's state is packed and hashed on its own, and compiled once into a library
+	a permutation that only changes one part reuses the other 3 libraries, and fast links (no optimization, cheap) on first use
+	the optimized link is done on the thread pool afterwards, and handed to PermutationCache::Upgrade
+	the monolithic pipeline is the fallback, when the extension isn't available or for mesh pipelines
+	parts are ref counted by the permutations linked from them. the last permutation's release destroys the part and releases its layout,
+		so hot reloaded shaders don't leave their old parts behind
+*/
+
+namespace EWE {
+	namespace PipelineLibrary {
+		enum Part : uint8_t {
+			VertexInput,
+			PreRasterization,
+			FragmentShader,
+			FragmentOutput,
+
+			COUNT
+		};
+		using LinkedParts = std::array<VkPipeline, Part::COUNT>;
+		//the spirv hash of each stage's shader
+		using ModuleHashes = std::array<uint64_t, ShaderStage::COUNT>;
+
+		struct Stats {
+			uint32_t partHits[Part::COUNT];
+			uint32_t partMisses[Part::COUNT];
+			uint32_t fastLinks;
+			uint32_t optimizedLinks;
+			uint32_t pendingOptimizations;
+			//milliseconds
+			double partCompileMean;
+			double fastLinkMean;
+			double fastLinkMax; //the first use hitch
+			double optimizedLinkMean;
+			//PIPELINE_LIBRARY_HITCH_REPORT, the same permutations built both ways
+			uint32_t firstUseSamples;
+			double firstUseFastMean; //part compiles that missed, and the fast link
+			double firstUseFastMax;
+			double firstUseMonolithicMean;
+			double firstUseMonolithicMax;
+		};
+
+		//the extension and feature were enabled on the device, and GRAPHICS_PIPELINE_LIBRARY is true
+		bool Enabled();
+		//set by the device, before any pipeline is created
+		void SetSupport(bool supported, bool fastLinking);
+
+		//stages come from PipeLayout::GetStageData, with the specialization info attached
+		//returns VK_NULL_HANDLE if the permutation can't be built from libraries
+		//outParts holds a reference to each part, hand them to PermutationCache::Insert with the pipeline
+		VkPipeline FastLink(PipeLayout const& layout, PipelineConfigInfo const& configInfo, std::vector<VkPipelineShaderStageCreateInfo> const& stages, LinkedParts& outParts);
+		//call after the fast linked pipeline is inserted into the PermutationCache. the parts are held until the link is done
+		void QueueOptimizedLink(LinkedParts const& parts, VkPipelineLayout vkLayout, VkPipeline fastPipeline);
+		//drops a reference to each part. null parts are skipped
+		void ReleaseParts(LinkedParts const& parts);
+		//milliseconds. FastLink's whole call, and a monolithic vkCreateGraphicsPipelines of the same permutation
+		void RecordFirstUse(double fastLinkMS, double monolithicMS);
+
+		//the part's key, no device. partStages are the stages that belong to the part
+		std::vector<uint8_t> PackPart(Part part, VkPipelineLayout vkLayout, ModuleHashes const& moduleHashes, PipelineConfigInfo const& configInfo, std::vector<VkPipelineShaderStageCreateInfo> const& partStages);
+
+		//waits for queued optimizations, then destroys the part libraries. after PermutationCache::WaitForPrewarm, before PermutationCache::Destroy
+		void Destroy();
+
+		Stats GetStats();
+		void PrintStats();
+	} //namespace PipelineLibrary
+} //namespace EWE
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "EWGraphics/Preprocessor.h"
+
+#if PIPELINE_HOT_RELOAD
+#include <string_view>
+
+/*
+* asynchronous pipeline hot reload
+	shader files loaded through GetShader are watched, inotify on linux and polling the write time elsewhere
+	when one changes, the module, the layouts and every pipeline in PipelineSystem that uses it are rebuilt on the thread pool
+	the rebuilt handles are swapped in at the end of a frame. the render thread never compiles
+	the PipeLayout a pipeline was created with stays the caller's, only its contents are replaced, and only if the reflected layout changed
+	the old handles are retired, and destroyed once the frames that could still be using them are done
+	the imgui reload buttons are still synchronous
+*/
+
+namespace EWE {
+	namespace PipelineReloader {
+		//main thread, once the thread pool exists
+		void Initialize();
+		//any thread. called from GetShader
+		void Watch(std::string_view filepath);
+		//main thread, at the end of every frame. dispatches changed shaders, swaps in finished rebuilds, and destroys retired handles
+		void Update();
+		//main thread, before PipelineSystem::DestructAll
+		void Destroy();
+	} //namespace PipelineReloader
+} //namespace EWE
+#endif
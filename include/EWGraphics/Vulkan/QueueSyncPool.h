@@ -52,37 +52,64 @@ namespace EWE{
 
     //each semaphore and fence could track which queue it's being used in, but I don't think that's the best approach
 
+    //the size SyncHub creates its pool with
+    static constexpr uint16_t QUEUE_SYNC_POOL_SIZE = 255;
+    //semaphores the frame can wait on that don't come from the pool, the upload queue's batches
+    static constexpr uint16_t RENDER_SYNC_EXTERNAL_SEMAPHORES = 8;
+
+    //fixed capacity, reused every frame. nothing in the submit path allocates
+    //sized for every semaphore that can exist at once, the pool's (2 per slot) and the external ones, so a frame can't run out
+    //the extra slot is for the swapchain semaphore (image available for waits, render finished for signals)
+    static constexpr uint16_t RENDER_SYNC_CAPACITY = QUEUE_SYNC_POOL_SIZE * 2 + RENDER_SYNC_EXTERNAL_SEMAPHORES;
+
     struct WaitData {
-        std::vector<Semaphore*> semaphores{};
-        std::vector<VkPipelineStageFlags> waitDstMask{};
+        uint16_t count{ 0 };
+        std::array<Semaphore*, RENDER_SYNC_CAPACITY> semaphores{};
+        std::array<VkPipelineStageFlags, RENDER_SYNC_CAPACITY + 1> waitDstMask{};
 
         //for submission, the lifetime needs to be controlled here
-        //theres probably a better way to control lifetime but i cant think of it right now
-        //main concern is repeatedly reallocating memory, which this might avoid depending on how the vector is handled behind the scenes
-        //an alternative solution is using an array, with a max size of say 16, and using a counter to keep track of the active count, rather than vectors
-        std::vector<VkSemaphore> semaphoreData{}; 
+        std::array<VkSemaphore, RENDER_SYNC_CAPACITY + 1> semaphoreData{};
+    };
+    struct SignalData {
+        uint16_t count{ 0 };
+        std::array<Semaphore*, RENDER_SYNC_CAPACITY> semaphores{};
+        std::array<VkSemaphore, RENDER_SYNC_CAPACITY + 1> semaphoreData{};
     };
 
 
-    struct RenderSyncData {
+    //the semaphore lists of the frame submission, without the device objects
+    struct RenderSemaphoreLists {
     private:
         std::mutex waitMutex{};
         std::mutex signalMutex{};
         WaitData previousWait[MAX_FRAMES_IN_FLIGHT]{};
-        std::vector<Semaphore*> previousSignals[MAX_FRAMES_IN_FLIGHT]{};
+        SignalData previousSignals[MAX_FRAMES_IN_FLIGHT]{};
     public:
-        VkFence inFlight[MAX_FRAMES_IN_FLIGHT] = { VK_NULL_HANDLE, VK_NULL_HANDLE };
-        VkSemaphore imageAvailableSemaphore[MAX_FRAMES_IN_FLIGHT] = { VK_NULL_HANDLE, VK_NULL_HANDLE };
-        VkSemaphore renderFinishedSemaphore[MAX_FRAMES_IN_FLIGHT] = { VK_NULL_HANDLE, VK_NULL_HANDLE };
         WaitData waitData{};
-        std::vector<Semaphore*> signalSemaphores{};
+        SignalData signalData{};
 
-        RenderSyncData();
-        ~RenderSyncData();
         void AddWaitSemaphore(Semaphore* semaphore, VkPipelineStageFlags waitDstStageMask);
         void AddSignalSemaphore(Semaphore* semaphore);
+        //the submit info points into frameIndex's storage, it's valid until this frame index comes back around
+        //frameSemaphore goes last, the swapchain's
+        void SetWaitData(VkSubmitInfo& submitInfo, uint8_t frameIndex, VkSemaphore frameSemaphore);
+        void SetSignalData(VkSubmitInfo& submitInfo, uint8_t frameIndex, VkSemaphore frameSemaphore);
+        //finishes the waits of every frame slot. only valid once all of the in flight fences have signaled
+        void ReleasePreviousFrames();
+    };
+
+    struct RenderSyncData : RenderSemaphoreLists {
+        VkFence inFlight[MAX_FRAMES_IN_FLIGHT]{};
+        VkSemaphore imageAvailableSemaphore[MAX_FRAMES_IN_FLIGHT]{};
+        VkSemaphore renderFinishedSemaphore[MAX_FRAMES_IN_FLIGHT]{};
+
+        RenderSyncData();
+        ~RenderSyncData();
+        using RenderSemaphoreLists::SetWaitData;
+        using RenderSemaphoreLists::SetSignalData;
+        //the current frame, with its image available and render finished semaphores
         void SetWaitData(VkSubmitInfo& submitInfo);
-        std::vector<VkSemaphore> GetSignalData();
+        void SetSignalData(VkSubmitInfo& submitInfo);
     };
 
     class QueueSyncPool{
@@ -3,6 +3,7 @@
 #include "EWGraphics/MainWindow.h"
 #include "EWGraphics/Vulkan/Device.hpp"
 #include "EWGraphics/Vulkan/Swapchain.hpp"
+#include "EWGraphics/Vulkan/FramePacer.h"
 
 #include <memory>
 
@@ -29,6 +30,8 @@ namespace EWE {
 
 		bool IsFrameInProgresss() const { return isFrameStarted; }
 
+		FramePacer& GetFramePacer() { return framePacer; }
+
 		bool BeginFrame();
 		bool EndFrame();
 		bool EndFrameAndWaitForFence();
@@ -57,6 +60,8 @@ namespace EWE {
 		uint32_t currentImageIndex;
 		bool isFrameStarted{false};
 
+		FramePacer framePacer{};
+
 	};
 }
 
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "EWGraphics/Vulkan/VulkanHeader.h"
+
+#include <vector>
+
+/*
+* queue ownership and layout tracking for images and buffers
+	each ImageInfo and EWEBuffer holds the state it was last left in: owning family, layout, access and stage
+	ResourceTracker::Transition compares that to the next usage and returns the minimal barriers to get there
+		- nothing, if the resource is only being read again in the same layout on the same family
+		- a single barrier, recorded on the new queue, if the family doesn't change (or the contents are being discarded)
+		- a release/acquire pair, if the family changes. the release is recorded on the old queue, the acquire on the new one
+	the tracker doesn't synchronize queues, the acquiring submission still needs to wait on a semaphore signaled after the release
+	not thread safe per resource, a resource is expected to be transitioned by one thread at a time
+*/
+
+namespace EWE {
+	struct ImageInfo;
+	class EWEBuffer;
+
+	struct ResourceState {
+		//ignored until the first transition, nothing owns the contents yet
+		uint32_t queueFamily{ VK_QUEUE_FAMILY_IGNORED };
+		VkImageLayout layout{ VK_IMAGE_LAYOUT_UNDEFINED }; //buffers leave this undefined
+		VkAccessFlags access{ 0 };
+		VkPipelineStageFlags stage{ VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT };
+	};
+
+	struct ResourceUsage {
+		Queue::Enum queue;
+		VkImageLayout layout; //ignored for buffers
+		VkAccessFlags access;
+		VkPipelineStageFlags stage;
+	};
+
+	template<typename BarrierType>
+	struct OwnershipTransition {
+		bool release{ false };
+		bool acquire{ false };
+		//recorded on the queue that previously owned the resource
+		BarrierType releaseBarrier{};
+		VkPipelineStageFlags releaseSrcStage{ VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT };
+		//recorded on the queue the usage is for. when there's no release, this is the only barrier
+		BarrierType acquireBarrier{};
+		VkPipelineStageFlags acquireSrcStage{ VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT };
+		VkPipelineStageFlags acquireDstStage{ VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT };
+
+		bool Empty() const {
+			return !release && !acquire;
+		}
+		void RecordRelease(CommandBuffer& cmdBuf) const;
+		void RecordAcquire(CommandBuffer& cmdBuf) const;
+	};
+	using ImageTransition = OwnershipTransition<VkImageMemoryBarrier>;
+	using BufferTransition = OwnershipTransition<VkBufferMemoryBarrier>;
+
+	//acquire halves gathered over a submission, recorded together as one barrier
+	//Clear before the storage is reused, anything left over would be recorded again
+	struct PendingAcquires {
+		std::vector<VkBufferMemoryBarrier> buffers{};
+		std::vector<VkImageMemoryBarrier> images{};
+		VkPipelineStageFlags srcStage{ 0 };
+		VkPipelineStageFlags dstStage{ 0 };
+
+		void Add(BufferTransition const& transition) {
+			buffers.push_back(transition.acquireBarrier);
+			srcStage |= transition.acquireSrcStage;
+			dstStage |= transition.acquireDstStage;
+		}
+		void Add(ImageTransition const& transition) {
+			images.push_back(transition.acquireBarrier);
+			srcStage |= transition.acquireSrcStage;
+			dstStage |= transition.acquireDstStage;
+		}
+		void Append(PendingAcquires const& other) {
+			buffers.insert(buffers.end(), other.buffers.begin(), other.buffers.end());
+			images.insert(images.end(), other.images.begin(), other.images.end());
+			srcStage |= other.srcStage;
+			dstStage |= other.dstStage;
+		}
+		void Clear() {
+			buffers.clear();
+			images.clear();
+			srcStage = 0;
+			dstStage = 0;
+		}
+		bool Empty() const {
+			return buffers.empty() && images.empty();
+		}
+	};
+
+	namespace ResourceTracker {
+		static constexpr VkAccessFlags writeAccessMask =
+			VK_ACCESS_SHADER_WRITE_BIT
+			| VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT
+			| VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT
+			| VK_ACCESS_TRANSFER_WRITE_BIT
+			| VK_ACCESS_HOST_WRITE_BIT
+			| VK_ACCESS_MEMORY_WRITE_BIT;
+
+		//discardContents skips the ownership transfer and transitions from UNDEFINED, for resources that are about to be fully overwritten
+		//the state is updated to the usage before returning, record the returned barriers
+		ImageTransition Transition(ImageInfo& imageInfo, ResourceUsage const& usage, bool discardContents = false);
+		//always the full range of the buffer
+		BufferTransition Transition(EWEBuffer& buffer, ResourceUsage const& usage, bool discardContents = false);
+
+		//what Transition does, without the device. dstFamily is the family of usage.queue
+		//the barrier passed in only needs the resource filled in (image and range, or buffer and size)
+		template<typename BarrierType>
+		OwnershipTransition<BarrierType> ComputeTransition(ResourceState& state, ResourceUsage const& usage, uint32_t dstFamily, bool discardContents, BarrierType const& resourceBarrier);
+
+		//for transitions that were recorded by hand (GenerateMipmaps)
+		void SetState(ResourceState& state, ResourceUsage const& usage);
+		void SetState(ResourceState& state, ResourceUsage const& usage, uint32_t queueFamily);
+	} //namespace ResourceTracker
+} //namespace EWE
@@ -103,6 +103,7 @@ namespace EWE {
 
 
 		std::string filepath{}; 
+		uint64_t moduleHash{ 0 }; //content hash of the spirv
 		VkPipelineShaderStageCreateInfo shaderStageCreateInfo;
 
 		DescriptorLayoutPack* descriptorSets;
@@ -123,6 +124,8 @@ namespace EWE {
 #if PIPELINE_HOT_RELOAD
 		std::vector<VkShaderModule> staleModules{};
 		void HotReload();
+		//module and reflected data, not the path
+		void SwapContents(Shader& other);
 #endif
 		void DrawImgui();
 
@@ -135,4 +138,8 @@ namespace EWE {
 	Shader* CreateShader(std::string_view filepath, const std::size_t dataSize, const void* data);
 	void DestroyShader(Shader& shader);
 	void DestroyAllShaders();
+#if PIPELINE_HOT_RELOAD
+	//doesn't add a usage
+	Shader* FindShader(std::string_view filepath);
+#endif
 }
\ No newline at end of file
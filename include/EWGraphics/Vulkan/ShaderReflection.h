@@ -0,0 +1,76 @@
+#pragma once
+
+#include "EWGraphics/Vulkan/Shader.h"
+
+#include <chrono>
+#include <string_view>
+#include <vector>
+
+/*
+* cache of the SPIRV-Cross reflection results, keyed by a hash of the SPIR-V
+	a shader module that's already been reflected (this run, or a previous run if the disk cache is on) skips SPIRV-Cross entirely
+	the disk file is loaded the first time a shader is reflected, and saved when the device is destroyed
+	the whole file is thrown out if the header, build config or checksum doesn't match
+	the key is the content, so an edited shader misses and gets reflected again. the stale entry stays in the file
+*/
+
+#ifndef SHADER_REFLECTION_DISK_CACHE
+#define SHADER_REFLECTION_DISK_CACHE true
+#endif
+
+namespace EWE {
+	namespace ShaderReflection {
+		//unsized arrays (texture[]) are reflected with this count, as a variable count binding
+		static constexpr uint32_t runtimeArrayDescriptorCount = 1024;
+
+		struct SetBindings {
+			uint8_t set;
+			std::vector<VkDescriptorSetLayoutBinding> bindings;
+			std::vector<VkDescriptorBindingFlags> bindingFlags; //parallel to bindings
+		};
+		struct Data {
+			VkShaderStageFlagBits stage;
+			VkPushConstantRange pushRange;
+			std::vector<SetBindings> sets;
+			std::vector<VkVertexInputAttributeDescription> vertexInputAttributes;
+			std::vector<Shader::SpecializationEntry> specConstants;
+		};
+
+		struct Stats {
+			uint32_t hits;
+			uint32_t misses;
+			uint32_t entries;
+			bool loadedFromDisk;
+			double reflectMS; //time spent in SPIRV-Cross, on misses
+			double cachedMS; //time spent building the shader's data from cached entries, on hits
+		};
+
+		uint64_t Hash(const void* data, std::size_t dataSize);
+
+		//SPIRV-Cross on the module, no cache and no device
+		Data Reflect(const void* data, std::size_t dataSize);
+		//the sets of every stage in a pipeline, in pipeline order. a binding used by more than one stage becomes one binding with the stage flags ORed
+		//the result is sorted by set, then binding
+		std::vector<SetBindings> MergeSets(std::vector<SetBindings> const& stageSets);
+
+		//thread safe. returns false on a miss
+		bool Find(uint64_t hash, Data& out);
+		void Insert(uint64_t hash, Data const& data);
+
+		//SPIR-V has no way to say a buffer is bound with a dynamic offset, the binding is marked here instead
+		//call it before any shader using the binding is loaded. it's applied after the cache, cached entries are always the reflected type
+		void SetDynamicBuffer(uint8_t set, uint32_t binding);
+		//uniform and storage buffers marked with SetDynamicBuffer become the dynamic type
+		void ApplyOverrides(std::vector<SetBindings>& sets);
+
+		//writes the cache out if anything was added since it was loaded
+		bool Save();
+
+		//the shader calls these, for the hit/miss timing
+		void RecordReflection(std::chrono::steady_clock::duration duration);
+		void RecordCacheHit(std::chrono::steady_clock::duration duration);
+
+		Stats GetStats();
+		void PrintStats();
+	} //namespace ShaderReflection
+} //namespace EWE
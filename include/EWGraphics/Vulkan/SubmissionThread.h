@@ -0,0 +1,98 @@
+#pragma once
+
+#include "EWGraphics/Vulkan/VulkanHeader.h"
+
+#include <atomic>
+#include <array>
+#include <thread>
+#include <chrono>
+
+/*
+* one thread per hardware queue owns the vkQueueSubmit/vkQueuePresentKHR calls
+	any thread pushes submit packets into a lock-free ring (multi producer, single consumer)
+	the caller returns immediately, instead of serializing on the queue mutex around the driver call
+	the queue mutex (VK::GetQueueMutex, shared by enums on the same VkQueue) is still locked by the submission thread, for the few places that touch the queue directly (debug labels, imgui)
+
+	the submit info is copied into the packet, but everything it points to needs to stay alive until the packet is submitted
+	pass a flag to Submit, or use SubmitAndWait, if that memory is on the stack
+
+	consecutive packets are coalesced into a single vkQueueSubmit, as long as only the last packet in the group has a fence
+	packets on the same queue are submitted in the order they were pushed
+*/
+
+namespace EWE {
+
+	class SubmissionThread {
+	public:
+		struct Stats {
+			uint64_t packets;
+			uint64_t submitCalls;
+			uint64_t totalLatencyNS; //from push to the driver call returning
+			uint64_t maxLatencyNS;
+			uint32_t maxQueueDepth;
+			uint32_t currentQueueDepth;
+		};
+
+	private:
+		static constexpr uint32_t ringSize = 256; //power of 2
+		static constexpr uint32_t maxCoalesce = 16;
+		static std::array<SubmissionThread*, Queue::_count> perQueue;
+
+		struct Packet {
+			VkSubmitInfo submitInfo;
+			VkFence fence;
+			VkPresentInfoKHR presentInfo;
+			bool isPresent;
+			VkResult* presentResult;
+			std::atomic<bool>* submitted;
+			std::chrono::steady_clock::time_point pushTime;
+		};
+		struct Cell {
+			std::atomic<uint32_t> sequence;
+			Packet packet;
+		};
+
+		const Queue::Enum queue;
+		std::array<Cell, ringSize> ring;
+		alignas(64) std::atomic<uint32_t> enqueuePos{ 0 };
+		alignas(64) uint32_t dequeuePos{ 0 };
+		alignas(64) std::atomic<uint32_t> depth{ 0 };
+		std::atomic<bool> running{ true };
+
+		std::atomic<uint64_t> packetCount{ 0 };
+		std::atomic<uint64_t> submitCallCount{ 0 };
+		std::atomic<uint64_t> totalLatency{ 0 };
+		std::atomic<uint64_t> maxLatency{ 0 };
+		std::atomic<uint32_t> maxDepth{ 0 };
+
+		std::thread thread;
+
+		void Push(Packet const& packet);
+		bool TryPop(Packet& packet);
+		void Run();
+		void RecordLatency(std::chrono::steady_clock::time_point pushTime, std::chrono::steady_clock::time_point now);
+
+	public:
+		//use Initialize, not the constructor directly
+		SubmissionThread(Queue::Enum queue);
+		~SubmissionThread();
+
+		//called from SyncHub
+		static void Initialize();
+		static void Destroy();
+
+		static SubmissionThread* Get(Queue::Enum queue) {
+			return perQueue[queue];
+		}
+
+		//doesn't wait. submitted is set to true after vkQueueSubmit returns
+		void Submit(VkSubmitInfo const& submitInfo, VkFence fence, std::atomic<bool>* submitted = nullptr);
+		//for submit info that points to the stack
+		void SubmitAndWait(VkSubmitInfo const& submitInfo, VkFence fence);
+		//present needs the result, so this always waits
+		VkResult Present(VkPresentInfoKHR const& presentInfo);
+
+		Stats GetStats() const;
+		void PrintStats() const;
+	};
+} //namespace EWE
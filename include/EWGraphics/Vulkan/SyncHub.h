@@ -1,6 +1,8 @@
 #pragma once
 
 #include "EWGraphics/Vulkan/QueueSyncPool.h"
+#include "EWGraphics/Vulkan/UploadQueue.h"
+#include "EWGraphics/Vulkan/SubmissionThread.h"
 #include "EWGraphics/Data/EWE_Memory.h"
 
 #include <mutex>
@@ -23,6 +25,8 @@ namespace EWE {
 
 		RenderSyncData renderSyncData;
 
+		UploadQueue uploadQueue;
+
 		std::vector<VkFence> imagesInFlight{};
 
 
@@ -74,6 +78,14 @@ namespace EWE {
 		}
 
 		void RunGraphicsCallbacks();
+
+		//waits on every frame in flight. only call this between frames
+		void SetFramesInFlight(uint8_t framesInFlight);
+
+		//call at the beginning of the frame, after the frame command buffer begins
+		void AcquireUploads() {
+			uploadQueue.RecordAcquires(VK::Object->GetFrameBuffer(), renderSyncData);
+		}
 	private:
 
 		void CreateBuffers();
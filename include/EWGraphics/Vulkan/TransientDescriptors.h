@@ -0,0 +1,43 @@
+#pragma once
+
+#include "EWGraphics/Vulkan/Descriptors.h"
+
+#ifndef TRANSIENT_DESCRIPTOR_POOL_SETS
+#define TRANSIENT_DESCRIPTOR_POOL_SETS 256
+#endif
+
+/*
+* transient descriptor sets, valid for one frame
+	each thread has its own chain of pools per frame in flight, allocating doesn't lock and never waits
+	when a pool is out of space, the next pool in the chain is used, a new one is created if there isn't one
+	once the frame's fence has passed (BeginFrame), the thread's chain for that frame is reset with vkResetDescriptorPool the next time it allocates
+		the pools are kept, so a steady workload stops creating pools after the first few frames
+	sets from here are never freed individually. for sets that live longer than a frame, use EWEDescriptorPool
+*/
+
+namespace EWE {
+	namespace TransientDescriptors {
+		struct Stats {
+			//the last completed frame, summed across threads
+			uint32_t allocations;
+			uint32_t poolsChained; //moved to the next pool in a chain because the current one was full
+			uint32_t poolsCreated;
+			//since startup
+			uint32_t totalPools;
+			uint32_t threads;
+		};
+
+		//main thread, right after the frame's fence wait
+		void BeginFrame();
+
+		//any thread. the set is for the frame being recorded, VK::Object->frameIndex
+		//throws for a layout the pools can't hold, update after bind, bindless, descriptor buffer, or a type the pools aren't sized for
+		VkDescriptorSet Allocate(DescriptorSetLayout* eDSL);
+
+		//main thread, after the device is idle. every thread's pools are destroyed
+		void Destroy();
+
+		Stats GetStats();
+		void PrintStats();
+	} //namespace TransientDescriptors
+} //namespace EWE
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "EWGraphics/Vulkan/QueueSyncPool.h"
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <array>
+
+/*
+* asynchronous uploads
+	loading threads enqueue buffer and image copies, and get back an UploadToken
+	copies are grouped into batches. a batch is recorded and submitted to the transfer queue when flushed
+	the main thread flushes whatever is pending at the beginning of each frame,
+	then records the queue ownership acquire barriers (and mip generation) into the frame command buffer
+	the frame submission waits on the batch semaphore, so the data is visible to everything recorded after the acquire
+
+	a token is complete once its acquire has been recorded. anything drawn after that, in the same frame or later, is safe
+	if the transfer queue isn't enabled, the batch is submitted to the graphics queue and the token completes at submission
+*/
+
+namespace EWE {
+
+	struct UploadToken {
+		//0 is never handed out, a default constructed token is always complete
+		uint64_t batch{ 0 };
+
+		bool Poll() const;
+		//not callable from the main thread, the main thread is the one that completes tokens
+		void Wait() const;
+	};
+
+	class UploadQueue {
+	private:
+		friend class SyncHub;
+
+		static UploadQueue* uploadQueuePtr;
+		static constexpr uint8_t batchCount = 8;
+		//each batch's semaphore is waited on by the frame
+		static_assert(batchCount <= RENDER_SYNC_EXTERNAL_SEMAPHORES);
+
+		struct BufferCopy {
+			StagingBuffer* stagingBuffer;
+			EWEBuffer* dstBuffer;
+			VkDeviceSize size;
+		};
+		struct ImageCopy {
+			StagingBuffer* stagingBuffer;
+			ImageInfo* imageInfo;
+			uint32_t width;
+			uint32_t height;
+			bool mipmapping;
+			//prebuilt levels, replaces the single width x height copy when it isn't empty
+			std::vector<VkBufferImageCopy> regions{};
+		};
+
+		struct Batch {
+			uint64_t id{ 0 };
+			CommandBuffer cmdBuf{};
+			VkFence fence{ VK_NULL_HANDLE };
+			Semaphore semaphore{};
+			//inUse from being taken for recording, until the frame that waited on it has finished
+			bool inUse{ false };
+			bool submitted{ false };
+			//set by the submission thread once vkQueueSubmit has returned
+			std::atomic<bool> packetSubmitted{ false };
+			bool acquired{ false };
+
+			std::vector<StagingBuffer*> stagingBuffers{};
+			//from ResourceTracker, recorded in the frame command buffer
+			PendingAcquires acquires{};
+			std::vector<ImageCopy> images{};
+
+			bool Idle() const {
+				return !submitted && semaphore.Idle();
+			}
+		};
+
+		std::mutex mut{};
+		VkCommandPool cmdPool{ VK_NULL_HANDLE };
+		std::array<Batch, batchCount> batches{};
+
+		std::vector<BufferCopy> pendingBuffers{};
+		std::vector<ImageCopy> pendingImages{};
+
+		//the id of the batch that pending copies will be submitted in
+		uint64_t openBatch{ 1 };
+		std::atomic<uint64_t> completedBatch{ 0 };
+
+		const bool usingTransferQueue;
+		//false if the transfer queue shares a family with the graphics queue
+		const bool ownershipTransfer;
+
+		UploadQueue();
+		~UploadQueue();
+
+		//these expect mut to already be locked
+		void RetireBatches();
+		Batch* TryAcquireBatch();
+		//returns false if there was pending work, but no batch was available
+		bool FlushLocked();
+		void RecordBatch(Batch& batch);
+
+		//called from SyncHub at the beginning of the frame, after the frame command buffer begins
+		void RecordAcquires(CommandBuffer& frameCmdBuf, RenderSyncData& renderSyncData);
+
+	public:
+		//ownership of the staging buffer is taken, it's freed once the copy is finished
+		//the buffer's ResourceState is updated as the copy is recorded and acquired
+		static UploadToken EnqueueBuffer(StagingBuffer* stagingBuffer, EWEBuffer& dstBuffer, VkDeviceSize size);
+		//the image is expected to be created already, in VK_IMAGE_LAYOUT_UNDEFINED
+		//imageInfo.descriptorImageInfo.imageLayout is set to destinationImageLayout once the acquire is recorded
+		static UploadToken EnqueueImage(StagingBuffer* stagingBuffer, ImageInfo& imageInfo, uint32_t width, uint32_t height, bool mipmapping);
+		//every level is in the staging buffer, one region each. no mips are generated
+		static UploadToken EnqueueImage(StagingBuffer* stagingBuffer, ImageInfo& imageInfo, std::vector<VkBufferImageCopy>&& regions);
+
+		//submits everything pending. loading threads can call this after a group of uploads to start the copies early
+		static void Flush();
+
+		static bool Poll(UploadToken token) {
+			return token.batch <= uploadQueuePtr->completedBatch.load(std::memory_order_acquire);
+		}
+		static void Wait(UploadToken token);
+	};
+} //namespace EWE
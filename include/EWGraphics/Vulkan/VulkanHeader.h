@@ -33,7 +33,9 @@
 #include <cassert>
 
 namespace EWE{
-    static constexpr uint8_t MAX_FRAMES_IN_FLIGHT = 2;
+    //per-frame resources are sized for this. the depth actually used is VK::Object->framesInFlight, 1 to MAX_FRAMES_IN_FLIGHT
+    static constexpr uint8_t MAX_FRAMES_IN_FLIGHT = 4;
+    static constexpr uint8_t DEFAULT_FRAMES_IN_FLIGHT = 2;
 
 
     namespace Queue {
@@ -115,18 +117,28 @@ namespace EWE{
         VkPhysicalDevice physicalDevice;
         VkInstance instance;
         std::array<std::mutex, Queue::_count> queueMutex{};
+        //queues that share a VkQueue share the first one's mutex, calls on the VkQueue need to be serialized, not the enum
+        std::mutex& GetQueueMutex(uint8_t queue) {
+            for (uint8_t i = 0; i < queue; i++) {
+                if (queues[i] == queues[queue]) {
+                    return queueMutex[i];
+                }
+            }
+            return queueMutex[queue];
+        }
         std::array<ThreadedSingleTimeCommands, Queue::_count> threadedSTCs{};
         std::array<bool, Queue::_count> queueEnabled{ true, true, false, false};
 
         static thread_local ThreadedSingleTimeCommands* threadedSTC;
 
         VkCommandPool renderCmdPool{ VK_NULL_HANDLE }; //separate graphics pool for single time commands
-        std::array<VkQueue, Queue::_count> queues;
+        std::array<VkQueue, Queue::_count> queues{};
         std::array<int, Queue::_count> queueIndex;
         VkSurfaceKHR surface;
         VkPhysicalDeviceProperties properties;
         VkPhysicalDeviceMeshShaderPropertiesEXT* meshShaderProperties{ nullptr };
         VkDescriptorSetLayout globalEmptyDSL = VK_NULL_HANDLE;
+        VkPipelineCache pipelineCache{ VK_NULL_HANDLE }; //persisted to disk, see PipelineCache.h
 
         float screenWidth;
         float screenHeight;
@@ -135,6 +147,8 @@ namespace EWE{
         void BindVPScissor() const;
 
         uint8_t frameIndex{0};
+        //changed through SyncHub::SetFramesInFlight, between frames
+        uint8_t framesInFlight{ DEFAULT_FRAMES_IN_FLIGHT };
 
         std::array<CommandBuffer, MAX_FRAMES_IN_FLIGHT> renderCommands{};
 
@@ -0,0 +1,73 @@
+#include "EWGraphics/Data/AtomicFile.h"
+
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <system_error>
+#include <thread>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace EWE {
+	static FILE* OpenForWrite(std::filesystem::path const& path) {
+#ifdef _WIN32
+		FILE* file = nullptr;
+		if (_wfopen_s(&file, path.c_str(), L"wb") != 0) {
+			return nullptr;
+		}
+		return file;
+#else
+		return fopen(path.c_str(), "wb");
+#endif
+	}
+	//past the OS cache, a rename that survives a crash shouldn't point at data that didn't
+	static bool SyncToDisk(FILE* file) {
+		if (fflush(file) != 0) {
+			return false;
+		}
+#ifdef _WIN32
+		return _commit(_fileno(file)) == 0;
+#else
+		return fsync(fileno(file)) == 0;
+#endif
+	}
+
+	bool AtomicWriteFile(std::filesystem::path const& path, std::initializer_list<FileChunk> chunks) {
+		std::error_code errorCode{};
+		if (path.has_parent_path()) {
+			std::filesystem::create_directories(path.parent_path(), errorCode);
+		}
+		//per thread, two threads writing the same target don't share a temp file
+		std::filesystem::path tempPath = path;
+		tempPath += ".tmp" + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+
+		FILE* file = OpenForWrite(tempPath);
+		if (file == nullptr) {
+			return false;
+		}
+		bool written = true;
+		for (auto const& chunk : chunks) {
+			if ((chunk.size > 0) && (fwrite(chunk.data, 1, chunk.size, file) != chunk.size)) {
+				written = false;
+				break;
+			}
+		}
+		written = written && SyncToDisk(file);
+		written = (fclose(file) == 0) && written;
+		if (!written) {
+			std::filesystem::remove(tempPath, errorCode);
+			return false;
+		}
+
+		std::filesystem::rename(tempPath, path, errorCode);
+		if (errorCode) {
+			std::filesystem::remove(tempPath, errorCode);
+			return false;
+		}
+		return true;
+	}
+} //namespace EWE
@@ -0,0 +1,202 @@
+#include "EWGraphics/Texture/BindlessTextures.h"
+#include "EWGraphics/Texture/Image.h"
+#include "EWGraphics/Vulkan/ShaderReflection.h"
+
+#include <mutex>
+#include <unordered_map>
+
+namespace EWE {
+	namespace BindlessTextures {
+		//the same count reflection gives an unsized array, so the layouts match
+		static constexpr uint32_t capacity = ShaderReflection::runtimeArrayDescriptorCount;
+
+		struct PendingWrite {
+			uint32_t slot;
+			VkDescriptorImageInfo* imageInfo;
+		};
+
+		static std::mutex mutex{};
+		static SlotAllocator slots{ capacity, MAX_FRAMES_IN_FLIGHT };
+		static std::unordered_map<ImageID, uint32_t> imageSlots{};
+		static std::vector<PendingWrite> pendingWrites{};
+
+		static DescriptorSetLayout* tableDSL{ nullptr };
+		static VkDescriptorPool tablePool{ VK_NULL_HANDLE };
+		static VkDescriptorSet tableSet{ VK_NULL_HANDLE };
+
+		void Initialize(VkShaderStageFlags stageFlags) {
+			assert(VK::Object->CheckMainThread());
+			assert(tableDSL == nullptr);
+
+			DescriptorSetLayout::Builder builder{};
+			builder.AddBinding(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, stageFlags, capacity);
+			tableDSL = builder.BuildBindless();
+
+			//its own pool, update after bind sets need a pool created with the flag
+			VkDescriptorPoolSize poolSize{};
+			poolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			poolSize.descriptorCount = capacity;
+			VkDescriptorPoolCreateInfo poolInfo{};
+			poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+			poolInfo.pNext = nullptr;
+			poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+			poolInfo.maxSets = 1;
+			poolInfo.poolSizeCount = 1;
+			poolInfo.pPoolSizes = &poolSize;
+			EWE_VK(vkCreateDescriptorPool, VK::Object->vkDevice, &poolInfo, nullptr, &tablePool);
+
+			VkDescriptorSetVariableDescriptorCountAllocateInfo variableCountInfo{};
+			variableCountInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_VARIABLE_DESCRIPTOR_COUNT_ALLOCATE_INFO;
+			variableCountInfo.pNext = nullptr;
+			variableCountInfo.descriptorSetCount = 1;
+			variableCountInfo.pDescriptorCounts = &capacity;
+
+			VkDescriptorSetAllocateInfo allocInfo{};
+			allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+			allocInfo.pNext = &variableCountInfo;
+			allocInfo.descriptorPool = tablePool;
+			allocInfo.descriptorSetCount = 1;
+			allocInfo.pSetLayouts = &tableDSL->vkDSL;
+			EWE_VK(vkAllocateDescriptorSets, VK::Object->vkDevice, &allocInfo, &tableSet);
+#if DEBUG_NAMING
+			DebugNaming::SetObjectName(tableSet, VK_OBJECT_TYPE_DESCRIPTOR_SET, "bindless textures");
+#endif
+		}
+
+		void Destroy() {
+			assert(VK::Object->CheckMainThread());
+			std::unique_lock<std::mutex> lock{ mutex };
+			if (tablePool != VK_NULL_HANDLE) {
+				//the set goes with the pool
+				EWE_VK(vkDestroyDescriptorPool, VK::Object->vkDevice, tablePool, nullptr);
+				tablePool = VK_NULL_HANDLE;
+				tableSet = VK_NULL_HANDLE;
+			}
+			if (tableDSL != nullptr) {
+				Deconstruct(tableDSL);
+				tableDSL = nullptr;
+			}
+			imageSlots.clear();
+			pendingWrites.clear();
+		}
+
+		//mutex is held
+		static void WriteSlot(uint32_t slot, VkDescriptorImageInfo const* imageInfo) {
+			VkWriteDescriptorSet write{};
+			write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			write.pNext = nullptr;
+			write.dstSet = tableSet;
+			write.dstBinding = 0;
+			write.dstArrayElement = slot;
+			write.descriptorCount = 1;
+			write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			write.pImageInfo = imageInfo;
+			//update after bind, the set can stay bound in command buffers that are recording or pending
+			EWE_VK(vkUpdateDescriptorSets, VK::Object->vkDevice, 1, &write, 0, nullptr);
+		}
+
+		uint32_t Acquire(ImageID imageID, VkDescriptorImageInfo* imageInfo) {
+			assert(imageID != IMAGE_INVALID);
+			std::unique_lock<std::mutex> lock{ mutex };
+			assert(tableSet != VK_NULL_HANDLE && "BindlessTextures::Initialize hasn't been called");
+			auto findRet = imageSlots.find(imageID);
+			if (findRet != imageSlots.end()) {
+				return findRet->second;
+			}
+			const uint32_t slot = slots.Allocate();
+			if (slot == SlotAllocator::INVALID_SLOT) {
+				printf("bindless texture table is full : %u live, %u retiring\n", slots.LiveCount(), slots.RetiringCount());
+				return INVALID_INDEX;
+			}
+			imageSlots.emplace(imageID, slot);
+			if (imageInfo->imageLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
+				WriteSlot(slot, imageInfo);
+			}
+			else {
+				//still being uploaded on another thread
+				pendingWrites.push_back(PendingWrite{ slot, imageInfo });
+			}
+			return slot;
+		}
+
+		uint32_t Find(ImageID imageID) {
+			std::unique_lock<std::mutex> lock{ mutex };
+			auto findRet = imageSlots.find(imageID);
+			if (findRet == imageSlots.end()) {
+				return INVALID_INDEX;
+			}
+			return findRet->second;
+		}
+
+		void Release(ImageID imageID) {
+			std::unique_lock<std::mutex> lock{ mutex };
+			auto findRet = imageSlots.find(imageID);
+			if (findRet == imageSlots.end()) {
+				return;
+			}
+			const uint32_t slot = findRet->second;
+			imageSlots.erase(findRet);
+			for (std::size_t i = 0; i < pendingWrites.size(); i++) {
+				if (pendingWrites[i].slot == slot) {
+					pendingWrites[i] = pendingWrites.back();
+					pendingWrites.pop_back();
+					break;
+				}
+			}
+			//the frame being recorded could still sample it
+			slots.Free(slot, VK::Object->totalFrameCount);
+		}
+
+		void Update() {
+			assert(VK::Object->CheckMainThread());
+			std::unique_lock<std::mutex> lock{ mutex };
+			for (std::size_t i = 0; i < pendingWrites.size();) {
+				if (pendingWrites[i].imageInfo->imageLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
+					WriteSlot(pendingWrites[i].slot, pendingWrites[i].imageInfo);
+					pendingWrites[i] = pendingWrites.back();
+					pendingWrites.pop_back();
+				}
+				else {
+					i++;
+				}
+			}
+			slots.Collect(VK::Object->totalFrameCount);
+		}
+
+		DescriptorSetLayout* GetLayout() {
+			assert(tableDSL != nullptr);
+			return tableDSL;
+		}
+		VkDescriptorSet GetSet() {
+			assert(tableSet != VK_NULL_HANDLE);
+			return tableSet;
+		}
+		void Bind(VkPipelineBindPoint bindPoint, VkPipelineLayout pipeLayout, uint32_t setIndex) {
+			EWE_VK(vkCmdBindDescriptorSets, VK::Object->GetFrameBuffer(),
+				bindPoint,
+				pipeLayout,
+				setIndex, 1,
+				&tableSet,
+				0, nullptr
+			);
+		}
+
+		Stats GetStats() {
+			std::unique_lock<std::mutex> lock{ mutex };
+			Stats ret{};
+			ret.capacity = slots.Capacity();
+			ret.live = slots.LiveCount();
+			ret.retiring = slots.RetiringCount();
+			ret.highWater = slots.HighWater();
+			ret.pendingWrites = static_cast<uint32_t>(pendingWrites.size());
+			return ret;
+		}
+		void PrintStats() {
+			const Stats stats = GetStats();
+			printf("bindless textures - live:retiring:high water:capacity - %u:%u:%u:%u, pending writes - %u\n",
+				stats.live, stats.retiring, stats.highWater, stats.capacity,
+				stats.pendingWrites
+			);
+		}
+	} //namespace BindlessTextures
+} //namespace EWE
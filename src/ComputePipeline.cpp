@@ -1,4 +1,6 @@
 #include "EWGraphics/Vulkan/ComputePipeline.h"
+#include "EWGraphics/Vulkan/PipelineCache.h"
+#include "EWGraphics/Vulkan/PermutationCache.h"
 
 #if PIPELINE_HOT_RELOAD
 #include "EWGraphics/imgui/imgui.h"
@@ -7,6 +9,12 @@
 namespace EWE{
 
 	void ComputePipeline::CreateVkPipeline() {
+		const PermutationCache::Key permutationKey = PermutationCache::MakeComputeKey(*pipeLayout, copySpecInfo);
+		vkPipe = PermutationCache::Acquire(permutationKey);
+		if (vkPipe != VK_NULL_HANDLE) {
+			return;
+		}
+
 		VkComputePipelineCreateInfo pipelineInfo{};
 		pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
 		pipelineInfo.pNext = nullptr;
@@ -15,8 +23,10 @@ namespace EWE{
 
 		Shader::VkSpecInfo_RAII temp{ copySpecInfo[0].value };
 		pipelineInfo.stage.pSpecializationInfo = &temp.specInfo;
-		EWE_VK(vkCreateComputePipelines, EWE::VK::Object->vkDevice, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &vkPipe);
-
+		const auto creationStart = std::chrono::steady_clock::now();
+		EWE_VK(vkCreateComputePipelines, EWE::VK::Object->vkDevice, PipelineCache::Get(), 1, &pipelineInfo, nullptr, &vkPipe);
+		PipelineCache::RecordCreation(std::chrono::steady_clock::now() - creationStart);
+		vkPipe = PermutationCache::Insert(permutationKey, vkPipe);
 	}
 
 	ComputePipeline::ComputePipeline(PipelineID pipeID, PipeLayout* layout) 
@@ -45,16 +45,16 @@ namespace EWE{
             utilLabel.color[2] = blue;
             utilLabel.color[3] = 1.f;
             utilLabel.pLabelName = name;
-            VK::Object->queueMutex[queue].lock();
+            VK::Object->GetQueueMutex(queue).lock();
             pfnQueueBegin(VK::Object->queues[queue], &utilLabel);
-            VK::Object->queueMutex[queue].unlock();
+            VK::Object->GetQueueMutex(queue).unlock();
 #endif
         }
         void QueueEnd(uint8_t queue) {
 #if DEBUG_NAMING
-            VK::Object->queueMutex[queue].lock();
+            VK::Object->GetQueueMutex(queue).lock();
             pfnQueueEnd(VK::Object->queues[queue]);
-            VK::Object->queueMutex[queue].unlock();
+            VK::Object->GetQueueMutex(queue).unlock();
 #endif
         }
 
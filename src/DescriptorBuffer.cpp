@@ -0,0 +1,321 @@
+#include "EWGraphics/Vulkan/DescriptorBuffer.h"
+#include "EWGraphics/Data/RangeAllocator.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <mutex>
+
+namespace EWE {
+	namespace DescriptorBuffer {
+		static bool supported{ false };
+		static bool initialized{ false };
+
+		static PFN_vkGetDescriptorSetLayoutSizeEXT pfnGetLayoutSize{ nullptr };
+		static PFN_vkGetDescriptorSetLayoutBindingOffsetEXT pfnGetBindingOffset{ nullptr };
+		static PFN_vkGetDescriptorEXT pfnGetDescriptor{ nullptr };
+		static PFN_vkCmdBindDescriptorBuffersEXT pfnCmdBindBuffers{ nullptr };
+		static PFN_vkCmdSetDescriptorBufferOffsetsEXT pfnCmdSetOffsets{ nullptr };
+
+		static VkPhysicalDeviceDescriptorBufferPropertiesEXT properties{};
+
+		static VkBuffer heap{ VK_NULL_HANDLE };
+#if USING_VMA
+		static VmaAllocation heapAlloc{};
+#endif
+		static uint8_t* heapMapped{ nullptr };
+		static VkDeviceAddress heapAddress{ 0 };
+		static VkBufferUsageFlags heapUsage{ 0 };
+
+		//the first half is persistent, the second half is split between the frames in flight
+		static VkDeviceSize persistentSize{ 0 };
+		static VkDeviceSize transientRegionSize{ 0 };
+
+		static std::array<std::atomic<VkDeviceSize>, MAX_FRAMES_IN_FLIGHT> transientHeads{};
+		static std::atomic<uint32_t> frameAllocations{ 0 };
+		static std::atomic<uint32_t> frameFailures{ 0 };
+		static Stats lastFrame{};
+
+		static std::mutex persistentMutex{};
+		static RangeAllocator persistentRanges{ MAX_FRAMES_IN_FLIGHT };
+
+		static VkDeviceSize AlignUp(VkDeviceSize size, VkDeviceSize alignment) {
+			return (size + alignment - 1) & ~(alignment - 1);
+		}
+
+		void SetSupport(bool isSupported) {
+			//the heap and the device addresses come from VMA
+			supported = isSupported && USING_VMA && DESCRIPTOR_BUFFER;
+		}
+		bool Enabled() {
+			return supported;
+		}
+		VkBufferUsageFlags BufferUsage(VkBufferUsageFlags usage) {
+			if (supported && (usage & (VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT))) {
+				//buffer descriptors are built from the device address
+				usage |= VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+			}
+			return usage;
+		}
+		VkPipelineCreateFlags PipelineCreateFlags() {
+			return supported ? VK_PIPELINE_CREATE_DESCRIPTOR_BUFFER_BIT_EXT : 0;
+		}
+
+		void Initialize() {
+			assert(VK::Object->CheckMainThread());
+			if (!supported) {
+				return;
+			}
+#if USING_VMA
+			pfnGetLayoutSize = reinterpret_cast<PFN_vkGetDescriptorSetLayoutSizeEXT>(vkGetDeviceProcAddr(VK::Object->vkDevice, "vkGetDescriptorSetLayoutSizeEXT"));
+			pfnGetBindingOffset = reinterpret_cast<PFN_vkGetDescriptorSetLayoutBindingOffsetEXT>(vkGetDeviceProcAddr(VK::Object->vkDevice, "vkGetDescriptorSetLayoutBindingOffsetEXT"));
+			pfnGetDescriptor = reinterpret_cast<PFN_vkGetDescriptorEXT>(vkGetDeviceProcAddr(VK::Object->vkDevice, "vkGetDescriptorEXT"));
+			pfnCmdBindBuffers = reinterpret_cast<PFN_vkCmdBindDescriptorBuffersEXT>(vkGetDeviceProcAddr(VK::Object->vkDevice, "vkCmdBindDescriptorBuffersEXT"));
+			pfnCmdSetOffsets = reinterpret_cast<PFN_vkCmdSetDescriptorBufferOffsetsEXT>(vkGetDeviceProcAddr(VK::Object->vkDevice, "vkCmdSetDescriptorBufferOffsetsEXT"));
+			if (!pfnGetLayoutSize || !pfnGetBindingOffset || !pfnGetDescriptor || !pfnCmdBindBuffers || !pfnCmdSetOffsets) {
+				printf("failed to load the descriptor buffer functions, using descriptor sets\n");
+				supported = false;
+				return;
+			}
+
+			properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_PROPERTIES_EXT;
+			properties.pNext = nullptr;
+			VkPhysicalDeviceProperties2 properties2{};
+			properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+			properties2.pNext = &properties;
+			EWE_VK(vkGetPhysicalDeviceProperties2, VK::Object->physicalDevice, &properties2);
+
+			VkDeviceSize heapSize = DESCRIPTOR_BUFFER_HEAP_SIZE;
+			heapSize = std::min<VkDeviceSize>(heapSize, properties.maxResourceDescriptorBufferRange);
+			heapSize = std::min<VkDeviceSize>(heapSize, properties.maxSamplerDescriptorBufferRange);
+			const VkDeviceSize alignment = properties.descriptorBufferOffsetAlignment;
+			persistentSize = AlignUp(heapSize / 2, alignment);
+			transientRegionSize = ((heapSize - persistentSize) / MAX_FRAMES_IN_FLIGHT) & ~(alignment - 1);
+			heapSize = persistentSize + transientRegionSize * MAX_FRAMES_IN_FLIGHT;
+
+			//one heap for resources and samplers, combined image samplers need both
+			heapUsage = VK_BUFFER_USAGE_RESOURCE_DESCRIPTOR_BUFFER_BIT_EXT | VK_BUFFER_USAGE_SAMPLER_DESCRIPTOR_BUFFER_BIT_EXT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+			VkBufferCreateInfo bufferInfo{};
+			bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+			bufferInfo.size = heapSize;
+			bufferInfo.usage = heapUsage;
+			bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+			VmaAllocationCreateInfo vmaAllocCreateInfo{};
+			vmaAllocCreateInfo.usage = VMA_MEMORY_USAGE_AUTO;
+			vmaAllocCreateInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+			//written from the cpu with no flush
+			vmaAllocCreateInfo.requiredFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+			VmaAllocationInfo vmaAllocInfo{};
+			EWE_VK(vmaCreateBuffer, VK::Object->vmaAllocator, &bufferInfo, &vmaAllocCreateInfo, &heap, &heapAlloc, &vmaAllocInfo);
+			heapMapped = reinterpret_cast<uint8_t*>(vmaAllocInfo.pMappedData);
+#if DEBUG_NAMING
+			DebugNaming::SetObjectName(heap, VK_OBJECT_TYPE_BUFFER, "descriptor buffer heap");
+#endif
+
+			VkBufferDeviceAddressInfo addressInfo{};
+			addressInfo.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO;
+			addressInfo.pNext = nullptr;
+			addressInfo.buffer = heap;
+			heapAddress = vkGetBufferDeviceAddress(VK::Object->vkDevice, &addressInfo);
+
+			persistentRanges.Reset(persistentSize);
+			for (auto& head : transientHeads) {
+				head = 0;
+			}
+			initialized = true;
+#endif
+		}
+
+		void Destroy() {
+			assert(VK::Object->CheckMainThread());
+			if (!initialized) {
+				return;
+			}
+#if USING_VMA
+			vmaDestroyBuffer(VK::Object->vmaAllocator, heap, heapAlloc);
+#endif
+			heap = VK_NULL_HANDLE;
+			heapMapped = nullptr;
+			std::unique_lock<std::mutex> lock{ persistentMutex };
+			persistentRanges.Clear();
+			initialized = false;
+		}
+
+		void QueryLayout(DescriptorSetLayout& layout) {
+			assert(initialized && "descriptor buffer layouts need DescriptorBuffer::Initialize first");
+			pfnGetLayoutSize(VK::Object->vkDevice, layout.vkDSL, &layout.bufferSize);
+			uint32_t highestBinding = 0;
+			for (auto const& binding : layout.bindings) {
+				highestBinding = std::max(highestBinding, binding.binding);
+			}
+			layout.bindingOffsets.assign(highestBinding + 1, 0);
+			for (auto const& binding : layout.bindings) {
+				pfnGetBindingOffset(VK::Object->vkDevice, layout.vkDSL, binding.binding, &layout.bindingOffsets[binding.binding]);
+			}
+		}
+
+		void BeginFrame() {
+			assert(VK::Object->CheckMainThread());
+			if (!initialized) {
+				return;
+			}
+			const uint8_t frameIndex = VK::Object->frameIndex;
+			lastFrame.transientBytes = std::min(transientHeads[frameIndex].exchange(0, std::memory_order_relaxed), transientRegionSize);
+			lastFrame.transientAllocations = frameAllocations.exchange(0, std::memory_order_relaxed);
+			lastFrame.transientFailures = frameFailures.exchange(0, std::memory_order_relaxed);
+		}
+
+		void Update() {
+			assert(VK::Object->CheckMainThread());
+			if (!initialized) {
+				return;
+			}
+			std::unique_lock<std::mutex> lock{ persistentMutex };
+			persistentRanges.Collect(VK::Object->totalFrameCount);
+		}
+
+		Allocation AllocateTransient(DescriptorSetLayout const& layout) {
+			assert(initialized);
+			assert(layout.descriptorBuffer && "the layout wasn't built for descriptor buffers");
+			const VkDeviceSize size = AlignUp(layout.bufferSize, properties.descriptorBufferOffsetAlignment);
+			const uint8_t frameIndex = VK::Object->frameIndex;
+			//the head can run past the region, it's clamped on reset
+			const VkDeviceSize offset = transientHeads[frameIndex].fetch_add(size, std::memory_order_relaxed);
+			if (offset + size > transientRegionSize) {
+				frameFailures.fetch_add(1, std::memory_order_relaxed);
+				return Allocation{};
+			}
+			frameAllocations.fetch_add(1, std::memory_order_relaxed);
+			return Allocation{ persistentSize + transientRegionSize * frameIndex + offset, size };
+		}
+
+		Allocation AllocatePersistent(DescriptorSetLayout const& layout) {
+			assert(initialized);
+			assert(layout.descriptorBuffer && "the layout wasn't built for descriptor buffers");
+			const VkDeviceSize size = AlignUp(layout.bufferSize, properties.descriptorBufferOffsetAlignment);
+			std::unique_lock<std::mutex> lock{ persistentMutex };
+			const uint64_t offset = persistentRanges.Allocate(size);
+			if (offset == RangeAllocator::INVALID_OFFSET) {
+				printf("descriptor buffer persistent region is full : %u live, %u retiring\n", persistentRanges.LiveCount(), persistentRanges.RetiringCount());
+				return Allocation{};
+			}
+			return Allocation{ offset, size };
+		}
+		void FreePersistent(Allocation allocation) {
+			if (!allocation.Valid()) {
+				return;
+			}
+			assert(allocation.offset + allocation.size <= persistentSize);
+			std::unique_lock<std::mutex> lock{ persistentMutex };
+			//the frame being recorded could still read it
+			persistentRanges.Free(allocation.offset, allocation.size, VK::Object->totalFrameCount);
+		}
+
+		static VkDeviceAddress BufferAddress(VkBuffer buffer) {
+			VkBufferDeviceAddressInfo addressInfo{};
+			addressInfo.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO;
+			addressInfo.pNext = nullptr;
+			addressInfo.buffer = buffer;
+			return vkGetBufferDeviceAddress(VK::Object->vkDevice, &addressInfo);
+		}
+
+		void Write(DescriptorSetLayout const& layout, Allocation allocation, std::vector<VkWriteDescriptorSet> const& writes) {
+			assert(allocation.Valid());
+			uint8_t* setData = heapMapped + allocation.offset;
+			for (auto const& write : writes) {
+				assert(write.dstBinding < layout.bindingOffsets.size());
+				uint8_t* bindingData = setData + layout.bindingOffsets[write.dstBinding];
+				for (uint32_t desc = 0; desc < write.descriptorCount; desc++) {
+					VkDescriptorGetInfoEXT getInfo{};
+					getInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_GET_INFO_EXT;
+					getInfo.pNext = nullptr;
+					getInfo.type = write.descriptorType;
+
+					VkDescriptorAddressInfoEXT addressInfo{};
+					std::size_t descriptorSize = 0;
+					switch (write.descriptorType) {
+						case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+						case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER: {
+							VkDescriptorBufferInfo const& bufferInfo = write.pBufferInfo[desc];
+							assert(bufferInfo.range != VK_WHOLE_SIZE && "descriptor buffers need an explicit range");
+							addressInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_ADDRESS_INFO_EXT;
+							addressInfo.pNext = nullptr;
+							addressInfo.address = BufferAddress(bufferInfo.buffer) + bufferInfo.offset;
+							addressInfo.range = bufferInfo.range;
+							addressInfo.format = VK_FORMAT_UNDEFINED;
+							if (write.descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER) {
+								getInfo.data.pUniformBuffer = &addressInfo;
+								descriptorSize = properties.uniformBufferDescriptorSize;
+							}
+							else {
+								getInfo.data.pStorageBuffer = &addressInfo;
+								descriptorSize = properties.storageBufferDescriptorSize;
+							}
+							break;
+						}
+						case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+							getInfo.data.pCombinedImageSampler = &write.pImageInfo[desc];
+							descriptorSize = properties.combinedImageSamplerDescriptorSize;
+							break;
+						case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+							getInfo.data.pSampledImage = &write.pImageInfo[desc];
+							descriptorSize = properties.sampledImageDescriptorSize;
+							break;
+						case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+							getInfo.data.pStorageImage = &write.pImageInfo[desc];
+							descriptorSize = properties.storageImageDescriptorSize;
+							break;
+						case VK_DESCRIPTOR_TYPE_SAMPLER:
+							getInfo.data.pSampler = &write.pImageInfo[desc].sampler;
+							descriptorSize = properties.samplerDescriptorSize;
+							break;
+						default:
+							//dynamic buffers don't exist with descriptor buffers, texel buffers aren't supported yet
+							EWE_UNREACHABLE;
+					}
+					pfnGetDescriptor(VK::Object->vkDevice, &getInfo, descriptorSize, bindingData + (write.dstArrayElement + desc) * descriptorSize);
+				}
+			}
+		}
+
+		void Bind(VkPipelineBindPoint bindPoint, VkPipelineLayout pipeLayout, uint32_t setIndex, Allocation allocation) {
+			assert(allocation.Valid());
+			VkCommandBuffer cmdBuf = VK::Object->GetFrameBuffer();
+			//command buffers are reused each frame, the frame count tells a re-recorded one apart
+			thread_local VkCommandBuffer boundCmdBuf{ VK_NULL_HANDLE };
+			thread_local std::size_t boundFrame{ 0 };
+			if ((boundCmdBuf != cmdBuf) || (boundFrame != VK::Object->totalFrameCount)) {
+				VkDescriptorBufferBindingInfoEXT bindingInfo{};
+				bindingInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_BUFFER_BINDING_INFO_EXT;
+				bindingInfo.pNext = nullptr;
+				bindingInfo.address = heapAddress;
+				bindingInfo.usage = heapUsage;
+				pfnCmdBindBuffers(cmdBuf, 1, &bindingInfo);
+				boundCmdBuf = cmdBuf;
+				boundFrame = VK::Object->totalFrameCount;
+			}
+			const uint32_t bufferIndex = 0;
+			pfnCmdSetOffsets(cmdBuf, bindPoint, pipeLayout, setIndex, 1, &bufferIndex, &allocation.offset);
+		}
+
+		Stats GetStats() {
+			Stats ret = lastFrame;
+			std::unique_lock<std::mutex> lock{ persistentMutex };
+			ret.persistentLive = persistentRanges.LiveCount();
+			ret.persistentBytes = persistentRanges.LiveBytes();
+			ret.persistentRetiring = persistentRanges.RetiringCount();
+			return ret;
+		}
+		void PrintStats() {
+			if (!initialized) {
+				printf("descriptor buffer - not enabled, using descriptor sets\n");
+				return;
+			}
+			const Stats stats = GetStats();
+			printf("descriptor buffer - last frame transient allocations:bytes:failures - %u:%zu:%u, persistent live:bytes:retiring - %u:%zu:%u\n",
+				stats.transientAllocations, static_cast<std::size_t>(stats.transientBytes), stats.transientFailures,
+				stats.persistentLive, static_cast<std::size_t>(stats.persistentBytes), stats.persistentRetiring
+			);
+		}
+	} //namespace DescriptorBuffer
+} //namespace EWE
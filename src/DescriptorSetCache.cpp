@@ -0,0 +1,88 @@
+#include "EWGraphics/Vulkan/DescriptorSetCache.h"
+#include "EWGraphics/Data/RetireQueue.h"
+
+#include <mutex>
+
+namespace EWE {
+	namespace DescriptorSetCache {
+		struct PendingFree {
+			VkDescriptorSet set;
+			EWEDescriptorPool* pool;
+		};
+
+		static std::mutex mutex{};
+		static Index index{};
+		static std::unordered_map<VkDescriptorSet, EWEDescriptorPool*> setPools{};
+		static RetireQueue<PendingFree> pendingFrees{ MAX_FRAMES_IN_FLIGHT };
+
+		static void FreePending(PendingFree& pending) {
+			pending.pool->FreeDescriptorWithoutTracker(&pending.set);
+		}
+
+		VkDescriptorSet Acquire(DescriptorSetLayout* eDSL, EWEDescriptorPool& pool, std::vector<VkWriteDescriptorSet>& writes) {
+			Key key = MakeKey(eDSL->vkDSL, writes.data(), static_cast<uint32_t>(writes.size()));
+			assert(Cacheable(key) && "only buffer and image writes can be cached");
+
+			std::unique_lock<std::mutex> lock{ mutex };
+			VkDescriptorSet set = index.Find(key);
+			if (set != VK_NULL_HANDLE) {
+				return set;
+			}
+			//held through the write, so a racing thread with the same key hits instead of allocating a duplicate
+			pool.AllocateDescriptor(&eDSL->vkDSL, set);
+			eDSL->WriteSet(set, writes);
+			index.Insert(std::move(key), set);
+			setPools.emplace(set, &pool);
+			return set;
+		}
+
+		void EvictResource(uint64_t resource) {
+			std::unique_lock<std::mutex> lock{ mutex };
+			//the frame being recorded could still be using the set
+			const std::size_t frame = VK::Object->totalFrameCount;
+			for (VkDescriptorSet set : index.Evict(resource)) {
+				auto poolIter = setPools.find(set);
+				assert(poolIter != setPools.end());
+				pendingFrees.Push(PendingFree{ set, poolIter->second }, frame);
+				setPools.erase(poolIter);
+			}
+		}
+
+		void Update() {
+			assert(VK::Object->CheckMainThread());
+			std::unique_lock<std::mutex> lock{ mutex };
+			pendingFrees.Collect(VK::Object->totalFrameCount, FreePending);
+		}
+
+		void Destroy() {
+			assert(VK::Object->CheckMainThread());
+			std::unique_lock<std::mutex> lock{ mutex };
+			pendingFrees.Flush(FreePending);
+			for (VkDescriptorSet set : index.Clear()) {
+				setPools.at(set)->FreeDescriptorWithoutTracker(&set);
+			}
+			setPools.clear();
+		}
+
+		Stats GetStats() {
+			std::unique_lock<std::mutex> lock{ mutex };
+			Stats ret{};
+			ret.hits = index.hits;
+			ret.misses = index.misses;
+			ret.live = index.Live();
+			ret.evictions = index.evictions;
+			ret.pendingFrees = static_cast<uint32_t>(pendingFrees.Size());
+			const uint32_t total = ret.hits + ret.misses;
+			ret.hitRate = total > 0 ? static_cast<float>(ret.hits) / static_cast<float>(total) : 0.f;
+			return ret;
+		}
+		void PrintStats() {
+			const Stats stats = GetStats();
+			printf("descriptor set cache - hits:misses:live - %u:%u:%u, hit rate - %.3f, evictions:pending frees - %u:%u\n",
+				stats.hits, stats.misses, stats.live,
+				stats.hitRate,
+				stats.evictions, stats.pendingFrees
+			);
+		}
+	} //namespace DescriptorSetCache
+} //namespace EWE
@@ -1,4 +1,7 @@
 #include "EWGraphics/Vulkan/Descriptors.h"
+#include "EWGraphics/Vulkan/LayoutCache.h"
+#include "EWGraphics/Vulkan/DescriptorSetCache.h"
+#include "EWGraphics/Vulkan/DescriptorBuffer.h"
 
 #include "EWGraphics/Texture/Image_Manager.h"
 
@@ -59,6 +62,13 @@ namespace EWE {
         ret->BuildVkDSL();
         return ret;
     }
+    DescriptorSetLayout* DescriptorSetLayout::Builder::BuildForDescriptorBuffer() {
+        assert(DescriptorBuffer::Enabled());
+        auto* ret = Construct<DescriptorSetLayout>(bindings);
+        ret->descriptorBuffer = true;
+        ret->BuildVkDSL();
+        return ret;
+    }
     DescriptorSetLayout DescriptorSetLayout::Builder::BuildInPlace() {
         return  DescriptorSetLayout(bindings);
     }
@@ -70,32 +80,146 @@ namespace EWE {
         descriptorSetLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
         descriptorSetLayoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
         descriptorSetLayoutInfo.pBindings = bindings.data();
+        descriptorSetLayoutInfo.flags = 0;
+        descriptorSetLayoutInfo.pNext = nullptr;
+
+        std::vector<VkDescriptorBindingFlags> flags = bindingFlags;
+        if (bindless && (bindings.size() > 0)) {
+            //the variable count can only be on the last binding
+            flags.assign(bindings.size(), VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT);
+            flags.back() |= VK_DESCRIPTOR_BINDING_VARIABLE_DESCRIPTOR_COUNT_BIT;
+        }
+        assert((flags.size() == 0) || (flags.size() == bindings.size()));
 
-        if (bindless) {
-            const VkDescriptorBindingFlagsEXT flags =
-                VK_DESCRIPTOR_BINDING_VARIABLE_DESCRIPTOR_COUNT_BIT_EXT |
-                VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT |
-                VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT |
-                VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT_EXT;
+        bool anyFlags = false;
+        for (uint32_t i = 0; i < flags.size(); i++) {
+            anyFlags |= flags[i] != 0;
+            if (flags[i] & VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT) {
+                descriptorSetLayoutInfo.flags |= VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+            }
+#if EWE_DEBUG
+            if (flags[i] & VK_DESCRIPTOR_BINDING_VARIABLE_DESCRIPTOR_COUNT_BIT) {
+                for (auto const& binding : bindings) {
+                    assert(binding.binding <= bindings[i].binding && "a variable count binding has to be the highest binding in the set");
+                }
+            }
+#endif
+        }
 
-            VkDescriptorSetLayoutBindingFlagsCreateInfoEXT binding_flags{};
-            binding_flags.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT;
-            binding_flags.pNext = nullptr;
-            binding_flags.bindingCount = 1;
-            binding_flags.pBindingFlags = &flags;
-            descriptorSetLayoutInfo.pNext = &binding_flags;
+        VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo{};
+        if (anyFlags) {
+            bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+            bindingFlagsInfo.pNext = nullptr;
+            bindingFlagsInfo.bindingCount = static_cast<uint32_t>(flags.size());
+            bindingFlagsInfo.pBindingFlags = flags.data();
+            descriptorSetLayoutInfo.pNext = &bindingFlagsInfo;
+        }
+        if (descriptorBuffer) {
+            //descriptor buffers don't have pools, update after bind is implied
+            descriptorSetLayoutInfo.flags &= ~VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+            descriptorSetLayoutInfo.flags |= VK_DESCRIPTOR_SET_LAYOUT_CREATE_DESCRIPTOR_BUFFER_BIT_EXT;
+        }
+        EWE_VK(vkCreateDescriptorSetLayout, VK::Object->vkDevice, &descriptorSetLayoutInfo, nullptr, &vkDSL);
 
-            descriptorSetLayoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+        if (descriptorBuffer) {
+            DescriptorBuffer::QueryLayout(*this);
+            return;
+        }
+#if DESCRIPTOR_UPDATE_TEMPLATES
+        BuildUpdateTemplate();
+#endif
+    }
 
-            EWE_VK(vkCreateDescriptorSetLayout, VK::Object->vkDevice, &descriptorSetLayoutInfo, nullptr, &vkDSL);
+    bool DescriptorSetLayout::BuildTemplateEntries(std::vector<VkDescriptorSetLayoutBinding> const& bindings, std::vector<VkDescriptorUpdateTemplateEntry>& entries) {
+        entries.clear();
+        entries.reserve(bindings.size());
+        for (std::size_t i = 0; i < bindings.size(); i++) {
+            auto const& binding = bindings[i];
+            //the writer fills binding i with its i-th write
+            if ((binding.binding != i) || (binding.descriptorCount != 1)) {
+                return false;
+            }
+            switch (binding.descriptorType) {
+                case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+                case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+                case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
+                case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:
+                case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+                case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+                case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+                case VK_DESCRIPTOR_TYPE_SAMPLER:
+                    break;
+                default:
+                    return false;
+            }
+            VkDescriptorUpdateTemplateEntry entry{};
+            entry.dstBinding = binding.binding;
+            entry.dstArrayElement = 0;
+            entry.descriptorCount = 1;
+            entry.descriptorType = binding.descriptorType;
+            entry.offset = i * sizeof(TemplateData);
+            entry.stride = sizeof(TemplateData);
+            entries.push_back(entry);
         }
-        else {
-            descriptorSetLayoutInfo.flags = 0;
-            descriptorSetLayoutInfo.pNext = nullptr;
-            EWE_VK(vkCreateDescriptorSetLayout, VK::Object->vkDevice, &descriptorSetLayoutInfo, nullptr, &vkDSL);
+        return true;
+    }
+    void DescriptorSetLayout::PackTemplateData(std::vector<VkWriteDescriptorSet> const& writes, TemplateData* data) {
+        for (std::size_t i = 0; i < writes.size(); i++) {
+            if (writes[i].pBufferInfo != nullptr) {
+                data[i].buffer = *writes[i].pBufferInfo;
+            }
+            else {
+                data[i].image = *writes[i].pImageInfo;
+            }
         }
     }
 
+#if DESCRIPTOR_UPDATE_TEMPLATES
+    void DescriptorSetLayout::BuildUpdateTemplate() {
+        if (bindless || (bindings.size() == 0)) {
+            return;
+        }
+        std::vector<VkDescriptorUpdateTemplateEntry> entries{};
+        if (!BuildTemplateEntries(bindings, entries)) {
+            return;
+        }
+
+        VkDescriptorUpdateTemplateCreateInfo templateInfo{};
+        templateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO;
+        templateInfo.pNext = nullptr;
+        templateInfo.flags = 0;
+        templateInfo.descriptorUpdateEntryCount = static_cast<uint32_t>(entries.size());
+        templateInfo.pDescriptorUpdateEntries = entries.data();
+        templateInfo.templateType = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET;
+        templateInfo.descriptorSetLayout = vkDSL;
+        EWE_VK(vkCreateDescriptorUpdateTemplate, VK::Object->vkDevice, &templateInfo, nullptr, &updateTemplate);
+    }
+#endif
+
+    void DescriptorSetLayout::WriteSet(VkDescriptorSet set, std::vector<VkWriteDescriptorSet>& writes) const {
+#if DESCRIPTOR_UPDATE_TEMPLATES
+        //a partial write falls back to vkUpdateDescriptorSets
+        if ((updateTemplate != VK_NULL_HANDLE) && (writes.size() == bindings.size())) {
+            //on the stack for the common sizes
+            static constexpr std::size_t localCount = 16;
+            TemplateData localData[localCount];
+            std::vector<TemplateData> heapData{};
+            TemplateData* data = localData;
+            if (writes.size() > localCount) {
+                heapData.resize(writes.size());
+                data = heapData.data();
+            }
+            PackTemplateData(writes, data);
+            EWE_VK(vkUpdateDescriptorSetWithTemplate, VK::Object->vkDevice, set, updateTemplate, data);
+            return;
+        }
+#endif
+        for (auto& write : writes) {
+            write.dstSet = set;
+        }
+        EWE_VK(vkUpdateDescriptorSets, VK::Object->vkDevice, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+    }
+
     DescriptorSetLayout::DescriptorSetLayout() : vkDSL{ VK_NULL_HANDLE }, bindings{}, bindless{ false } {}
     DescriptorSetLayout::DescriptorSetLayout(std::vector<VkDescriptorSetLayoutBinding>& bindings, bool bindless)
         : vkDSL{ VK_NULL_HANDLE }, bindings{ std::move(bindings) }, bindless{ bindless }
@@ -103,9 +227,24 @@ namespace EWE {
     DescriptorSetLayout::DescriptorSetLayout(std::vector<VkDescriptorSetLayoutBinding> const& bindings, bool bindless)
         : vkDSL{ VK_NULL_HANDLE }, bindings{ bindings }, bindless{ bindless }
     {}
+    DescriptorSetLayout::DescriptorSetLayout(std::vector<VkDescriptorSetLayoutBinding> const& bindings, std::vector<VkDescriptorBindingFlags> const& bindingFlags)
+        : vkDSL{ VK_NULL_HANDLE }, bindings{ bindings }, bindingFlags{}, bindless{ false }
+    {
+        assert(bindingFlags.size() == bindings.size());
+        for (auto flags : bindingFlags) {
+            if (flags != 0) {
+                this->bindingFlags = bindingFlags;
+                break;
+            }
+        }
+    }
 
     DescriptorSetLayout::~DescriptorSetLayout() {
+        if (updateTemplate != VK_NULL_HANDLE) {
+            EWE_VK(vkDestroyDescriptorUpdateTemplate, VK::Object->vkDevice, updateTemplate, nullptr);
+        }
         if (vkDSL != VK_NULL_HANDLE) {
+            DescriptorSetCache::Evict(vkDSL);
             EWE_VK(vkDestroyDescriptorSetLayout, VK::Object->vkDevice, vkDSL, nullptr);
         }
 #if EWE_DEBUG
@@ -129,7 +268,7 @@ namespace EWE {
 
 
     DescriptorLayoutPack::DescriptorLayoutPack(DescriptorLayoutPack&& other) noexcept
-        : setLayouts{ std::move(other.setLayouts)}
+        : setLayouts{ std::move(other.setLayouts)}, interned{ other.interned }
     {
 		other.setLayouts.clear();
     }
@@ -137,7 +276,12 @@ namespace EWE {
     DescriptorLayoutPack::~DescriptorLayoutPack() {
         for (auto& dsl : setLayouts) {
             if (dsl.value) {
-                Deconstruct(dsl.value);
+                if (interned) {
+                    LayoutCache::ReleaseDSL(dsl.value);
+                }
+                else {
+                    Deconstruct(dsl.value);
+                }
             }
         }
         setLayouts.clear();
@@ -453,6 +597,9 @@ namespace EWE {
         return set;
 #endif
     }
+    VkDescriptorSet EWEDescriptorWriter::BuildCached() {
+        return DescriptorSetCache::Acquire(setLayout, pool, writes);
+    }
     VkDescriptorSet EWEDescriptorWriter::BuildPrint() {
         VkDescriptorSet set;
         pool.AllocateDescriptor(setLayout, set);
@@ -476,10 +623,14 @@ namespace EWE {
     }
 
     void EWEDescriptorWriter::Overwrite(VkDescriptorSet& set) {
-        for (auto& write : writes) {
-            write.dstSet = set;
+        setLayout->WriteSet(set, writes);
+    }
+    DescriptorBuffer::Allocation EWEDescriptorWriter::BuildInDescriptorBuffer(bool transient) {
+        assert(setLayout->descriptorBuffer);
+        const DescriptorBuffer::Allocation allocation = transient ? DescriptorBuffer::AllocateTransient(*setLayout) : DescriptorBuffer::AllocatePersistent(*setLayout);
+        if (allocation.Valid()) {
+            DescriptorBuffer::Write(*setLayout, allocation, writes);
         }
-
-        EWE_VK(vkUpdateDescriptorSets, VK::Object->vkDevice, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+        return allocation;
     }
 }  // namespace EWE
\ No newline at end of file
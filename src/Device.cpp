@@ -1,6 +1,11 @@
 #include "EWGraphics/Vulkan/Device.hpp"
 
 #include "EWGraphics/Texture/Sampler.h" //this is only for construction and deconstruction, do not call Sampler directly from device.cpp
+#include "EWGraphics/Vulkan/PipelineCache.h"
+#include "EWGraphics/Vulkan/PipelineLibrary.h"
+#include "EWGraphics/Vulkan/DescriptorBuffer.h"
+#include "EWGraphics/Vulkan/ShaderReflection.h"
+#include "EWGraphics/Texture/TextureCooker.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb/stb_image.h>
@@ -240,6 +245,9 @@ namespace EWE {
                 //{VK_EXT_FULL_SCREEN_EXCLUSIVE_EXTENSION_NAME}
     #endif
             {VK_EXT_MESH_SHADER_EXTENSION_NAME, false},
+            {VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME, false},
+            {VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME, false},
+            {VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME, false},
         }
     { //ewe device entrance
         
@@ -273,6 +281,8 @@ namespace EWE {
 #endif
 
         CreateCommandPools();
+        PipelineCache::Initialize();
+        DescriptorBuffer::Initialize();
         //printf("command pool, transfer CP - %lld:%lld \n", commandPool, transferCommandPool);
         //std::cout << "command pool, transfer CP - " << std::hex << commandPool << ":" << transferCommandPool << std::endl;
         //printf("after creating transfer command pool \n");
@@ -307,6 +317,9 @@ namespace EWE {
         if (VK::Object->renderCmdPool != VK_NULL_HANDLE) {
             EWE_VK(vkDestroyCommandPool, VK::Object->vkDevice, VK::Object->renderCmdPool, nullptr);
         }
+        PipelineCache::Destroy();
+        DescriptorBuffer::Destroy();
+        ShaderReflection::Save();
 #if USING_VMA
         vmaDestroyAllocator(VK::Object->vmaAllocator);
 #endif
@@ -598,11 +611,76 @@ namespace EWE {
         deviceFeatures2.features.geometryShader = VK_TRUE;
         deviceFeatures2.features.wideLines = VK_TRUE;
         deviceFeatures2.features.tessellationShader = VK_TRUE;
+        {
+            //ktx2 textures are usually BCn
+            VkPhysicalDeviceFeatures supportedFeatures{};
+            EWE_VK(vkGetPhysicalDeviceFeatures, VK::Object->physicalDevice, &supportedFeatures);
+            deviceFeatures2.features.textureCompressionBC = supportedFeatures.textureCompressionBC;
+            //everything the cooker writes is BCn
+            TextureCooker::SetSupport(supportedFeatures.textureCompressionBC == VK_TRUE);
+        }
 
 #if EWE_DEBUG
         deviceFeatures2.features.fillModeNonSolid = VK_TRUE;
 #endif
 
+        //the extension being listed doesn't mean the feature is
+        VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT pipelineLibraryFeatures{};
+        pipelineLibraryFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+#if DEBUGGING_DEVICE_LOST
+        //optional extensions aren't enabled in the device lost debug path
+        bool pipelineLibrarySupported = false;
+#else
+        bool pipelineLibrarySupported = optionalExtensions.at(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME) && optionalExtensions.at(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME);
+#endif
+        if (pipelineLibrarySupported) {
+            VkPhysicalDeviceFeatures2 supportedFeatures{};
+            supportedFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+            supportedFeatures.pNext = &pipelineLibraryFeatures;
+            EWE_VK(vkGetPhysicalDeviceFeatures2, VK::Object->physicalDevice, &supportedFeatures);
+            pipelineLibrarySupported = pipelineLibraryFeatures.graphicsPipelineLibrary == VK_TRUE;
+            pipelineLibraryFeatures.pNext = nullptr;
+        }
+        if (pipelineLibrarySupported) {
+            deviceExts.Add((VkBaseInStructure*)&pipelineLibraryFeatures);
+        }
+
+        //descriptor buffers build buffer descriptors from device addresses
+        VkPhysicalDeviceDescriptorBufferFeaturesEXT descriptorBufferFeatures{};
+        descriptorBufferFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_FEATURES_EXT;
+        VkPhysicalDeviceBufferDeviceAddressFeatures bufferDeviceAddressFeatures{};
+        bufferDeviceAddressFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_BUFFER_DEVICE_ADDRESS_FEATURES;
+#if DEBUGGING_DEVICE_LOST || !DESCRIPTOR_BUFFER
+        bool descriptorBufferSupported = false;
+#else
+        bool descriptorBufferSupported = optionalExtensions.at(VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME);
+#endif
+        if (descriptorBufferSupported) {
+            VkPhysicalDeviceFeatures2 supportedFeatures{};
+            supportedFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+            supportedFeatures.pNext = &descriptorBufferFeatures;
+            descriptorBufferFeatures.pNext = &bufferDeviceAddressFeatures;
+            EWE_VK(vkGetPhysicalDeviceFeatures2, VK::Object->physicalDevice, &supportedFeatures);
+            descriptorBufferSupported = (descriptorBufferFeatures.descriptorBuffer == VK_TRUE) && (bufferDeviceAddressFeatures.bufferDeviceAddress == VK_TRUE);
+            descriptorBufferFeatures.pNext = nullptr;
+            bufferDeviceAddressFeatures.pNext = nullptr;
+        }
+        if (descriptorBufferSupported) {
+            //only what's used, capture replay and the rest stay off
+            descriptorBufferFeatures.descriptorBufferCaptureReplay = VK_FALSE;
+            descriptorBufferFeatures.descriptorBufferImageLayoutIgnored = VK_FALSE;
+            descriptorBufferFeatures.descriptorBufferPushDescriptors = VK_FALSE;
+            bufferDeviceAddressFeatures.bufferDeviceAddressCaptureReplay = VK_FALSE;
+            bufferDeviceAddressFeatures.bufferDeviceAddressMultiDevice = VK_FALSE;
+            deviceExts.Add((VkBaseInStructure*)&descriptorBufferFeatures);
+            deviceExts.Add((VkBaseInStructure*)&bufferDeviceAddressFeatures);
+        }
+        else {
+            //listed but the features aren't there, or the backend is off. don't enable it
+            optionalExtensions.at(VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME) = false;
+        }
+        DescriptorBuffer::SetSupport(descriptorBufferSupported);
+
         VkPhysicalDeviceDynamicRenderingFeatures dynamic_rendering_feature{};
 		deviceExts.Add((VkBaseInStructure*)&dynamic_rendering_feature);
         dynamic_rendering_feature.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES;
@@ -692,6 +770,20 @@ namespace EWE {
             EWE_VK(vkGetPhysicalDeviceProperties2, VK::Object->physicalDevice, &testDeviceFeatures2);
         }
 
+        if (pipelineLibrarySupported) {
+            VkPhysicalDeviceGraphicsPipelineLibraryPropertiesEXT pipelineLibraryProperties{};
+            pipelineLibraryProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_PROPERTIES_EXT;
+            pipelineLibraryProperties.pNext = nullptr;
+            VkPhysicalDeviceProperties2 properties2{};
+            properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+            properties2.pNext = &pipelineLibraryProperties;
+            EWE_VK(vkGetPhysicalDeviceProperties2, VK::Object->physicalDevice, &properties2);
+            PipelineLibrary::SetSupport(true, pipelineLibraryProperties.graphicsPipelineLibraryFastLinking == VK_TRUE);
+        }
+        else {
+            PipelineLibrary::SetSupport(false, false);
+        }
+
         VK::CmdDrawMeshTasksEXT = reinterpret_cast<PFN_vkCmdDrawMeshTasksEXT>(vkGetDeviceProcAddr(VK::Object->vkDevice, "vkCmdDrawMeshTasksEXT"));
 #if EWE_DEBUG
         //std::cout << "getting device queues \n";
@@ -723,6 +815,9 @@ namespace EWE {
     void EWEDevice::CreateVmaAllocator() {
         VmaAllocatorCreateInfo allocatorCreateInfo{};
         allocatorCreateInfo.flags = VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
+        if (DescriptorBuffer::Enabled()) {
+            allocatorCreateInfo.flags |= VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT;
+        }
         allocatorCreateInfo.vulkanApiVersion = VK_API_VERSION_1_3;
         allocatorCreateInfo.physicalDevice = VK::Object->physicalDevice;
         allocatorCreateInfo.device = VK::Object->vkDevice;
@@ -1,4 +1,6 @@
 #include "EWGraphics/Vulkan/Device_Buffer.h"
+#include "EWGraphics/Vulkan/DescriptorSetCache.h"
+#include "EWGraphics/Vulkan/DescriptorBuffer.h"
 
 // std
 #include <cassert>
@@ -49,7 +51,7 @@ namespace EWE {
         VkBufferCreateInfo bufferInfo{};
         bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
         bufferInfo.size = bufferSize;
-        bufferInfo.usage = usageFlags;
+        bufferInfo.usage = DescriptorBuffer::BufferUsage(usageFlags);
         bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
         VmaAllocationInfo vmaAllocInfo{};
         VmaAllocationCreateInfo vmaAllocCreateInfo{};
@@ -110,6 +112,7 @@ namespace EWE {
 
     EWEBuffer::~EWEBuffer() {
         Unmap();
+        DescriptorSetCache::Evict(buffer_info.buffer);
 #if USING_VMA
         vmaDestroyBuffer(VK::Object->vmaAllocator, buffer_info.buffer, vmaAlloc);
 #else
@@ -122,6 +125,7 @@ namespace EWE {
         if (mapped) {
             Unmap();
         }
+        DescriptorSetCache::Evict(buffer_info.buffer);
 #if USING_VMA
         vmaDestroyBuffer(VK::Object->vmaAllocator, buffer_info.buffer, vmaAlloc);
 #else
@@ -138,7 +142,7 @@ namespace EWE {
         VkBufferCreateInfo bufferInfo{};
         bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
         bufferInfo.size = bufferSize;
-        bufferInfo.usage = usageFlags;
+        bufferInfo.usage = DescriptorBuffer::BufferUsage(usageFlags);
         bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
         VmaAllocationInfo vmaAllocInfo{};
         VmaAllocationCreateInfo vmaAllocCreateInfo{};
@@ -0,0 +1,121 @@
+#include "EWGraphics/Vulkan/FramePacer.h"
+
+#include "EWGraphics/Vulkan/SyncHub.h"
+
+#include <cmath>
+#include <thread>
+
+namespace EWE {
+	template<typename Duration>
+	static double ToMilliseconds(Duration duration) {
+		return std::chrono::duration<double, std::milli>(duration).count();
+	}
+
+	void FramePacer::SetMode(Mode mode) {
+		this->mode = mode;
+		predictedWait = 0.0;
+		framesSinceDepthChange = 0;
+	}
+
+	void FramePacer::BeginFrame() {
+		const Clock::time_point frameStart = Clock::now();
+
+		double sleepTime = 0.0;
+		if (mode != Mode::Throughput) {
+			const double sleepTarget = predictedWait - safetyMargin;
+			if (sleepTarget > 0.0) {
+				std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(sleepTarget));
+				sleepTime = ToMilliseconds(Clock::now() - frameStart);
+			}
+		}
+
+		const Clock::time_point waitStart = Clock::now();
+		SyncHub::GetSyncHubInstance()->WaitOnGraphicsFence();
+		const double fenceWait = ToMilliseconds(Clock::now() - waitStart);
+
+		//if the sleep was right, the fence wait is down to the margin, and the sum stays where it was
+		predictedWait += ((sleepTime + fenceWait) - predictedWait) * 0.1;
+
+		if (hasLastFrame) {
+			frameTimes[sampleIndex] = static_cast<float>(ToMilliseconds(frameStart - lastFrameStart));
+			fenceWaits[sampleIndex] = static_cast<float>(fenceWait);
+			sleeps[sampleIndex] = static_cast<float>(sleepTime);
+			sampleIndex = (sampleIndex + 1) % windowSize;
+			if (sampleCount < windowSize) {
+				sampleCount++;
+			}
+		}
+		hasLastFrame = true;
+		lastFrameStart = frameStart;
+
+		if (mode == Mode::Adaptive) {
+			framesSinceDepthChange++;
+			if ((framesSinceDepthChange >= windowSize) && (sampleCount == windowSize)) {
+				AdjustDepth(GetStats());
+			}
+		}
+	}
+
+	void FramePacer::AdjustDepth(Stats const& stats) {
+		uint8_t framesInFlight = VK::Object->framesInFlight;
+		const double variation = stats.frameTimeMean > 0.0 ? stats.frameTimeStdDev / stats.frameTimeMean : 0.0;
+		if ((stats.fenceWaitMean < 0.1) && (variation > 0.15) && (framesInFlight < MAX_FRAMES_IN_FLIGHT)) {
+			//the GPU is never ahead, deeper queuing absorbs the CPU spikes
+			framesInFlight++;
+		}
+		else if (((stats.fenceWaitMean + stats.sleepMean) > (stats.frameTimeMean * 0.25)) && (framesInFlight > DEFAULT_FRAMES_IN_FLIGHT)) {
+			//GPU bound, the extra frames are only adding latency
+			framesInFlight--;
+		}
+		if (framesInFlight != VK::Object->framesInFlight) {
+			SyncHub::GetSyncHubInstance()->SetFramesInFlight(framesInFlight);
+			//the samples from the old depth don't say anything about the new one
+			sampleCount = 0;
+			sampleIndex = 0;
+			hasLastFrame = false;
+		}
+		framesSinceDepthChange = 0;
+	}
+
+	FramePacer::Stats FramePacer::GetStats() const {
+		Stats ret{};
+		ret.framesInFlight = VK::Object->framesInFlight;
+		ret.sampleCount = sampleCount;
+		ret.predictedWait = predictedWait;
+		if (sampleCount == 0) {
+			return ret;
+		}
+		double frameTimeSum = 0.0;
+		double fenceWaitSum = 0.0;
+		double sleepSum = 0.0;
+		for (uint16_t i = 0; i < sampleCount; i++) {
+			frameTimeSum += frameTimes[i];
+			fenceWaitSum += fenceWaits[i];
+			sleepSum += sleeps[i];
+			if (frameTimes[i] > ret.frameTimeMax) {
+				ret.frameTimeMax = frameTimes[i];
+			}
+		}
+		ret.frameTimeMean = frameTimeSum / sampleCount;
+		ret.fenceWaitMean = fenceWaitSum / sampleCount;
+		ret.sleepMean = sleepSum / sampleCount;
+
+		double varianceSum = 0.0;
+		for (uint16_t i = 0; i < sampleCount; i++) {
+			const double diff = frameTimes[i] - ret.frameTimeMean;
+			varianceSum += diff * diff;
+		}
+		ret.frameTimeVariance = varianceSum / sampleCount;
+		ret.frameTimeStdDev = std::sqrt(ret.frameTimeVariance);
+		return ret;
+	}
+
+	void FramePacer::PrintStats() const {
+		const Stats stats = GetStats();
+		printf("frame pacing[%u in flight] - frame time mean:stddev:max(ms) - %.3f:%.3f:%.3f, fence wait - %.3f, sleep - %.3f, predicted - %.3f\n",
+			stats.framesInFlight,
+			stats.frameTimeMean, stats.frameTimeStdDev, stats.frameTimeMax,
+			stats.fenceWaitMean, stats.sleepMean, stats.predictedWait
+		);
+	}
+} //namespace EWE
@@ -2,6 +2,9 @@
 
 #include "EWGraphics/Model/Model.h"
 #include "EWGraphics/Vulkan/Renderer.h"
+#include "EWGraphics/Vulkan/PipelineCache.h"
+#include "EWGraphics/Vulkan/PermutationCache.h"
+#include "EWGraphics/Vulkan/PipelineLibrary.h"
 
 #if PIPELINE_HOT_RELOAD
 #include "EWGraphics/Data/magic_enum.hpp"
@@ -294,20 +297,56 @@ namespace EWE {
 		pipelineInfo.layout = pipeLayout->vkLayout;
 		pipelineInfo.subpass = configInfo.subpass;
 
-		EWE_VK(vkCreateGraphicsPipelines, VK::Object->vkDevice, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &vkPipe);
+		const auto creationStart = std::chrono::steady_clock::now();
+		EWE_VK(vkCreateGraphicsPipelines, VK::Object->vkDevice, PipelineCache::Get(), 1, &pipelineInfo, nullptr, &vkPipe);
+		PipelineCache::RecordCreation(std::chrono::steady_clock::now() - creationStart);
 	}
 
 	void GraphicsPipeline::CreateVkPipeline(PipelineConfigInfo& configInfo) {
+		const PermutationCache::Key permutationKey = PermutationCache::MakeGraphicsKey(*pipeLayout, configInfo, copySpecInfo);
+		vkPipe = PermutationCache::Acquire(permutationKey);
+		if (vkPipe != VK_NULL_HANDLE) {
+			return;
+		}
+
 		std::vector<KeyValuePair<ShaderStage, Shader::VkSpecInfo_RAII>> temp{};
 		for (auto& stage : copySpecInfo) {
 			temp.push_back(KeyValuePair<ShaderStage, Shader::VkSpecInfo_RAII>(stage.key, Shader::VkSpecInfo_RAII(stage.value)));
 		}
-		VkGraphicsPipelineCreateInfo pipelineInfo{};
 		std::vector<VkPipelineShaderStageCreateInfo> shaderStages = pipeLayout->GetStageData(temp);
+
+		PipelineLibrary::LinkedParts libraryParts{};
+#if PIPELINE_LIBRARY_HITCH_REPORT
+		const auto fastLinkStart = std::chrono::steady_clock::now();
+#endif
+		const VkPipeline fastPipe = PipelineLibrary::FastLink(*pipeLayout, configInfo, shaderStages, libraryParts);
+		if (fastPipe != VK_NULL_HANDLE) {
+#if PIPELINE_LIBRARY_HITCH_REPORT
+			{
+				const double fastLinkMS = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - fastLinkStart).count();
+				//what the first use would have cost without libraries. built, timed and destroyed
+				VkGraphicsPipelineCreateInfo pipelineInfo{};
+				pipelineInfo.stageCount = static_cast<uint32_t>(shaderStages.size());
+				pipelineInfo.pStages = shaderStages.data();
+				const auto monolithicStart = std::chrono::steady_clock::now();
+				CreateVkPipeline_SecondStage(configInfo, pipelineInfo);
+				PipelineLibrary::RecordFirstUse(fastLinkMS, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - monolithicStart).count());
+				EWE_VK(vkDestroyPipeline, VK::Object->vkDevice, vkPipe, nullptr);
+			}
+#endif
+			vkPipe = PermutationCache::Insert(permutationKey, fastPipe, libraryParts);
+			if (vkPipe == fastPipe) {
+				PipelineLibrary::QueueOptimizedLink(libraryParts, pipeLayout->vkLayout, fastPipe);
+			}
+			return;
+		}
+
+		VkGraphicsPipelineCreateInfo pipelineInfo{};
 		pipelineInfo.stageCount = static_cast<uint32_t>(shaderStages.size());
 		pipelineInfo.pStages = shaderStages.data();
 
 		CreateVkPipeline_SecondStage(configInfo, pipelineInfo);
+		vkPipe = PermutationCache::Insert(permutationKey, vkPipe);
 	}
 
 
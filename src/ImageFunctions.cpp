@@ -2,9 +2,15 @@
 
 #include "EWGraphics/Vulkan/SyncHub.h"
 #include "EWGraphics/Texture/Sampler.h"
+#include "EWGraphics/Vulkan/DescriptorSetCache.h"
+#include "EWGraphics/Texture/KTX2.h"
+#include "EWGraphics/Texture/TextureCooker.h"
+#include "EWGraphics/Texture/MipGenerator.h"
 
 #include <stb/stb_image.h>
+#include <chrono>
 #include <cmath>
+#include <stdexcept>
 
 
 namespace EWE {
@@ -69,6 +75,14 @@ namespace EWE {
                 1, &region
             );
         }
+        void CopyBufferToImage(CommandBuffer& cmdBuf, VkBuffer buffer, VkImage image, std::vector<VkBufferImageCopy> const& regions) {
+            EWE_VK(vkCmdCopyBufferToImage,
+                cmdBuf,
+                buffer,
+                image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                static_cast<uint32_t>(regions.size()), regions.data()
+            );
+        }
         void GenerateMipMapsForMultipleImagesTransferQueue(CommandBuffer& cmdBuf, std::vector<ImageInfo*>& imageInfos) {
             assert(VK::Object->queueEnabled[Queue::transfer]);
             //printf("before mip map loop? size of image : %d \n", image.size());
@@ -371,128 +385,72 @@ namespace EWE {
         }
 
 
-        void CreateImageCommands(ImageInfo& imageInfo, VkImageCreateInfo const& imageCreateInfo, StagingBuffer* stagingBuffer, bool mipmapping) {
-            SyncHub* syncHub = SyncHub::GetSyncHubInstance();
-            CommandBuffer& cmdBuf = syncHub->BeginSingleTimeCommand();
-            VkImageSubresourceRange subresourceRange = CreateSubresourceRange(imageInfo);
-            {
-                VkImageMemoryBarrier imageBarrier = Barrier::ChangeImageLayout(imageInfo.image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, subresourceRange);
-                imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-                imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-                EWE_VK(vkCmdPipelineBarrier, cmdBuf,
-                    VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
-                    0,
-                    0, nullptr,
-                    0, nullptr,
-                    1, &imageBarrier
-                );
+        UploadToken CreateImageCommands(ImageInfo& imageInfo, VkImageCreateInfo const& imageCreateInfo, StagingBuffer* stagingBuffer, bool mipmapping) {
+            if (mipmapping && MIPMAP_ENABLED) {
+                VkFormatProperties formatProperties;
+                EWE_VK(vkGetPhysicalDeviceFormatProperties, VK::Object->physicalDevice, imageCreateInfo.format, &formatProperties);
+                assert((formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT) && "texture image format does not support linear blitting");
             }
+
+            if (!VK::Object->CheckMainThread()) {
+                //doesn't block, the image is acquired by the graphics queue at the beginning of a following frame
+                //descriptorImageInfo.imageLayout is set to destinationImageLayout when that happens
+                return UploadQueue::EnqueueImage(stagingBuffer, imageInfo, imageCreateInfo.extent.width, imageCreateInfo.extent.height, mipmapping);
+            }
+
+            SyncHub* syncHub = SyncHub::GetSyncHubInstance();
+            CommandBuffer& cmdBuf = syncHub->BeginSingleTimeCommandGraphics();
+            const ResourceUsage shaderReadUsage{ Queue::graphics, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT };
+            ResourceTracker::Transition(imageInfo, ResourceUsage{ Queue::graphics, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT }, true).RecordAcquire(cmdBuf);
             //printf("before copy buffer to image \n");
             
             Image::CopyBufferToImage(cmdBuf, stagingBuffer->buffer, imageInfo.image, imageCreateInfo.extent.width, imageCreateInfo.extent.height, imageInfo.arrayLayers);
 
-            const bool inMainThread = VK::Object->CheckMainThread();
-
-            if (inMainThread || (!VK::Object->queueEnabled[Queue::transfer])) {
-                GraphicsCommand graphicsCommand{};
-                graphicsCommand.command = &cmdBuf;
-                graphicsCommand.stagingBuffer = stagingBuffer;
-                if (mipmapping && MIPMAP_ENABLED) {
-                    syncHub->EndSingleTimeCommandGraphics(graphicsCommand);
-                    VkFormatProperties formatProperties;
-                    EWE_VK(vkGetPhysicalDeviceFormatProperties, VK::Object->physicalDevice, imageCreateInfo.format, &formatProperties);
-                    assert((formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT) && "texture image format does not support linear blitting");
+            GraphicsCommand graphicsCommand{};
+            graphicsCommand.command = &cmdBuf;
+            graphicsCommand.stagingBuffer = stagingBuffer;
+            if (mipmapping && MIPMAP_ENABLED) {
+                syncHub->EndSingleTimeCommandGraphics(graphicsCommand);
 
-                    SyncHub* syncHub = SyncHub::GetSyncHubInstance();
-                    GraphicsCommand mipCommand{};
-                    mipCommand.command = &syncHub->BeginSingleTimeCommand();
-                    mipCommand.imageInfo = &imageInfo;
+                GraphicsCommand mipCommand{};
+                mipCommand.command = &syncHub->BeginSingleTimeCommandGraphics();
+                mipCommand.imageInfo = &imageInfo;
 
-                    GenerateMipmaps(*mipCommand.command, &imageInfo, Queue::graphics);
+                GenerateMipmaps(*mipCommand.command, &imageInfo, Queue::graphics);
+                ResourceTracker::SetState(imageInfo.state, shaderReadUsage);
 
-                    syncHub->EndSingleTimeCommandGraphics(mipCommand);
-                }
-                else {
-                    graphicsCommand.imageInfo = &imageInfo;
-                    VkImageMemoryBarrier imageBarrier = Barrier::ChangeImageLayout(imageInfo.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, subresourceRange);
-                    imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-                    imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-                    EWE_VK(vkCmdPipelineBarrier, cmdBuf,
-                        VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
-                        0,
-                        0, nullptr,
-                        0, nullptr,
-                        1, &imageBarrier
-                    );
-
-                    syncHub->EndSingleTimeCommandGraphics(graphicsCommand);
-                }
+                syncHub->EndSingleTimeCommandGraphics(mipCommand);
             }
             else {
-                VkImageMemoryBarrier imageBarrier{};
-                imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-                imageBarrier.pNext = nullptr;
-                imageBarrier.image = imageInfo.image;
-                imageBarrier.srcQueueFamilyIndex = VK::Object->queueIndex[Queue::transfer];
-                imageBarrier.dstQueueFamilyIndex = VK::Object->queueIndex[Queue::graphics];
-                imageBarrier.subresourceRange = subresourceRange;
-                imageBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-                imageBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-                imageBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-
-                if (mipmapping && MIPMAP_ENABLED) {
-                    //pipeBarrier.AddBarrier(imageBarrier);
-                    //pipeBarrier.SubmitBarrier(cmdBuf);
-                    VkFormatProperties formatProperties;
-                    EWE_VK(vkGetPhysicalDeviceFormatProperties, VK::Object->physicalDevice, imageCreateInfo.format, &formatProperties);
-                    assert((formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT) && "texture image format does not support linear blitting");
-
-
-                    //this matches the barrier in generate mips, the only difference, as far as i know, is levelCount == 1 instead of == mipLevels
-                    //i honestly dont know why that isn't producing a bug, but it has been working so i'll leave it
-                    imageBarrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-                    imageBarrier.subresourceRange.baseArrayLayer = 0;
-                    imageBarrier.subresourceRange.layerCount = imageInfo.arrayLayers;
-                    imageBarrier.subresourceRange.levelCount = 1;
-
-                    imageBarrier.subresourceRange.baseMipLevel = 0;
-                    imageBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-                    imageBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-                    //printf("before cmd pipeline barrier \n");
-                    EWE_VK(vkCmdPipelineBarrier, cmdBuf,
-                        VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
-                        0, nullptr,
-                        0, nullptr,
-                        1, &imageBarrier
-                    );
+                graphicsCommand.imageInfo = &imageInfo;
+                ResourceTracker::Transition(imageInfo, shaderReadUsage).RecordAcquire(cmdBuf);
 
-                    imageInfo.descriptorImageInfo.imageLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-
-                    TransferCommand command{};
-                    command.commands.push_back(&cmdBuf);
-                    command.stagingBuffers.push_back(stagingBuffer);
-                    command.images.push_back(&imageInfo);
-                    syncHub->EndSingleTimeCommandTransfer(command);
-                }
-                else {
-                    PipelineBarrier pipeBarrier{};
-                    pipeBarrier.srcStageMask = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
-                    pipeBarrier.dstStageMask = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
-                    imageBarrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-                    pipeBarrier.AddBarrier(imageBarrier);
-                    pipeBarrier.Submit(cmdBuf);
-
-                    TransferCommand command{};
-                    command.commands.push_back(&cmdBuf);
-                    command.stagingBuffers.push_back(stagingBuffer);
-                    command.images.push_back(&imageInfo);
-                    command.pipeBarriers.push_back(std::move(pipeBarrier));
-                    syncHub->EndSingleTimeCommandTransfer(command);
-                }
-                
+                syncHub->EndSingleTimeCommandGraphics(graphicsCommand);
             }
-            
+            //the frame waits on the single time semaphore, this is visible to anything recorded afterwards
+            return UploadToken{};
+        }
+        UploadToken CreateImageCommands(ImageInfo& imageInfo, StagingBuffer* stagingBuffer, std::vector<VkBufferImageCopy>&& regions) {
+            if (!VK::Object->CheckMainThread()) {
+                return UploadQueue::EnqueueImage(stagingBuffer, imageInfo, std::move(regions));
+            }
+
+            SyncHub* syncHub = SyncHub::GetSyncHubInstance();
+            CommandBuffer& cmdBuf = syncHub->BeginSingleTimeCommandGraphics();
+            const ResourceUsage shaderReadUsage{ Queue::graphics, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT };
+            ResourceTracker::Transition(imageInfo, ResourceUsage{ Queue::graphics, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT }, true).RecordAcquire(cmdBuf);
+
+            Image::CopyBufferToImage(cmdBuf, stagingBuffer->buffer, imageInfo.image, regions);
+
+            GraphicsCommand graphicsCommand{};
+            graphicsCommand.command = &cmdBuf;
+            graphicsCommand.stagingBuffer = stagingBuffer;
+            graphicsCommand.imageInfo = &imageInfo;
+            ResourceTracker::Transition(imageInfo, shaderReadUsage).RecordAcquire(cmdBuf);
+            syncHub->EndSingleTimeCommandGraphics(graphicsCommand);
+            return UploadToken{};
         }
+
         VkImageSubresourceRange CreateSubresourceRange(ImageInfo const& imageInfo) {
             VkImageSubresourceRange subresourceRange{};
 
@@ -539,7 +497,72 @@ namespace EWE {
             return stagingBuffer;
         }
 
+#if CPU_MIPMAPS
+        //the chain is filtered on the CPU, every level goes up with the copy. no blits, no TRANSFER_SRC, no graphics queue hop
+        static void CreateMippedTextureImage(ImageInfo& imageInfo, PixelPeek& pixelPeek) {
+            const uint32_t width = static_cast<uint32_t>(pixelPeek.width);
+            const uint32_t height = static_cast<uint32_t>(pixelPeek.height);
+            imageInfo.mipLevels = MipGenerator::LevelCount(width, height);
+
+            std::vector<MipGenerator::Level> levels{};
+            const uint64_t chainSize = MipGenerator::Layout(width, height, imageInfo.mipLevels, levels);
+            //generated in regular memory, it's read back level by level. the staging buffer is only written once
+            std::vector<uint8_t> chain(chainSize);
+            MipGenerator::Generate(reinterpret_cast<const uint8_t*>(pixelPeek.pixels), width, height, imageInfo.mipLevels, chain.data(), MipGenerator::Options{});
+            stbi_image_free(pixelPeek.pixels);
+            StagingBuffer* stagingBuffer = Construct<StagingBuffer>(chainSize, chain.data());
+
+            std::vector<VkBufferImageCopy> regions(levels.size());
+            for (std::size_t i = 0; i < levels.size(); i++) {
+                VkBufferImageCopy& region = regions[i];
+                region.bufferOffset = levels[i].offset;
+                region.bufferRowLength = 0;
+                region.bufferImageHeight = 0;
+                region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+                region.imageSubresource.mipLevel = static_cast<uint32_t>(i);
+                region.imageSubresource.baseArrayLayer = 0;
+                region.imageSubresource.layerCount = 1;
+                region.imageOffset = { 0, 0, 0 };
+                region.imageExtent = { levels[i].width, levels[i].height, 1 };
+            }
+
+            VkImageCreateInfo imageCreateInfo{};
+            imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+            imageCreateInfo.pNext = nullptr;
+            imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
+            imageCreateInfo.extent.width = width;
+            imageCreateInfo.extent.height = height;
+            imageCreateInfo.extent.depth = 1;
+            imageCreateInfo.mipLevels = imageInfo.mipLevels;
+            imageCreateInfo.arrayLayers = 1;
+            imageCreateInfo.format = VK_FORMAT_R8G8B8A8_SRGB;
+            imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+            imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            imageCreateInfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+            imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+            imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+            imageCreateInfo.flags = 0;
+            imageCreateInfo.queueFamilyIndexCount = 0;
+            imageCreateInfo.pQueueFamilyIndices = nullptr;
+
+            Image::CreateImageWithInfo(imageCreateInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, imageInfo.image, imageInfo.memory);
+#if DEBUG_NAMING
+            DebugNaming::SetObjectName(imageInfo.image, VK_OBJECT_TYPE_IMAGE, pixelPeek.debugName.c_str());
+#endif
+#if IMAGE_DEBUGGING
+            imageInfo.imageName = pixelPeek.debugName;
+#endif
+            CreateImageCommands(imageInfo, stagingBuffer, std::move(regions));
+        }
+#endif
+
         void CreateTextureImage(ImageInfo& imageInfo, PixelPeek& pixelPeek, bool mipmapping) {
+#if CPU_MIPMAPS
+            if (MIPMAP_ENABLED && mipmapping && (imageInfo.arrayLayers == 1)) {
+                CreateMippedTextureImage(imageInfo, pixelPeek);
+                return;
+            }
+#endif
 
             StagingBuffer* stagingBuffer = StageImage(pixelPeek);
             //printf("image dimensions : %d:%d \n", width[i], height[i]);
@@ -633,7 +656,135 @@ namespace EWE {
             imageInfo.sampler = Sampler::GetSampler(samplerInfo);
         }
 
+        //false if the file couldn't be parsed or the device can't sample its format, imageInfo is untouched then
+        static bool CreateImageFromKTX2(ImageInfo* imageInfo, std::string const& path) {
+            KTX2::Texture texture{};
+            const KTX2::ParseResult result = KTX2::Load(path, texture);
+            if (result != KTX2::ParseResult::Success) {
+                printf("failed to load ktx2 %s : %s\n", path.c_str(), KTX2::ToString(result));
+                return false;
+            }
+            VkFormatProperties formatProperties;
+            EWE_VK(vkGetPhysicalDeviceFormatProperties, VK::Object->physicalDevice, texture.format, &formatProperties);
+            if ((formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) == 0) {
+                //there's no transcoder
+                printf("ktx2 format %d isn't supported by the device : %s\n", texture.format, path.c_str());
+                return false;
+            }
+
+            if (VK::Object->CheckMainThread()) {
+                imageInfo->descriptorImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            }
+            else {
+                imageInfo->descriptorImageInfo.imageLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            }
+            imageInfo->destinationImageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            imageInfo->width = texture.width;
+            imageInfo->height = texture.height;
+            imageInfo->mipLevels = static_cast<uint8_t>(texture.levels.size());
+            imageInfo->arrayLayers = 1;
+
+            //the whole chain goes up in one staging buffer
+            std::vector<uint64_t> packedOffsets{};
+            const uint64_t stagingSize = KTX2::PackLevels(texture, packedOffsets);
+            StagingBuffer* stagingBuffer = Construct<StagingBuffer>(stagingSize);
+            void* data;
+            stagingBuffer->Map(data);
+            std::vector<VkBufferImageCopy> regions(texture.levels.size());
+            for (std::size_t i = 0; i < texture.levels.size(); i++) {
+                KTX2::Level const& level = texture.levels[i];
+                memcpy(reinterpret_cast<uint8_t*>(data) + packedOffsets[i], texture.data.data() + level.offset, level.size);
+
+                VkBufferImageCopy& region = regions[i];
+                region.bufferOffset = packedOffsets[i];
+                region.bufferRowLength = 0;
+                region.bufferImageHeight = 0;
+                region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+                region.imageSubresource.mipLevel = static_cast<uint32_t>(i);
+                region.imageSubresource.baseArrayLayer = 0;
+                region.imageSubresource.layerCount = 1;
+                region.imageOffset = { 0, 0, 0 };
+                region.imageExtent = { level.width, level.height, 1 };
+            }
+            stagingBuffer->Unmap();
+
+            VkImageCreateInfo imageCreateInfo{};
+            imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+            imageCreateInfo.pNext = nullptr;
+            imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
+            imageCreateInfo.extent.width = texture.width;
+            imageCreateInfo.extent.height = texture.height;
+            imageCreateInfo.extent.depth = 1;
+            imageCreateInfo.mipLevels = imageInfo->mipLevels;
+            imageCreateInfo.arrayLayers = 1;
+            imageCreateInfo.format = texture.format;
+            imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+            imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            imageCreateInfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+            imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+            imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+            imageCreateInfo.flags = 0;
+            imageCreateInfo.queueFamilyIndexCount = 0;
+            imageCreateInfo.pQueueFamilyIndices = nullptr;
+
+            Image::CreateImageWithInfo(imageCreateInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, imageInfo->image, imageInfo->memory);
+#if DEBUG_NAMING
+            DebugNaming::SetObjectName(imageInfo->image, VK_OBJECT_TYPE_IMAGE, path.c_str());
+#endif
+#if IMAGE_DEBUGGING
+            imageInfo->imageName = path;
+#endif
+            CreateImageCommands(*imageInfo, stagingBuffer, std::move(regions));
+
+            VkImageViewCreateInfo viewInfo{};
+            viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+            viewInfo.pNext = nullptr;
+            viewInfo.image = imageInfo->image;
+            viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+            viewInfo.format = texture.format;
+            viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            viewInfo.subresourceRange.baseMipLevel = 0;
+            viewInfo.subresourceRange.levelCount = imageInfo->mipLevels;
+            viewInfo.subresourceRange.baseArrayLayer = 0;
+            viewInfo.subresourceRange.layerCount = 1;
+            EWE_VK(vkCreateImageView, VK::Object->vkDevice, &viewInfo, nullptr, &imageInfo->imageView);
+
+            if (imageInfo->sampler == VK_NULL_HANDLE) {
+                CreateTextureSampler(*imageInfo);
+            }
+            imageInfo->descriptorImageInfo.sampler = imageInfo->sampler;
+            imageInfo->descriptorImageInfo.imageView = imageInfo->imageView;
+            return true;
+        }
+
         void CreateImage(ImageInfo* imageInfo, std::string const& path, bool mipmap) {
+            if (KTX2::IsKTX2Path(path)) {
+                //requested directly, there's no source to fall back on
+                if (!CreateImageFromKTX2(imageInfo, path)) {
+                    throw std::runtime_error("failed to load ktx2");
+                }
+                return;
+            }
+#if TEXTURE_COOKING
+            if (TextureCooker::Enabled()) {
+                const auto loadStart = std::chrono::steady_clock::now();
+                TextureCooker::Options options{};
+                options.mipmap = mipmap;
+                std::string cookedPath;
+                const TextureCooker::Result result = TextureCooker::GetCooked(path, options, cookedPath);
+                if (result != TextureCooker::Result::Failed) {
+                    if (CreateImageFromKTX2(imageInfo, cookedPath)) {
+#if IMAGE_DEBUGGING
+                        imageInfo->imageName = path;
+#endif
+                        TextureCooker::RecordLoad(result, std::chrono::steady_clock::now() - loadStart);
+                        return;
+                    }
+                    //a bad cooked file would fail every load, drop it and use the source this time
+                    TextureCooker::Discard(path, options, cookedPath);
+                }
+            }
+#endif
             PixelPeek pixelPeek{ path };
             return CreateImage(imageInfo, pixelPeek, mipmap);
         }
@@ -661,6 +812,7 @@ namespace EWE {
         void Destroy(ImageInfo& imageInfo) {
             Sampler::RemoveSampler(imageInfo.sampler);
 
+            DescriptorSetCache::Evict(imageInfo.imageView);
             EWE_VK(vkDestroyImageView, VK::Object->vkDevice, imageInfo.imageView, nullptr);
 #if USING_VMA
             vmaDestroyImage(VK::Object->vmaAllocator, imageInfo.image, imageInfo.memory);
@@ -1,5 +1,8 @@
 #include "EWGraphics/Texture/Image_Manager.h"
 #include "EWGraphics/Texture/UI_Texture.h"
+#include "EWGraphics/Texture/BindlessTextures.h"
+#include "EWGraphics/Texture/TextureCooker.h"
+#include "EWGraphics/Texture/MipGenerator.h"
 
 #ifndef TEXTURE_DIR
 #define TEXTURE_DIR "textures/"
@@ -23,70 +26,84 @@ namespace EWE {
 #endif
         //uint32_t tracker = 0;
 
-        for (auto& image : imageTrackerIDMap) {
+        imageTrackerIDMap.ForEach([](ImageID const& imgID, ImageTracker*& tracker) {
             //printf("%d tracking \n", tracker++);
-            Image::Destroy(image.second->imageInfo);
-            Deconstruct(image.second);
+            Image::Destroy(tracker->imageInfo);
+            Deconstruct(tracker);
             //imageTrackerBucket.FreeDataChunk(image.second);
-        }
+        });
+        imageTrackerIDMap.Clear();
+        imageStringToIDMap.Clear();
+        existingMaterialsByID.Clear();
         for (auto& texDSL : simpleTextureLayouts) {
             Deconstruct(texDSL.second);
         }
         simpleTextureLayouts.clear();
 
         //globalPool.reset();
+#if EWE_DEBUG
+        TextureCooker::PrintStats();
+        MipGenerator::PrintStats();
+#endif
 #if DECONSTRUCTION_DEBUG
         printf("end of texture cleanup \n");
 #endif
     }
 
     void Image_Manager::RemoveImage(ImageID imgID) {
-        std::unique_lock<std::mutex> uniq_lock(imgMgrPtr->imageMutex);
+        bool remove = false;
+        std::string path{};
+        //the count is only touched under the shard's exclusive lock
+        [[maybe_unused]] const bool found = imgMgrPtr->imageTrackerIDMap.Modify(imgID, [&](ImageTracker*& tracker) {
 #if EWE_DEBUG
-        assert(imgMgrPtr->imageTrackerIDMap.contains(imgID));
+            assert(tracker->usageCount > 0);
 #endif
-        auto& atRet = imgMgrPtr->imageTrackerIDMap.at(imgID);
+            tracker->usageCount--;
+            remove = (tracker->usageCount == 0) && tracker->zeroUsageDelete;
+            if (remove) {
+                path = tracker->path;
+            }
+        });
 #if EWE_DEBUG
-        assert(atRet->usageCount > 1);
+        assert(found);
 #endif
-        atRet->usageCount--;
-        if (atRet->usageCount == 0 && atRet->zeroUsageDelete) {
-            imgMgrPtr->imageTrackerIDMap.erase(imgID);
-            auto materialFindRet = imgMgrPtr->existingMaterialsByID.find(imgID);
-            if (materialFindRet != imgMgrPtr->existingMaterialsByID.end()) {
-                imgMgrPtr->existingMaterialsByID.erase(imgID);
+        if (remove) {
+            //a path request that already found this ID sees the count at 0 and waits for the erase, then loads it again
+            if (!path.empty()) {
+                imgMgrPtr->imageStringToIDMap.Erase(path);
             }
+            BindlessTextures::Release(imgID);
+            imgMgrPtr->imageTrackerIDMap.Erase(imgID);
+            imgMgrPtr->existingMaterialsByID.Erase(imgID);
         }
     }
 
+    ImageID Image_Manager::AddImageTracker(ImageTracker* imageTracker) {
+        const ImageID ret = imgMgrPtr->currentImageCount.fetch_add(1, std::memory_order_relaxed);
+        imgMgrPtr->imageTrackerIDMap.Insert(ret, imageTracker);
+        return ret;
+    }
+
 
     ImageID Image_Manager::ConstructImageTracker(std::string const& path, bool mipmap, bool zeroUsageDelete) {
         //ImageTracker* imageTracker = reinterpret_cast<ImageTracker*>(imgMgrPtr->imageTrackerBucket.GetDataChunk());
 
         //new(imageTracker) ImageTracker(path, mipmap, zeroUsageDelete);
         ImageTracker* imageTracker = Construct<ImageTracker>( path, mipmap, zeroUsageDelete );
-        std::unique_lock<std::mutex> uniq_lock(imgMgrPtr->imageMutex);
-        imgMgrPtr->imageTrackerIDMap.try_emplace(imgMgrPtr->currentImageCount, imageTracker);
-        return imgMgrPtr->currentImageCount++;
+        return AddImageTracker(imageTracker);
     }
     ImageID Image_Manager::ConstructImageTracker(std::string const& path, VkSampler sampler, bool mipmap, bool zeroUsageDelete) {
         //ImageTracker* imageTracker = reinterpret_cast<ImageTracker*>(imgMgrPtr->imageTrackerBucket.GetDataChunk());
 
         //new(imageTracker) ImageTracker(path, mipmap, zeroUsageDelete);
         ImageTracker* imageTracker = Construct<ImageTracker>( path, sampler, mipmap, zeroUsageDelete );
-
-        std::unique_lock<std::mutex> uniq_lock(imgMgrPtr->imageMutex);
-        imgMgrPtr->imageTrackerIDMap.try_emplace(imgMgrPtr->currentImageCount, imageTracker);
-        return imgMgrPtr->currentImageCount++;
+        return AddImageTracker(imageTracker);
     }
     ImageID Image_Manager::ConstructImageTracker(std::string const& path, ImageInfo& imageInfo, bool zeroUsageDelete) {
         //ImageTracker* imageTracker = reinterpret_cast<ImageTracker*>(imgMgrPtr->imageTrackerBucket.GetDataChunk());
         //new(imageTracker) ImageTracker(imageInfo, zeroUsageDelete);
         ImageTracker* imageTracker = Construct<ImageTracker>( imageInfo, zeroUsageDelete );
-
-        std::unique_lock<std::mutex> uniq_lock(imgMgrPtr->imageMutex);
-        imgMgrPtr->imageTrackerIDMap.try_emplace(imgMgrPtr->currentImageCount, imageTracker);
-        return imgMgrPtr->currentImageCount++;
+        return AddImageTracker(imageTracker);
     }
 
     Image_Manager::ImageReturn Image_Manager::ConstructEmptyImageTracker(bool zeroUsageDelete) {
@@ -94,10 +111,7 @@ namespace EWE {
         //ImageTracker* imageTracker = reinterpret_cast<ImageTracker*>(imgMgrPtr->imageTrackerBucket.GetDataChunk());
         //new(imageTracker) ImageTracker(zeroUsageDelete);
         ImageTracker* imageTracker = Construct<ImageTracker>( zeroUsageDelete );
-
-        std::unique_lock<std::mutex> uniq_lock(imgMgrPtr->imageMutex);
-        const ImageID tempID = imgMgrPtr->currentImageCount++;
-        return ImageReturn{ tempID, imgMgrPtr->imageTrackerIDMap.try_emplace(tempID, imageTracker).first->second };
+        return ImageReturn{ AddImageTracker(imageTracker), imageTracker };
     }
 
 
@@ -132,11 +146,7 @@ namespace EWE {
         arrayImageInfo->descriptorImageInfo.imageView = arrayImageInfo->imageView;
         //arrayImageInfo->descriptorImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 
-        std::unique_lock<std::mutex> uniq_lock(imgMgrPtr->imageMutex);
-        ImageID ret = imgMgrPtr->currentImageCount;
-        imgMgrPtr->imageTrackerIDMap.try_emplace(ret, imageTracker);
-        imgMgrPtr->currentImageCount++;
-        return ret;
+        return AddImageTracker(imageTracker);
         //return arrayImageInfo;
     }
     ImageID Image_Manager::CreateUIImage() {
@@ -270,20 +280,22 @@ namespace EWE {
         arrayImageInfo->descriptorImageInfo.sampler = arrayImageInfo->sampler;
         arrayImageInfo->descriptorImageInfo.imageView = arrayImageInfo->imageView;
 
-        std::unique_lock<std::mutex> uniq_lock(imgMgrPtr->imageMutex);
-        ImageID ret = imgMgrPtr->currentImageCount;
-        imgMgrPtr->imageTrackerIDMap.try_emplace(ret, imageTracker);
-        imgMgrPtr->currentImageCount++;
-        return ret;
+        return AddImageTracker(imageTracker);
     }
 
     ImageID Image_Manager::FindByPath(std::string const& path) {
-        std::unique_lock<std::mutex> uniq_lock(imgMgrPtr->imageMutex);
-        auto foundImage = imgMgrPtr->imageStringToIDMap.find(path);
-        if (foundImage == imgMgrPtr->imageStringToIDMap.end()) {
+        std::shared_future<ImageID> future;
+        if (!imgMgrPtr->imageStringToIDMap.Find(path, future)) {
             return IMAGE_INVALID;
         }
-        return foundImage->second;
+        //if it's still loading, wait for it
+        return future.get();
+    }
+
+    uint32_t Image_Manager::GetBindlessIndex(ImageID imgID) {
+        //the tracker is heap allocated, the pointer stays valid after the lock is dropped
+        VkDescriptorImageInfo* imageInfo = GetDescriptorImageInfo(imgID);
+        return BindlessTextures::Acquire(imgID, imageInfo);
     }
 
     DescriptorSetLayout* Image_Manager::GetSimpleTextureDSL(VkShaderStageFlags stageFlags) {
@@ -332,27 +344,13 @@ namespace EWE {
     }
 
     ImageID Image_Manager::GetCreateImageID(std::string const& imagePath, bool mipmap, bool zeroUsageDelete) {
-        imgMgrPtr->imageMutex.lock();
-        auto findRet = imgMgrPtr->imageStringToIDMap.find(imagePath);
-        if (findRet == imgMgrPtr->imageStringToIDMap.end()) {
-            imgMgrPtr->imageMutex.unlock();
+        return GetOrCreateByPath(imagePath, PathOptions{ VK_NULL_HANDLE, mipmap, zeroUsageDelete }, [&]() {
             return ConstructImageTracker(imagePath, mipmap, zeroUsageDelete);
-        }
-        else {
-            imgMgrPtr->imageMutex.unlock();
-            return findRet->second;
-        }
+        });
     }
     ImageID Image_Manager::GetCreateImageID(std::string const& imagePath, VkSampler sampler, bool mipmap, bool zeroUsageDelete) {
-        imgMgrPtr->imageMutex.lock();
-        auto findRet = imgMgrPtr->imageStringToIDMap.find(imagePath);
-        if (findRet == imgMgrPtr->imageStringToIDMap.end()) {
-            imgMgrPtr->imageMutex.unlock();
+        return GetOrCreateByPath(imagePath, PathOptions{ sampler, mipmap, zeroUsageDelete }, [&]() {
             return ConstructImageTracker(imagePath, sampler, mipmap, zeroUsageDelete);
-        }
-        else {
-            imgMgrPtr->imageMutex.unlock();
-            return findRet->second;
-        }
+        });
     }
 }
\ No newline at end of file
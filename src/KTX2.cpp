@@ -0,0 +1,347 @@
+#include "EWGraphics/Texture/KTX2.h"
+
+#include "EWGraphics/Data/AtomicFile.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include <string_view>
+
+namespace EWE {
+	namespace KTX2 {
+		static constexpr uint8_t identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+		//the fixed part of the header, everything little endian
+		struct Header {
+			uint32_t vkFormat;
+			uint32_t typeSize;
+			uint32_t pixelWidth;
+			uint32_t pixelHeight;
+			uint32_t pixelDepth;
+			uint32_t layerCount;
+			uint32_t faceCount;
+			uint32_t levelCount;
+			uint32_t supercompressionScheme;
+
+			uint32_t dfdByteOffset;
+			uint32_t dfdByteLength;
+			uint32_t kvdByteOffset;
+			uint32_t kvdByteLength;
+			//followed by the supercompression global data offset and length, 2 uint64s. unused without supercompression
+		};
+		static_assert(sizeof(Header) == 52);
+		static constexpr std::size_t sgdIndexSize = 16;
+		struct LevelIndex {
+			uint64_t byteOffset;
+			uint64_t byteLength;
+			uint64_t uncompressedByteLength;
+		};
+		static constexpr std::size_t levelIndexOffset = sizeof(identifier) + sizeof(Header) + sgdIndexSize;
+
+		bool GetFormatBlock(VkFormat format, FormatBlock& block) {
+			switch (format) {
+				case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+				case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+				case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+				case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+				case VK_FORMAT_BC4_UNORM_BLOCK:
+				case VK_FORMAT_BC4_SNORM_BLOCK:
+					block = FormatBlock{ 4, 4, 8 };
+					return true;
+				case VK_FORMAT_BC2_UNORM_BLOCK:
+				case VK_FORMAT_BC2_SRGB_BLOCK:
+				case VK_FORMAT_BC3_UNORM_BLOCK:
+				case VK_FORMAT_BC3_SRGB_BLOCK:
+				case VK_FORMAT_BC5_UNORM_BLOCK:
+				case VK_FORMAT_BC5_SNORM_BLOCK:
+				case VK_FORMAT_BC6H_UFLOAT_BLOCK:
+				case VK_FORMAT_BC6H_SFLOAT_BLOCK:
+				case VK_FORMAT_BC7_UNORM_BLOCK:
+				case VK_FORMAT_BC7_SRGB_BLOCK:
+					block = FormatBlock{ 4, 4, 16 };
+					return true;
+				case VK_FORMAT_R8_UNORM:
+					block = FormatBlock{ 1, 1, 1 };
+					return true;
+				case VK_FORMAT_R8G8_UNORM:
+					block = FormatBlock{ 1, 1, 2 };
+					return true;
+				case VK_FORMAT_R8G8B8A8_UNORM:
+				case VK_FORMAT_R8G8B8A8_SRGB:
+				case VK_FORMAT_B8G8R8A8_UNORM:
+				case VK_FORMAT_B8G8R8A8_SRGB:
+					block = FormatBlock{ 1, 1, 4 };
+					return true;
+				case VK_FORMAT_R16G16B16A16_SFLOAT:
+					block = FormatBlock{ 1, 1, 8 };
+					return true;
+				case VK_FORMAT_R32G32B32A32_SFLOAT:
+					block = FormatBlock{ 1, 1, 16 };
+					return true;
+				default:
+					return false;
+			}
+		}
+		bool IsBlockCompressed(VkFormat format) {
+			FormatBlock block;
+			return GetFormatBlock(format, block) && (block.width > 1);
+		}
+
+		const char* ToString(ParseResult result) {
+			switch (result) {
+				case ParseResult::Success: return "success";
+				case ParseResult::FileError: return "file error";
+				case ParseResult::BadIdentifier: return "not a ktx2 file";
+				case ParseResult::Truncated: return "truncated";
+				case ParseResult::Malformed: return "malformed";
+				case ParseResult::Unsupported: return "unsupported";
+			}
+			return "unknown";
+		}
+
+		ParseResult Parse(std::vector<uint8_t>&& fileData, Texture& out) {
+			if (fileData.size() < levelIndexOffset) {
+				return ParseResult::Truncated;
+			}
+			if (memcmp(fileData.data(), identifier, sizeof(identifier)) != 0) {
+				return ParseResult::BadIdentifier;
+			}
+			Header header;
+			memcpy(&header, fileData.data() + sizeof(identifier), sizeof(Header));
+
+			//transcoding isn't available, only data the GPU can take directly
+			if ((header.supercompressionScheme != 0) || (header.vkFormat == VK_FORMAT_UNDEFINED)) {
+				return ParseResult::Unsupported;
+			}
+			if ((header.pixelDepth > 1) || (header.layerCount > 1) || (header.faceCount != 1)) {
+				return ParseResult::Unsupported;
+			}
+			FormatBlock block;
+			if (!GetFormatBlock(static_cast<VkFormat>(header.vkFormat), block)) {
+				return ParseResult::Unsupported;
+			}
+			if ((header.pixelWidth == 0) || (header.pixelHeight == 0)) {
+				return ParseResult::Malformed;
+			}
+			//0 means the loader is expected to generate them, there's still one level stored
+			const uint32_t levelCount = header.levelCount == 0 ? 1 : header.levelCount;
+			if (levelCount > 32) {
+				return ParseResult::Malformed;
+			}
+			if (fileData.size() < levelIndexOffset + sizeof(LevelIndex) * levelCount) {
+				return ParseResult::Truncated;
+			}
+
+			out.format = static_cast<VkFormat>(header.vkFormat);
+			out.width = header.pixelWidth;
+			out.height = header.pixelHeight;
+			out.levels.clear();
+			out.levels.reserve(levelCount);
+			for (uint32_t i = 0; i < levelCount; i++) {
+				LevelIndex levelIndex;
+				memcpy(&levelIndex, fileData.data() + levelIndexOffset + sizeof(LevelIndex) * i, sizeof(LevelIndex));
+
+				const uint32_t levelWidth = std::max(header.pixelWidth >> i, 1u);
+				const uint32_t levelHeight = std::max(header.pixelHeight >> i, 1u);
+				if ((levelWidth == 1) && (levelHeight == 1) && (i + 1 < levelCount)) {
+					//more levels than the size allows
+					return ParseResult::Malformed;
+				}
+				const uint64_t blocksX = (levelWidth + block.width - 1) / block.width;
+				const uint64_t blocksY = (levelHeight + block.height - 1) / block.height;
+				const uint64_t expectedSize = blocksX * blocksY * block.bytes;
+				if (levelIndex.byteLength != expectedSize) {
+					return ParseResult::Malformed;
+				}
+				if ((levelIndex.byteOffset > fileData.size()) || (levelIndex.byteLength > fileData.size() - levelIndex.byteOffset)) {
+					return ParseResult::Truncated;
+				}
+				out.levels.push_back(Level{ levelIndex.byteOffset, levelIndex.byteLength, levelWidth, levelHeight });
+			}
+			out.data = std::move(fileData);
+			return ParseResult::Success;
+		}
+
+		ParseResult Load(std::string const& path, Texture& out) {
+			std::ifstream file{ path, std::ios::binary | std::ios::ate };
+			if (!file.is_open()) {
+				return ParseResult::FileError;
+			}
+			const std::streamsize size = file.tellg();
+			if (size <= 0) {
+				return ParseResult::FileError;
+			}
+			std::vector<uint8_t> fileData(static_cast<std::size_t>(size));
+			file.seekg(0);
+			if (!file.read(reinterpret_cast<char*>(fileData.data()), size)) {
+				return ParseResult::FileError;
+			}
+			return Parse(std::move(fileData), out);
+		}
+
+		bool IsKTX2Path(std::string const& path) {
+			static constexpr std::string_view extension{ ".ktx2" };
+			return (path.size() >= extension.size()) && (path.compare(path.size() - extension.size(), extension.size(), extension) == 0);
+		}
+
+		uint64_t PackLevels(Texture const& texture, std::vector<uint64_t>& packedOffsets) {
+			packedOffsets.clear();
+			packedOffsets.reserve(texture.levels.size());
+			uint64_t offset = 0;
+			for (auto const& level : texture.levels) {
+				offset = (offset + LEVEL_ALIGNMENT - 1) & ~(LEVEL_ALIGNMENT - 1);
+				packedOffsets.push_back(offset);
+				offset += level.size;
+			}
+			return offset;
+		}
+
+		//khronos data format descriptor, only the basic block
+		namespace DFD {
+			static constexpr uint8_t MODEL_RGBSDA = 1;
+			static constexpr uint8_t MODEL_BC1A = 128;
+			static constexpr uint8_t MODEL_BC3 = 130;
+			static constexpr uint8_t MODEL_BC4 = 131;
+			static constexpr uint8_t MODEL_BC5 = 132;
+			static constexpr uint8_t PRIMARIES_BT709 = 1;
+			static constexpr uint8_t TRANSFER_LINEAR = 1;
+			static constexpr uint8_t TRANSFER_SRGB = 2;
+			//channel type qualifier, alpha stays linear in an srgb format
+			static constexpr uint8_t QUALIFIER_LINEAR = 0x10;
+			static constexpr uint8_t CHANNEL_ALPHA = 15;
+
+			struct Sample {
+				uint8_t channelType;
+				uint16_t bitOffset;
+				uint8_t bitLength;
+			};
+		} //namespace DFD
+
+		static bool BuildDataFormatDescriptor(VkFormat format, std::vector<uint32_t>& words) {
+			FormatBlock block;
+			if (!GetFormatBlock(format, block)) {
+				return false;
+			}
+			uint8_t model;
+			bool srgb = false;
+			std::vector<DFD::Sample> samples{};
+			switch (format) {
+				case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+					srgb = true;
+					[[fallthrough]];
+				case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+					model = DFD::MODEL_BC1A;
+					samples.push_back({ 0, 0, 64 });
+					break;
+				case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+					srgb = true;
+					[[fallthrough]];
+				case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+					//BC1A's alpha present channel
+					model = DFD::MODEL_BC1A;
+					samples.push_back({ 1, 0, 64 });
+					break;
+				case VK_FORMAT_BC3_SRGB_BLOCK:
+					srgb = true;
+					[[fallthrough]];
+				case VK_FORMAT_BC3_UNORM_BLOCK:
+					model = DFD::MODEL_BC3;
+					samples.push_back({ DFD::CHANNEL_ALPHA | DFD::QUALIFIER_LINEAR, 0, 64 });
+					samples.push_back({ 0, 64, 64 });
+					break;
+				case VK_FORMAT_BC4_UNORM_BLOCK:
+					model = DFD::MODEL_BC4;
+					samples.push_back({ 0, 0, 64 });
+					break;
+				case VK_FORMAT_BC5_UNORM_BLOCK:
+					model = DFD::MODEL_BC5;
+					samples.push_back({ 0, 0, 64 });
+					samples.push_back({ 1, 64, 64 });
+					break;
+				case VK_FORMAT_R8G8B8A8_SRGB:
+					srgb = true;
+					[[fallthrough]];
+				case VK_FORMAT_R8G8B8A8_UNORM:
+					model = DFD::MODEL_RGBSDA;
+					samples.push_back({ 0, 0, 8 });
+					samples.push_back({ 1, 8, 8 });
+					samples.push_back({ 2, 16, 8 });
+					samples.push_back({ DFD::CHANNEL_ALPHA | DFD::QUALIFIER_LINEAR, 24, 8 });
+					break;
+				default:
+					return false;
+			}
+			const uint32_t blockSize = 24 + 16 * static_cast<uint32_t>(samples.size());
+
+			words.clear();
+			words.push_back(4 + blockSize); //dfdTotalSize
+			words.push_back(0); //khronos vendor, basic descriptor type
+			words.push_back(2 | (blockSize << 16)); //version 1.3
+			words.push_back(model | (DFD::PRIMARIES_BT709 << 8) | ((srgb ? DFD::TRANSFER_SRGB : DFD::TRANSFER_LINEAR) << 16));
+			words.push_back((block.width - 1) | ((block.height - 1) << 8));
+			words.push_back(block.bytes);
+			words.push_back(0);
+			const bool compressed = block.width > 1;
+			for (auto const& sample : samples) {
+				words.push_back(sample.bitOffset | ((sample.bitLength - 1u) << 16) | (static_cast<uint32_t>(sample.channelType) << 24));
+				words.push_back(0); //sample position
+				words.push_back(0); //lower
+				words.push_back(compressed ? UINT32_MAX : ((1u << sample.bitLength) - 1));
+			}
+			return true;
+		}
+
+		bool Write(std::string const& path, VkFormat format, uint32_t width, uint32_t height, std::vector<std::vector<uint8_t>> const& levels) {
+			if (levels.empty() || (levels.size() > 32) || (width == 0) || (height == 0)) {
+				return false;
+			}
+			std::vector<uint32_t> dfd{};
+			if (!BuildDataFormatDescriptor(format, dfd)) {
+				return false;
+			}
+			FormatBlock block;
+			GetFormatBlock(format, block);
+
+			Header header{};
+			header.vkFormat = static_cast<uint32_t>(format);
+			header.typeSize = 1;
+			header.pixelWidth = width;
+			header.pixelHeight = height;
+			header.pixelDepth = 0;
+			header.layerCount = 0;
+			header.faceCount = 1;
+			header.levelCount = static_cast<uint32_t>(levels.size());
+			header.supercompressionScheme = 0;
+			header.dfdByteOffset = static_cast<uint32_t>(levelIndexOffset + sizeof(LevelIndex) * levels.size());
+			header.dfdByteLength = static_cast<uint32_t>(dfd.size() * sizeof(uint32_t));
+			header.kvdByteOffset = 0;
+			header.kvdByteLength = 0;
+
+			//the spec stores the smallest level first, each aligned to lcm(block size, 4)
+			const uint64_t alignment = std::lcm<uint64_t>(block.bytes, 4);
+			std::vector<LevelIndex> levelIndices(levels.size());
+			uint64_t offset = header.dfdByteOffset + header.dfdByteLength;
+			for (std::size_t i = levels.size(); i > 0; i--) {
+				const std::size_t level = i - 1;
+				offset = (offset + alignment - 1) / alignment * alignment;
+				levelIndices[level].byteOffset = offset;
+				levelIndices[level].byteLength = levels[level].size();
+				levelIndices[level].uncompressedByteLength = levels[level].size();
+				offset += levels[level].size();
+			}
+
+			std::vector<uint8_t> fileData(offset, 0);
+			memcpy(fileData.data(), identifier, sizeof(identifier));
+			memcpy(fileData.data() + sizeof(identifier), &header, sizeof(Header));
+			//the supercompression global data index stays zeroed
+			memcpy(fileData.data() + levelIndexOffset, levelIndices.data(), sizeof(LevelIndex) * levelIndices.size());
+			memcpy(fileData.data() + header.dfdByteOffset, dfd.data(), header.dfdByteLength);
+			for (std::size_t i = 0; i < levels.size(); i++) {
+				memcpy(fileData.data() + levelIndices[i].byteOffset, levels[i].data(), levels[i].size());
+			}
+
+			return AtomicWriteFile(path, { { fileData.data(), fileData.size() } });
+		}
+	} //namespace KTX2
+} //namespace EWE
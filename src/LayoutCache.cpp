@@ -0,0 +1,214 @@
+#include "EWGraphics/Vulkan/LayoutCache.h"
+
+#include "EWGraphics/Data/EWE_Utils.h"
+
+#include <mutex>
+#include <unordered_map>
+
+namespace EWE {
+	namespace LayoutCache {
+		struct DSLEntry {
+			DescriptorSetLayout* dsl;
+			uint32_t refCount;
+		};
+		struct PipeLayoutEntry {
+			std::vector<VkDescriptorSetLayout> setLayouts;
+			std::vector<VkPushConstantRange> pushRanges;
+			VkPipelineLayout vkLayout;
+			uint32_t refCount;
+		};
+
+		static std::mutex mutex{};
+		//the hash only narrows it down, the contents are compared in full
+		static std::unordered_multimap<std::size_t, DSLEntry> dslMap{};
+		static std::unordered_multimap<std::size_t, PipeLayoutEntry> pipeLayoutMap{};
+		static std::unordered_map<VkPipelineLayout, std::size_t> pipeLayoutHashes{};
+
+		static uint32_t dslHits{ 0 };
+		static uint32_t dslMisses{ 0 };
+		static uint32_t pipeLayoutHits{ 0 };
+		static uint32_t pipeLayoutMisses{ 0 };
+
+		static VkDescriptorBindingFlags FlagsAt(std::vector<VkDescriptorBindingFlags> const& bindingFlags, std::size_t index) {
+			return bindingFlags.size() > 0 ? bindingFlags[index] : 0;
+		}
+
+		std::size_t HashDSL(std::vector<VkDescriptorSetLayoutBinding> const& bindings, std::vector<VkDescriptorBindingFlags> const& bindingFlags) {
+			std::size_t seed = bindings.size();
+			for (std::size_t i = 0; i < bindings.size(); i++) {
+				auto const& binding = bindings[i];
+				HashCombine(seed, binding.binding, binding.descriptorType, binding.descriptorCount, binding.stageFlags, binding.pImmutableSamplers, FlagsAt(bindingFlags, i));
+			}
+			return seed;
+		}
+		bool SameDSL(std::vector<VkDescriptorSetLayoutBinding> const& bindingsA, std::vector<VkDescriptorBindingFlags> const& bindingFlagsA,
+			std::vector<VkDescriptorSetLayoutBinding> const& bindingsB, std::vector<VkDescriptorBindingFlags> const& bindingFlagsB
+		) {
+			if (bindingsA.size() != bindingsB.size()) {
+				return false;
+			}
+			for (std::size_t i = 0; i < bindingsA.size(); i++) {
+				auto const& a = bindingsA[i];
+				auto const& b = bindingsB[i];
+				if ((a.binding != b.binding) || (a.descriptorType != b.descriptorType) || (a.descriptorCount != b.descriptorCount)
+					|| (a.stageFlags != b.stageFlags) || (a.pImmutableSamplers != b.pImmutableSamplers)
+					|| (FlagsAt(bindingFlagsA, i) != FlagsAt(bindingFlagsB, i))
+					) {
+					return false;
+				}
+			}
+			return true;
+		}
+		static bool MatchesDSL(DescriptorSetLayout const& dsl, std::vector<VkDescriptorSetLayoutBinding> const& bindings, std::vector<VkDescriptorBindingFlags> const& bindingFlags) {
+			return !dsl.bindless && SameDSL(dsl.bindings, dsl.bindingFlags, bindings, bindingFlags);
+		}
+
+		std::size_t HashPipeLayout(std::vector<VkDescriptorSetLayout> const& setLayouts, std::vector<VkPushConstantRange> const& pushRanges) {
+			std::size_t seed = setLayouts.size();
+			for (auto const& setLayout : setLayouts) {
+				HashCombine(seed, setLayout);
+			}
+			for (auto const& range : pushRanges) {
+				HashCombine(seed, range.stageFlags, range.offset, range.size);
+			}
+			return seed;
+		}
+		bool SamePipeLayout(std::vector<VkDescriptorSetLayout> const& setLayoutsA, std::vector<VkPushConstantRange> const& pushRangesA,
+			std::vector<VkDescriptorSetLayout> const& setLayoutsB, std::vector<VkPushConstantRange> const& pushRangesB
+		) {
+			if ((setLayoutsA != setLayoutsB) || (pushRangesA.size() != pushRangesB.size())) {
+				return false;
+			}
+			for (std::size_t i = 0; i < pushRangesA.size(); i++) {
+				auto const& a = pushRangesA[i];
+				auto const& b = pushRangesB[i];
+				if ((a.stageFlags != b.stageFlags) || (a.offset != b.offset) || (a.size != b.size)) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		DescriptorSetLayout* AcquireDSL(std::vector<VkDescriptorSetLayoutBinding> const& bindings, std::vector<VkDescriptorBindingFlags> const& bindingFlags) {
+			assert((bindingFlags.size() == 0) || (bindingFlags.size() == bindings.size()));
+			const std::size_t hash = HashDSL(bindings, bindingFlags);
+
+			std::unique_lock<std::mutex> lock{ mutex };
+			auto range = dslMap.equal_range(hash);
+			for (auto iter = range.first; iter != range.second; iter++) {
+				if (MatchesDSL(*iter->second.dsl, bindings, bindingFlags)) {
+					iter->second.refCount++;
+					dslHits++;
+					return iter->second.dsl;
+				}
+			}
+			dslMisses++;
+			DescriptorSetLayout* dsl = bindingFlags.size() > 0 ? Construct<DescriptorSetLayout>(bindings, bindingFlags) : Construct<DescriptorSetLayout>(bindings);
+			dsl->BuildVkDSL();
+			dslMap.emplace(hash, DSLEntry{ dsl, 1 });
+			return dsl;
+		}
+
+		void ReleaseDSL(DescriptorSetLayout* dsl) {
+			const std::size_t hash = HashDSL(dsl->bindings, dsl->bindingFlags);
+
+			std::unique_lock<std::mutex> lock{ mutex };
+			auto range = dslMap.equal_range(hash);
+			for (auto iter = range.first; iter != range.second; iter++) {
+				if (iter->second.dsl == dsl) {
+					assert(iter->second.refCount > 0);
+					iter->second.refCount--;
+					if (iter->second.refCount == 0) {
+						Deconstruct(dsl);
+						dslMap.erase(iter);
+					}
+					return;
+				}
+			}
+			assert(false && "releasing a descriptor set layout that wasn't acquired from the cache");
+		}
+
+		VkPipelineLayout AcquirePipelineLayout(std::vector<VkDescriptorSetLayout> const& setLayouts, std::vector<VkPushConstantRange> const& pushRanges) {
+			const std::size_t hash = HashPipeLayout(setLayouts, pushRanges);
+
+			std::unique_lock<std::mutex> lock{ mutex };
+			auto range = pipeLayoutMap.equal_range(hash);
+			for (auto iter = range.first; iter != range.second; iter++) {
+				if (SamePipeLayout(iter->second.setLayouts, iter->second.pushRanges, setLayouts, pushRanges)) {
+					iter->second.refCount++;
+					pipeLayoutHits++;
+					return iter->second.vkLayout;
+				}
+			}
+			pipeLayoutMisses++;
+
+			VkPipelineLayoutCreateInfo plCreateInfo{};
+			plCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+			plCreateInfo.pNext = nullptr;
+			plCreateInfo.flags = 0;
+			plCreateInfo.pushConstantRangeCount = static_cast<uint32_t>(pushRanges.size());
+			plCreateInfo.pPushConstantRanges = pushRanges.data();
+			plCreateInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
+			plCreateInfo.pSetLayouts = setLayouts.data();
+
+			VkPipelineLayout vkLayout;
+			EWE_VK(vkCreatePipelineLayout, VK::Object->vkDevice, &plCreateInfo, nullptr, &vkLayout);
+			pipeLayoutMap.emplace(hash, PipeLayoutEntry{ setLayouts, pushRanges, vkLayout, 1 });
+			pipeLayoutHashes.emplace(vkLayout, hash);
+			return vkLayout;
+		}
+
+		void RetainPipelineLayout(VkPipelineLayout pipeLayout) {
+			std::unique_lock<std::mutex> lock{ mutex };
+			auto hashIter = pipeLayoutHashes.find(pipeLayout);
+			assert(hashIter != pipeLayoutHashes.end() && "retaining a pipeline layout that wasn't acquired from the cache");
+			auto range = pipeLayoutMap.equal_range(hashIter->second);
+			for (auto iter = range.first; iter != range.second; iter++) {
+				if (iter->second.vkLayout == pipeLayout) {
+					iter->second.refCount++;
+					return;
+				}
+			}
+			EWE_UNREACHABLE;
+		}
+
+		void ReleasePipelineLayout(VkPipelineLayout pipeLayout) {
+			std::unique_lock<std::mutex> lock{ mutex };
+			auto hashIter = pipeLayoutHashes.find(pipeLayout);
+			assert(hashIter != pipeLayoutHashes.end() && "releasing a pipeline layout that wasn't acquired from the cache");
+			auto range = pipeLayoutMap.equal_range(hashIter->second);
+			for (auto iter = range.first; iter != range.second; iter++) {
+				if (iter->second.vkLayout == pipeLayout) {
+					assert(iter->second.refCount > 0);
+					iter->second.refCount--;
+					if (iter->second.refCount == 0) {
+						EWE_VK(vkDestroyPipelineLayout, VK::Object->vkDevice, pipeLayout, nullptr);
+						pipeLayoutMap.erase(iter);
+						pipeLayoutHashes.erase(hashIter);
+					}
+					return;
+				}
+			}
+			EWE_UNREACHABLE;
+		}
+
+		Stats GetStats() {
+			std::unique_lock<std::mutex> lock{ mutex };
+			Stats ret{};
+			ret.dslHits = dslHits;
+			ret.dslMisses = dslMisses;
+			ret.dslLive = static_cast<uint32_t>(dslMap.size());
+			ret.pipeLayoutHits = pipeLayoutHits;
+			ret.pipeLayoutMisses = pipeLayoutMisses;
+			ret.pipeLayoutLive = static_cast<uint32_t>(pipeLayoutMap.size());
+			return ret;
+		}
+		void PrintStats() {
+			const Stats stats = GetStats();
+			printf("layout cache - descriptor set layouts hits:unique:live - %u:%u:%u, pipeline layouts hits:unique:live - %u:%u:%u\n",
+				stats.dslHits, stats.dslMisses, stats.dslLive,
+				stats.pipeLayoutHits, stats.pipeLayoutMisses, stats.pipeLayoutLive
+			);
+		}
+	} //namespace LayoutCache
+} //namespace EWE
@@ -1,6 +1,10 @@
 #include "EWGraphics/Texture/Material_Textures.h"
+#include "EWGraphics/Data/ThreadPool.h"
 
 #include <filesystem>
+#include <atomic>
+#include <memory>
+#include <unordered_set>
 
 #ifndef TEXTURE_DIR
 #define TEXTURE_DIR "textures/"
@@ -9,23 +13,71 @@
 
 namespace EWE {
 
-    MaterialInfo Material_Image::CreateMaterialImage(std::string texPath, bool mipmapping, bool global) {
+    //one scan per directory, the filename probes are set lookups after that
+    //shared so a clear doesn't pull an index out from under a load that's using it
+    static std::mutex directoryIndexMutex{};
+    static std::unordered_map<std::string, std::shared_ptr<const std::unordered_set<std::string>>> directoryIndex{};
 
-        auto imPtr = Image_Manager::GetImageManagerPtr();
+    static std::shared_ptr<const std::unordered_set<std::string>> GetDirectoryIndex(std::filesystem::path const& directory) {
+        const std::string key = directory.generic_string();
         {
-            ImageID imgID = imPtr->FindByPath(texPath);
-            if (imgID != IMAGE_INVALID) {
-                std::unique_lock<std::mutex> imgLock(imPtr->imageMutex);
-                auto findRet = imPtr->existingMaterialsByID.find(imgID);
-                if (findRet != imPtr->existingMaterialsByID.end()) {
-                    return findRet->second;
-                }
+            std::unique_lock<std::mutex> lock{ directoryIndexMutex };
+            auto findRet = directoryIndex.find(key);
+            if (findRet != directoryIndex.end()) {
+                return findRet->second;
+            }
+        }
+        //scanned outside the lock, two threads scanning the same directory at once is only wasted work
+        auto files = std::make_shared<std::unordered_set<std::string>>();
+        std::error_code errorCode{};
+        for (auto const& entry : std::filesystem::directory_iterator(directory, errorCode)) {
+            if (entry.is_regular_file(errorCode)) {
+                files->insert(entry.path().filename().string());
+            }
+        }
 #if EWE_DEBUG
-                printf("image manager contains texPath, but it's not a material?\n");
+        if (errorCode) {
+            printf("failed to scan texture directory %s : %s\n", key.c_str(), errorCode.message().c_str());
+        }
 #endif
+        std::unique_lock<std::mutex> lock{ directoryIndexMutex };
+        return directoryIndex.try_emplace(key, std::move(files)).first->second;
+    }
+
+    void Material_Image::ClearDirectoryIndex() {
+        std::unique_lock<std::mutex> lock{ directoryIndexMutex };
+        directoryIndex.clear();
+    }
+
+    //the maps of one material, decoded by whichever threads get to them first
+    //the calling thread decodes too, so a load from inside the thread pool can't deadlock waiting on it
+    struct MaterialDecode {
+        std::vector<std::string> paths;
+        std::vector<PixelPeek> pixelPeeks;
+        std::atomic<uint32_t> next{ 0 };
+        std::atomic<uint32_t> remaining;
+
+        MaterialDecode(std::vector<std::string>&& paths) : paths{ std::move(paths) }, pixelPeeks(this->paths.size()), remaining{ static_cast<uint32_t>(this->paths.size()) } {}
+
+        void Run() {
+            const uint32_t count = static_cast<uint32_t>(paths.size());
+            for (uint32_t i = next.fetch_add(1, std::memory_order_relaxed); i < count; i = next.fetch_add(1, std::memory_order_relaxed)) {
+                pixelPeeks[i] = PixelPeek{ paths[i] };
+                if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    remaining.notify_all();
+                }
             }
         }
+        void Wait() {
+            uint32_t current = remaining.load(std::memory_order_acquire);
+            while (current != 0) {
+                remaining.wait(current, std::memory_order_acquire);
+                current = remaining.load(std::memory_order_acquire);
+            }
+        }
+    };
 
+    Material_Image::MaterialMaps Material_Image::FindMaps(std::string const& texPath) {
         const std::array<std::vector<std::string>, Material::Attributes::Texture::SIZE> matImgTypes = {
 
             //its important that this lines up with Material::Attributes::Texture
@@ -36,68 +88,88 @@ namespace EWE {
             std::vector<std::string>{"Normal", "normal" },
             std::vector<std::string>{"ao", "ambientOcclusion", "AO", "AmbientOcclusion", "Ao"},
         };
-        std::vector<std::string> matPaths{};
-        std::array<bool, Material::Attributes::Texture::SIZE> foundTypes{false};
-
-        for (int i = 0; i < matImgTypes.size(); i++) {
-            //foundTypes[i] = true;
-            for (int j = 0; j < matImgTypes[i].size(); j++) {
-                auto& empRet = matPaths.emplace_back(TEXTURE_DIR);
-                empRet += texPath + matImgTypes[i][j];
-
-                //printf("smart material path : %s \n", matPaths.back().c_str());
+        const std::array<std::string, 3> extensions{ ".png", ".jpg", ".tga" };
+        MaterialMaps ret{};
 
-                if (std::filesystem::exists(matPaths.back() + ".png")) {
-                    empRet += ".png";
-                    //pixelPeek.emplace_back(materialPath);
-                    foundTypes[i] = true;
+        //texPath is a filename prefix, possibly with directories in front of it
+        const std::filesystem::path basePath{ TEXTURE_DIR + texPath };
+        const std::string prefix = basePath.filename().string();
+        const auto files = GetDirectoryIndex(basePath.parent_path());
 
-                    break;
-
-                }
-                else if (std::filesystem::exists(matPaths.back() + ".jpg")) {
-                    empRet += ".jpg";
-                    //pixelPeek.emplace_back(materialPath);
-                    foundTypes[i] = true;
-                    break;
-                }
-                else if (std::filesystem::exists(matPaths.back() + ".tga")) {
-                    empRet += ".tga";
-                    //pixelPeek.emplace_back(materialPaths.back());
-                    foundTypes[i] = true;
-                    break;
+        for (int i = 0; i < matImgTypes.size(); i++) {
+            //the flag bit is the attribute index
+            const MaterialFlags typeFlag = static_cast<MaterialFlags>(1 << i);
+            for (int j = 0; (j < matImgTypes[i].size()) && !(ret.flags & typeFlag); j++) {
+                for (auto const& extension : extensions) {
+                    if (files->contains(prefix + matImgTypes[i][j] + extension)) {
+                        //printf("smart material path : %s \n", ret.paths.back().c_str());
+                        ret.paths.push_back(TEXTURE_DIR + texPath + matImgTypes[i][j] + extension);
+                        ret.flags |= typeFlag;
+                        break;
+                    }
                 }
-                matPaths.pop_back();
             }
         }
+        return ret;
+    }
 
-        std::vector<PixelPeek> pixelPeeks{};
-        for (int i = 0; i < matPaths.size(); i++) {
-            pixelPeeks.emplace_back(matPaths[i]);
+    std::vector<PixelPeek> Material_Image::DecodeMaps(std::vector<std::string>&& paths) {
+        auto decode = std::make_shared<MaterialDecode>(std::move(paths));
+        std::size_t helperCount = 0;
+        if (decode->paths.size() > 1) {
+            helperCount = std::min<std::size_t>(ThreadPool::GetThreadCount(), decode->paths.size() - 1);
         }
+        for (std::size_t i = 0; i < helperCount; i++) {
+            ThreadPool::EnqueueVoid([decode]() { decode->Run(); });
+        }
+        decode->Run();
+        decode->Wait();
+        //a helper that gets scheduled after the work ran out only touches the counters
+        return std::move(decode->pixelPeeks);
+    }
 
-        const ImageID imgID = imPtr->CreateImageArray(pixelPeeks, mipmapping);
+    static MaterialInfo CreateMaterialArray(std::string const& texPath, bool mipmapping) {
+        Material_Image::MaterialMaps maps = Material_Image::FindMaps(texPath);
+        const MaterialFlags flags = maps.flags;
+
+        //decode every map at once, then they go up together as the layers of one array image, one staging buffer and one submit
+        std::vector<PixelPeek> pixelPeeks = Material_Image::DecodeMaps(std::move(maps.paths));
+        const ImageID imgID = Image_Manager::CreateImageArray(pixelPeeks, mipmapping);
 
-        //flags = normal, metal, rough, ao
-        const MaterialFlags flags = (foundTypes[Material::Attributes::Texture::Albedo] * Material::Flags::Texture::Albedo) + (foundTypes[Material::Attributes::Texture::Bump] * Material::Flags::Texture::Bump) + (foundTypes[Material::Attributes::Texture::Metal] * Material::Flags::Texture::Metal) + (foundTypes[Material::Attributes::Texture::Rough] * Material::Flags::Texture::Rough) + (foundTypes[Material::Attributes::Texture::AO] * Material::Flags::Texture::AO) + ((foundTypes[Material::Attributes::Texture::Normal] * Material::Flags::Texture::Normal));
         //printf("flag values : %d \n", flags);
         assert(flags != 0 && "found zero images in material texture, needs at least one");
 
 #if EWE_DEBUG
-        if (!foundTypes[Material::Attributes::Texture::Albedo]) {
+        if (!(flags & Material::Flags::Texture::Albedo)) {
             printf("did not find an albedo or diffuse texture for this MRO set : %s \n", texPath.c_str());
             assert(false);
         }
-        if (foundTypes[Material::Attributes::Texture::Bump]) {
+        if (flags & Material::Flags::Texture::Bump) {
             printf("found a height map \n");
         }
 #endif
-        std::unique_lock<std::mutex> imgLock(imPtr->imageMutex);
-        imPtr->imageStringToIDMap.try_emplace(texPath, imgID);
-        imPtr->existingMaterialsByID.try_emplace(imgID, flags, imgID);
-        //existingMaterialIDs[texPath] = std::pair<MaterialFlags, int32_t>{ flags, returnID };
-
         //printf("returning from smart creation \n");
         return { flags, imgID };
     }
+
+    MaterialInfo Material_Image::CreateMaterialImage(std::string texPath, bool mipmapping, bool global) {
+
+        auto imPtr = Image_Manager::GetImageManagerPtr();
+        //concurrent requests for the same material wait on one load
+        const ImageID imgID = Image_Manager::GetOrCreateByPath(texPath, PathOptions{ VK_NULL_HANDLE, mipmapping, false }, [&]() {
+            const MaterialInfo created = CreateMaterialArray(texPath, mipmapping);
+            imPtr->existingMaterialsByID.Insert(created.imageID, created);
+            return created.imageID;
+        });
+        MaterialInfo ret{};
+        if (imPtr->existingMaterialsByID.Find(imgID, ret)) {
+            return ret;
+        }
+#if EWE_DEBUG
+        printf("image manager contains texPath, but it's not a material?\n");
+#endif
+        ret = CreateMaterialArray(texPath, mipmapping);
+        imPtr->existingMaterialsByID.Insert(ret.imageID, ret);
+        return ret;
+    }
 }
\ No newline at end of file
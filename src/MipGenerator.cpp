@@ -0,0 +1,415 @@
+#include "EWGraphics/Texture/MipGenerator.h"
+
+#include "EWGraphics/Data/ThreadPool.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define MIP_SSE true
+#include <immintrin.h>
+#else
+#define MIP_SSE false
+#endif
+#if MIP_SSE && defined(__AVX2__)
+#define MIP_AVX2 true
+#else
+#define MIP_AVX2 false
+#endif
+
+namespace EWE {
+	namespace MipGenerator {
+		//levels with fewer texels than this are filtered on the calling thread alone
+		static constexpr uint64_t parallelTexelThreshold = 128 * 128;
+		static constexpr uint32_t minBandRows = 8;
+		//the horizontal taps reach this far left of the first texel
+		static constexpr int32_t rowPadding = 3;
+
+		static std::atomic<uint32_t> chainCount{ 0 };
+		static std::atomic<uint64_t> texelsGenerated{ 0 };
+		static std::atomic<uint64_t> totalNS{ 0 };
+
+		struct Tables {
+			//[0, 256) srgb to linear, [256, 512) unorm to float. alpha and non srgb channels read the second half
+			alignas(32) std::array<float, 512> toFloat;
+			//linear quantized to 12 bits
+			std::array<uint8_t, 4096> linearToSRGB;
+
+			Tables() {
+				for (uint32_t i = 0; i < 256; i++) {
+					const float value = static_cast<float>(i) / 255.f;
+					toFloat[i] = value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+					toFloat[i + 256] = value;
+				}
+				for (uint32_t i = 0; i < 4096; i++) {
+					const float value = static_cast<float>(i) / 4095.f;
+					const float encoded = value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.f / 2.4f) - 0.055f;
+					linearToSRGB[i] = static_cast<uint8_t>(std::clamp(encoded * 255.f + 0.5f, 0.f, 255.f));
+				}
+			}
+		};
+		static Tables const& GetTables() {
+			static const Tables tables{};
+			return tables;
+		}
+
+		//output texel x reads source texels [2x + first, 2x + first + taps)
+		struct Kernel {
+			int32_t first;
+			uint32_t taps;
+			float weights[8];
+		};
+		static double BesselI0(double x) {
+			double sum = 1.0;
+			double term = 1.0;
+			for (uint32_t k = 1; k < 32; k++) {
+				term *= (x / (2.0 * k)) * (x / (2.0 * k));
+				sum += term;
+			}
+			return sum;
+		}
+		static Kernel const& GetKernel(Filter filter) {
+			static const Kernel box{ 0, 2, { 0.5f, 0.5f } };
+			static const Kernel kaiser = [] {
+				//sinc at half the source frequency, windowed to 4 source texels either side
+				static constexpr double alpha = 4.0;
+				static constexpr double radius = 4.0;
+				static constexpr double pi = 3.14159265358979323846;
+				Kernel ret{ -3, 8, {} };
+				double sum = 0.0;
+				double weights[8];
+				for (uint32_t k = 0; k < 8; k++) {
+					//distance from the output texel's center, in source texels
+					const double distance = static_cast<double>(k) - 3.5;
+					const double t = distance * 0.5;
+					const double sinc = std::sin(pi * t) / (pi * t);
+					const double ratio = distance / radius;
+					const double window = BesselI0(alpha * std::sqrt(1.0 - ratio * ratio)) / BesselI0(alpha);
+					weights[k] = sinc * window;
+					sum += weights[k];
+				}
+				for (uint32_t k = 0; k < 8; k++) {
+					ret.weights[k] = static_cast<float>(weights[k] / sum);
+				}
+				return ret;
+			}();
+			return filter == Filter::Kaiser ? kaiser : box;
+		}
+
+		//a source row to floats, padded with copies of the edge texels so the horizontal taps never need a clamp
+		static void DecodeRow(const uint8_t* src, uint32_t width, uint32_t paddedWidth, bool srgb, float* out) {
+			const float* table = GetTables().toFloat.data();
+			const uint32_t colorOffset = srgb ? 0 : 256;
+			float* texels = out + rowPadding * 4;
+			uint32_t x = 0;
+#if MIP_AVX2
+			const __m256i offsets = _mm256_setr_epi32(colorOffset, colorOffset, colorOffset, 256, colorOffset, colorOffset, colorOffset, 256);
+			for (; x + 2 <= width; x += 2) {
+				const __m256i indices = _mm256_add_epi32(_mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + x * 4))), offsets);
+				_mm256_storeu_ps(texels + x * 4, _mm256_i32gather_ps(table, indices, 4));
+			}
+#endif
+			for (; x < width; x++) {
+				texels[x * 4 + 0] = table[colorOffset + src[x * 4 + 0]];
+				texels[x * 4 + 1] = table[colorOffset + src[x * 4 + 1]];
+				texels[x * 4 + 2] = table[colorOffset + src[x * 4 + 2]];
+				texels[x * 4 + 3] = table[256 + src[x * 4 + 3]];
+			}
+			for (int32_t i = 0; i < rowPadding; i++) {
+				memcpy(out + i * 4, texels, sizeof(float) * 4);
+			}
+			for (uint32_t i = width; i < paddedWidth; i++) {
+				memcpy(texels + i * 4, texels + (width - 1) * 4, sizeof(float) * 4);
+			}
+		}
+
+		static void HorizontalPass(const float* padded, uint32_t dstWidth, Kernel const& kernel, float* out) {
+			const float* base = padded + (rowPadding + kernel.first) * 4;
+			uint32_t x = 0;
+#if MIP_AVX2
+			//two output texels per register, 2 source texels apart
+			for (; x + 2 <= dstWidth; x += 2) {
+				__m256 sum = _mm256_setzero_ps();
+				for (uint32_t k = 0; k < kernel.taps; k++) {
+					const float* tap = base + (x * 2 + k) * 4;
+					const __m256 texels = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(tap)), _mm_loadu_ps(tap + 8), 1);
+					sum = _mm256_add_ps(sum, _mm256_mul_ps(texels, _mm256_set1_ps(kernel.weights[k])));
+				}
+				_mm256_storeu_ps(out + x * 4, sum);
+			}
+#endif
+#if MIP_SSE
+			for (; x < dstWidth; x++) {
+				__m128 sum = _mm_setzero_ps();
+				for (uint32_t k = 0; k < kernel.taps; k++) {
+					sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(base + (x * 2 + k) * 4), _mm_set1_ps(kernel.weights[k])));
+				}
+				_mm_storeu_ps(out + x * 4, sum);
+			}
+#else
+			for (; x < dstWidth; x++) {
+				float sum[4] = { 0.f, 0.f, 0.f, 0.f };
+				for (uint32_t k = 0; k < kernel.taps; k++) {
+					const float* tap = base + (x * 2 + k) * 4;
+					for (uint32_t c = 0; c < 4; c++) {
+						sum[c] += tap[c] * kernel.weights[k];
+					}
+				}
+				memcpy(out + x * 4, sum, sizeof(sum));
+			}
+#endif
+		}
+
+		//accum += row * weight
+		static void AccumulateRow(float* accum, const float* row, float weight, uint32_t count) {
+			uint32_t i = 0;
+#if MIP_AVX2
+			const __m256 weight8 = _mm256_set1_ps(weight);
+			for (; i + 8 <= count; i += 8) {
+				_mm256_storeu_ps(accum + i, _mm256_add_ps(_mm256_loadu_ps(accum + i), _mm256_mul_ps(_mm256_loadu_ps(row + i), weight8)));
+			}
+#endif
+#if MIP_SSE
+			const __m128 weight4 = _mm_set1_ps(weight);
+			for (; i + 4 <= count; i += 4) {
+				_mm_storeu_ps(accum + i, _mm_add_ps(_mm_loadu_ps(accum + i), _mm_mul_ps(_mm_loadu_ps(row + i), weight4)));
+			}
+#endif
+			for (; i < count; i++) {
+				accum[i] += row[i] * weight;
+			}
+		}
+
+		//clamped, the kaiser filter can ring past [0, 1]. color to [0, colorScale], alpha to [0, 255]
+		static void Quantize(const float* texel, float colorScale, int32_t* out) {
+#if MIP_SSE
+			const __m128 clamped = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(texel), _mm_setzero_ps()), _mm_set1_ps(1.f));
+			const __m128 scaled = _mm_add_ps(_mm_mul_ps(clamped, _mm_setr_ps(colorScale, colorScale, colorScale, 255.f)), _mm_set1_ps(0.5f));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_cvttps_epi32(scaled));
+#else
+			for (uint32_t c = 0; c < 4; c++) {
+				out[c] = static_cast<int32_t>(std::clamp(texel[c], 0.f, 1.f) * (c == 3 ? 255.f : colorScale) + 0.5f);
+			}
+#endif
+		}
+
+		static void EncodeRow(const float* texels, uint32_t width, bool srgb, uint8_t* out) {
+			const uint8_t* toSRGB = GetTables().linearToSRGB.data();
+			const float colorScale = srgb ? 4095.f : 255.f;
+			int32_t quantized[4];
+			for (uint32_t x = 0; x < width; x++) {
+				Quantize(texels + x * 4, colorScale, quantized);
+				uint8_t* texel = out + x * 4;
+				if (srgb) {
+					texel[0] = toSRGB[quantized[0]];
+					texel[1] = toSRGB[quantized[1]];
+					texel[2] = toSRGB[quantized[2]];
+				}
+				else {
+					texel[0] = static_cast<uint8_t>(quantized[0]);
+					texel[1] = static_cast<uint8_t>(quantized[1]);
+					texel[2] = static_cast<uint8_t>(quantized[2]);
+				}
+				texel[3] = static_cast<uint8_t>(quantized[3]);
+			}
+		}
+
+		//one level, split into bands of rows. whichever threads get to a band first filter it
+		struct LevelJob {
+			const uint8_t* src;
+			uint32_t srcWidth;
+			uint32_t srcHeight;
+			uint8_t* dst;
+			uint32_t dstWidth;
+			uint32_t dstHeight;
+			Kernel const& kernel;
+			bool srgb;
+			uint32_t bandRows;
+			uint32_t bandCount;
+			std::atomic<uint32_t> next{ 0 };
+			std::atomic<uint32_t> remaining;
+
+			LevelJob(const uint8_t* src, uint32_t srcWidth, uint32_t srcHeight, uint8_t* dst, uint32_t dstWidth, uint32_t dstHeight, Kernel const& kernel, bool srgb, uint32_t bandRows)
+				: src{ src }, srcWidth{ srcWidth }, srcHeight{ srcHeight },
+				dst{ dst }, dstWidth{ dstWidth }, dstHeight{ dstHeight },
+				kernel{ kernel }, srgb{ srgb },
+				bandRows{ bandRows }, bandCount{ (dstHeight + bandRows - 1) / bandRows },
+				remaining{ bandCount }
+			{}
+
+			void FilterBand(uint32_t band) {
+				thread_local std::vector<float> padded{};
+				thread_local std::vector<float> filteredRows{};
+				thread_local std::vector<float> accum{};
+
+				const uint32_t yBegin = band * bandRows;
+				const uint32_t yEnd = std::min(yBegin + bandRows, dstHeight);
+				const int32_t lastSourceRow = static_cast<int32_t>(srcHeight) - 1;
+				//the source rows this band's taps touch
+				const int32_t rowBegin = std::max(static_cast<int32_t>(yBegin * 2) + kernel.first, 0);
+				const int32_t rowEnd = std::min(static_cast<int32_t>((yEnd - 1) * 2) + kernel.first + static_cast<int32_t>(kernel.taps) - 1, lastSourceRow);
+
+				//far enough right for the last output texel's taps, even when the source is narrower than 2x
+				const uint32_t paddedWidth = std::max(srcWidth, dstWidth * 2 + 3);
+				const std::size_t rowFloats = static_cast<std::size_t>(dstWidth) * 4;
+				padded.resize((static_cast<std::size_t>(paddedWidth) + rowPadding) * 4);
+				filteredRows.resize(rowFloats * static_cast<std::size_t>(rowEnd - rowBegin + 1));
+				accum.resize(rowFloats);
+
+				for (int32_t row = rowBegin; row <= rowEnd; row++) {
+					DecodeRow(src + static_cast<std::size_t>(row) * srcWidth * 4, srcWidth, paddedWidth, srgb, padded.data());
+					HorizontalPass(padded.data(), dstWidth, kernel, filteredRows.data() + rowFloats * static_cast<std::size_t>(row - rowBegin));
+				}
+				for (uint32_t y = yBegin; y < yEnd; y++) {
+					std::fill(accum.begin(), accum.end(), 0.f);
+					for (uint32_t k = 0; k < kernel.taps; k++) {
+						const int32_t row = std::clamp(static_cast<int32_t>(y * 2) + kernel.first + static_cast<int32_t>(k), 0, lastSourceRow);
+						AccumulateRow(accum.data(), filteredRows.data() + rowFloats * static_cast<std::size_t>(row - rowBegin), kernel.weights[k], static_cast<uint32_t>(rowFloats));
+					}
+					EncodeRow(accum.data(), dstWidth, srgb, dst + static_cast<std::size_t>(y) * dstWidth * 4);
+				}
+			}
+
+			void Run() {
+				for (uint32_t band = next.fetch_add(1, std::memory_order_relaxed); band < bandCount; band = next.fetch_add(1, std::memory_order_relaxed)) {
+					FilterBand(band);
+					if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+						remaining.notify_all();
+					}
+				}
+			}
+			void Wait() {
+				uint32_t current = remaining.load(std::memory_order_acquire);
+				while (current != 0) {
+					remaining.wait(current, std::memory_order_acquire);
+					current = remaining.load(std::memory_order_acquire);
+				}
+			}
+		};
+
+		static std::array<uint64_t, 256> AlphaHistogram(const uint8_t* texels, uint64_t count) {
+			std::array<uint64_t, 256> ret{};
+			for (uint64_t i = 0; i < count; i++) {
+				ret[texels[i * 4 + 3]]++;
+			}
+			return ret;
+		}
+		static double Coverage(std::array<uint64_t, 256> const& histogram, uint64_t count, float cutoff, float scale) {
+			uint64_t passing = 0;
+			for (uint32_t alpha = 0; alpha < 256; alpha++) {
+				if (std::min(static_cast<float>(alpha) * scale, 255.f) >= cutoff * 255.f) {
+					passing += histogram[alpha];
+				}
+			}
+			return static_cast<double>(passing) / static_cast<double>(count);
+		}
+		//coverage only grows with the scale, a bisection finds the scale that matches level 0
+		static void PreserveAlphaCoverage(uint8_t* texels, uint64_t count, float cutoff, double targetCoverage) {
+			const std::array<uint64_t, 256> histogram = AlphaHistogram(texels, count);
+			float low = 0.f;
+			float high = 4.f;
+			for (uint32_t i = 0; i < 16; i++) {
+				const float mid = (low + high) * 0.5f;
+				if (Coverage(histogram, count, cutoff, mid) < targetCoverage) {
+					low = mid;
+				}
+				else {
+					high = mid;
+				}
+			}
+			const float scale = high;
+			std::array<uint8_t, 256> remap;
+			for (uint32_t alpha = 0; alpha < 256; alpha++) {
+				remap[alpha] = static_cast<uint8_t>(std::min(static_cast<float>(alpha) * scale + 0.5f, 255.f));
+			}
+			for (uint64_t i = 0; i < count; i++) {
+				texels[i * 4 + 3] = remap[texels[i * 4 + 3]];
+			}
+		}
+
+		uint32_t LevelCount(uint32_t width, uint32_t height) {
+			return static_cast<uint32_t>(std::floor(std::log2(std::max(width, height)))) + 1;
+		}
+
+		uint64_t Layout(uint32_t width, uint32_t height, uint32_t levelCount, std::vector<Level>& levels) {
+			levels.clear();
+			levels.reserve(levelCount);
+			uint64_t offset = 0;
+			for (uint32_t i = 0; i < levelCount; i++) {
+				levels.push_back(Level{ offset, width, height });
+				offset += static_cast<uint64_t>(width) * height * 4;
+				width = std::max(width / 2, 1u);
+				height = std::max(height / 2, 1u);
+			}
+			return offset;
+		}
+
+		void Generate(const uint8_t* src, uint32_t width, uint32_t height, uint32_t levelCount, uint8_t* dst, Options const& options) {
+			const auto start = std::chrono::steady_clock::now();
+			Kernel const& kernel = GetKernel(options.filter);
+
+			std::vector<Level> levels{};
+			Layout(width, height, levelCount, levels);
+			memcpy(dst, src, static_cast<std::size_t>(width) * height * 4);
+
+			double targetCoverage = 0.0;
+			if (options.preserveAlphaCoverage) {
+				const uint64_t count = static_cast<uint64_t>(width) * height;
+				targetCoverage = Coverage(AlphaHistogram(src, count), count, options.alphaCutoff, 1.f);
+			}
+
+			uint64_t generated = 0;
+			for (uint32_t i = 1; i < levelCount; i++) {
+				Level const& srcLevel = levels[i - 1];
+				Level const& dstLevel = levels[i];
+				const uint64_t texelCount = static_cast<uint64_t>(dstLevel.width) * dstLevel.height;
+
+				uint32_t helperCount = 0;
+				uint32_t bandRows = dstLevel.height;
+				if (texelCount >= parallelTexelThreshold) {
+					const uint32_t threadCount = static_cast<uint32_t>(ThreadPool::GetThreadCount());
+					//a few bands per thread, so a slow thread doesn't hold the level up
+					bandRows = std::max((dstLevel.height + threadCount * 4) / (threadCount * 4 + 1), minBandRows);
+					helperCount = std::min(threadCount, (dstLevel.height + bandRows - 1) / bandRows - 1);
+				}
+				auto job = std::make_shared<LevelJob>(dst + srcLevel.offset, srcLevel.width, srcLevel.height, dst + dstLevel.offset, dstLevel.width, dstLevel.height, kernel, options.srgb, bandRows);
+				for (uint32_t helper = 0; helper < helperCount; helper++) {
+					ThreadPool::EnqueueVoid([job] { job->Run(); });
+				}
+				job->Run();
+				job->Wait();
+
+				if (options.preserveAlphaCoverage) {
+					PreserveAlphaCoverage(dst + dstLevel.offset, texelCount, options.alphaCutoff, targetCoverage);
+				}
+				generated += texelCount;
+			}
+
+			chainCount.fetch_add(1, std::memory_order_relaxed);
+			texelsGenerated.fetch_add(generated, std::memory_order_relaxed);
+			totalNS.fetch_add(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count()), std::memory_order_relaxed);
+		}
+
+		Stats GetStats() {
+			Stats ret{};
+			ret.chains = chainCount.load(std::memory_order_relaxed);
+			ret.texelsGenerated = texelsGenerated.load(std::memory_order_relaxed);
+			ret.totalMS = static_cast<double>(totalNS.load(std::memory_order_relaxed)) / 1000000.0;
+			return ret;
+		}
+		void PrintStats() {
+			const Stats stats = GetStats();
+			printf("mip generator - %u chains, %llu texels in %.3f ms (%.1f Mtexels/s)\n",
+				stats.chains,
+				static_cast<unsigned long long>(stats.texelsGenerated), stats.totalMS,
+				stats.totalMS > 0.0 ? static_cast<double>(stats.texelsGenerated) / (stats.totalMS * 1000.0) : 0.0
+			);
+		}
+	} //namespace MipGenerator
+} //namespace EWE
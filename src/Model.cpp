@@ -21,24 +21,23 @@ namespace EWE {
         VertexBuffers(static_cast<uint32_t>(vertexCount), static_cast<uint32_t>(sizeOfVertex), verticesData);
     }
     
-    inline void CopyModelBuffer(StagingBuffer* stagingBuffer, VkBuffer dstBuffer, const VkDeviceSize bufferSize) {
-        SyncHub* syncHub = SyncHub::GetSyncHubInstance();
-        CommandBuffer& cmdBuf = syncHub->BeginSingleTimeCommand();
-        VK::CopyBuffer(cmdBuf, stagingBuffer->buffer, dstBuffer, bufferSize);
+    inline UploadToken CopyModelBuffer(StagingBuffer* stagingBuffer, EWEBuffer& dstBuffer, const VkDeviceSize bufferSize) {
 
-
-        if (VK::Object->CheckMainThread() || (!VK::Object->queueEnabled[Queue::transfer])) {
+        if (VK::Object->CheckMainThread()) {
+            SyncHub* syncHub = SyncHub::GetSyncHubInstance();
+            CommandBuffer& cmdBuf = syncHub->BeginSingleTimeCommand();
+            VK::CopyBuffer(cmdBuf, stagingBuffer->buffer, dstBuffer.GetBuffer(), bufferSize);
             GraphicsCommand gCommand{};
             gCommand.command = &cmdBuf;
             gCommand.stagingBuffer = stagingBuffer;
             syncHub->EndSingleTimeCommandGraphics(gCommand);
+            //the frame waits on the single time semaphore, this is visible to anything recorded afterwards
+            ResourceTracker::SetState(dstBuffer.GetState(), ResourceUsage{ Queue::graphics, VK_IMAGE_LAYOUT_UNDEFINED, VK_ACCESS_MEMORY_READ_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT });
+            return UploadToken{};
         }
         else {
-            //transitioning from transfer to compute not supported currently
-            TransferCommand command{};
-            command.commands.push_back(&cmdBuf);
-            command.stagingBuffers.push_back(stagingBuffer);
-            syncHub->EndSingleTimeCommandTransfer(command);
+            //doesn't block, the upload is acquired by the graphics queue at the beginning of a following frame
+            return UploadQueue::EnqueueBuffer(stagingBuffer, dstBuffer, bufferSize);
         }
     }
 
@@ -57,7 +56,7 @@ namespace EWE {
             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT 
         );
         
-        CopyModelBuffer(stagingBuffer, instanceBuffer->GetBuffer(), bufferSize);
+        uploadToken = CopyModelBuffer(stagingBuffer, *instanceBuffer, bufferSize);
     }
 
     void EWEModel::VertexBuffers(uint32_t vertexCount, uint32_t vertexSize, void const* data){
@@ -82,7 +81,7 @@ namespace EWE {
         );
 #endif
 
-        CopyModelBuffer(stagingBuffer, vertexBuffer->GetBuffer(), bufferSize);
+        uploadToken = CopyModelBuffer(stagingBuffer, *vertexBuffer, bufferSize);
     }
 
     void EWEModel::CreateIndexBuffer(const void* indexData, uint32_t indexCount){
@@ -107,7 +106,7 @@ namespace EWE {
             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
         );
 #endif
-        CopyModelBuffer(stagingBuffer, indexBuffer->GetBuffer(), bufferSize);
+        uploadToken = CopyModelBuffer(stagingBuffer, *indexBuffer, bufferSize);
     }
 
     void EWEModel::CreateIndexBuffers(std::vector<uint32_t> const& indices){
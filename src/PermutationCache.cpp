@@ -0,0 +1,613 @@
+#include "EWGraphics/Vulkan/PermutationCache.h"
+
+#include "EWGraphics/Vulkan/ComputePipeline.h"
+#include "EWGraphics/Data/ByteStream.h"
+#include "EWGraphics/Data/RetireQueue.h"
+#include "EWGraphics/Data/Hash.h"
+#include "EWGraphics/Data/AtomicFile.h"
+#include "EWGraphics/Data/ThreadPool.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+#ifndef PIPELINE_PERMUTATION_LIST_PATH
+#define PIPELINE_PERMUTATION_LIST_PATH "pipeline_permutations.bin"
+#endif
+
+namespace EWE {
+	namespace PermutationCache {
+		static constexpr uint32_t fileMagic = 0x50505745; //EWPP
+		static constexpr uint32_t fileVersion = 1;
+
+		enum PermutationType : uint8_t {
+			Compute,
+			Graphics,
+		};
+
+		struct FileHeader {
+			uint32_t magic;
+			uint32_t version;
+			uint32_t recordCount;
+			uint32_t padding;
+			uint64_t dataSize;
+			uint64_t checksum;
+		};
+
+		struct Entry {
+			std::vector<uint8_t> bytes;
+			VkPipeline pipeline;
+			uint32_t refCount;
+			bool prewarmed;
+			//the handle before an upgrade, alive until every reference to it is refreshed or released
+			VkPipeline replaced{ VK_NULL_HANDLE };
+			uint32_t replacedRefCount{ 0 };
+			//null unless it was linked from libraries
+			PipelineLibrary::LinkedParts libraryParts{};
+		};
+
+		static std::mutex mutex{};
+		//the hash only narrows it down, the bytes are compared in full
+		static std::unordered_multimap<std::size_t, Entry> entries{};
+		static std::unordered_map<VkPipeline, std::size_t> pipelineHashes{};
+		static std::unordered_set<std::string> records{};
+		static RetireQueue<VkPipeline> retired{ MAX_FRAMES_IN_FLIGHT };
+		static std::atomic<uint32_t> upgradeGeneration{ 0 };
+
+		static uint32_t hits{ 0 };
+		static uint32_t misses{ 0 };
+		static uint32_t prewarmed{ 0 };
+		static uint32_t prewarmHits{ 0 };
+
+		static std::mutex prewarmMutex{};
+		static std::condition_variable prewarmCondition{};
+		static uint32_t prewarmsInFlight{ 0 };
+		static thread_local bool prewarming{ false };
+
+		static void PackSpec(ByteWriter& writer, std::vector<KeyValuePair<ShaderStage, std::vector<Shader::SpecializationEntry>>> const& specInfo) {
+			writer.Write(static_cast<uint8_t>(specInfo.size()));
+			for (auto const& stage : specInfo) {
+				writer.Write(static_cast<uint8_t>(stage.key.value));
+				writer.Write(static_cast<uint32_t>(stage.value.size()));
+				for (auto const& entry : stage.value) {
+					//names don't change the compiled pipeline
+					writer.Write(entry.constantID);
+					writer.Write(entry.type);
+					writer.Write(entry.elementCount);
+					writer.Write(entry.value, sizeof(float) * entry.elementCount);
+				}
+			}
+		}
+		static void UnpackSpec(ByteReader& reader, std::vector<KeyValuePair<ShaderStage, std::vector<Shader::SpecializationEntry>>>& specInfo) {
+			const uint8_t stageCount = reader.Read<uint8_t>();
+			for (uint8_t i = 0; (i < stageCount) && !reader.failed; i++) {
+				const ShaderStage stage{ static_cast<ShaderStage::Bits>(reader.Read<uint8_t>()) };
+				std::vector<Shader::SpecializationEntry> stageEntries(reader.Read<uint32_t>());
+				for (auto& entry : stageEntries) {
+					entry.constantID = reader.Read<uint32_t>();
+					entry.type = reader.Read<Shader::ShaderFundamentalType>();
+					entry.elementCount = reader.Read<uint8_t>();
+					if (entry.elementCount * sizeof(float) > sizeof(entry.value)) {
+						reader.failed = true;
+						return;
+					}
+					reader.Read(entry.value, sizeof(float) * entry.elementCount);
+				}
+				specInfo.push_back(KeyValuePair<ShaderStage, std::vector<Shader::SpecializationEntry>>(stage, std::move(stageEntries)));
+			}
+		}
+
+		//everything CreateVkPipeline_SecondStage reads from the config, pointers followed
+		static void PackState(ByteWriter& writer, PipelineConfigInfo const& configInfo) {
+			writer.WriteVector(configInfo.bindingDescriptions);
+			writer.WriteVector(configInfo.attributeDescriptions);
+
+			writer.Write(configInfo.inputAssemblyInfo.topology);
+			writer.Write(configInfo.inputAssemblyInfo.primitiveRestartEnable);
+			writer.Write(configInfo.viewportInfo.viewportCount);
+			writer.Write(configInfo.viewportInfo.scissorCount);
+
+			auto const& raster = configInfo.rasterizationInfo;
+			writer.Write(raster.depthClampEnable);
+			writer.Write(raster.rasterizerDiscardEnable);
+			writer.Write(raster.polygonMode);
+			writer.Write(raster.cullMode);
+			writer.Write(raster.frontFace);
+			writer.Write(raster.depthBiasEnable);
+			writer.Write(raster.depthBiasConstantFactor);
+			writer.Write(raster.depthBiasClamp);
+			writer.Write(raster.depthBiasSlopeFactor);
+			writer.Write(raster.lineWidth);
+
+			auto const& multisample = configInfo.multisampleInfo;
+			writer.Write(multisample.rasterizationSamples);
+			writer.Write(multisample.sampleShadingEnable);
+			writer.Write(multisample.minSampleShading);
+			writer.Write(multisample.alphaToCoverageEnable);
+			writer.Write(multisample.alphaToOneEnable);
+			writer.Write(configInfo.sampleMask);
+
+			auto const& blend = configInfo.colorBlendInfo;
+			writer.Write(blend.logicOpEnable);
+			writer.Write(blend.logicOp);
+			writer.Write(blend.blendConstants);
+			writer.Write(blend.attachmentCount);
+			writer.Write(blend.pAttachments, sizeof(VkPipelineColorBlendAttachmentState) * blend.attachmentCount);
+
+			auto const& depthStencil = configInfo.depthStencilInfo;
+			writer.Write(depthStencil.depthTestEnable);
+			writer.Write(depthStencil.depthWriteEnable);
+			writer.Write(depthStencil.depthCompareOp);
+			writer.Write(depthStencil.depthBoundsTestEnable);
+			writer.Write(depthStencil.stencilTestEnable);
+			writer.Write(depthStencil.front);
+			writer.Write(depthStencil.back);
+			writer.Write(depthStencil.minDepthBounds);
+			writer.Write(depthStencil.maxDepthBounds);
+
+			writer.WriteVector(configInfo.dynamicStateEnables);
+			writer.Write(configInfo.tessCreateInfo.patchControlPoints);
+
+			auto const& rendering = configInfo.pipelineRenderingInfo;
+			writer.Write(rendering.viewMask);
+			writer.Write(rendering.colorAttachmentCount);
+			writer.Write(rendering.pColorAttachmentFormats, sizeof(VkFormat) * rendering.colorAttachmentCount);
+			writer.Write(rendering.depthAttachmentFormat);
+			writer.Write(rendering.stencilAttachmentFormat);
+
+			writer.Write(configInfo.subpass);
+		}
+
+		//storage for what the config points at
+		struct UnpackedState {
+			std::vector<VkPipelineColorBlendAttachmentState> blendAttachments{};
+			std::vector<VkFormat> colorFormats{};
+		};
+		static void UnpackState(ByteReader& reader, PipelineConfigInfo& configInfo, UnpackedState& storage) {
+			configInfo.SetToDefaults();
+			reader.ReadVector(configInfo.bindingDescriptions);
+			reader.ReadVector(configInfo.attributeDescriptions);
+
+			configInfo.inputAssemblyInfo.topology = reader.Read<VkPrimitiveTopology>();
+			configInfo.inputAssemblyInfo.primitiveRestartEnable = reader.Read<VkBool32>();
+			configInfo.viewportInfo.viewportCount = reader.Read<uint32_t>();
+			configInfo.viewportInfo.scissorCount = reader.Read<uint32_t>();
+
+			auto& raster = configInfo.rasterizationInfo;
+			raster.depthClampEnable = reader.Read<VkBool32>();
+			raster.rasterizerDiscardEnable = reader.Read<VkBool32>();
+			raster.polygonMode = reader.Read<VkPolygonMode>();
+			raster.cullMode = reader.Read<VkCullModeFlags>();
+			raster.frontFace = reader.Read<VkFrontFace>();
+			raster.depthBiasEnable = reader.Read<VkBool32>();
+			raster.depthBiasConstantFactor = reader.Read<float>();
+			raster.depthBiasClamp = reader.Read<float>();
+			raster.depthBiasSlopeFactor = reader.Read<float>();
+			raster.lineWidth = reader.Read<float>();
+
+			auto& multisample = configInfo.multisampleInfo;
+			multisample.rasterizationSamples = reader.Read<VkSampleCountFlagBits>();
+			multisample.sampleShadingEnable = reader.Read<VkBool32>();
+			multisample.minSampleShading = reader.Read<float>();
+			multisample.alphaToCoverageEnable = reader.Read<VkBool32>();
+			multisample.alphaToOneEnable = reader.Read<VkBool32>();
+			reader.Read(configInfo.sampleMask, sizeof(configInfo.sampleMask));
+
+			auto& blend = configInfo.colorBlendInfo;
+			blend.logicOpEnable = reader.Read<VkBool32>();
+			blend.logicOp = reader.Read<VkLogicOp>();
+			reader.Read(blend.blendConstants, sizeof(blend.blendConstants));
+			blend.attachmentCount = reader.Read<uint32_t>();
+			if (blend.attachmentCount > 64) {
+				reader.failed = true;
+				return;
+			}
+			storage.blendAttachments.resize(blend.attachmentCount);
+			reader.Read(storage.blendAttachments.data(), sizeof(VkPipelineColorBlendAttachmentState) * blend.attachmentCount);
+			blend.pAttachments = storage.blendAttachments.data();
+
+			auto& depthStencil = configInfo.depthStencilInfo;
+			depthStencil.depthTestEnable = reader.Read<VkBool32>();
+			depthStencil.depthWriteEnable = reader.Read<VkBool32>();
+			depthStencil.depthCompareOp = reader.Read<VkCompareOp>();
+			depthStencil.depthBoundsTestEnable = reader.Read<VkBool32>();
+			depthStencil.stencilTestEnable = reader.Read<VkBool32>();
+			depthStencil.front = reader.Read<VkStencilOpState>();
+			depthStencil.back = reader.Read<VkStencilOpState>();
+			depthStencil.minDepthBounds = reader.Read<float>();
+			depthStencil.maxDepthBounds = reader.Read<float>();
+
+			reader.ReadVector(configInfo.dynamicStateEnables);
+			configInfo.dynamicStateInfo.pDynamicStates = configInfo.dynamicStateEnables.data();
+			configInfo.dynamicStateInfo.dynamicStateCount = static_cast<uint32_t>(configInfo.dynamicStateEnables.size());
+			configInfo.tessCreateInfo.patchControlPoints = reader.Read<uint32_t>();
+
+			auto& rendering = configInfo.pipelineRenderingInfo;
+			rendering.viewMask = reader.Read<uint32_t>();
+			rendering.colorAttachmentCount = reader.Read<uint32_t>();
+			if (rendering.colorAttachmentCount > 64) {
+				reader.failed = true;
+				return;
+			}
+			storage.colorFormats.resize(rendering.colorAttachmentCount);
+			reader.Read(storage.colorFormats.data(), sizeof(VkFormat) * rendering.colorAttachmentCount);
+			rendering.pColorAttachmentFormats = storage.colorFormats.data();
+			rendering.depthAttachmentFormat = reader.Read<VkFormat>();
+			rendering.stencilAttachmentFormat = reader.Read<VkFormat>();
+
+			configInfo.subpass = reader.Read<uint32_t>();
+		}
+
+		static void PackStages(ByteWriter& keyWriter, ByteWriter& recordWriter, bool& recordable, PipeLayout const& layout) {
+			uint8_t stageCount = 0;
+			for (auto const* shader : layout.shaders) {
+				stageCount += shader != nullptr;
+			}
+			keyWriter.Write(stageCount);
+			recordWriter.Write(stageCount);
+			for (uint8_t i = 0; i < layout.shaders.size(); i++) {
+				Shader const* shader = layout.shaders[i];
+				if (shader == nullptr) {
+					continue;
+				}
+				keyWriter.Write(i);
+				keyWriter.Write(shader->moduleHash);
+				recordWriter.Write(i);
+				recordWriter.WriteString(shader->filepath);
+				//shaders created from memory can't be loaded again by path
+				recordable &= std::filesystem::exists(shader->filepath);
+			}
+		}
+
+		static Key FinishKey(ByteWriter& keyWriter, ByteWriter& recordWriter, bool recordable) {
+			Key ret{};
+			ret.hash = std::hash<std::string_view>{}(std::string_view(reinterpret_cast<const char*>(keyWriter.bytes.data()), keyWriter.bytes.size()));
+			ret.bytes = std::move(keyWriter.bytes);
+			if (recordable) {
+				ret.record = std::move(recordWriter.bytes);
+			}
+			return ret;
+		}
+
+		Key MakeComputeKey(PipeLayout const& layout, std::vector<KeyValuePair<ShaderStage, std::vector<Shader::SpecializationEntry>>> const& specInfo) {
+			ByteWriter keyWriter{};
+			ByteWriter recordWriter{};
+			bool recordable = true;
+			keyWriter.Write(PermutationType::Compute);
+			recordWriter.Write(PermutationType::Compute);
+			PackStages(keyWriter, recordWriter, recordable, layout);
+			PackSpec(keyWriter, specInfo);
+			PackSpec(recordWriter, specInfo);
+			return FinishKey(keyWriter, recordWriter, recordable);
+		}
+
+		Key MakeGraphicsKey(PipeLayout const& layout, PipelineConfigInfo const& configInfo, std::vector<KeyValuePair<ShaderStage, std::vector<Shader::SpecializationEntry>>> const& specInfo) {
+			ByteWriter keyWriter{};
+			ByteWriter recordWriter{};
+			bool recordable = true;
+			keyWriter.Write(PermutationType::Graphics);
+			recordWriter.Write(PermutationType::Graphics);
+			PackStages(keyWriter, recordWriter, recordable, layout);
+			PackSpec(keyWriter, specInfo);
+			PackSpec(recordWriter, specInfo);
+			PackState(keyWriter, configInfo);
+			PackState(recordWriter, configInfo);
+			return FinishKey(keyWriter, recordWriter, recordable);
+		}
+
+		//called with the mutex held
+		static void ReleaseReplaced(Entry& entry) {
+			assert(entry.replacedRefCount > 0);
+			entry.replacedRefCount--;
+			if (entry.replacedRefCount == 0) {
+				retired.Push(entry.replaced, VK::Object->totalFrameCount);
+				pipelineHashes.erase(entry.replaced);
+				entry.replaced = VK_NULL_HANDLE;
+			}
+		}
+
+		VkPipeline Acquire(Key const& key) {
+			std::unique_lock<std::mutex> lock{ mutex };
+			auto range = entries.equal_range(key.hash);
+			for (auto iter = range.first; iter != range.second; iter++) {
+				if (iter->second.bytes == key.bytes) {
+					iter->second.refCount++;
+					hits++;
+					if (iter->second.prewarmed && !prewarming) {
+						prewarmHits++;
+					}
+					return iter->second.pipeline;
+				}
+			}
+			misses++;
+			return VK_NULL_HANDLE;
+		}
+
+		VkPipeline Insert(Key const& key, VkPipeline pipeline, PipelineLibrary::LinkedParts const& libraryParts) {
+			std::unique_lock<std::mutex> lock{ mutex };
+			if (key.record.size() > 0) {
+				records.emplace(reinterpret_cast<const char*>(key.record.data()), key.record.size());
+			}
+			auto range = entries.equal_range(key.hash);
+			for (auto iter = range.first; iter != range.second; iter++) {
+				if (iter->second.bytes == key.bytes) {
+					//compiled on two threads at once
+					EWE_VK(vkDestroyPipeline, VK::Object->vkDevice, pipeline, nullptr);
+					PipelineLibrary::ReleaseParts(libraryParts);
+					iter->second.refCount++;
+					return iter->second.pipeline;
+				}
+			}
+			entries.emplace(key.hash, Entry{ key.bytes, pipeline, 1, prewarming, VK_NULL_HANDLE, 0, libraryParts });
+			pipelineHashes.emplace(pipeline, key.hash);
+			if (prewarming) {
+				prewarmed++;
+			}
+			return pipeline;
+		}
+
+		void Release(VkPipeline pipeline) {
+			std::unique_lock<std::mutex> lock{ mutex };
+			auto hashIter = pipelineHashes.find(pipeline);
+			if (hashIter == pipelineHashes.end()) {
+				//created outside of the cache
+				EWE_VK(vkDestroyPipeline, VK::Object->vkDevice, pipeline, nullptr);
+				return;
+			}
+			auto range = entries.equal_range(hashIter->second);
+			for (auto iter = range.first; iter != range.second; iter++) {
+				Entry& entry = iter->second;
+				if ((entry.pipeline == pipeline) || (entry.replaced == pipeline)) {
+					assert(entry.refCount > 0);
+					entry.refCount--;
+					if (entry.replaced == pipeline) {
+						ReleaseReplaced(entry);
+					}
+					if (entry.refCount == 0) {
+						EWE_VK(vkDestroyPipeline, VK::Object->vkDevice, entry.pipeline, nullptr);
+						pipelineHashes.erase(entry.pipeline);
+						if (entry.replaced != VK_NULL_HANDLE) {
+							EWE_VK(vkDestroyPipeline, VK::Object->vkDevice, entry.replaced, nullptr);
+							pipelineHashes.erase(entry.replaced);
+						}
+						PipelineLibrary::ReleaseParts(entry.libraryParts);
+						entries.erase(iter);
+					}
+					return;
+				}
+			}
+			EWE_UNREACHABLE;
+		}
+
+		void Upgrade(VkPipeline pipeline, VkPipeline upgraded) {
+			std::unique_lock<std::mutex> lock{ mutex };
+			auto hashIter = pipelineHashes.find(pipeline);
+			if (hashIter == pipelineHashes.end()) {
+				//every reference was released before the upgrade finished
+				EWE_VK(vkDestroyPipeline, VK::Object->vkDevice, upgraded, nullptr);
+				return;
+			}
+			const std::size_t hash = hashIter->second;
+			auto range = entries.equal_range(hash);
+			for (auto iter = range.first; iter != range.second; iter++) {
+				Entry& entry = iter->second;
+				if (entry.pipeline == pipeline) {
+					assert(entry.replaced == VK_NULL_HANDLE && "a permutation can only be upgraded once");
+					entry.replaced = pipeline;
+					entry.replacedRefCount = entry.refCount;
+					entry.pipeline = upgraded;
+					pipelineHashes.emplace(upgraded, hash);
+					upgradeGeneration.fetch_add(1, std::memory_order_release);
+					return;
+				}
+			}
+			EWE_UNREACHABLE;
+		}
+
+		uint32_t GetUpgradeGeneration() {
+			return upgradeGeneration.load(std::memory_order_acquire);
+		}
+
+		VkPipeline Refresh(VkPipeline pipeline) {
+			std::unique_lock<std::mutex> lock{ mutex };
+			auto hashIter = pipelineHashes.find(pipeline);
+			if (hashIter == pipelineHashes.end()) {
+				return pipeline;
+			}
+			auto range = entries.equal_range(hashIter->second);
+			for (auto iter = range.first; iter != range.second; iter++) {
+				Entry& entry = iter->second;
+				if (entry.replaced == pipeline) {
+					ReleaseReplaced(entry);
+					return entry.pipeline;
+				}
+			}
+			return pipeline;
+		}
+
+		static void DestroyPipeline(VkPipeline pipeline) {
+			EWE_VK(vkDestroyPipeline, VK::Object->vkDevice, pipeline, nullptr);
+		}
+
+		void Update() {
+			assert(VK::Object->CheckMainThread());
+			std::unique_lock<std::mutex> lock{ mutex };
+			//a frame recorded before the handle was retired could still be in flight
+			retired.Collect(VK::Object->totalFrameCount, DestroyPipeline);
+		}
+
+		struct PrewarmTask {
+			PermutationType type;
+			PipeLayout* layout;
+			std::vector<KeyValuePair<ShaderStage, std::vector<Shader::SpecializationEntry>>> specInfo{};
+			PipelineConfigInfo configInfo{};
+			UnpackedState storage{};
+		};
+
+		static void RunPrewarm(PrewarmTask* task) {
+			prewarming = true;
+			//the temporary pipeline's reference is handed to the cache, it's held until Destroy
+			if (task->type == PermutationType::Compute) {
+				std::vector<Shader::SpecializationEntry> computeSpec{};
+				if (task->specInfo.size() > 0) {
+					computeSpec = task->specInfo[0].value;
+				}
+				ComputePipeline* pipeline = Construct<ComputePipeline>(0, task->layout, computeSpec);
+				pipeline->vkPipe = VK_NULL_HANDLE;
+				Deconstruct(pipeline);
+			}
+			else {
+				GraphicsPipeline* pipeline = Construct<GraphicsPipeline>(0, task->layout, task->configInfo, task->specInfo);
+				pipeline->vkPipe = VK_NULL_HANDLE;
+				Deconstruct(pipeline);
+			}
+			Deconstruct(task->layout);
+			Deconstruct(task);
+			prewarming = false;
+
+			std::unique_lock<std::mutex> lock{ prewarmMutex };
+			prewarmsInFlight--;
+			prewarmCondition.notify_all();
+		}
+
+		static std::vector<uint8_t> ReadValidatedFile(FileHeader& header) {
+			std::ifstream inFile{ PIPELINE_PERMUTATION_LIST_PATH, std::ios::binary | std::ios::ate };
+			if (!inFile.is_open()) {
+				return {};
+			}
+			const std::size_t fileSize = static_cast<std::size_t>(inFile.tellg());
+			if (fileSize < sizeof(FileHeader)) {
+				printf("pipeline permutation list is truncated, ignoring it\n");
+				return {};
+			}
+			inFile.seekg(0);
+			inFile.read(reinterpret_cast<char*>(&header), sizeof(FileHeader));
+			if ((header.magic != fileMagic) || (header.version != fileVersion) || (header.dataSize != (fileSize - sizeof(FileHeader)))) {
+				printf("pipeline permutation list has an unknown format, ignoring it\n");
+				return {};
+			}
+			std::vector<uint8_t> data(header.dataSize);
+			inFile.read(reinterpret_cast<char*>(data.data()), data.size());
+			if (!inFile || (Hash::FNV1a(data.data(), data.size()) != header.checksum)) {
+				printf("pipeline permutation list checksum mismatch, ignoring it\n");
+				return {};
+			}
+			return data;
+		}
+
+		void Prewarm() {
+			assert(VK::Object->CheckMainThread());
+			assert(PipelineConfigInfo::pipelineRenderingInfoStatic != nullptr);
+			FileHeader header{};
+			const std::vector<uint8_t> data = ReadValidatedFile(header);
+			ByteReader fileReader{ data.data(), data.size() };
+
+			uint32_t queued = 0;
+			for (uint32_t i = 0; i < header.recordCount; i++) {
+				std::vector<uint8_t> record{};
+				fileReader.ReadVector(record);
+				if (fileReader.failed) {
+					printf("pipeline permutation list is malformed, stopping the prewarm\n");
+					break;
+				}
+				ByteReader reader{ record.data(), record.size() };
+				PrewarmTask* task = Construct<PrewarmTask>();
+				task->type = reader.Read<PermutationType>();
+
+				std::vector<std::string> shaderPaths{};
+				const uint8_t stageCount = reader.Read<uint8_t>();
+				for (uint8_t stage = 0; (stage < stageCount) && !reader.failed; stage++) {
+					reader.Read<uint8_t>();
+					shaderPaths.push_back(reader.ReadString());
+				}
+				UnpackSpec(reader, task->specInfo);
+				if (task->type == PermutationType::Graphics) {
+					UnpackState(reader, task->configInfo, task->storage);
+				}
+				bool valid = !reader.failed && reader.AtEnd() && (shaderPaths.size() > 0);
+				for (auto const& path : shaderPaths) {
+					valid &= std::filesystem::exists(path);
+				}
+				if (!valid) {
+					Deconstruct(task);
+					continue;
+				}
+				//the layout and the shaders are built here, the shader registry isn't thread safe
+				std::vector<Shader*> shaders{};
+				for (auto const& path : shaderPaths) {
+					shaders.push_back(GetShader(path));
+				}
+				task->layout = Construct<PipeLayout>(shaders);
+				{
+					std::unique_lock<std::mutex> lock{ prewarmMutex };
+					prewarmsInFlight++;
+				}
+				ThreadPool::EnqueueVoid(RunPrewarm, task);
+				queued++;
+			}
+#if EWE_DEBUG
+			printf("prewarming %u pipeline permutations\n", queued);
+#endif
+		}
+
+		static void WriteList() {
+			ByteWriter writer{};
+			for (auto const& record : records) {
+				writer.WriteString(record);
+			}
+			FileHeader header{};
+			header.magic = fileMagic;
+			header.version = fileVersion;
+			header.recordCount = static_cast<uint32_t>(records.size());
+			header.dataSize = writer.bytes.size();
+			header.checksum = Hash::FNV1a(writer.bytes.data(), writer.bytes.size());
+
+			if (!AtomicWriteFile(PIPELINE_PERMUTATION_LIST_PATH, { { &header, sizeof(FileHeader) }, { writer.bytes.data(), writer.bytes.size() } })) {
+				printf("failed to write the pipeline permutation list\n");
+			}
+		}
+
+		void WaitForPrewarm() {
+			std::unique_lock<std::mutex> lock{ prewarmMutex };
+			prewarmCondition.wait(lock, [] { return prewarmsInFlight == 0; });
+		}
+
+		void Destroy() {
+			WaitForPrewarm();
+			std::unique_lock<std::mutex> lock{ mutex };
+			WriteList();
+			for (auto& entry : entries) {
+				EWE_VK(vkDestroyPipeline, VK::Object->vkDevice, entry.second.pipeline, nullptr);
+				if (entry.second.replaced != VK_NULL_HANDLE) {
+					EWE_VK(vkDestroyPipeline, VK::Object->vkDevice, entry.second.replaced, nullptr);
+				}
+			}
+			retired.Flush(DestroyPipeline);
+			entries.clear();
+			pipelineHashes.clear();
+		}
+
+		Stats GetStats() {
+			std::unique_lock<std::mutex> lock{ mutex };
+			Stats ret{};
+			ret.hits = hits;
+			ret.misses = misses;
+			ret.live = static_cast<uint32_t>(entries.size());
+			ret.prewarmed = prewarmed;
+			ret.prewarmHits = prewarmHits;
+			ret.hitRate = (hits + misses) > 0 ? static_cast<float>(hits) / static_cast<float>(hits + misses) : 0.f;
+			return ret;
+		}
+		void PrintStats() {
+			const Stats stats = GetStats();
+			printf("pipeline permutations - hits:misses - %u:%u (%.1f%%), live - %u, prewarmed - %u, prewarm hits - %u\n",
+				stats.hits, stats.misses, stats.hitRate * 100.f,
+				stats.live, stats.prewarmed, stats.prewarmHits
+			);
+		}
+	} //namespace PermutationCache
+} //namespace EWE
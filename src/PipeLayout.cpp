@@ -1,4 +1,6 @@
 #include "EWGraphics/Vulkan/PipeLayout.h"
+#include "EWGraphics/Vulkan/LayoutCache.h"
+#include "EWGraphics/Vulkan/ShaderReflection.h"
 
 #if PIPELINE_HOT_RELOAD
 #include "EWGraphics/imgui/imgui.h"
@@ -9,66 +11,23 @@
 namespace EWE {
 	DescriptorLayoutPack* MergeDescriptorSets(std::array<Shader*, ShaderStage::COUNT> const& shaders) {
 		assert(shaders.size() > 0);
-		auto ret = Construct<DescriptorLayoutPack>();
-
-		uint8_t highestSize = 0;
-		for (auto& shader : shaders) {
-			if (shader == nullptr) {
-				continue;
-			}
-			highestSize = lab::Max(highestSize, static_cast<uint8_t>(shader->descriptorSets->setLayouts.size()));
-		}
-		ret->setLayouts.clear();
-		ret->setLayouts.reserve(highestSize);
 
+		std::vector<ShaderReflection::SetBindings> stageSets{};
 		for (auto& shader : shaders) {
 			if (shader == nullptr) {
 				continue;
 			}
 			for (auto& set : shader->descriptorSets->setLayouts) {
-				bool hasSetMatch = false;
-				for (auto& retSet : ret->setLayouts) {
-					if (retSet.key == set.key) {
-						hasSetMatch = true;
-						auto& retBindings = retSet.value->bindings;
-						auto& shaderBindings = set.value->bindings;
-
-						for (auto& binding : shaderBindings) {
-							bool foundBindingMatch = false;
-							for (auto& retBinding : retBindings) {
-								if (binding.binding == retBinding.binding) {
-									assert(retBinding.descriptorType == binding.descriptorType);
-									retBinding.stageFlags |= binding.stageFlags;
-									foundBindingMatch = true;
-								}
-							}
-							if (!foundBindingMatch) {
-								retBindings.push_back(binding);
-							}
-						}
-						break;
-					}
-				}
-				if (!hasSetMatch) {
-					//this needs to be done so it's not moved, and is instead copied
-					//i could potentially use std::copy to pass it into the constructor as well
-					auto const& constRefBindings = set.value->bindings;
-
-					ret->setLayouts.push_back(set.key, Construct<DescriptorSetLayout>(constRefBindings));
-				}
+				stageSets.push_back(ShaderReflection::SetBindings{ set.key, set.value->bindings, set.value->bindingFlags });
 			}
-		}		
-		std::sort(ret->setLayouts.begin(), ret->setLayouts.end(),
-			[](const KeyValuePair<uint8_t, DescriptorSetLayout*>& a, const KeyValuePair<uint8_t, DescriptorSetLayout*>& b) {
-				return a.key < b.key;
-			}
-		);
+		}
 
-		for (auto& dsl : ret->setLayouts) {
-			assert(dsl.value->bindings.size() > 0);
-			dsl.value->BuildVkDSL();
-			//std::string debug_name = std::string(fileLocation.data()) + std::string(" - dsl#") + std::to_string(dsl.first);
-			//DebugNaming::SetObjectName(dsl.second->vkDSL, VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, debug_name.c_str());
+		auto ret = Construct<DescriptorLayoutPack>();
+		ret->setLayouts.clear();
+		ret->interned = true;
+		for (auto const& set : ShaderReflection::MergeSets(stageSets)) {
+			//identical sets from other pipelines share the layout
+			ret->setLayouts.push_back(set.set, LayoutCache::AcquireDSL(set.bindings, set.bindingFlags));
 		}
 		return ret;
 	}
@@ -108,9 +67,52 @@ namespace EWE {
 				merged.push_back(range);
 			}
 		}
+
+		const uint32_t maxPushSize = VK::Object->properties.limits.maxPushConstantsSize;
+		for (auto& range : merged) {
+			if (((range.offset % 4) != 0) || ((range.size % 4) != 0) || ((range.offset + range.size) > maxPushSize)) {
+				printf("invalid push constant range - offset:size %u:%u, stages %u, device max - %u\n", range.offset, range.size, range.stageFlags, maxPushSize);
+				assert(false && "push constant range is invalid for this device");
+			}
+		}
 		return merged;
 	}
 
+	//splits the ranges at every boundary, so each segment has exactly the stages that overlap it
+	//vkCmdPushConstants needs every stage overlapping the pushed bytes, and every stage given has to cover all of them
+	std::vector<PipeLayout::PushSegment> BuildPushSegments(std::vector<VkPushConstantRange> const& ranges) {
+		std::vector<uint32_t> boundaries{};
+		boundaries.reserve(ranges.size() * 2);
+		for (auto& range : ranges) {
+			boundaries.push_back(range.offset);
+			boundaries.push_back(range.offset + range.size);
+		}
+		std::sort(boundaries.begin(), boundaries.end());
+		boundaries.erase(std::unique(boundaries.begin(), boundaries.end()), boundaries.end());
+
+		std::vector<PipeLayout::PushSegment> segments{};
+		for (std::size_t i = 1; i < boundaries.size(); i++) {
+			const uint32_t begin = boundaries[i - 1];
+			const uint32_t end = boundaries[i];
+			VkShaderStageFlags stageFlags = 0;
+			for (auto& range : ranges) {
+				if ((range.offset < end) && ((range.offset + range.size) > begin)) {
+					stageFlags |= range.stageFlags;
+				}
+			}
+			if (stageFlags == 0) {
+				continue;
+			}
+			if (!segments.empty() && (segments.back().stageFlags == stageFlags) && ((segments.back().offset + segments.back().size) == begin)) {
+				segments.back().size += end - begin;
+			}
+			else {
+				segments.push_back(PipeLayout::PushSegment{ begin, end - begin, stageFlags });
+			}
+		}
+		return segments;
+	}
+
 	PipeLayout::PipeLayout(std::initializer_list<Shader*> shaders, VkAllocationCallbacks* allocCallbacks) {
 		this->shaders.fill(nullptr);
 		for (auto& shader : shaders) {
@@ -121,6 +123,16 @@ namespace EWE {
 		CreateVkPipeLayout(allocCallbacks);
 	}
 
+	PipeLayout::PipeLayout(std::vector<Shader*> const& shaders, VkAllocationCallbacks* allocCallbacks) {
+		this->shaders.fill(nullptr);
+		for (auto& shader : shaders) {
+			this->shaders[ShaderStage(shader->shaderStageCreateInfo.stage).value] = shader;
+		}
+		descriptorSets = MergeDescriptorSets(this->shaders);
+		pushConstantRanges = MergePushRanges(this->shaders);
+		CreateVkPipeLayout(allocCallbacks);
+	}
+
 	PipeLayout::PipeLayout(std::initializer_list<std::string_view> shaderFileLocations, VkAllocationCallbacks* allocCallbacks) {
 		this->shaders.fill(nullptr);
 		for (auto& fileLocation : shaderFileLocations) {
@@ -176,12 +188,8 @@ namespace EWE {
 		}
 
 
-		VkPipelineLayoutCreateInfo plCreateInfo{};
-		plCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-		plCreateInfo.pNext = nullptr;
-		plCreateInfo.flags = 0;
-		plCreateInfo.pushConstantRangeCount = static_cast<uint32_t>(pushConstantRanges.size());
-		plCreateInfo.pPushConstantRanges = pushConstantRanges.data();
+		pushSegments = BuildPushSegments(pushConstantRanges);
+		this->allocCallbacks = allocCallbacks;
 
 		if (VK::Object->globalEmptyDSL == VK_NULL_HANDLE) {
 			VkDescriptorSetLayoutCreateInfo emptyInfo{};
@@ -200,12 +208,37 @@ namespace EWE {
 			layouts[descriptorSets->setLayouts[i].key] = descriptorSets->setLayouts[i].value->vkDSL;
 		}
 
+		if (allocCallbacks == nullptr) {
+			vkLayout = LayoutCache::AcquirePipelineLayout(layouts, pushConstantRanges);
+			return;
+		}
+		//the cache can't share a layout created with different callbacks
+		VkPipelineLayoutCreateInfo plCreateInfo{};
+		plCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		plCreateInfo.pNext = nullptr;
+		plCreateInfo.flags = 0;
+		plCreateInfo.pushConstantRangeCount = static_cast<uint32_t>(pushConstantRanges.size());
+		plCreateInfo.pPushConstantRanges = pushConstantRanges.data();
 		plCreateInfo.setLayoutCount = static_cast<uint32_t>(layouts.size());
 		plCreateInfo.pSetLayouts = layouts.data();
 
 		EWE_VK(vkCreatePipelineLayout, VK::Object->vkDevice, &plCreateInfo, allocCallbacks, &vkLayout);
 	}
 
+	static void ReleaseVkPipeLayout(VkPipelineLayout vkLayout, VkAllocationCallbacks* allocCallbacks) {
+		if (allocCallbacks == nullptr) {
+			LayoutCache::ReleasePipelineLayout(vkLayout);
+		}
+		else {
+			EWE_VK(vkDestroyPipelineLayout, VK::Object->vkDevice, vkLayout, allocCallbacks);
+		}
+	}
+
+	PipeLayout::~PipeLayout() {
+		ReleaseVkPipeLayout(vkLayout, allocCallbacks);
+		Deconstruct(descriptorSets);
+	}
+
 #if PIPELINE_HOT_RELOAD
 	void PipeLayout::HotReload() {
 		for (auto& shader : shaders) {
@@ -213,13 +246,26 @@ namespace EWE {
 				shader->HotReload();
 			}
 		}
-		printf("memory leak here - descriptor sets not freed before recreated\n");
-		//Deconstruct(descriptorSets); //need this to be stored then deleted stale
-		pushConstantRanges.clear();
+		DescriptorLayoutPack* oldSets = descriptorSets;
+		const VkPipelineLayout oldLayout = vkLayout;
 
 		descriptorSets = MergeDescriptorSets(this->shaders);
 		pushConstantRanges = MergePushRanges(this->shaders);
-		CreateVkPipeLayout();
+		CreateVkPipeLayout(allocCallbacks);
+
+		//released after the new ones are acquired, so an unchanged layout is a cache hit instead of being destroyed and created again
+		ReleaseVkPipeLayout(oldLayout, allocCallbacks);
+		Deconstruct(oldSets);
+	}
+
+	void PipeLayout::SwapContents(PipeLayout& other) {
+		std::swap(shaders, other.shaders);
+		std::swap(descriptorSets, other.descriptorSets);
+		std::swap(pushConstantRanges, other.pushConstantRanges);
+		std::swap(pushSegments, other.pushSegments);
+		std::swap(vkLayout, other.vkLayout);
+		std::swap(pipelineType, other.pipelineType);
+		std::swap(allocCallbacks, other.allocCallbacks);
 	}
 
 	void PipeLayout::DrawImgui() {
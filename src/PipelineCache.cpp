@@ -0,0 +1,298 @@
+#include "EWGraphics/Vulkan/PipelineCache.h"
+
+#include "EWGraphics/Data/ThreadPool.h"
+#include "EWGraphics/Data/Hash.h"
+#include "EWGraphics/Data/AtomicFile.h"
+
+#include <fstream>
+#include <filesystem>
+#include <vector>
+#include <cstring>
+#include <type_traits>
+
+#ifndef PIPELINE_CACHE_PATH
+#define PIPELINE_CACHE_PATH "pipeline_cache.bin"
+#endif
+
+namespace EWE {
+	namespace PipelineCache {
+		static constexpr uint32_t fileMagic = 0x43505745; //EWPC
+		static constexpr uint32_t fileVersion = 1;
+
+		//written to disk as is, so there's no implicit padding in it
+		struct FileHeader {
+			uint32_t magic;
+			uint32_t version;
+			uint32_t vendorID;
+			uint32_t deviceID;
+			uint32_t driverVersion;
+			uint8_t pipelineCacheUUID[VK_UUID_SIZE];
+			uint32_t reserved; //aligns dataSize, always 0
+			uint64_t dataSize;
+			uint64_t checksum;
+		};
+		static_assert(sizeof(FileHeader) == 56);
+		static_assert(std::has_unique_object_representations_v<FileHeader>);
+
+		static std::mutex saveMutex{};
+		static std::atomic<bool> saveInProgress{ false };
+		//read from the main thread, written by whichever thread saves
+		static std::atomic<std::chrono::steady_clock::rep> lastSaveTicks{ 0 };
+		static std::size_t lastSavedSize{ 0 };
+
+		static bool warm{ false };
+		static double loadMS{ 0.0 };
+		static std::size_t loadedBytes{ 0 };
+		static std::atomic<uint32_t> pipelinesCreated{ 0 };
+		static std::atomic<uint64_t> totalCreationNS{ 0 };
+		static std::atomic<uint64_t> maxCreationNS{ 0 };
+
+		static DeviceIdentity CurrentDevice() {
+			DeviceIdentity device{};
+			device.vendorID = VK::Object->properties.vendorID;
+			device.deviceID = VK::Object->properties.deviceID;
+			device.driverVersion = VK::Object->properties.driverVersion;
+			memcpy(device.pipelineCacheUUID, VK::Object->properties.pipelineCacheUUID, VK_UUID_SIZE);
+			return device;
+		}
+
+		static FileHeader MakeHeader(DeviceIdentity const& device) {
+			FileHeader header{};
+			header.magic = fileMagic;
+			header.version = fileVersion;
+			header.vendorID = device.vendorID;
+			header.deviceID = device.deviceID;
+			header.driverVersion = device.driverVersion;
+			memcpy(header.pipelineCacheUUID, device.pipelineCacheUUID, VK_UUID_SIZE);
+			header.reserved = 0;
+			return header;
+		}
+
+		std::vector<uint8_t> ReadValidatedFile(std::filesystem::path const& path, DeviceIdentity const& device) {
+			std::ifstream inFile{ path, std::ios::binary | std::ios::ate };
+			if (!inFile.is_open()) {
+				return {};
+			}
+			const std::size_t fileSize = static_cast<std::size_t>(inFile.tellg());
+			if (fileSize < sizeof(FileHeader)) {
+				printf("pipeline cache file is truncated, ignoring it\n");
+				return {};
+			}
+			inFile.seekg(0);
+
+			FileHeader fileHeader{};
+			inFile.read(reinterpret_cast<char*>(&fileHeader), sizeof(FileHeader));
+			const FileHeader current = MakeHeader(device);
+			if ((fileHeader.magic != current.magic) || (fileHeader.version != current.version)) {
+				printf("pipeline cache file has an unknown format, ignoring it\n");
+				return {};
+			}
+			if ((fileHeader.vendorID != current.vendorID) || (fileHeader.deviceID != current.deviceID) || (fileHeader.driverVersion != current.driverVersion)
+				|| (memcmp(fileHeader.pipelineCacheUUID, current.pipelineCacheUUID, VK_UUID_SIZE) != 0)
+				) {
+				printf("pipeline cache was created by a different device or driver, ignoring it\n");
+				return {};
+			}
+			if (fileHeader.dataSize != (fileSize - sizeof(FileHeader))) {
+				printf("pipeline cache size mismatch, ignoring it\n");
+				return {};
+			}
+
+			std::vector<uint8_t> data(fileHeader.dataSize);
+			inFile.read(reinterpret_cast<char*>(data.data()), data.size());
+			if (!inFile || (Hash::FNV1a(data.data(), data.size()) != fileHeader.checksum)) {
+				printf("pipeline cache checksum mismatch, ignoring it\n");
+				return {};
+			}
+
+			//the driver validates its own header as well, but a bad one here is already known to be useless
+			VkPipelineCacheHeaderVersionOne vkHeader{};
+			if (data.size() < sizeof(VkPipelineCacheHeaderVersionOne)) {
+				return {};
+			}
+			memcpy(&vkHeader, data.data(), sizeof(VkPipelineCacheHeaderVersionOne));
+			if ((vkHeader.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE) || (vkHeader.vendorID != current.vendorID) || (vkHeader.deviceID != current.deviceID)
+				|| (memcmp(vkHeader.pipelineCacheUUID, current.pipelineCacheUUID, VK_UUID_SIZE) != 0)
+				) {
+				printf("pipeline cache data header doesn't match the device, ignoring it\n");
+				return {};
+			}
+			return data;
+		}
+
+		void Initialize() {
+			assert(VK::Object->pipelineCache == VK_NULL_HANDLE);
+			const auto loadStart = std::chrono::steady_clock::now();
+
+			std::vector<uint8_t> data = ReadValidatedFile(PIPELINE_CACHE_PATH, CurrentDevice());
+
+			VkPipelineCacheCreateInfo cacheInfo{};
+			cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+			cacheInfo.pNext = nullptr;
+			cacheInfo.flags = 0;
+			cacheInfo.initialDataSize = data.size();
+			cacheInfo.pInitialData = data.size() > 0 ? data.data() : nullptr;
+			VkResult result = vkCreatePipelineCache(VK::Object->vkDevice, &cacheInfo, nullptr, &VK::Object->pipelineCache);
+			if ((result != VK_SUCCESS) && (data.size() > 0)) {
+				//the data passed every check here but the driver still didn't like it. start cold
+				printf("driver rejected the pipeline cache data, starting with an empty cache\n");
+				data.clear();
+				cacheInfo.initialDataSize = 0;
+				cacheInfo.pInitialData = nullptr;
+				result = vkCreatePipelineCache(VK::Object->vkDevice, &cacheInfo, nullptr, &VK::Object->pipelineCache);
+			}
+			EWE_VK_RESULT(result);
+
+			warm = data.size() > 0;
+			loadedBytes = data.size();
+			lastSavedSize = data.size();
+			const auto loadEnd = std::chrono::steady_clock::now();
+			lastSaveTicks.store(loadEnd.time_since_epoch().count(), std::memory_order_relaxed);
+			loadMS = std::chrono::duration<double, std::milli>(loadEnd - loadStart).count();
+#if EWE_DEBUG
+			printf("pipeline cache %s - %zu bytes in %.3f ms\n", warm ? "loaded" : "started cold", loadedBytes, loadMS);
+#endif
+		}
+
+		void Destroy() {
+			//join a periodic save that's still queued or running, it finishes on the pool and notifies
+			saveInProgress.wait(true, std::memory_order_acquire);
+			Save();
+#if EWE_DEBUG
+			PrintStats();
+#endif
+			EWE_VK(vkDestroyPipelineCache, VK::Object->vkDevice, VK::Object->pipelineCache, nullptr);
+			VK::Object->pipelineCache = VK_NULL_HANDLE;
+		}
+
+		bool Save() {
+			std::unique_lock<std::mutex> saveLock(saveMutex);
+			lastSaveTicks.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+
+			std::size_t dataSize = 0;
+			EWE_VK(vkGetPipelineCacheData, VK::Object->vkDevice, VK::Object->pipelineCache, &dataSize, nullptr);
+			if ((dataSize == 0) || (dataSize == lastSavedSize)) {
+				//a cache only grows, the same size means nothing new was added
+				return true;
+			}
+			std::vector<uint8_t> data(dataSize);
+			VkResult result = vkGetPipelineCacheData(VK::Object->vkDevice, VK::Object->pipelineCache, &dataSize, data.data());
+			if (result == VK_INCOMPLETE) {
+				//grew between the two calls, whatever was written is still a valid cache
+				result = VK_SUCCESS;
+			}
+			EWE_VK_RESULT(result);
+			data.resize(dataSize);
+
+			if (!WriteFile(PIPELINE_CACHE_PATH, CurrentDevice(), data.data(), data.size())) {
+				printf("failed to write the pipeline cache\n");
+				return false;
+			}
+			lastSavedSize = data.size();
+			return true;
+		}
+
+		bool WriteFile(std::filesystem::path const& path, DeviceIdentity const& device, const void* data, std::size_t dataSize) {
+			FileHeader header = MakeHeader(device);
+			header.dataSize = dataSize;
+			header.checksum = Hash::FNV1a(data, dataSize);
+			return AtomicWriteFile(path, { { &header, sizeof(FileHeader) }, { data, dataSize } });
+		}
+
+		void SavePeriodically(std::chrono::seconds interval) {
+			const std::chrono::steady_clock::time_point lastSave{ std::chrono::steady_clock::duration(lastSaveTicks.load(std::memory_order_relaxed)) };
+			if ((std::chrono::steady_clock::now() - lastSave) < interval) {
+				return;
+			}
+			bool expected = false;
+			if (!saveInProgress.compare_exchange_strong(expected, true)) {
+				return;
+			}
+			ThreadPool::EnqueueVoid([]() {
+				Save();
+				saveInProgress.store(false, std::memory_order_release);
+				saveInProgress.notify_all();
+			});
+		}
+
+		static thread_local VkPipelineCache threadCache{ VK_NULL_HANDLE };
+
+		VkPipelineCache Get() {
+			return threadCache != VK_NULL_HANDLE ? threadCache : VK::Object->pipelineCache;
+		}
+		void SetThreadCache(VkPipelineCache cache) {
+			threadCache = cache;
+		}
+
+		VkPipelineCache CreateSeededCache() {
+			std::vector<uint8_t> data{};
+			{
+				std::unique_lock<std::mutex> saveLock(saveMutex);
+				std::size_t dataSize = 0;
+				EWE_VK(vkGetPipelineCacheData, VK::Object->vkDevice, VK::Object->pipelineCache, &dataSize, nullptr);
+				data.resize(dataSize);
+				if (dataSize > 0) {
+					VkResult result = vkGetPipelineCacheData(VK::Object->vkDevice, VK::Object->pipelineCache, &dataSize, data.data());
+					if (result == VK_INCOMPLETE) {
+						result = VK_SUCCESS;
+					}
+					EWE_VK_RESULT(result);
+					data.resize(dataSize);
+				}
+			}
+			VkPipelineCacheCreateInfo cacheInfo{};
+			cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+			cacheInfo.pNext = nullptr;
+			cacheInfo.flags = 0;
+			cacheInfo.initialDataSize = data.size();
+			cacheInfo.pInitialData = data.size() > 0 ? data.data() : nullptr;
+			VkPipelineCache ret = VK_NULL_HANDLE;
+			EWE_VK(vkCreatePipelineCache, VK::Object->vkDevice, &cacheInfo, nullptr, &ret);
+			return ret;
+		}
+
+		void MergeAndDestroy(std::vector<VkPipelineCache>& srcCaches) {
+			assert(VK::Object->CheckMainThread());
+			if (srcCaches.size() == 0) {
+				return;
+			}
+			{
+				//the destination of a merge is externally synchronized, this keeps it away from a background save
+				std::unique_lock<std::mutex> saveLock(saveMutex);
+				EWE_VK(vkMergePipelineCaches, VK::Object->vkDevice, VK::Object->pipelineCache, static_cast<uint32_t>(srcCaches.size()), srcCaches.data());
+			}
+			for (auto& cache : srcCaches) {
+				EWE_VK(vkDestroyPipelineCache, VK::Object->vkDevice, cache, nullptr);
+			}
+			srcCaches.clear();
+		}
+
+		void RecordCreation(std::chrono::steady_clock::duration duration) {
+			const uint64_t nanoseconds = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+			pipelinesCreated.fetch_add(1, std::memory_order_relaxed);
+			totalCreationNS.fetch_add(nanoseconds, std::memory_order_relaxed);
+			uint64_t prevMax = maxCreationNS.load(std::memory_order_relaxed);
+			while ((nanoseconds > prevMax) && !maxCreationNS.compare_exchange_weak(prevMax, nanoseconds, std::memory_order_relaxed)) {}
+		}
+
+		Stats GetStats() {
+			Stats ret{};
+			ret.warm = warm;
+			ret.pipelinesCreated = pipelinesCreated.load(std::memory_order_relaxed);
+			ret.totalCreationMS = static_cast<double>(totalCreationNS.load(std::memory_order_relaxed)) / 1000000.0;
+			ret.maxCreationMS = static_cast<double>(maxCreationNS.load(std::memory_order_relaxed)) / 1000000.0;
+			ret.loadMS = loadMS;
+			ret.loadedBytes = loadedBytes;
+			return ret;
+		}
+		void PrintStats() {
+			const Stats stats = GetStats();
+			printf("pipeline cache[%s] - %u pipelines, creation total:max(ms) - %.3f:%.3f, load - %zu bytes in %.3f ms\n",
+				stats.warm ? "warm" : "cold",
+				stats.pipelinesCreated,
+				stats.totalCreationMS, stats.maxCreationMS,
+				stats.loadedBytes, stats.loadMS
+			);
+		}
+	} //namespace PipelineCache
+} //namespace EWE
@@ -0,0 +1,220 @@
+#include "EWGraphics/Vulkan/PipelineCompiler.h"
+
+#include "EWGraphics/Vulkan/PipelineCache.h"
+#include "EWGraphics/Data/ThreadPool.h"
+
+#include <thread>
+
+namespace EWE {
+
+	PipelineBatch::~PipelineBatch() {
+		assert((!compiling || (finishedTasks.load(std::memory_order_acquire) == threadCount)) && "batch destroyed while it was compiling");
+		for (auto& result : results) {
+			if (!result.published && (result.pipeline != nullptr)) {
+				Deconstruct(result.pipeline);
+			}
+		}
+		for (auto& cache : taskCaches) {
+			EWE_VK(vkDestroyPipelineCache, VK::Object->vkDevice, cache, nullptr);
+		}
+	}
+
+	void PipelineBatch::AddGraphics(std::string const& name, PipelineID pipeID, PipeLayout* layout, PipelineConfigInfo& configInfo) {
+		assert(!compiling);
+		graphicsDescs.push_back(GraphicsDesc{ name, pipeID, layout, &configInfo, {} });
+	}
+	void PipelineBatch::AddGraphics(std::string const& name, PipelineID pipeID, PipeLayout* layout, PipelineConfigInfo& configInfo, std::vector<KeyValuePair<ShaderStage, std::vector<Shader::SpecializationEntry>>> const& specInfo) {
+		assert(!compiling);
+		graphicsDescs.push_back(GraphicsDesc{ name, pipeID, layout, &configInfo, specInfo });
+	}
+	void PipelineBatch::AddCompute(std::string const& name, PipelineID pipeID, PipeLayout* layout) {
+		assert(!compiling);
+		computeDescs.push_back(ComputeDesc{ name, pipeID, layout, {} });
+	}
+	void PipelineBatch::AddCompute(std::string const& name, PipelineID pipeID, PipeLayout* layout, std::vector<Shader::SpecializationEntry> const& specInfo) {
+		assert(!compiling);
+		computeDescs.push_back(ComputeDesc{ name, pipeID, layout, specInfo });
+	}
+
+	void PipelineBatch::Compile(uint32_t threadCount, CacheMode cacheMode) {
+		assert(!compiling && "a batch can only be compiled once");
+		compiling = true;
+		this->cacheMode = cacheMode;
+
+		const uint32_t pipelineCount = Size();
+		results = std::vector<Result>(pipelineCount);
+		const uint32_t poolThreads = static_cast<uint32_t>(ThreadPool::GetThreadCount());
+		if ((threadCount == 0) || (threadCount > poolThreads)) {
+			threadCount = poolThreads;
+		}
+		//no point in a task that will never get a pipeline
+		if (threadCount > pipelineCount) {
+			threadCount = pipelineCount;
+		}
+		this->threadCount = threadCount;
+
+		compileStart = std::chrono::steady_clock::now();
+		if (pipelineCount == 0) {
+			return;
+		}
+
+		if (cacheMode == CacheMode::Merged) {
+			for (uint32_t i = 0; i < threadCount; i++) {
+				taskCaches.push_back(PipelineCache::CreateSeededCache());
+			}
+		}
+		else if (cacheMode == CacheMode::Isolated) {
+			VkPipelineCacheCreateInfo cacheInfo{};
+			cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+			cacheInfo.pNext = nullptr;
+			cacheInfo.flags = 0;
+			cacheInfo.initialDataSize = 0;
+			cacheInfo.pInitialData = nullptr;
+			for (uint32_t i = 0; i < threadCount; i++) {
+				VkPipelineCache& cache = taskCaches.emplace_back(VK_NULL_HANDLE);
+				EWE_VK(vkCreatePipelineCache, VK::Object->vkDevice, &cacheInfo, nullptr, &cache);
+			}
+		}
+		for (uint32_t i = 0; i < threadCount; i++) {
+			ThreadPool::EnqueueVoid(&PipelineBatch::RunTask, this, i);
+		}
+	}
+
+	void PipelineBatch::RunTask(uint32_t taskIndex) {
+		if (cacheMode != CacheMode::Shared) {
+			PipelineCache::SetThreadCache(taskCaches[taskIndex]);
+		}
+		const uint32_t pipelineCount = Size();
+		for (uint32_t index = nextIndex.fetch_add(1, std::memory_order_relaxed); index < pipelineCount; index = nextIndex.fetch_add(1, std::memory_order_relaxed)) {
+			CompileIndex(index);
+		}
+		if (cacheMode != CacheMode::Shared) {
+			PipelineCache::SetThreadCache(VK_NULL_HANDLE);
+		}
+		//the last access to the batch, it can be destroyed as soon as every task is past this
+		finishedTasks.fetch_add(1, std::memory_order_release);
+	}
+
+	void PipelineBatch::CompileIndex(uint32_t index) {
+		const auto creationStart = std::chrono::steady_clock::now();
+		Result& result = results[index];
+		if (index < graphicsDescs.size()) {
+			GraphicsDesc& desc = graphicsDescs[index];
+			if (desc.specInfo.size() > 0) {
+				result.pipeline = Construct<GraphicsPipeline>(desc.pipeID, desc.layout, *desc.configInfo, desc.specInfo);
+			}
+			else {
+				result.pipeline = Construct<GraphicsPipeline>(desc.pipeID, desc.layout, *desc.configInfo);
+			}
+		}
+		else {
+			ComputeDesc& desc = computeDescs[index - graphicsDescs.size()];
+			if (desc.specInfo.size() > 0) {
+				result.pipeline = Construct<ComputePipeline>(desc.pipeID, desc.layout, desc.specInfo);
+			}
+			else {
+				result.pipeline = Construct<ComputePipeline>(desc.pipeID, desc.layout);
+			}
+		}
+		const auto creationEnd = std::chrono::steady_clock::now();
+		creationSumNS.fetch_add(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(creationEnd - creationStart).count()), std::memory_order_relaxed);
+
+		result.ready.store(true, std::memory_order_release);
+		if ((finishedCount.fetch_add(1, std::memory_order_acq_rel) + 1) == Size()) {
+			wallNS.store(std::chrono::duration_cast<std::chrono::nanoseconds>(creationEnd - compileStart).count(), std::memory_order_relaxed);
+		}
+	}
+
+	uint32_t PipelineBatch::PublishReady() {
+		assert(VK::Object->CheckMainThread());
+		assert(compiling && "compile the batch before publishing it");
+
+		for (uint32_t i = 0; i < results.size(); i++) {
+			Result& result = results[i];
+			if (result.published || !result.ready.load(std::memory_order_acquire)) {
+				continue;
+			}
+			std::string const& name = i < graphicsDescs.size() ? graphicsDescs[i].name : computeDescs[i - graphicsDescs.size()].name;
+#if DEBUG_NAMING
+			result.pipeline->SetDebugName(name.c_str());
+#endif
+#if PIPELINE_HOT_RELOAD
+			PipelineSystem::Emplace(name, result.pipeline->GetID(), result.pipeline);
+#else
+			PipelineSystem::Emplace(result.pipeline->GetID(), result.pipeline);
+#endif
+			result.published = true;
+			publishedCount++;
+		}
+
+		//the task caches are still in use until every task has exited
+		if ((taskCaches.size() > 0) && (finishedTasks.load(std::memory_order_acquire) == threadCount)) {
+			if (cacheMode == CacheMode::Merged) {
+				PipelineCache::MergeAndDestroy(taskCaches);
+			}
+			else {
+				for (auto& cache : taskCaches) {
+					EWE_VK(vkDestroyPipelineCache, VK::Object->vkDevice, cache, nullptr);
+				}
+				taskCaches.clear();
+			}
+		}
+		return Size() - publishedCount;
+	}
+
+	void PipelineBatch::PublishAll() {
+		PublishReady();
+		//the last task can exit after the last pipeline was published, the merge waits for it
+		while (!Finished()) {
+			std::this_thread::sleep_for(std::chrono::microseconds(100));
+			PublishReady();
+		}
+	}
+
+	PipelineBatch::Stats PipelineBatch::GetStats() const {
+		Stats ret{};
+		ret.pipelineCount = Size();
+		ret.threadCount = threadCount;
+		ret.wallMS = static_cast<double>(wallNS.load(std::memory_order_relaxed)) / 1000000.0;
+		ret.creationSumMS = static_cast<double>(creationSumNS.load(std::memory_order_relaxed)) / 1000000.0;
+		return ret;
+	}
+	void PipelineBatch::PrintStats() const {
+		const Stats stats = GetStats();
+		const char* cacheName = "shared";
+		if (cacheMode == CacheMode::Merged) {
+			cacheName = "merged";
+		}
+		else if (cacheMode == CacheMode::Isolated) {
+			cacheName = "isolated";
+		}
+		printf("pipeline batch[%s cache] - %u pipelines on %u threads, wall - %.3f ms, sum - %.3f ms, speedup - %.2fx\n",
+			cacheName,
+			stats.pipelineCount, stats.threadCount,
+			stats.wallMS, stats.creationSumMS,
+			stats.wallMS > 0.0 ? stats.creationSumMS / stats.wallMS : 0.0
+		);
+	}
+
+	std::vector<PipelineBatch::Stats> PipelineBatch::ThreadSweep(std::function<void(PipelineBatch&)> const& fill, CacheMode cacheMode) {
+		assert(VK::Object->CheckMainThread());
+		const uint32_t poolThreads = static_cast<uint32_t>(ThreadPool::GetThreadCount());
+		std::vector<Stats> ret{};
+		for (uint32_t threads = 1; threads <= poolThreads; threads++) {
+			PipelineBatch batch{};
+			fill(batch);
+			batch.Compile(threads, cacheMode);
+			//every task has to exit before the batch can go, the unpublished pipelines are destroyed with it
+			while (batch.finishedTasks.load(std::memory_order_acquire) != batch.threadCount) {
+				std::this_thread::sleep_for(std::chrono::microseconds(100));
+			}
+			batch.PrintStats();
+			ret.push_back(batch.GetStats());
+			if (batch.threadCount < threads) {
+				//fewer pipelines than threads, more threads can't change anything
+				break;
+			}
+		}
+		return ret;
+	}
+} //namespace EWE
@@ -0,0 +1,493 @@
+#include "EWGraphics/Vulkan/PipelineLibrary.h"
+
+#include "EWGraphics/Vulkan/PermutationCache.h"
+#include "EWGraphics/Vulkan/LayoutCache.h"
+#include "EWGraphics/Vulkan/PipelineCache.h"
+#include "EWGraphics/Data/ByteStream.h"
+#include "EWGraphics/Data/ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <unordered_map>
+
+namespace EWE {
+	namespace PipelineLibrary {
+		struct PartEntry {
+			std::vector<uint8_t> bytes;
+			VkPipeline library;
+			VkPipelineLayout vkLayout; //retained, null for the parts that don't use a layout
+			uint32_t refCount; //permutations linked from it, and optimized links waiting on it
+		};
+
+		static constexpr std::array<VkGraphicsPipelineLibraryFlagsEXT, Part::COUNT> partFlags{
+			VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT,
+			VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT,
+			VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT,
+			VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT,
+		};
+
+		static bool supported{ false };
+
+		static std::mutex mutex{};
+		//the hash only narrows it down, the bytes are compared in full
+		static std::array<std::unordered_multimap<std::size_t, PartEntry>, Part::COUNT> parts{};
+		static std::unordered_map<VkPipeline, std::size_t> libraryHashes{};
+
+		static std::array<uint32_t, Part::COUNT> partHits{};
+		static std::array<uint32_t, Part::COUNT> partMisses{};
+		static uint32_t fastLinks{ 0 };
+		static uint32_t optimizedLinks{ 0 };
+		static double partCompileTotal{ 0.0 };
+		static double fastLinkTotal{ 0.0 };
+		static double fastLinkMax{ 0.0 };
+		static double optimizedLinkTotal{ 0.0 };
+		static uint32_t firstUseSamples{ 0 };
+		static double firstUseFastTotal{ 0.0 };
+		static double firstUseFastMax{ 0.0 };
+		static double firstUseMonolithicTotal{ 0.0 };
+		static double firstUseMonolithicMax{ 0.0 };
+
+		static std::mutex pendingMutex{};
+		static std::condition_variable pendingCondition{};
+		static uint32_t pendingOptimizations{ 0 };
+
+		static double Milliseconds(std::chrono::steady_clock::duration duration) {
+			return std::chrono::duration<double, std::milli>(duration).count();
+		}
+
+		bool Enabled() {
+#if GRAPHICS_PIPELINE_LIBRARY
+			return supported;
+#else
+			return false;
+#endif
+		}
+		void SetSupport(bool extensionSupported, bool fastLinking) {
+			//without fast linking, linking can cost as much as a monolithic compile. nothing to gain
+			supported = extensionSupported && fastLinking;
+#if EWE_DEBUG
+			printf("graphics pipeline library - %s\n", supported ? "enabled" : (extensionSupported ? "no fast linking, disabled" : "not supported"));
+#endif
+		}
+
+		static void PackStage(ByteWriter& writer, ModuleHashes const& moduleHashes, VkPipelineShaderStageCreateInfo const& stage) {
+			const ShaderStage shaderStage{ stage.stage };
+			writer.Write(static_cast<uint8_t>(shaderStage.value));
+			writer.Write(moduleHashes[shaderStage.value]);
+			if (stage.pSpecializationInfo != nullptr) {
+				auto const& spec = *stage.pSpecializationInfo;
+				writer.Write(spec.mapEntryCount);
+				writer.Write(spec.pMapEntries, sizeof(VkSpecializationMapEntry) * spec.mapEntryCount);
+				writer.Write(static_cast<uint64_t>(spec.dataSize));
+				writer.Write(spec.pData, spec.dataSize);
+			}
+			else {
+				writer.Write(uint32_t{ 0 });
+			}
+		}
+		static void PackMultisample(ByteWriter& writer, PipelineConfigInfo const& configInfo) {
+			auto const& multisample = configInfo.multisampleInfo;
+			writer.Write(multisample.rasterizationSamples);
+			writer.Write(multisample.sampleShadingEnable);
+			writer.Write(multisample.minSampleShading);
+			writer.Write(multisample.alphaToCoverageEnable);
+			writer.Write(multisample.alphaToOneEnable);
+			writer.Write(configInfo.sampleMask);
+		}
+
+		//only the state that belongs to the part goes into its key. dynamic states are in every part, they have to match across all of them
+		std::vector<uint8_t> PackPart(Part part, VkPipelineLayout vkLayout, ModuleHashes const& moduleHashes, PipelineConfigInfo const& configInfo, std::vector<VkPipelineShaderStageCreateInfo> const& partStages) {
+			ByteWriter writer{};
+			writer.WriteVector(configInfo.dynamicStateEnables);
+			switch (part) {
+				case Part::VertexInput: {
+					writer.WriteVector(configInfo.bindingDescriptions);
+					writer.WriteVector(configInfo.attributeDescriptions);
+					writer.Write(configInfo.inputAssemblyInfo.topology);
+					writer.Write(configInfo.inputAssemblyInfo.primitiveRestartEnable);
+					break;
+				}
+				case Part::PreRasterization: {
+					writer.Write(vkLayout);
+					for (auto const& stage : partStages) {
+						PackStage(writer, moduleHashes, stage);
+					}
+					writer.Write(configInfo.viewportInfo.viewportCount);
+					writer.Write(configInfo.viewportInfo.scissorCount);
+					auto const& raster = configInfo.rasterizationInfo;
+					writer.Write(raster.depthClampEnable);
+					writer.Write(raster.rasterizerDiscardEnable);
+					writer.Write(raster.polygonMode);
+					writer.Write(raster.cullMode);
+					writer.Write(raster.frontFace);
+					writer.Write(raster.depthBiasEnable);
+					writer.Write(raster.depthBiasConstantFactor);
+					writer.Write(raster.depthBiasClamp);
+					writer.Write(raster.depthBiasSlopeFactor);
+					writer.Write(raster.lineWidth);
+					writer.Write(configInfo.tessCreateInfo.patchControlPoints);
+					writer.Write(configInfo.pipelineRenderingInfo.viewMask);
+					break;
+				}
+				case Part::FragmentShader: {
+					writer.Write(vkLayout);
+					for (auto const& stage : partStages) {
+						PackStage(writer, moduleHashes, stage);
+					}
+					PackMultisample(writer, configInfo);
+					auto const& depthStencil = configInfo.depthStencilInfo;
+					writer.Write(depthStencil.depthTestEnable);
+					writer.Write(depthStencil.depthWriteEnable);
+					writer.Write(depthStencil.depthCompareOp);
+					writer.Write(depthStencil.depthBoundsTestEnable);
+					writer.Write(depthStencil.stencilTestEnable);
+					writer.Write(depthStencil.front);
+					writer.Write(depthStencil.back);
+					writer.Write(depthStencil.minDepthBounds);
+					writer.Write(depthStencil.maxDepthBounds);
+					writer.Write(configInfo.pipelineRenderingInfo.viewMask);
+					break;
+				}
+				case Part::FragmentOutput: {
+					PackMultisample(writer, configInfo);
+					auto const& blend = configInfo.colorBlendInfo;
+					writer.Write(blend.logicOpEnable);
+					writer.Write(blend.logicOp);
+					writer.Write(blend.blendConstants);
+					writer.Write(blend.attachmentCount);
+					writer.Write(blend.pAttachments, sizeof(VkPipelineColorBlendAttachmentState) * blend.attachmentCount);
+					auto const& rendering = configInfo.pipelineRenderingInfo;
+					writer.Write(rendering.viewMask);
+					writer.Write(rendering.colorAttachmentCount);
+					writer.Write(rendering.pColorAttachmentFormats, sizeof(VkFormat) * rendering.colorAttachmentCount);
+					writer.Write(rendering.depthAttachmentFormat);
+					writer.Write(rendering.stencilAttachmentFormat);
+					break;
+				}
+				default: EWE_UNREACHABLE;
+			}
+			return std::move(writer.bytes);
+		}
+
+		static VkPipeline CompilePart(Part part, PipeLayout const& layout, PipelineConfigInfo const& configInfo, std::vector<VkPipelineShaderStageCreateInfo> const& partStages) {
+			VkGraphicsPipelineLibraryCreateInfoEXT libraryInfo{};
+			libraryInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT;
+			libraryInfo.pNext = nullptr;
+			libraryInfo.flags = partFlags[part];
+
+			//viewMask for the shader parts, the formats for the output
+			VkPipelineRenderingCreateInfo renderingInfo = configInfo.pipelineRenderingInfo;
+			renderingInfo.pNext = &libraryInfo;
+
+			VkGraphicsPipelineCreateInfo pipelineInfo{};
+			pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+			pipelineInfo.pNext = (part == Part::VertexInput) ? static_cast<void*>(&libraryInfo) : static_cast<void*>(&renderingInfo);
+			pipelineInfo.flags = VK_PIPELINE_CREATE_LIBRARY_BIT_KHR | VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT;
+			pipelineInfo.pDynamicState = &configInfo.dynamicStateInfo;
+
+			VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
+			VkPipelineMultisampleStateCreateInfo multisampleInfo = configInfo.multisampleInfo;
+			multisampleInfo.pSampleMask = configInfo.sampleMask;
+
+			switch (part) {
+				case Part::VertexInput: {
+					vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+					vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(configInfo.attributeDescriptions.size());
+					vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(configInfo.bindingDescriptions.size());
+					vertexInputInfo.pVertexAttributeDescriptions = configInfo.attributeDescriptions.data();
+					vertexInputInfo.pVertexBindingDescriptions = configInfo.bindingDescriptions.data();
+					pipelineInfo.pVertexInputState = &vertexInputInfo;
+					pipelineInfo.pInputAssemblyState = &configInfo.inputAssemblyInfo;
+					break;
+				}
+				case Part::PreRasterization: {
+					pipelineInfo.stageCount = static_cast<uint32_t>(partStages.size());
+					pipelineInfo.pStages = partStages.data();
+					pipelineInfo.pViewportState = &configInfo.viewportInfo;
+					pipelineInfo.pRasterizationState = &configInfo.rasterizationInfo;
+					if (layout.shaders[ShaderStage::TessControl] != nullptr) {
+						pipelineInfo.pTessellationState = &configInfo.tessCreateInfo;
+					}
+					pipelineInfo.layout = layout.vkLayout;
+					break;
+				}
+				case Part::FragmentShader: {
+					pipelineInfo.stageCount = static_cast<uint32_t>(partStages.size());
+					pipelineInfo.pStages = partStages.data();
+					pipelineInfo.pMultisampleState = &multisampleInfo;
+					pipelineInfo.pDepthStencilState = &configInfo.depthStencilInfo;
+					pipelineInfo.layout = layout.vkLayout;
+					break;
+				}
+				case Part::FragmentOutput: {
+					pipelineInfo.pColorBlendState = &configInfo.colorBlendInfo;
+					pipelineInfo.pMultisampleState = &multisampleInfo;
+					break;
+				}
+				default: EWE_UNREACHABLE;
+			}
+
+			VkPipeline library;
+			EWE_VK(vkCreateGraphicsPipelines, VK::Object->vkDevice, PipelineCache::Get(), 1, &pipelineInfo, nullptr, &library);
+			return library;
+		}
+
+		static VkPipeline AcquirePart(Part part, PipeLayout const& layout, ModuleHashes const& moduleHashes, PipelineConfigInfo const& configInfo, std::vector<VkPipelineShaderStageCreateInfo> const& partStages) {
+			std::vector<uint8_t> bytes = PackPart(part, layout.vkLayout, moduleHashes, configInfo, partStages);
+			const std::size_t hash = std::hash<std::string_view>{}(std::string_view(reinterpret_cast<const char*>(bytes.data()), bytes.size()));
+			{
+				std::unique_lock<std::mutex> lock{ mutex };
+				auto range = parts[part].equal_range(hash);
+				for (auto iter = range.first; iter != range.second; iter++) {
+					if (iter->second.bytes == bytes) {
+						partHits[part]++;
+						iter->second.refCount++;
+						return iter->second.library;
+					}
+				}
+			}
+
+			//compiled outside of the lock, other threads can keep linking
+			const auto compileStart = std::chrono::steady_clock::now();
+			VkPipeline library = CompilePart(part, layout, configInfo, partStages);
+			const auto compileDuration = std::chrono::steady_clock::now() - compileStart;
+			PipelineCache::RecordCreation(compileDuration);
+
+			std::unique_lock<std::mutex> lock{ mutex };
+			auto range = parts[part].equal_range(hash);
+			for (auto iter = range.first; iter != range.second; iter++) {
+				if (iter->second.bytes == bytes) {
+					//compiled on two threads at once
+					EWE_VK(vkDestroyPipeline, VK::Object->vkDevice, library, nullptr);
+					partHits[part]++;
+					iter->second.refCount++;
+					return iter->second.library;
+				}
+			}
+			partMisses[part]++;
+			partCompileTotal += Milliseconds(compileDuration);
+			//the layout handle is part of the key, it can't be destroyed and reused while the library exists
+			VkPipelineLayout retainedLayout = VK_NULL_HANDLE;
+			if ((part == Part::PreRasterization) || (part == Part::FragmentShader)) {
+				retainedLayout = layout.vkLayout;
+				LayoutCache::RetainPipelineLayout(retainedLayout);
+			}
+			parts[part].emplace(hash, PartEntry{ std::move(bytes), library, retainedLayout, 1 });
+			libraryHashes.emplace(library, hash);
+			return library;
+		}
+
+		static void RetainParts(LinkedParts const& linkedParts) {
+			std::unique_lock<std::mutex> lock{ mutex };
+			for (uint8_t i = 0; i < Part::COUNT; i++) {
+				auto range = parts[i].equal_range(libraryHashes.at(linkedParts[i]));
+				for (auto iter = range.first; iter != range.second; iter++) {
+					if (iter->second.library == linkedParts[i]) {
+						iter->second.refCount++;
+						break;
+					}
+				}
+			}
+		}
+
+		//called with the mutex held
+		static void ReleasePart(Part part, VkPipeline library) {
+			auto hashIter = libraryHashes.find(library);
+			if (hashIter == libraryHashes.end()) {
+				//already destroyed by Destroy
+				return;
+			}
+			auto range = parts[part].equal_range(hashIter->second);
+			for (auto iter = range.first; iter != range.second; iter++) {
+				PartEntry& entry = iter->second;
+				if (entry.library != library) {
+					continue;
+				}
+				assert(entry.refCount > 0);
+				entry.refCount--;
+				if (entry.refCount == 0) {
+					//pipelines linked from it don't depend on it
+					EWE_VK(vkDestroyPipeline, VK::Object->vkDevice, entry.library, nullptr);
+					if (entry.vkLayout != VK_NULL_HANDLE) {
+						LayoutCache::ReleasePipelineLayout(entry.vkLayout);
+					}
+					libraryHashes.erase(hashIter);
+					parts[part].erase(iter);
+				}
+				return;
+			}
+			EWE_UNREACHABLE;
+		}
+
+		void ReleaseParts(LinkedParts const& linkedParts) {
+			std::unique_lock<std::mutex> lock{ mutex };
+			for (uint8_t i = 0; i < Part::COUNT; i++) {
+				if (linkedParts[i] != VK_NULL_HANDLE) {
+					ReleasePart(static_cast<Part>(i), linkedParts[i]);
+				}
+			}
+		}
+
+		static VkPipeline Link(LinkedParts const& libraries, VkPipelineLayout vkLayout, bool optimized) {
+			VkPipelineLibraryCreateInfoKHR linkInfo{};
+			linkInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR;
+			linkInfo.pNext = nullptr;
+			linkInfo.libraryCount = static_cast<uint32_t>(libraries.size());
+			linkInfo.pLibraries = libraries.data();
+
+			VkGraphicsPipelineCreateInfo pipelineInfo{};
+			pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+			pipelineInfo.pNext = &linkInfo;
+			pipelineInfo.flags = optimized ? VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT : 0;
+			pipelineInfo.layout = vkLayout;
+
+			VkPipeline pipeline;
+			EWE_VK(vkCreateGraphicsPipelines, VK::Object->vkDevice, PipelineCache::Get(), 1, &pipelineInfo, nullptr, &pipeline);
+			return pipeline;
+		}
+
+		VkPipeline FastLink(PipeLayout const& layout, PipelineConfigInfo const& configInfo, std::vector<VkPipelineShaderStageCreateInfo> const& stages, LinkedParts& outParts) {
+			//mesh pipelines don't have a vertex input part. layouts with their own allocation callbacks can't be retained
+			if (!Enabled() || (layout.pipelineType != PipelineType::Vertex) || (layout.allocCallbacks != nullptr)) {
+				return VK_NULL_HANDLE;
+			}
+
+			ModuleHashes moduleHashes{};
+			std::vector<VkPipelineShaderStageCreateInfo> preRasterStages{};
+			std::vector<VkPipelineShaderStageCreateInfo> fragmentStages{};
+			for (auto const& stage : stages) {
+				const ShaderStage shaderStage{ stage.stage };
+				moduleHashes[shaderStage.value] = layout.shaders[shaderStage.value]->moduleHash;
+				if (stage.stage == VK_SHADER_STAGE_FRAGMENT_BIT) {
+					fragmentStages.push_back(stage);
+				}
+				else {
+					preRasterStages.push_back(stage);
+				}
+			}
+
+			outParts[Part::VertexInput] = AcquirePart(Part::VertexInput, layout, moduleHashes, configInfo, {});
+			outParts[Part::PreRasterization] = AcquirePart(Part::PreRasterization, layout, moduleHashes, configInfo, preRasterStages);
+			outParts[Part::FragmentShader] = AcquirePart(Part::FragmentShader, layout, moduleHashes, configInfo, fragmentStages);
+			outParts[Part::FragmentOutput] = AcquirePart(Part::FragmentOutput, layout, moduleHashes, configInfo, {});
+
+			const auto linkStart = std::chrono::steady_clock::now();
+			VkPipeline pipeline = Link(outParts, layout.vkLayout, false);
+			const double linkTime = Milliseconds(std::chrono::steady_clock::now() - linkStart);
+
+			std::unique_lock<std::mutex> lock{ mutex };
+			fastLinks++;
+			fastLinkTotal += linkTime;
+			if (linkTime > fastLinkMax) {
+				fastLinkMax = linkTime;
+			}
+			return pipeline;
+		}
+
+		static void OptimizedLinkTask(LinkedParts parts, VkPipelineLayout vkLayout, VkPipeline fastPipeline) {
+			const auto linkStart = std::chrono::steady_clock::now();
+			VkPipeline optimized = Link(parts, vkLayout, true);
+			const auto linkDuration = std::chrono::steady_clock::now() - linkStart;
+			PipelineCache::RecordCreation(linkDuration);
+			LayoutCache::ReleasePipelineLayout(vkLayout);
+			ReleaseParts(parts);
+
+			PermutationCache::Upgrade(fastPipeline, optimized);
+			{
+				std::unique_lock<std::mutex> lock{ mutex };
+				optimizedLinks++;
+				optimizedLinkTotal += Milliseconds(linkDuration);
+			}
+
+			std::unique_lock<std::mutex> lock{ pendingMutex };
+			pendingOptimizations--;
+			pendingCondition.notify_all();
+		}
+
+		void RecordFirstUse(double fastLinkMS, double monolithicMS) {
+			std::unique_lock<std::mutex> lock{ mutex };
+			firstUseSamples++;
+			firstUseFastTotal += fastLinkMS;
+			firstUseFastMax = std::max(firstUseFastMax, fastLinkMS);
+			firstUseMonolithicTotal += monolithicMS;
+			firstUseMonolithicMax = std::max(firstUseMonolithicMax, monolithicMS);
+		}
+
+		void QueueOptimizedLink(LinkedParts const& parts, VkPipelineLayout vkLayout, VkPipeline fastPipeline) {
+			//the PipeLayout, or every permutation linked from the parts, could be destroyed before the task runs
+			LayoutCache::RetainPipelineLayout(vkLayout);
+			RetainParts(parts);
+			{
+				std::unique_lock<std::mutex> lock{ pendingMutex };
+				pendingOptimizations++;
+			}
+			ThreadPool::EnqueueVoid(OptimizedLinkTask, parts, vkLayout, fastPipeline);
+		}
+
+		void Destroy() {
+			{
+				std::unique_lock<std::mutex> lock{ pendingMutex };
+				pendingCondition.wait(lock, [] { return pendingOptimizations == 0; });
+			}
+			std::unique_lock<std::mutex> lock{ mutex };
+			for (auto& partMap : parts) {
+				for (auto& entry : partMap) {
+					EWE_VK(vkDestroyPipeline, VK::Object->vkDevice, entry.second.library, nullptr);
+					if (entry.second.vkLayout != VK_NULL_HANDLE) {
+						LayoutCache::ReleasePipelineLayout(entry.second.vkLayout);
+					}
+				}
+				partMap.clear();
+			}
+			libraryHashes.clear();
+		}
+
+		Stats GetStats() {
+			Stats ret{};
+			{
+				std::unique_lock<std::mutex> lock{ pendingMutex };
+				ret.pendingOptimizations = pendingOptimizations;
+			}
+			std::unique_lock<std::mutex> lock{ mutex };
+			uint32_t totalMisses = 0;
+			for (uint8_t i = 0; i < Part::COUNT; i++) {
+				ret.partHits[i] = partHits[i];
+				ret.partMisses[i] = partMisses[i];
+				totalMisses += partMisses[i];
+			}
+			ret.fastLinks = fastLinks;
+			ret.optimizedLinks = optimizedLinks;
+			ret.partCompileMean = totalMisses > 0 ? partCompileTotal / totalMisses : 0.0;
+			ret.fastLinkMean = fastLinks > 0 ? fastLinkTotal / fastLinks : 0.0;
+			ret.fastLinkMax = fastLinkMax;
+			ret.optimizedLinkMean = optimizedLinks > 0 ? optimizedLinkTotal / optimizedLinks : 0.0;
+			ret.firstUseSamples = firstUseSamples;
+			ret.firstUseFastMean = firstUseSamples > 0 ? firstUseFastTotal / firstUseSamples : 0.0;
+			ret.firstUseFastMax = firstUseFastMax;
+			ret.firstUseMonolithicMean = firstUseSamples > 0 ? firstUseMonolithicTotal / firstUseSamples : 0.0;
+			ret.firstUseMonolithicMax = firstUseMonolithicMax;
+			return ret;
+		}
+		void PrintStats() {
+			const Stats stats = GetStats();
+			printf("pipeline libraries - part hits:compiles - vertex input %u:%u, pre-raster %u:%u, fragment %u:%u, output %u:%u\n",
+				stats.partHits[Part::VertexInput], stats.partMisses[Part::VertexInput],
+				stats.partHits[Part::PreRasterization], stats.partMisses[Part::PreRasterization],
+				stats.partHits[Part::FragmentShader], stats.partMisses[Part::FragmentShader],
+				stats.partHits[Part::FragmentOutput], stats.partMisses[Part::FragmentOutput]
+			);
+			printf("\tpart compile mean - %.3fms, fast links - %u (mean %.3fms, max %.3fms), optimized links - %u (mean %.3fms), pending - %u\n",
+				stats.partCompileMean, stats.fastLinks, stats.fastLinkMean, stats.fastLinkMax,
+				stats.optimizedLinks, stats.optimizedLinkMean, stats.pendingOptimizations
+			);
+			if (stats.firstUseSamples > 0) {
+				printf("\tfirst use over %u permutations - fast link mean %.3fms (max %.3fms), monolithic mean %.3fms (max %.3fms)\n",
+					stats.firstUseSamples, stats.firstUseFastMean, stats.firstUseFastMax,
+					stats.firstUseMonolithicMean, stats.firstUseMonolithicMax
+				);
+			}
+		}
+	} //namespace PipelineLibrary
+} //namespace EWE
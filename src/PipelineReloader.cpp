@@ -0,0 +1,451 @@
+#include "EWGraphics/Vulkan/PipelineReloader.h"
+
+#if PIPELINE_HOT_RELOAD
+#include "EWGraphics/Vulkan/GraphicsPipeline.h"
+#include "EWGraphics/Vulkan/ComputePipeline.h"
+#include "EWGraphics/Vulkan/PermutationCache.h"
+#include "EWGraphics/Data/ThreadPool.h"
+#include "EWGraphics/Data/RetireQueue.h"
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+namespace EWE {
+	namespace PipelineReloader {
+		using Clock = std::chrono::steady_clock;
+		//editors write a file in more than one step
+		static constexpr auto debounceTime = std::chrono::milliseconds(150);
+
+		struct ShaderRebuild {
+			Shader* live;
+			Shader* rebuilt{ nullptr };
+		};
+		struct PipelineRebuild {
+			PipelineSystem::Handle handle;
+			bool compute;
+			std::vector<Shader*> liveShaders{};
+			std::vector<KeyValuePair<ShaderStage, std::vector<Shader::SpecializationEntry>>> specInfo{};
+			PipelineConfigInfo* configInfo{ nullptr };
+			PipeLayout* rebuiltLayout{ nullptr };
+			Pipeline* rebuilt{ nullptr };
+		};
+		struct Batch {
+			std::vector<ShaderRebuild> shaders{};
+			std::vector<PipelineRebuild> pipelines{};
+			bool failed{ false };
+		};
+
+		struct Retired {
+			VkPipeline pipeline{ VK_NULL_HANDLE };
+			//always one the reloader built, holding a live layout's old contents. the PipeLayouts users pass in are never destroyed here
+			PipeLayout* layout{ nullptr };
+			Shader* shader{ nullptr };
+		};
+
+		static std::mutex watchMutex{};
+		//absolute path -> the path the shader was loaded with
+		static std::unordered_map<std::string, std::string> watchedFiles{};
+		static std::unordered_set<std::string> changedFiles{};
+		static Clock::time_point lastChange{};
+
+		static std::thread watchThread{};
+		static std::atomic<bool> stopWatching{ false };
+#if defined(__linux__)
+		static int inotifyFD{ -1 };
+		static std::unordered_map<std::string, int> watchedDirectories{};
+		static std::unordered_map<int, std::string> watchDescriptors{};
+#else
+		static std::unordered_map<std::string, std::filesystem::file_time_type> writeTimes{};
+#endif
+
+		static std::mutex batchMutex{};
+		static Batch* inFlight{ nullptr };
+		static bool batchFinished{ false };
+
+		//main thread only
+		static RetireQueue<Retired> retired{ MAX_FRAMES_IN_FLIGHT };
+
+		static std::string AbsolutePath(std::string_view filepath) {
+			std::error_code errorCode{};
+			std::filesystem::path absolute = std::filesystem::absolute(filepath, errorCode);
+			if (errorCode) {
+				return std::string(filepath);
+			}
+			return absolute.lexically_normal().string();
+		}
+
+		//watchMutex is held
+		static void MarkChanged(std::string const& absolutePath) {
+			if (watchedFiles.contains(absolutePath)) {
+				changedFiles.insert(absolutePath);
+				lastChange = Clock::now();
+			}
+		}
+
+#if defined(__linux__)
+		//watchMutex is held
+		static void AddDirectoryWatch(std::string const& absolutePath) {
+			if (inotifyFD < 0) {
+				return;
+			}
+			const std::string directory = std::filesystem::path(absolutePath).parent_path().string();
+			if (watchedDirectories.contains(directory)) {
+				return;
+			}
+			//close_write for in place saves, moved_to for editors that write a temp file and rename it
+			const int descriptor = inotify_add_watch(inotifyFD, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+			if (descriptor < 0) {
+				printf("failed to watch shader directory : %s\n", directory.c_str());
+				return;
+			}
+			watchedDirectories.emplace(directory, descriptor);
+			watchDescriptors.emplace(descriptor, directory);
+		}
+
+		static void WatchLoop() {
+			alignas(inotify_event) char buffer[4096];
+			pollfd pollDesc{};
+			pollDesc.fd = inotifyFD;
+			pollDesc.events = POLLIN;
+			while (!stopWatching.load(std::memory_order_relaxed)) {
+				//timeout so the stop flag is seen
+				if (poll(&pollDesc, 1, 100) <= 0) {
+					continue;
+				}
+				const ssize_t length = read(inotifyFD, buffer, sizeof(buffer));
+				if (length <= 0) {
+					continue;
+				}
+				std::unique_lock<std::mutex> lock{ watchMutex };
+				for (ssize_t offset = 0; offset < length;) {
+					const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+					offset += sizeof(inotify_event) + event->len;
+					if (event->len == 0) {
+						continue;
+					}
+					auto dirFind = watchDescriptors.find(event->wd);
+					if (dirFind != watchDescriptors.end()) {
+						MarkChanged((std::filesystem::path(dirFind->second) / event->name).lexically_normal().string());
+					}
+				}
+			}
+		}
+#else
+		static void WatchLoop() {
+			while (!stopWatching.load(std::memory_order_relaxed)) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(250));
+				std::unique_lock<std::mutex> lock{ watchMutex };
+				for (auto& writeTime : writeTimes) {
+					std::error_code errorCode{};
+					const auto currentTime = std::filesystem::last_write_time(writeTime.first, errorCode);
+					if (!errorCode && (currentTime != writeTime.second)) {
+						writeTime.second = currentTime;
+						MarkChanged(writeTime.first);
+					}
+				}
+			}
+		}
+#endif
+
+		void Initialize() {
+			assert(VK::Object->CheckMainThread());
+			std::unique_lock<std::mutex> lock{ watchMutex };
+#if defined(__linux__)
+			inotifyFD = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+			if (inotifyFD < 0) {
+				printf("inotify unavailable, shaders won't be hot reloaded\n");
+				return;
+			}
+			//shaders loaded before initialization
+			for (auto const& watched : watchedFiles) {
+				AddDirectoryWatch(watched.first);
+			}
+#endif
+			stopWatching = false;
+			watchThread = std::thread(WatchLoop);
+		}
+
+		void Watch(std::string_view filepath) {
+			std::string absolutePath = AbsolutePath(filepath);
+			std::unique_lock<std::mutex> lock{ watchMutex };
+			if (watchedFiles.contains(absolutePath)) {
+				return;
+			}
+#if defined(__linux__)
+			AddDirectoryWatch(absolutePath);
+#else
+			std::error_code errorCode{};
+			writeTimes.emplace(absolutePath, std::filesystem::last_write_time(absolutePath, errorCode));
+#endif
+			watchedFiles.emplace(std::move(absolutePath), std::string(filepath));
+		}
+
+		static bool ReadSpirv(std::string const& filepath, std::vector<uint32_t>& outCode) {
+			std::ifstream shaderFile{ filepath, std::ios::binary | std::ios::ate };
+			if (!shaderFile.is_open()) {
+				return false;
+			}
+			const std::size_t fileSize = static_cast<std::size_t>(shaderFile.tellg());
+			//header is 5 words, the first one is the magic number
+			if ((fileSize < sizeof(uint32_t) * 5) || ((fileSize % sizeof(uint32_t)) != 0)) {
+				return false;
+			}
+			outCode.resize(fileSize / sizeof(uint32_t));
+			shaderFile.seekg(0);
+			shaderFile.read(reinterpret_cast<char*>(outCode.data()), fileSize);
+			return shaderFile.good() && (outCode[0] == 0x07230203);
+		}
+
+		static void RebuildTask(Batch* batch) {
+			for (auto& shaderRebuild : batch->shaders) {
+				std::vector<uint32_t> code{};
+				if (!ReadSpirv(shaderRebuild.live->filepath, code)) {
+					printf("hot reload - %s isn't valid spirv, skipping the reload\n", shaderRebuild.live->filepath.c_str());
+					batch->failed = true;
+					break;
+				}
+				//not registered with the shader map, its contents are swapped into the live shader later
+				shaderRebuild.rebuilt = Construct<Shader>(shaderRebuild.live->filepath, code.size() * sizeof(uint32_t), code.data());
+			}
+			if (!batch->failed) {
+				for (auto& pipeRebuild : batch->pipelines) {
+					std::vector<Shader*> shaders = pipeRebuild.liveShaders;
+					for (auto& shader : shaders) {
+						for (auto const& shaderRebuild : batch->shaders) {
+							if (shader == shaderRebuild.live) {
+								shader = shaderRebuild.rebuilt;
+							}
+						}
+					}
+					pipeRebuild.rebuiltLayout = Construct<PipeLayout>(shaders);
+					if (pipeRebuild.compute) {
+						std::vector<Shader::SpecializationEntry> computeSpec{};
+						if (pipeRebuild.specInfo.size() > 0) {
+							computeSpec = pipeRebuild.specInfo[0].value;
+						}
+						pipeRebuild.rebuilt = Construct<ComputePipeline>(pipeRebuild.handle.id, pipeRebuild.rebuiltLayout, computeSpec);
+					}
+					else {
+						pipeRebuild.rebuilt = Construct<GraphicsPipeline>(pipeRebuild.handle.id, pipeRebuild.rebuiltLayout, *pipeRebuild.configInfo, pipeRebuild.specInfo);
+					}
+				}
+			}
+			std::unique_lock<std::mutex> lock{ batchMutex };
+			batchFinished = true;
+		}
+
+		static void DeconstructPipeline(PipelineRebuild& pipeRebuild) {
+			if (pipeRebuild.compute) {
+				Deconstruct(static_cast<ComputePipeline*>(pipeRebuild.rebuilt));
+			}
+			else {
+				Deconstruct(static_cast<GraphicsPipeline*>(pipeRebuild.rebuilt));
+			}
+		}
+
+		//everything the batch built that wasn't swapped in is destroyed, nothing live references it
+		static void DiscardBatch(Batch* batch) {
+			for (auto& pipeRebuild : batch->pipelines) {
+				if (pipeRebuild.rebuilt != nullptr) {
+					DeconstructPipeline(pipeRebuild);
+				}
+				if (pipeRebuild.rebuiltLayout != nullptr) {
+					Deconstruct(pipeRebuild.rebuiltLayout);
+				}
+				if (pipeRebuild.configInfo != nullptr) {
+					Deconstruct(pipeRebuild.configInfo);
+				}
+			}
+			for (auto& shaderRebuild : batch->shaders) {
+				if (shaderRebuild.rebuilt != nullptr) {
+					Deconstruct(shaderRebuild.rebuilt);
+				}
+			}
+			Deconstruct(batch);
+		}
+
+		static void SwapBatch(Batch* batch) {
+			const std::size_t frame = VK::Object->totalFrameCount;
+			//the live Shader pointers stay valid, anything that holds them sees the new module
+			for (auto& shaderRebuild : batch->shaders) {
+				shaderRebuild.live->SwapContents(*shaderRebuild.rebuilt);
+				retired.Push(Retired{ VK_NULL_HANDLE, nullptr, shaderRebuild.rebuilt }, frame);
+				shaderRebuild.rebuilt = nullptr;
+			}
+			//pipelines can share a PipeLayout, it only takes new contents once
+			std::unordered_set<PipeLayout*> swappedLayouts{};
+			for (auto& pipeRebuild : batch->pipelines) {
+				if (!PipelineSystem::IsValid(pipeRebuild.handle)) {
+					//destroyed while the rebuild was running
+					continue;
+				}
+				Pipeline* live = PipelineSystem::At(pipeRebuild.handle);
+				PipeLayout* liveLayout = live->pipeLayout;
+				PipeLayout* rebuiltLayout = pipeRebuild.rebuiltLayout;
+				//the rebuilt shaders hold the old modules now
+				for (uint8_t i = 0; i < rebuiltLayout->shaders.size(); i++) {
+					for (auto const& shaderRebuild : batch->shaders) {
+						if (liveLayout->shaders[i] == shaderRebuild.live) {
+							rebuiltLayout->shaders[i] = shaderRebuild.live;
+						}
+					}
+				}
+				//interned, an unchanged layout comes back as the same handle and only the pipeline is replaced
+				if ((rebuiltLayout->vkLayout != liveLayout->vkLayout) && swappedLayouts.insert(liveLayout).second) {
+					//the user's PipeLayout keeps its address and takes the new contents, the old ones are retired in the rebuilt object
+					liveLayout->SwapContents(*rebuiltLayout);
+					retired.Push(Retired{ VK_NULL_HANDLE, rebuiltLayout, nullptr }, frame);
+					pipeRebuild.rebuiltLayout = nullptr;
+					printf("hot reload - pipeline %u's layout changed, descriptor sets allocated from the old layout have to be recreated\n", pipeRebuild.handle.id);
+				}
+				retired.Push(Retired{ live->vkPipe, nullptr, nullptr }, frame);
+				live->vkPipe = pipeRebuild.rebuilt->vkPipe;
+				pipeRebuild.rebuilt->vkPipe = VK_NULL_HANDLE;
+				printf("hot reloaded pipeline %u\n", pipeRebuild.handle.id);
+			}
+		}
+
+		static void Dispatch() {
+			std::vector<std::string> paths{};
+			{
+				std::unique_lock<std::mutex> lock{ watchMutex };
+				if (changedFiles.empty() || ((Clock::now() - lastChange) < debounceTime)) {
+					return;
+				}
+				for (auto const& changed : changedFiles) {
+					paths.push_back(watchedFiles.at(changed));
+				}
+				changedFiles.clear();
+			}
+
+			Batch* batch = Construct<Batch>();
+			std::unordered_set<PipelineID> pipelineIDs{};
+			std::vector<PipelineSystem::Handle> handles{};
+			for (auto const& path : paths) {
+				Shader* live = FindShader(path);
+				if (live == nullptr) {
+					continue;
+				}
+				batch->shaders.push_back(ShaderRebuild{ live });
+				for (auto const& handle : PipelineSystem::GetPipelinesUsing(live)) {
+					if (pipelineIDs.insert(handle.id).second) {
+						handles.push_back(handle);
+					}
+				}
+			}
+			//copied here, the rebuild can't read state the main thread is editing
+			for (auto const& handle : handles) {
+				Pipeline* live = PipelineSystem::At(handle);
+				PipelineRebuild& pipeRebuild = batch->pipelines.emplace_back();
+				pipeRebuild.handle = handle;
+				pipeRebuild.specInfo = live->copySpecInfo;
+				for (auto* shader : live->pipeLayout->shaders) {
+					if (shader != nullptr) {
+						pipeRebuild.liveShaders.push_back(shader);
+					}
+				}
+				pipeRebuild.compute = PipelineSystem::KindAt(handle.id) == PipelineSystem::Kind::Compute;
+				if (!pipeRebuild.compute) {
+					pipeRebuild.configInfo = Construct<PipelineConfigInfo>(static_cast<GraphicsPipeline*>(live)->copyConfigInfo);
+				}
+			}
+			if (batch->shaders.empty()) {
+				Deconstruct(batch);
+				return;
+			}
+			{
+				std::unique_lock<std::mutex> lock{ batchMutex };
+				inFlight = batch;
+				batchFinished = false;
+			}
+			ThreadPool::EnqueueVoid(RebuildTask, batch);
+		}
+
+		static void DestroyRetired(Retired& retiredObject) {
+			if (retiredObject.pipeline != VK_NULL_HANDLE) {
+				PermutationCache::Release(retiredObject.pipeline);
+			}
+			if (retiredObject.layout != nullptr) {
+				Deconstruct(retiredObject.layout);
+			}
+			if (retiredObject.shader != nullptr) {
+				Deconstruct(retiredObject.shader);
+			}
+		}
+
+		void Update() {
+			assert(VK::Object->CheckMainThread());
+			Batch* finished = nullptr;
+			{
+				std::unique_lock<std::mutex> lock{ batchMutex };
+				if (inFlight != nullptr && batchFinished) {
+					finished = inFlight;
+					inFlight = nullptr;
+				}
+			}
+			if (finished != nullptr) {
+				if (!finished->failed) {
+					SwapBatch(finished);
+				}
+				DiscardBatch(finished);
+			}
+			//one batch at a time, changes that come in meanwhile go in the next one
+			bool idle;
+			{
+				std::unique_lock<std::mutex> lock{ batchMutex };
+				idle = inFlight == nullptr;
+			}
+			if (idle) {
+				Dispatch();
+			}
+
+			//a frame recorded before the swap could still be in flight
+			retired.Collect(VK::Object->totalFrameCount, DestroyRetired);
+		}
+
+		void Destroy() {
+			assert(VK::Object->CheckMainThread());
+			stopWatching = true;
+			if (watchThread.joinable()) {
+				watchThread.join();
+			}
+#if defined(__linux__)
+			if (inotifyFD >= 0) {
+				close(inotifyFD);
+				inotifyFD = -1;
+			}
+			watchedDirectories.clear();
+			watchDescriptors.clear();
+#endif
+			//wait out a rebuild that's still running
+			while (true) {
+				{
+					std::unique_lock<std::mutex> lock{ batchMutex };
+					if ((inFlight == nullptr) || batchFinished) {
+						break;
+					}
+				}
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+			if (inFlight != nullptr) {
+				DiscardBatch(inFlight);
+				inFlight = nullptr;
+			}
+			//the device is idle by the time the framework is torn down
+			retired.Flush(DestroyRetired);
+		}
+	} //namespace PipelineReloader
+} //namespace EWE
+#endif
@@ -2,13 +2,18 @@
 
 
 #include "EWGraphics/Texture/Image_Manager.h"
+#include "EWGraphics/Vulkan/PermutationCache.h"
+#include "EWGraphics/Vulkan/GraphicsPipeline.h"
+#include "EWGraphics/Vulkan/ComputePipeline.h"
+#include "EWGraphics/Data/FlatRegistry.h"
 
 #if PIPELINE_HOT_RELOAD
 #include "EWGraphics/imgui/imgui.h"
-#include "EWGraphics/Vulkan/GraphicsPipeline.h"
-#include "EWGraphics/Vulkan/ComputePipeline.h"
 #endif
 
+#include <mutex>
+#include <stdexcept>
+
 namespace EWE {
 
 
@@ -36,6 +41,17 @@ namespace EWE {
 		copySpecInfo{ specInfo }
 	{}
 
+	Pipeline::~Pipeline() {
+		if (vkPipe != VK_NULL_HANDLE) {
+			PermutationCache::Release(vkPipe);
+		}
+#if PIPELINE_HOT_RELOAD
+		if (stalePipeline != VK_NULL_HANDLE) {
+			PermutationCache::Release(stalePipeline);
+		}
+#endif
+	}
+
 
 	void Pipeline::BindDescriptor(uint8_t descSlot, VkDescriptorSet* descSet) {
 		EWE_VK(vkCmdBindDescriptorSets, VK::Object->GetFrameBuffer(),
@@ -48,6 +64,12 @@ namespace EWE {
 	}
 
 	void Pipeline::BindPipeline() {
+		//a fast linked pipeline is swapped for the optimized one once it's ready
+		const uint32_t currentGeneration = PermutationCache::GetUpgradeGeneration();
+		if (upgradeGeneration != currentGeneration) {
+			vkPipe = PermutationCache::Refresh(vkPipe);
+			upgradeGeneration = currentGeneration;
+		}
 		EWE_VK(vkCmdBindPipeline, VK::Object->GetFrameBuffer(), BindPointFromType(pipeLayout->pipelineType), vkPipe);
 	}
 	void Pipeline::BindPipelineWithVPScissor() {
@@ -57,7 +79,34 @@ namespace EWE {
 	}
 	void Pipeline::Push(void* push, uint8_t pushIndex) {
 		auto& range = pipeLayout->pushConstantRanges[pushIndex];
-		EWE_VK(vkCmdPushConstants, VK::Object->GetFrameBuffer(), pipeLayout->vkLayout, range.stageFlags, range.offset, range.size, push);
+		//if another range overlaps this one, it's split up
+		PushRange(range.offset, range.size, push);
+	}
+	void Pipeline::Push(ShaderStage stage, const void* push) {
+		const VkShaderStageFlags stageBit = static_cast<VkShaderStageFlagBits>(stage);
+		for (auto& range : pipeLayout->pushConstantRanges) {
+			if (range.stageFlags & stageBit) {
+				PushRange(range.offset, range.size, push);
+				return;
+			}
+		}
+		EWE_UNREACHABLE;
+	}
+	void Pipeline::PushRange(uint32_t offset, uint32_t size, const void* push) {
+		assert(((offset % 4) == 0) && ((size % 4) == 0));
+		const uint32_t end = offset + size;
+		for (auto& segment : pipeLayout->pushSegments) {
+			const uint32_t segmentEnd = segment.offset + segment.size;
+			if (segmentEnd <= offset) {
+				continue;
+			}
+			if (segment.offset >= end) {
+				break;
+			}
+			const uint32_t pushBegin = lab::Max(segment.offset, offset);
+			const uint32_t pushEnd = segmentEnd < end ? segmentEnd : end;
+			EWE_VK(vkCmdPushConstants, VK::Object->GetFrameBuffer(), pipeLayout->vkLayout, segment.stageFlags, pushBegin, pushEnd - pushBegin, reinterpret_cast<const uint8_t*>(push) + (pushBegin - offset));
+		}
 	}
 
 #if DEBUG_NAMING
@@ -68,42 +117,111 @@ namespace EWE {
 #endif
 
 	namespace PipelineSystem {
-		std::unordered_map<PipelineID, ::EWE::Pipeline*> pipelineMap{};
-		std::unordered_map<PipelineID, std::string> pipelineNames{};
+		struct Entry {
+			Pipeline* pipeline{ nullptr };
+			Kind kind{ Kind::Graphics };
+#if PIPELINE_HOT_RELOAD
+			std::string name{};
+#endif
+		};
+		static FlatRegistry<PipelineID, Entry, PIPELINE_REGISTRY_CAPACITY> registry{};
+		static std::mutex registryMutex{};
 
 		Pipeline* At(PipelineID pipeID) {
-			auto foundPipe = pipelineMap.find(pipeID);
-			assert(foundPipe != pipelineMap.end());
-			return foundPipe->second;
+			return registry.At(pipeID).pipeline;
 		}
-		void Emplace(std::string const& pipeName, PipelineID pipeID, Pipeline* pipe) {
-			assert(!pipelineMap.contains(pipeID));
-			pipelineMap.emplace(pipeID, pipe);
-			pipelineNames.emplace(pipeID, pipeName);
+		Pipeline* At(Handle handle) {
+			assert(IsValid(handle) && "stale pipeline handle");
+			return registry.At(handle.id).pipeline;
+		}
+		Pipeline* OptionalAt(PipelineID pipeID) {
+			Entry* entry = registry.Get(pipeID);
+			return entry != nullptr ? entry->pipeline : nullptr;
+		}
+		bool IsValid(Handle handle) {
+			return registry.IsValid(handle.id, handle.generation);
+		}
+		Handle GetHandle(PipelineID pipeID) {
+			assert(registry.Contains(pipeID));
+			return Handle{ pipeID, registry.Generation(pipeID) };
+		}
+		Kind KindAt(PipelineID pipeID) {
+			return registry.At(pipeID).kind;
 		}
-		bool OptionalDestructAt(PipelineID pipeID) {
-			auto foundPipe = pipelineMap.find(pipeID);
 
-			if (foundPipe != pipelineMap.end()) {
-				Deconstruct(foundPipe->second);
-				pipelineMap.erase(foundPipe);
-				return true;
+		static Handle Register(PipelineID pipeID, Pipeline* pipe) {
+			//every other access trusts the ID, this is the one place it's checked in release
+			if (pipeID >= PIPELINE_REGISTRY_CAPACITY) {
+				printf("pipeline ID %u is past PIPELINE_REGISTRY_CAPACITY (%u), define it higher\n", static_cast<uint32_t>(pipeID), static_cast<uint32_t>(PIPELINE_REGISTRY_CAPACITY));
+				throw std::out_of_range("pipeline ID is past PIPELINE_REGISTRY_CAPACITY");
 			}
-			return false;
+			assert(pipe != nullptr);
+			Entry entry{};
+			entry.pipeline = pipe;
+			entry.kind = (pipe->pipeLayout->pipelineType == PipelineType::Compute) ? Kind::Compute : Kind::Graphics;
+			return Handle{ pipeID, registry.Insert(pipeID, entry) };
 		}
-		void DestructAt(PipelineID pipeID) {
+
 #if PIPELINE_HOT_RELOAD
-			pipelineNames.erase(pipeID);
+		Handle Emplace(std::string const& pipeName, PipelineID pipeID, Pipeline* pipe) {
+			std::unique_lock<std::mutex> lock{ registryMutex };
+			const Handle ret = Register(pipeID, pipe);
+			registry.At(pipeID).name = pipeName;
+			return ret;
+		}
+
+		std::vector<Handle> GetPipelinesUsing(Shader const* shader) {
+			std::unique_lock<std::mutex> lock{ registryMutex };
+			std::vector<Handle> ret{};
+			for (PipelineID pipeID : registry.LiveIDs()) {
+				for (auto* pipeShader : registry.At(pipeID).pipeline->pipeLayout->shaders) {
+					if (pipeShader == shader) {
+						ret.push_back(Handle{ pipeID, registry.Generation(pipeID) });
+						break;
+					}
+				}
+			}
+			return ret;
+		}
+#else
+		Handle Emplace(PipelineID pipeID, Pipeline* pipe) {
+			std::unique_lock<std::mutex> lock{ registryMutex };
+			return Register(pipeID, pipe);
+		}
 #endif
-			assert(OptionalDestructAt(pipeID));
+
+		//the registry mutex is held
+		static void DestructEntry(Entry const& entry) {
+			//the base has no virtual destructor
+			if (entry.kind == Kind::Compute) {
+				Deconstruct(static_cast<ComputePipeline*>(entry.pipeline));
+			}
+			else {
+				Deconstruct(static_cast<GraphicsPipeline*>(entry.pipeline));
+			}
+		}
+
+		bool OptionalDestructAt(PipelineID pipeID) {
+			std::unique_lock<std::mutex> lock{ registryMutex };
+			Entry* entry = registry.Get(pipeID);
+			if (entry == nullptr) {
+				return false;
+			}
+			DestructEntry(*entry);
+			registry.Erase(pipeID);
+			return true;
+		}
+		void DestructAt(PipelineID pipeID) {
+			[[maybe_unused]] const bool destructed = OptionalDestructAt(pipeID);
+			assert(destructed);
 		}
 
 		void DestructAll() {
-			for (auto& pipe : pipelineMap) {
-				Deconstruct(pipe.second);
+			std::unique_lock<std::mutex> lock{ registryMutex };
+			for (PipelineID pipeID : registry.LiveIDs()) {
+				DestructEntry(registry.At(pipeID));
 			}
-			pipelineMap.clear();
-			pipelineNames.clear();
+			registry.Clear();
 		}
 
 
@@ -111,17 +229,19 @@ namespace EWE {
 		void DrawImgui() {
 
 			if (ImGui::TreeNode("Pipelines")) {
-				for (auto& pipePair : pipelineMap) {
-					auto& pipe = pipePair.second;
-					auto* graphicsPipe = dynamic_cast<GraphicsPipeline*>(pipe);
-					auto* computePipe = dynamic_cast<ComputePipeline*>(pipe);
+				//held for the whole draw, a pipeline can be destroyed from another thread. nothing below registers or destroys
+				std::unique_lock<std::mutex> lock{ registryMutex };
+				for (PipelineID pipeID : registry.LiveIDs()) {
+					Entry& entry = registry.At(pipeID);
+					auto* pipe = entry.pipeline;
+					auto* graphicsPipe = entry.kind == Kind::Graphics ? static_cast<GraphicsPipeline*>(pipe) : nullptr;
 				
 					std::string extension{};
-					auto& pipeName = pipelineNames.at(pipePair.first);
+					auto& pipeName = entry.name;
 					//for (auto& pipeName : pipelineNames) {
 
 						extension = "##ps";
-						extension += std::to_string(pipePair.first);
+						extension += std::to_string(pipeID);
 						ImGui::Checkbox(extension.c_str(), &pipe->enabled);
 						ImGui::SameLine();
 						if (ImGui::TreeNode(pipeName.c_str())) {
@@ -131,7 +251,7 @@ namespace EWE {
 								printf("ticking stale pipeline for destruction - %d : %s\n", pipe->framesSinceSwap, pipeName.c_str());
 								if (pipe->framesSinceSwap > (MAX_FRAMES_IN_FLIGHT * 2 + 1)) {
 									//if (pipe->pipe->framesSinceSwap > 200) {
-									EWE_VK(vkDestroyPipeline, VK::Object->vkDevice, pipe->stalePipeline, nullptr);
+									PermutationCache::Release(pipe->stalePipeline);
 
 									printf("destroying stale pipeline, sleeping\n");
 									//std::this_thread::sleep_for(std::chrono::seconds(2));
@@ -143,7 +263,7 @@ namespace EWE {
 								pipe->pipeLayout->DrawImgui();
 
 								extension = "reload layout##ps";
-								extension += std::to_string(pipePair.first);
+								extension += std::to_string(pipeID);
 								if (ImGui::Button(extension.c_str())) {
 									//holdingReloadPipe = pipe->pipe;
 									//pipe->pipe = Construct<EWEPipeline>({ holdingReloadPipe->copyStringStruct, holdingReloadPipe->copyConfigInfo });
@@ -152,7 +272,7 @@ namespace EWE {
 								}
 
 								extension = "specialization info##ps";
-								extension += std::to_string(pipePair.first);
+								extension += std::to_string(pipeID);
 								if (ImGui::TreeNode(extension.c_str())) {
 									for (auto& stage : pipe->copySpecInfo) {
 										ImGui::Text("%s - %d", magic_enum::enum_name(stage.key.value).data(), stage.value.size());
@@ -204,7 +324,7 @@ namespace EWE {
 								}
 
 								extension = "reload pipeline only##ps";
-								extension += std::to_string(pipePair.first);
+								extension += std::to_string(pipeID);
 								if (ImGui::Button(extension.c_str())) {
 									pipe->HotReload(false);
 								}
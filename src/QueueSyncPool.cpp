@@ -5,6 +5,7 @@
 #include "EWGraphics/Texture/ImageFunctions.h"
 
 #include <sstream>
+#include <stdexcept>
 
 namespace EWE {
 
@@ -106,62 +107,87 @@ namespace EWE {
             EWE_VK(vkDestroySemaphore, VK::Object->vkDevice, renderFinishedSemaphore[i], nullptr);
         }
     }
-    void RenderSyncData::AddWaitSemaphore(Semaphore* semaphore, VkPipelineStageFlags waitDstStageMask) {
+    void RenderSemaphoreLists::AddWaitSemaphore(Semaphore* semaphore, VkPipelineStageFlags waitDstStageMask) {
         waitMutex.lock();
+        if (waitData.count >= RENDER_SYNC_CAPACITY) {
+            //every semaphore already fits, this is the same one added twice, or a new source of semaphores that isn't counted
+            waitMutex.unlock();
+            printf("too many wait semaphores in a single frame - %u\n", static_cast<uint32_t>(RENDER_SYNC_CAPACITY));
+            throw std::runtime_error("render sync wait capacity exceeded");
+        }
         semaphore->BeginWaiting();
-        waitData.semaphores.push_back(semaphore);
-        waitData.waitDstMask.push_back(waitDstStageMask);
+        waitData.semaphores[waitData.count] = semaphore;
+        waitData.waitDstMask[waitData.count] = waitDstStageMask;
+        waitData.count++;
         waitMutex.unlock();
     }
-    void RenderSyncData::AddSignalSemaphore(Semaphore* semaphore) {
+    void RenderSemaphoreLists::AddSignalSemaphore(Semaphore* semaphore) {
         signalMutex.lock();
-        signalSemaphores.push_back(semaphore);
+        if (signalData.count >= RENDER_SYNC_CAPACITY) {
+            signalMutex.unlock();
+            printf("too many signal semaphores in a single frame - %u\n", static_cast<uint32_t>(RENDER_SYNC_CAPACITY));
+            throw std::runtime_error("render sync signal capacity exceeded");
+        }
+        signalData.semaphores[signalData.count] = semaphore;
+        signalData.count++;
         signalMutex.unlock();
     }
-    void RenderSyncData::SetWaitData(VkSubmitInfo& submitInfo) {
+    void RenderSemaphoreLists::SetWaitData(VkSubmitInfo& submitInfo, uint8_t frameIndex, VkSemaphore frameSemaphore) {
+        WaitData& previous = previousWait[frameIndex];
         waitMutex.lock();
-        for (auto& waitSem : previousWait[VK::Object->frameIndex].semaphores) {
-            waitSem->FinishWaiting();
+        for (uint16_t i = 0; i < previous.count; i++) {
+            previous.semaphores[i]->FinishWaiting();
         }
-        previousWait[VK::Object->frameIndex].semaphores.clear();
-        previousWait[VK::Object->frameIndex].waitDstMask.clear();
-        previousWait[VK::Object->frameIndex].semaphoreData.clear();
-        previousWait[VK::Object->frameIndex] = waitData; //i think this makes the above clears repetitive, but im not sure
-        waitData.semaphores.clear();
-        waitData.waitDstMask.clear();
-        waitData.semaphoreData.clear();
-
-        assert(previousWait[VK::Object->frameIndex].semaphores.size() == previousWait[VK::Object->frameIndex].waitDstMask.size());
-
-        for (auto& waitSem : previousWait[VK::Object->frameIndex].semaphores) {
-            previousWait[VK::Object->frameIndex].semaphoreData.push_back(waitSem->vkSemaphore);
+
+        previous.count = waitData.count;
+        for (uint16_t i = 0; i < waitData.count; i++) {
+            previous.semaphores[i] = waitData.semaphores[i];
+            previous.waitDstMask[i] = waitData.waitDstMask[i];
+            previous.semaphoreData[i] = waitData.semaphores[i]->vkSemaphore;
         }
-        previousWait[VK::Object->frameIndex].semaphoreData.push_back(imageAvailableSemaphore[VK::Object->frameIndex]);
-        previousWait[VK::Object->frameIndex].waitDstMask.push_back(VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+        waitData.count = 0;
+        waitMutex.unlock();
 
-        submitInfo.pWaitDstStageMask = previousWait[VK::Object->frameIndex].waitDstMask.data();
-        submitInfo.waitSemaphoreCount = static_cast<uint32_t>(previousWait[VK::Object->frameIndex].semaphoreData.size());
-        submitInfo.pWaitSemaphores = previousWait[VK::Object->frameIndex].semaphoreData.data();
+        previous.semaphoreData[previous.count] = frameSemaphore;
+        previous.waitDstMask[previous.count] = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
 
+        submitInfo.pWaitDstStageMask = previous.waitDstMask.data();
+        submitInfo.waitSemaphoreCount = static_cast<uint32_t>(previous.count) + 1;
+        submitInfo.pWaitSemaphores = previous.semaphoreData.data();
+    }
+    void RenderSemaphoreLists::ReleasePreviousFrames() {
+        waitMutex.lock();
+        for (uint8_t frame = 0; frame < MAX_FRAMES_IN_FLIGHT; frame++) {
+            WaitData& previous = previousWait[frame];
+            for (uint16_t i = 0; i < previous.count; i++) {
+                previous.semaphores[i]->FinishWaiting();
+            }
+            previous.count = 0;
+            previousSignals[frame].count = 0;
+        }
         waitMutex.unlock();
     }
-    std::vector<VkSemaphore> RenderSyncData::GetSignalData() {
+    void RenderSemaphoreLists::SetSignalData(VkSubmitInfo& submitInfo, uint8_t frameIndex, VkSemaphore frameSemaphore) {
+        SignalData& previous = previousSignals[frameIndex];
         signalMutex.lock();
-        //for (auto& sigSem : previousSignals[VK::Object->frameIndex]) {
-            //sigSem->FinishSignaling();
-        //}
-        previousSignals[VK::Object->frameIndex].clear();
-        previousSignals[VK::Object->frameIndex] = signalSemaphores;
-        signalSemaphores.clear();
-
-        std::vector<VkSemaphore> ret{};
-        ret.reserve(previousSignals[VK::Object->frameIndex].size() + 1);
-        for (auto& sigSem : previousSignals[VK::Object->frameIndex]) {
-            ret.push_back(sigSem->vkSemaphore);
+        previous.count = signalData.count;
+        for (uint16_t i = 0; i < signalData.count; i++) {
+            previous.semaphores[i] = signalData.semaphores[i];
+            previous.semaphoreData[i] = signalData.semaphores[i]->vkSemaphore;
         }
-        ret.push_back(renderFinishedSemaphore[VK::Object->frameIndex]);
+        signalData.count = 0;
         signalMutex.unlock();
-        return ret;
+
+        previous.semaphoreData[previous.count] = frameSemaphore;
+
+        submitInfo.signalSemaphoreCount = static_cast<uint32_t>(previous.count) + 1;
+        submitInfo.pSignalSemaphores = previous.semaphoreData.data();
+    }
+    void RenderSyncData::SetWaitData(VkSubmitInfo& submitInfo) {
+        SetWaitData(submitInfo, VK::Object->frameIndex, imageAvailableSemaphore[VK::Object->frameIndex]);
+    }
+    void RenderSyncData::SetSignalData(VkSubmitInfo& submitInfo) {
+        SetSignalData(submitInfo, VK::Object->frameIndex, renderFinishedSemaphore[VK::Object->frameIndex]);
     }
 
 
@@ -179,6 +205,7 @@ namespace EWE {
         //cmdBufs{}
     {
         //assert(size <= 64 && "this isn't optimized very well, don't use big size"); //big size probably also isn't necessary
+        assert(size <= QUEUE_SYNC_POOL_SIZE && "RenderSyncData is sized for QUEUE_SYNC_POOL_SIZE");
 
         VkFenceCreateInfo fenceInfo{};
         fenceInfo.flags = 0;
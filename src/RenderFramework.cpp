@@ -3,6 +3,12 @@
 #include "EWGraphics/Vulkan/Device_Buffer.h"
 
 #include "EWGraphics/Vulkan/GraphicsPipeline.h"
+#include "EWGraphics/Vulkan/PermutationCache.h"
+#include "EWGraphics/Vulkan/PipelineLibrary.h"
+#include "EWGraphics/Vulkan/PipelineReloader.h"
+#include "EWGraphics/Texture/BindlessTextures.h"
+#include "EWGraphics/Vulkan/TransientDescriptors.h"
+#include "EWGraphics/Vulkan/DescriptorSetCache.h"
 
 namespace EWE {
 
@@ -32,6 +38,11 @@ namespace EWE {
 		printf("after finishing construction of engine\n");
 #endif
 		PipelineConfigInfo::pipelineRenderingInfoStatic = eweRenderer.getPipelineInfo();
+		PermutationCache::Prewarm();
+		BindlessTextures::Initialize();
+#if PIPELINE_HOT_RELOAD
+		PipelineReloader::Initialize();
+#endif
 #if EWE_DEBUG
 		printf("eight winds constructor, ENGINE_VERSION: %s \n", EWF_VERSION);
 #endif
@@ -45,13 +56,23 @@ namespace EWE {
 
 	RenderFramework::~RenderFramework() {
 
+#if PIPELINE_HOT_RELOAD
+		PipelineReloader::Destroy();
+#endif
 		PipelineSystem::DestructAll();
 
 		Deconstruct(leafSystem);
+		//prewarming can still be queueing optimized links
+		PermutationCache::WaitForPrewarm();
+		PipelineLibrary::Destroy();
+		PermutationCache::Destroy();
 #if DECONSTRUCTION_DEBUG
 		printf("beginning of RenderFramework deconstructor \n");
 #endif
 
+		TransientDescriptors::Destroy();
+		DescriptorSetCache::Destroy();
+		BindlessTextures::Destroy();
 		imageManager.Cleanup();
 
 #if DECONSTRUCTION_DEBUG
@@ -60,6 +81,23 @@ namespace EWE {
 	}
 
 
+	void RenderFramework::PublishLoadingPipelines(bool blocking) {
+		PipelineBatch* batch = loadingPipelines.load(std::memory_order_acquire);
+		if (batch == nullptr) {
+			return;
+		}
+		if (blocking) {
+			batch->PublishAll();
+		}
+		else if ((batch->PublishReady() > 0) || !batch->Finished()) {
+			return;
+		}
+#if EWE_DEBUG
+		batch->PrintStats();
+#endif
+		loadingPipelines.store(nullptr, std::memory_order_release);
+	}
+
 	void RenderFramework::LoadingScreen() {
 #if EWE_DEBUG
 		printf("BEGINNING LEAF RENDER ~~~~~~~~~~~~~~~~ \n");
@@ -119,11 +157,13 @@ namespace EWE {
 					}
 				}
 
+				PublishLoadingPipelines(false);
 				renderThreadTime = 0.0;
 				//printf("end rendering thread \n");
 			}
 			//printf("end of render thread loop \n");
 		}
+		PublishLoadingPipelines(true);
 		finishedLoadingScreen = true;
 #if EWE_DEBUG
 		printf(" ~~~~ END OF LOADING SCREEN FUNCTION \n");
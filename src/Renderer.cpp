@@ -1,6 +1,13 @@
 #include "EWGraphics/Vulkan/Renderer.h"
 
 #include <EWGraphics/Vulkan/Descriptors.h>
+#include "EWGraphics/Vulkan/PipelineCache.h"
+#include "EWGraphics/Vulkan/PermutationCache.h"
+#include "EWGraphics/Vulkan/PipelineReloader.h"
+#include "EWGraphics/Texture/BindlessTextures.h"
+#include "EWGraphics/Vulkan/TransientDescriptors.h"
+#include "EWGraphics/Vulkan/DescriptorSetCache.h"
+#include "EWGraphics/Vulkan/DescriptorBuffer.h"
 
 #include <array>
 #include <stdexcept>
@@ -72,6 +79,12 @@ namespace EWE {
 	bool EWERenderer::BeginFrame() {
 		assert(!isFrameStarted && "cannot call begin frame while frame is in progress!");
 
+		//the fence wait is done here, timed, so the wait in AcquireNextImage returns immediately
+		framePacer.BeginFrame();
+		//this frame's transient descriptor pools can be reset now
+		TransientDescriptors::BeginFrame();
+		DescriptorBuffer::BeginFrame();
+
 		//std::cout << "begin frame 1" << std::endl;
 		if (eweSwapChain->AcquireNextImage(&currentImageIndex)) {
 #if EWE_DEBUG
@@ -93,6 +106,7 @@ namespace EWE {
 #if DEBUG_NAMING
 		DebugNaming::SetObjectName(VK::Object->GetVKCommandBufferDirect(), VK_OBJECT_TYPE_COMMAND_BUFFER, "graphics cmd buffer");
 #endif
+		SyncHub::GetSyncHubInstance()->AcquireUploads();
 
 		return true;
 	}
@@ -106,14 +120,27 @@ namespace EWE {
 			mainWindow.ResetWindowResizedFlag();
 			RecreateSwapChain();
 			isFrameStarted = false;
-			VK::Object->frameIndex = (VK::Object->frameIndex + 1) % MAX_FRAMES_IN_FLIGHT;
+			VK::Object->frameIndex = (VK::Object->frameIndex + 1) % VK::Object->framesInFlight;
 			return true;
 		}
 		EWE_VK_RESULT(vkResult);
 		//printf("after submitting command buffer \n");
 
 		isFrameStarted = false;
-		VK::Object->frameIndex = (VK::Object->frameIndex + 1) % MAX_FRAMES_IN_FLIGHT;
+		VK::Object->frameIndex = (VK::Object->frameIndex + 1) % VK::Object->framesInFlight;
+		//pipelines compiled since the last save aren't lost if the process doesn't shut down cleanly
+		PipelineCache::SavePeriodically();
+		//fast linked pipelines that were swapped for optimized ones, once they're out of flight
+		PermutationCache::Update();
+		//textures uploaded since the last frame, and slots from removed images that are out of flight
+		BindlessTextures::Update();
+		//sets evicted by destroyed resources, once they're out of flight
+		DescriptorSetCache::Update();
+		DescriptorBuffer::Update();
+#if PIPELINE_HOT_RELOAD
+		//rebuilt pipelines are swapped in here, between frames
+		PipelineReloader::Update();
+#endif
 
 		return false;
 	}
@@ -128,7 +155,7 @@ namespace EWE {
 			RecreateSwapChain();
 			SyncHub::GetSyncHubInstance()->WaitOnGraphicsFence();
 			isFrameStarted = false;
-			VK::Object->frameIndex = (VK::Object->frameIndex + 1) % MAX_FRAMES_IN_FLIGHT;
+			VK::Object->frameIndex = (VK::Object->frameIndex + 1) % VK::Object->framesInFlight;
 			return true;
 		}
 		EWE_VK_RESULT(vkResult);
@@ -136,7 +163,7 @@ namespace EWE {
 		SyncHub::GetSyncHubInstance()->WaitOnGraphicsFence();
 
 		isFrameStarted = false;
-		VK::Object->frameIndex = (VK::Object->frameIndex + 1) % MAX_FRAMES_IN_FLIGHT;
+		VK::Object->frameIndex = (VK::Object->frameIndex + 1) % VK::Object->framesInFlight;
 
 		return false;
 	}
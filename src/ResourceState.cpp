@@ -0,0 +1,160 @@
+#include "EWGraphics/Vulkan/ResourceState.h"
+
+#include "EWGraphics/Vulkan/Device_Buffer.h"
+#include "EWGraphics/Texture/ImageFunctions.h"
+
+#include <type_traits>
+
+namespace EWE {
+
+	static void RecordBarrier(CommandBuffer& cmdBuf, VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage, VkImageMemoryBarrier const& barrier) {
+		EWE_VK(vkCmdPipelineBarrier, cmdBuf,
+			srcStage, dstStage,
+			0,
+			0, nullptr,
+			0, nullptr,
+			1, &barrier
+		);
+	}
+	static void RecordBarrier(CommandBuffer& cmdBuf, VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage, VkBufferMemoryBarrier const& barrier) {
+		EWE_VK(vkCmdPipelineBarrier, cmdBuf,
+			srcStage, dstStage,
+			0,
+			0, nullptr,
+			1, &barrier,
+			0, nullptr
+		);
+	}
+
+	template<typename BarrierType>
+	void OwnershipTransition<BarrierType>::RecordRelease(CommandBuffer& cmdBuf) const {
+		if (release) {
+			RecordBarrier(cmdBuf, releaseSrcStage, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, releaseBarrier);
+		}
+	}
+	template<typename BarrierType>
+	void OwnershipTransition<BarrierType>::RecordAcquire(CommandBuffer& cmdBuf) const {
+		if (acquire) {
+			RecordBarrier(cmdBuf, acquireSrcStage, acquireDstStage, acquireBarrier);
+		}
+	}
+	template struct OwnershipTransition<VkImageMemoryBarrier>;
+	template struct OwnershipTransition<VkBufferMemoryBarrier>;
+
+	namespace ResourceTracker {
+
+		template<typename BarrierType>
+		OwnershipTransition<BarrierType> ComputeTransition(ResourceState& state, ResourceUsage const& usage, uint32_t dstFamily, bool discardContents, BarrierType const& resourceBarrier) {
+			constexpr bool tracksLayout = std::is_same_v<BarrierType, VkImageMemoryBarrier>;
+
+			OwnershipTransition<BarrierType> ret{};
+			const bool unowned = state.queueFamily == VK_QUEUE_FAMILY_IGNORED;
+			const bool familyChange = !unowned && (state.queueFamily != dstFamily);
+			const VkImageLayout oldLayout = discardContents ? VK_IMAGE_LAYOUT_UNDEFINED : state.layout;
+			const VkImageLayout newLayout = tracksLayout ? usage.layout : VK_IMAGE_LAYOUT_UNDEFINED;
+
+			const VkAccessFlags previousWrites = state.access & writeAccessMask;
+			const bool nextWrites = (usage.access & writeAccessMask) != 0;
+			//read after write, or write after anything
+			const bool hazard = (previousWrites != 0) || (nextWrites && (state.access != 0));
+
+			BarrierType barrier = resourceBarrier;
+			if constexpr (tracksLayout) {
+				barrier.oldLayout = oldLayout;
+				barrier.newLayout = newLayout;
+			}
+
+			if (familyChange && !discardContents) {
+				//the contents need to survive the move to another family
+				barrier.srcQueueFamilyIndex = state.queueFamily;
+				barrier.dstQueueFamilyIndex = dstFamily;
+
+				ret.release = true;
+				ret.releaseBarrier = barrier;
+				ret.releaseBarrier.srcAccessMask = previousWrites;
+				ret.releaseBarrier.dstAccessMask = 0;
+				ret.releaseSrcStage = state.stage;
+
+				ret.acquire = true;
+				ret.acquireBarrier = barrier;
+				ret.acquireBarrier.srcAccessMask = 0;
+				ret.acquireBarrier.dstAccessMask = usage.access;
+				//the semaphore wait covers the execution dependency on the release
+				ret.acquireSrcStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+				ret.acquireDstStage = usage.stage;
+			}
+			else {
+				//work on another family is ordered by the semaphore, work on this family needs the barrier to wait on it
+				const bool sameFamilyHazard = !unowned && !familyChange && hazard;
+				const bool layoutChange = tracksLayout && (oldLayout != newLayout);
+				if (!layoutChange && !sameFamilyHazard) {
+					//reading again, or the first use of a buffer. nothing to record
+					if (!unowned && !familyChange && !nextWrites) {
+						//keep the earlier readers around, a later write has to wait on all of them
+						state.access |= usage.access;
+						state.stage |= usage.stage;
+					}
+					else {
+						state.access = usage.access;
+						state.stage = usage.stage;
+					}
+					state.queueFamily = dstFamily;
+					state.layout = newLayout;
+					return ret;
+				}
+				barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+
+				ret.acquire = true;
+				ret.acquireBarrier = barrier;
+				if (unowned || familyChange) {
+					ret.acquireBarrier.srcAccessMask = 0;
+					ret.acquireSrcStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+				}
+				else {
+					ret.acquireBarrier.srcAccessMask = previousWrites;
+					ret.acquireSrcStage = state.stage;
+				}
+				ret.acquireBarrier.dstAccessMask = usage.access;
+				ret.acquireDstStage = usage.stage;
+			}
+
+			state.queueFamily = dstFamily;
+			state.layout = newLayout;
+			state.access = usage.access;
+			state.stage = usage.stage;
+			return ret;
+		}
+		template ImageTransition ComputeTransition(ResourceState& state, ResourceUsage const& usage, uint32_t dstFamily, bool discardContents, VkImageMemoryBarrier const& resourceBarrier);
+		template BufferTransition ComputeTransition(ResourceState& state, ResourceUsage const& usage, uint32_t dstFamily, bool discardContents, VkBufferMemoryBarrier const& resourceBarrier);
+
+		ImageTransition Transition(ImageInfo& imageInfo, ResourceUsage const& usage, bool discardContents) {
+			VkImageMemoryBarrier resourceBarrier{};
+			resourceBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			resourceBarrier.pNext = nullptr;
+			resourceBarrier.image = imageInfo.image;
+			resourceBarrier.subresourceRange = Image::CreateSubresourceRange(imageInfo);
+			return ComputeTransition(imageInfo.state, usage, VK::Object->queueIndex[usage.queue], discardContents, resourceBarrier);
+		}
+
+		BufferTransition Transition(EWEBuffer& buffer, ResourceUsage const& usage, bool discardContents) {
+			VkBufferMemoryBarrier resourceBarrier{};
+			resourceBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+			resourceBarrier.pNext = nullptr;
+			resourceBarrier.buffer = buffer.GetBuffer();
+			resourceBarrier.offset = 0;
+			resourceBarrier.size = VK_WHOLE_SIZE;
+			return ComputeTransition(buffer.GetState(), usage, VK::Object->queueIndex[usage.queue], discardContents, resourceBarrier);
+		}
+
+		void SetState(ResourceState& state, ResourceUsage const& usage) {
+			SetState(state, usage, VK::Object->queueIndex[usage.queue]);
+		}
+		void SetState(ResourceState& state, ResourceUsage const& usage, uint32_t queueFamily) {
+			state.queueFamily = queueFamily;
+			state.layout = usage.layout;
+			state.access = usage.access;
+			state.stage = usage.stage;
+		}
+	} //namespace ResourceTracker
+} //namespace EWE
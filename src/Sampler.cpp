@@ -1,4 +1,5 @@
 #include "EWGraphics/Vulkan/VulkanHeader.h"
+#include "EWGraphics/Vulkan/DescriptorSetCache.h"
 
 #include <vector>
 #include <cassert>
@@ -80,6 +81,7 @@ namespace EWE {
             for (auto iter = storedSamplers.begin(); iter != storedSamplers.end(); iter++) {
                 if (iter->sampler == sampler) {
                     if (iter->tracker.Remove()) {
+                        DescriptorSetCache::Evict(iter->sampler);
                         EWE_VK(vkDestroySampler, VK::Object->vkDevice, iter->sampler, nullptr);
                         storedSamplers.erase(iter);
                     }
@@ -90,6 +92,7 @@ namespace EWE {
             assert(false && "removing a sampler that does not exist");
 #endif
 #else
+            DescriptorSetCache::Evict(sampler);
             EWE_VK(vkDestroySampler, EWEDevice::GetVkDevice(), sampler, nullptr);
 #endif
         }
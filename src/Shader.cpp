@@ -1,10 +1,12 @@
 #include "EWGraphics/Vulkan/Shader.h"
+#include "EWGraphics/Vulkan/ShaderReflection.h"
 
 
 #include "EWGraphics/Data/magic_enum.hpp"
 #include "spirvcross/spirv_reflect.hpp"
 #if PIPELINE_HOT_RELOAD
 #include "EWGraphics/imgui/imgui.h"
+#include "EWGraphics/Vulkan/PipelineReloader.h"
 
 
 #endif
@@ -44,36 +46,51 @@ namespace EWE {
 	}
 
 
-	void AddBinding(spirv_cross::Compiler const& compiler, DescriptorLayoutPack* layoutPack, spirv_cross::Resource const& res, VkDescriptorType descType, VkShaderStageFlagBits stageFlag) {
+	void AddBinding(spirv_cross::Compiler const& compiler, std::vector<ShaderReflection::SetBindings>& sets, spirv_cross::Resource const& res, VkDescriptorType descType, VkShaderStageFlagBits stageFlag) {
 
-		const uint32_t setIndex = compiler.get_decoration(res.id, spv::DecorationDescriptorSet);
-		if(!layoutPack->setLayouts.Contains(setIndex)) {
-			layoutPack->setLayouts.push_back(setIndex, Construct<DescriptorSetLayout>());
+		const uint8_t setIndex = static_cast<uint8_t>(compiler.get_decoration(res.id, spv::DecorationDescriptorSet));
+		auto setIter = std::find_if(sets.begin(), sets.end(), [setIndex](ShaderReflection::SetBindings const& set) { return set.set == setIndex; });
+		if (setIter == sets.end()) {
+			setIter = sets.insert(sets.end(), ShaderReflection::SetBindings{ setIndex, {}, {} });
 		}
+
+		VkDescriptorBindingFlags bindingFlags = 0;
 		uint32_t descCount = 1;
 		auto const& type = compiler.get_type(res.type_id);
-		if (!type.array.empty() && type.array[0] != 0) {
-			descCount = type.array[0];
+		//multi-dimensional arrays are flattened. array.back() is the outermost dimension, the only one that can be unsized
+		for (std::size_t i = 0; i < type.array.size(); i++) {
+			if (type.array[i] != 0) {
+				//a spec constant sized array reflects its default size
+				descCount *= type.array_size_literal[i] ? type.array[i] : compiler.get_constant(type.array[i]).scalar();
+			}
+			else {
+				assert(i == type.array.size() - 1 && "only the outermost dimension can be unsized");
+				descCount *= ShaderReflection::runtimeArrayDescriptorCount;
+				bindingFlags |= VK_DESCRIPTOR_BINDING_VARIABLE_DESCRIPTOR_COUNT_BIT | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT;
+				//the device only enables update after bind for sampled images. same flags as DescriptorSetLayout::Builder::BuildBindless, so the global texture table matches
+				if ((descType == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER) || (descType == VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE) || (descType == VK_DESCRIPTOR_TYPE_SAMPLER)) {
+					bindingFlags |= VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+				}
+			}
 		}
-		compiler.get_name(res.id);
-		
 
-		layoutPack->setLayouts.at(setIndex).value->bindings.push_back(
+		setIter->bindings.push_back(
 			VkDescriptorSetLayoutBinding{
 				.binding = compiler.get_decoration(res.id, spv::DecorationBinding),
 				.descriptorType = descType,
 				.descriptorCount = descCount,
-				.stageFlags = VK_SHADER_STAGE_ALL,//bad but going with it for now
+				.stageFlags = static_cast<VkShaderStageFlags>(stageFlag),
 				.pImmutableSamplers = nullptr,
 			}
 		);
+		setIter->bindingFlags.push_back(bindingFlags);
 	}
 
 
-	DescriptorLayoutPack* CreateDescriptorLayoutPack(spirv_cross::Compiler const& compiler, VkShaderStageFlagBits stageFlag) {
+	std::vector<ShaderReflection::SetBindings> ReflectDescriptorSets(spirv_cross::Compiler const& compiler, VkShaderStageFlagBits stageFlag) {
 		auto const& resources = compiler.get_shader_resources();
 
-		DescriptorLayoutPack* ret = Construct<DescriptorLayoutPack>();
+		std::vector<ShaderReflection::SetBindings> ret{};
 
 #define AddBindingType(vec, descType) for(auto& binding : vec) {AddBinding(compiler, ret, binding, descType, stageFlag);}
 
@@ -84,17 +101,41 @@ namespace EWE {
 		AddBindingType(resources.separate_samplers, VK_DESCRIPTOR_TYPE_SAMPLER);
 		AddBindingType(resources.separate_images, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE);
 
-		for (auto& set : ret->setLayouts) {
-			std::sort(set.value->bindings.begin(), set.value->bindings.end(),
-				[](VkDescriptorSetLayoutBinding const& a, VkDescriptorSetLayoutBinding const& b) {
-					return a.binding < b.binding;
+		//sort the bindings and their flags together
+		for (auto& set : ret) {
+			std::vector<uint32_t> order(set.bindings.size());
+			for (uint32_t i = 0; i < order.size(); i++) {
+				order[i] = i;
+			}
+			std::sort(order.begin(), order.end(),
+				[&bindings = set.bindings](uint32_t a, uint32_t b) {
+					return bindings[a].binding < bindings[b].binding;
 				}
 			);
+			std::vector<VkDescriptorSetLayoutBinding> sortedBindings{};
+			std::vector<VkDescriptorBindingFlags> sortedFlags{};
+			sortedBindings.reserve(order.size());
+			sortedFlags.reserve(order.size());
+			for (auto index : order) {
+				sortedBindings.push_back(set.bindings[index]);
+				sortedFlags.push_back(set.bindingFlags[index]);
+			}
+			set.bindings = std::move(sortedBindings);
+			set.bindingFlags = std::move(sortedFlags);
 		}
 
 
 		return ret;
 	}
+
+	DescriptorLayoutPack* CreateDescriptorLayoutPack(std::vector<ShaderReflection::SetBindings> const& sets) {
+		DescriptorLayoutPack* ret = Construct<DescriptorLayoutPack>();
+		ret->setLayouts.reserve(sets.size());
+		for (auto const& set : sets) {
+			ret->setLayouts.push_back(set.set, Construct<DescriptorSetLayout>(set.bindings, set.bindingFlags));
+		}
+		return ret;
+	}
 	
 
 	VkFormat SPIRTypeToVkFormat(const spirv_cross::SPIRType& type)
@@ -184,16 +225,17 @@ namespace EWE {
 		if (pushResource.size() == 0) {
 			return;
 		}
-		//only supporting 1 push range rn
-		auto& reflectedPush = pushResource[0];
+		//a stage can only have 1 push block. the block's range starts at its lowest member offset (layout(offset = x)),
+		//so stages with their own constants get separate ranges
+		assert(pushResource.size() == 1);
 		const auto& pushReflectedType = compiler.get_type(pushResource[0].base_type_id);
-		pushRange.size = static_cast<uint32_t>(compiler.get_declared_struct_size(pushReflectedType));
-		if (pushRange.size > 0) {
-			//pushRange.offset = pushReflectedType.member_types[0];
+		const uint32_t declaredSize = static_cast<uint32_t>(compiler.get_declared_struct_size(pushReflectedType));
+		uint32_t lowestOffset = declaredSize;
+		for (uint32_t i = 0; i < pushReflectedType.member_types.size(); i++) {
+			lowestOffset = std::min(lowestOffset, compiler.type_struct_member_offset(pushReflectedType, i));
 		}
-		//else {
-		pushRange.offset = 0;
-		//}
+		pushRange.offset = lowestOffset;
+		pushRange.size = declaredSize - lowestOffset;
 	}
 
 	void ProcessEntry(spirv_cross::Compiler const& compiler, spirv_cross::SpecializationConstant const& sc, std::vector<Shader::SpecializationEntry>& specConstants) {
@@ -256,38 +298,67 @@ namespace EWE {
 			ProcessEntry(compiler, sc, specConstants);
 		}
 	}
-	void Shader::ReadReflection(const std::size_t dataSize, const void* data) {
+	ShaderReflection::Data ShaderReflection::Reflect(const void* data, std::size_t dataSize) {
+		ShaderReflection::Data ret{};
 
 		spirv_cross::Compiler compiler(reinterpret_cast<const uint32_t*>(data), dataSize / sizeof(uint32_t));
 		auto entryPoints = compiler.get_entry_points_and_stages();
 		for (auto& entryPoint : entryPoints) {
 			std::string name = entryPoint.name;
 			switch (entryPoint.execution_model)	{
-				case spv::ExecutionModelVertex:   shaderStageCreateInfo.stage = VK_SHADER_STAGE_VERTEX_BIT; break;
-				case spv::ExecutionModelFragment: shaderStageCreateInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT; break;
-				case spv::ExecutionModelGLCompute:shaderStageCreateInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT; break;
-				case spv::ExecutionModelTaskEXT:  shaderStageCreateInfo.stage = VK_SHADER_STAGE_TASK_BIT_EXT; break;
-				case spv::ExecutionModelMeshEXT:  shaderStageCreateInfo.stage = VK_SHADER_STAGE_MESH_BIT_EXT; break;
+				case spv::ExecutionModelVertex:   ret.stage = VK_SHADER_STAGE_VERTEX_BIT; break;
+				case spv::ExecutionModelFragment: ret.stage = VK_SHADER_STAGE_FRAGMENT_BIT; break;
+				case spv::ExecutionModelGLCompute:ret.stage = VK_SHADER_STAGE_COMPUTE_BIT; break;
+				case spv::ExecutionModelTaskEXT:  ret.stage = VK_SHADER_STAGE_TASK_BIT_EXT; break;
+				case spv::ExecutionModelMeshEXT:  ret.stage = VK_SHADER_STAGE_MESH_BIT_EXT; break;
 				default: EWE_UNREACHABLE; break;
 			}
 		}
 		auto resources = compiler.get_shader_resources();
-		InterpretPushConstants(compiler, resources.push_constant_buffers, pushRange);
-		pushRange.stageFlags = shaderStageCreateInfo.stage;
-		//InterpretInputAttributes(compiler, vertexInputAttributes);
-
-		shaderStageCreateInfo.pName = "main";
-		shaderStageCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-		shaderStageCreateInfo.pNext = nullptr;
-		shaderStageCreateInfo.pSpecializationInfo = nullptr;
-		shaderStageCreateInfo.flags = 0;
-		
-		descriptorSets = CreateDescriptorLayoutPack(compiler, shaderStageCreateInfo.stage);
+		InterpretPushConstants(compiler, resources.push_constant_buffers, ret.pushRange);
+		ret.pushRange.stageFlags = ret.stage;
+		//InterpretInputAttributes(compiler, ret.vertexInputAttributes);
 
-		defaultSpecConstants.clear();
-		InterpretSpecializationConstants(compiler, defaultSpecConstants);
-	
+		ret.sets = ReflectDescriptorSets(compiler, ret.stage);
+
+		InterpretSpecializationConstants(compiler, ret.specConstants);
+		return ret;
+	}
 
+	void ApplyReflection(Shader& shader, ShaderReflection::Data const& reflected) {
+		shader.shaderStageCreateInfo.stage = reflected.stage;
+		shader.pushRange = reflected.pushRange;
+		shader.vertexInputAttributes = reflected.vertexInputAttributes;
+
+		shader.shaderStageCreateInfo.pName = "main";
+		shader.shaderStageCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		shader.shaderStageCreateInfo.pNext = nullptr;
+		shader.shaderStageCreateInfo.pSpecializationInfo = nullptr;
+		shader.shaderStageCreateInfo.flags = 0;
+
+		auto sets = reflected.sets;
+		ShaderReflection::ApplyOverrides(sets);
+		shader.descriptorSets = CreateDescriptorLayoutPack(sets);
+
+		shader.defaultSpecConstants = reflected.specConstants;
+	}
+
+	void Shader::ReadReflection(const std::size_t dataSize, const void* data) {
+		const auto reflectStart = std::chrono::steady_clock::now();
+		const uint64_t hash = ShaderReflection::Hash(data, dataSize);
+		moduleHash = hash;
+
+		ShaderReflection::Data reflected{};
+		if (ShaderReflection::Find(hash, reflected)) {
+			ApplyReflection(*this, reflected);
+			ShaderReflection::RecordCacheHit(std::chrono::steady_clock::now() - reflectStart);
+			return;
+		}
+
+		reflected = ShaderReflection::Reflect(data, dataSize);
+		ApplyReflection(*this, reflected);
+		ShaderReflection::Insert(hash, reflected);
+		ShaderReflection::RecordReflection(std::chrono::steady_clock::now() - reflectStart);
 	}
 
 	void Shader::CompileModule(const std::size_t dataSize, const void* data) {
@@ -348,6 +419,15 @@ namespace EWE {
 		ReadReflection(shaderData.size(), shaderData.data());
 	}
 
+	void Shader::SwapContents(Shader& other) {
+		std::swap(shaderStageCreateInfo, other.shaderStageCreateInfo);
+		std::swap(descriptorSets, other.descriptorSets);
+		std::swap(vertexInputAttributes, other.vertexInputAttributes);
+		std::swap(pushRange, other.pushRange);
+		std::swap(defaultSpecConstants, other.defaultSpecConstants);
+		std::swap(moduleHash, other.moduleHash);
+	}
+
 	void Shader::DrawImgui() {
 
 	}
@@ -444,18 +524,31 @@ namespace EWE {
 	}
 
 	Shader* GetShader(std::string_view filepath) {
+		std::unique_lock<std::mutex> uniqLock{ shaderMapMutex };
 		auto modFind = shaderModuleMap.find(filepath);
 		if (modFind == shaderModuleMap.end()) {
 			auto empRet = shaderModuleMap.emplace(filepath, Construct<Shader>(filepath));
 			assert(empRet.second);
+#if PIPELINE_HOT_RELOAD
+			PipelineReloader::Watch(filepath);
+#endif
 			return empRet.first->second.shader;
 		}
 		else {
-			shaderMapMutex.lock();
 			modFind->second.usageCount++;
 			return modFind->second.shader;
 		}
 	}
+#if PIPELINE_HOT_RELOAD
+	Shader* FindShader(std::string_view filepath) {
+		std::unique_lock<std::mutex> uniqLock{ shaderMapMutex };
+		auto modFind = shaderModuleMap.find(filepath);
+		if (modFind == shaderModuleMap.end()) {
+			return nullptr;
+		}
+		return modFind->second.shader;
+	}
+#endif
 	Shader* CreateShader(std::string_view filepath, const std::size_t dataSize, const void* data) {
 		assert(shaderModuleMap.find(filepath) == shaderModuleMap.end());
 
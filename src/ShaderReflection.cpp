@@ -0,0 +1,331 @@
+#include "EWGraphics/Vulkan/ShaderReflection.h"
+
+#include "EWGraphics/Data/ByteStream.h"
+#include "EWGraphics/Data/Hash.h"
+#include "EWGraphics/Data/AtomicFile.h"
+
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+#include <filesystem>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+
+#ifndef SHADER_REFLECTION_CACHE_PATH
+#define SHADER_REFLECTION_CACHE_PATH "shader_reflection.bin"
+#endif
+
+namespace EWE {
+	namespace ShaderReflection {
+		static constexpr uint32_t fileMagic = 0x52535745; //EWSR
+		//bump this whenever what gets reflected changes, the old entries would be wrong
+		static constexpr uint32_t fileVersion = 4;
+		//spec constant names are only reflected with hot reload
+		static constexpr uint32_t buildFlags = PIPELINE_HOT_RELOAD ? 1 : 0;
+
+		struct FileHeader {
+			uint32_t magic;
+			uint32_t version;
+			uint32_t buildFlags;
+			uint32_t entryCount;
+			uint64_t dataSize;
+			uint64_t checksum;
+		};
+
+		static std::mutex mutex{};
+		static std::unordered_map<uint64_t, Data> entries{};
+		static bool loadAttempted{ false };
+		static bool loadedFromDisk{ false };
+		static bool dirty{ false };
+
+		static uint32_t hits{ 0 };
+		static uint32_t misses{ 0 };
+		static uint64_t reflectNS{ 0 };
+		static uint64_t cachedNS{ 0 };
+
+		static std::mutex overrideMutex{};
+		static std::vector<std::pair<uint8_t, uint32_t>> dynamicBuffers{};
+
+		uint64_t Hash(const void* data, std::size_t dataSize) {
+			//SPIR-V is always a multiple of 4 bytes, hash it a word at a time
+			const uint32_t* words = reinterpret_cast<const uint32_t*>(data);
+			const std::size_t wordCount = dataSize / sizeof(uint32_t);
+			uint64_t hash = Hash::FNV_OFFSET ^ static_cast<uint64_t>(dataSize);
+			for (std::size_t i = 0; i < wordCount; i++) {
+				hash = Hash::FNV1aWord(words[i], hash);
+			}
+			return hash;
+		}
+
+		void SetDynamicBuffer(uint8_t set, uint32_t binding) {
+			std::lock_guard<std::mutex> lock(overrideMutex);
+			const std::pair<uint8_t, uint32_t> key{ set, binding };
+			if (std::find(dynamicBuffers.begin(), dynamicBuffers.end(), key) == dynamicBuffers.end()) {
+				dynamicBuffers.push_back(key);
+			}
+		}
+
+		void ApplyOverrides(std::vector<SetBindings>& sets) {
+			std::lock_guard<std::mutex> lock(overrideMutex);
+			if (dynamicBuffers.empty()) {
+				return;
+			}
+			for (auto& set : sets) {
+				for (std::size_t i = 0; i < set.bindings.size(); i++) {
+					auto& binding = set.bindings[i];
+					if (std::find(dynamicBuffers.begin(), dynamicBuffers.end(), std::pair<uint8_t, uint32_t>{ set.set, binding.binding }) == dynamicBuffers.end()) {
+						continue;
+					}
+					if (binding.descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER) {
+						binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+					}
+					else if (binding.descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER) {
+						binding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+					}
+					else {
+						printf("set %u binding %u is marked dynamic but isn't a uniform or storage buffer\n", set.set, binding.binding);
+						assert(false && "only uniform and storage buffers can be dynamic");
+						continue;
+					}
+					assert(!(set.bindingFlags[i] & (VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_VARIABLE_DESCRIPTOR_COUNT_BIT)) && "dynamic buffers can't be update after bind or variable count");
+				}
+			}
+		}
+
+		std::vector<SetBindings> MergeSets(std::vector<SetBindings> const& stageSets) {
+			struct BindingEntry {
+				uint8_t set;
+				VkDescriptorSetLayoutBinding binding;
+				VkDescriptorBindingFlags flags;
+			};
+			std::vector<BindingEntry> bindingEntries{};
+			for (auto const& set : stageSets) {
+				for (std::size_t i = 0; i < set.bindings.size(); i++) {
+					bindingEntries.push_back(BindingEntry{ set.set, set.bindings[i], set.bindingFlags.size() > 0 ? set.bindingFlags[i] : 0 });
+				}
+			}
+			//stable, so the stages stay in pipeline order within a binding
+			std::stable_sort(bindingEntries.begin(), bindingEntries.end(),
+				[](BindingEntry const& a, BindingEntry const& b) {
+					if (a.set != b.set) return a.set < b.set;
+					return a.binding.binding < b.binding.binding;
+				}
+			);
+
+			std::vector<SetBindings> ret{};
+			for (auto const& entry : bindingEntries) {
+				if (ret.empty() || (ret.back().set != entry.set)) {
+					ret.push_back(SetBindings{ entry.set, {}, {} });
+				}
+				SetBindings& set = ret.back();
+				if (!set.bindings.empty() && (set.bindings.back().binding == entry.binding.binding)) {
+					//the same binding from another stage
+					VkDescriptorSetLayoutBinding& merged = set.bindings.back();
+#if EWE_DEBUG
+					if ((merged.descriptorType != entry.binding.descriptorType) || (merged.descriptorCount != entry.binding.descriptorCount) || (set.bindingFlags.back() != entry.flags)) {
+						printf("descriptor mismatch between stages at set:binding %u:%u - type %d:%d, count %u:%u, flags %u:%u\n",
+							entry.set, entry.binding.binding,
+							merged.descriptorType, entry.binding.descriptorType,
+							merged.descriptorCount, entry.binding.descriptorCount,
+							set.bindingFlags.back(), entry.flags
+						);
+					}
+#endif
+					assert(merged.descriptorType == entry.binding.descriptorType);
+					//a stage can declare a smaller array than another
+					merged.descriptorCount = std::max(merged.descriptorCount, entry.binding.descriptorCount);
+					merged.stageFlags |= entry.binding.stageFlags;
+					set.bindingFlags.back() |= entry.flags;
+				}
+				else {
+					set.bindings.push_back(entry.binding);
+					set.bindingFlags.push_back(entry.flags);
+				}
+			}
+			return ret;
+		}
+
+		static void WriteEntry(ByteWriter& writer, uint64_t hash, Data const& entry) {
+			writer.Write(hash);
+			writer.Write(entry.stage);
+			writer.Write(entry.pushRange);
+			writer.Write(static_cast<uint32_t>(entry.sets.size()));
+			for (auto const& set : entry.sets) {
+				writer.Write(set.set);
+				//pImmutableSamplers is always null out of reflection
+				writer.WriteVector(set.bindings);
+				writer.WriteVector(set.bindingFlags);
+			}
+			writer.WriteVector(entry.vertexInputAttributes);
+			writer.Write(static_cast<uint32_t>(entry.specConstants.size()));
+			for (auto const& spec : entry.specConstants) {
+#if PIPELINE_HOT_RELOAD
+				writer.WriteString(spec.name);
+#endif
+				writer.Write(spec.type);
+				writer.Write(spec.constantID);
+				writer.Write(spec.elementCount);
+				writer.Write(spec.value);
+			}
+		}
+
+		static bool ReadEntry(ByteReader& reader, uint64_t& hash, Data& entry) {
+			hash = reader.Read<uint64_t>();
+			entry.stage = reader.Read<VkShaderStageFlagBits>();
+			entry.pushRange = reader.Read<VkPushConstantRange>();
+			const uint32_t setCount = reader.Read<uint32_t>();
+			for (uint32_t i = 0; (i < setCount) && !reader.failed; i++) {
+				auto& set = entry.sets.emplace_back();
+				set.set = reader.Read<uint8_t>();
+				reader.ReadVector(set.bindings);
+				reader.ReadVector(set.bindingFlags);
+				if (set.bindingFlags.size() != set.bindings.size()) {
+					reader.failed = true;
+				}
+			}
+			reader.ReadVector(entry.vertexInputAttributes);
+			const uint32_t specCount = reader.Read<uint32_t>();
+			for (uint32_t i = 0; (i < specCount) && !reader.failed; i++) {
+				auto& spec = entry.specConstants.emplace_back();
+#if PIPELINE_HOT_RELOAD
+				spec.name = reader.ReadString();
+#endif
+				spec.type = reader.Read<Shader::ShaderFundamentalType>();
+				spec.constantID = reader.Read<uint32_t>();
+				spec.elementCount = reader.Read<uint8_t>();
+				reader.Read(spec.value, sizeof(spec.value));
+			}
+			return !reader.failed;
+		}
+
+		//mutex is held
+		static void LoadFromDisk() {
+			loadAttempted = true;
+#if SHADER_REFLECTION_DISK_CACHE
+			std::ifstream inFile{ SHADER_REFLECTION_CACHE_PATH, std::ios::binary | std::ios::ate };
+			if (!inFile.is_open()) {
+				return;
+			}
+			const std::size_t fileSize = static_cast<std::size_t>(inFile.tellg());
+			if (fileSize < sizeof(FileHeader)) {
+				printf("shader reflection cache is truncated, ignoring it\n");
+				return;
+			}
+			inFile.seekg(0);
+			FileHeader header{};
+			inFile.read(reinterpret_cast<char*>(&header), sizeof(FileHeader));
+			if ((header.magic != fileMagic) || (header.version != fileVersion) || (header.buildFlags != buildFlags)) {
+				printf("shader reflection cache is from a different version or build, ignoring it\n");
+				return;
+			}
+			if (header.dataSize != (fileSize - sizeof(FileHeader))) {
+				printf("shader reflection cache size mismatch, ignoring it\n");
+				return;
+			}
+			std::vector<uint8_t> data(header.dataSize);
+			inFile.read(reinterpret_cast<char*>(data.data()), data.size());
+			if (!inFile || (Hash::FNV1a(data.data(), data.size()) != header.checksum)) {
+				printf("shader reflection cache checksum mismatch, ignoring it\n");
+				return;
+			}
+
+			ByteReader reader{ data.data(), data.size() };
+			std::unordered_map<uint64_t, Data> loaded{};
+			loaded.reserve(header.entryCount);
+			for (uint32_t i = 0; i < header.entryCount; i++) {
+				uint64_t hash;
+				Data entry{};
+				if (!ReadEntry(reader, hash, entry)) {
+					printf("shader reflection cache entry is malformed, ignoring the file\n");
+					return;
+				}
+				loaded.emplace(hash, std::move(entry));
+			}
+			//anything reflected before the load is still valid
+			loaded.merge(entries);
+			entries = std::move(loaded);
+			loadedFromDisk = true;
+#endif
+		}
+
+		bool Find(uint64_t hash, Data& out) {
+			std::unique_lock<std::mutex> lock{ mutex };
+			if (!loadAttempted) {
+				LoadFromDisk();
+			}
+			auto found = entries.find(hash);
+			if (found == entries.end()) {
+				misses++;
+				return false;
+			}
+			hits++;
+			out = found->second;
+			return true;
+		}
+
+		void Insert(uint64_t hash, Data const& data) {
+			std::unique_lock<std::mutex> lock{ mutex };
+			if (entries.insert_or_assign(hash, data).second) {
+				dirty = true;
+			}
+		}
+
+		bool Save() {
+#if SHADER_REFLECTION_DISK_CACHE
+			std::unique_lock<std::mutex> lock{ mutex };
+			if (!dirty) {
+				return true;
+			}
+			ByteWriter writer{};
+			for (auto const& entry : entries) {
+				WriteEntry(writer, entry.first, entry.second);
+			}
+			FileHeader header{};
+			header.magic = fileMagic;
+			header.version = fileVersion;
+			header.buildFlags = buildFlags;
+			header.entryCount = static_cast<uint32_t>(entries.size());
+			header.dataSize = writer.bytes.size();
+			header.checksum = Hash::FNV1a(writer.bytes.data(), writer.bytes.size());
+
+			if (!AtomicWriteFile(SHADER_REFLECTION_CACHE_PATH, { { &header, sizeof(FileHeader) }, { writer.bytes.data(), writer.bytes.size() } })) {
+				printf("failed to write the shader reflection cache\n");
+				return false;
+			}
+			dirty = false;
+#endif
+			return true;
+		}
+
+		void RecordReflection(std::chrono::steady_clock::duration duration) {
+			std::unique_lock<std::mutex> lock{ mutex };
+			reflectNS += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+		}
+		void RecordCacheHit(std::chrono::steady_clock::duration duration) {
+			std::unique_lock<std::mutex> lock{ mutex };
+			cachedNS += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+		}
+
+		Stats GetStats() {
+			std::unique_lock<std::mutex> lock{ mutex };
+			Stats ret{};
+			ret.hits = hits;
+			ret.misses = misses;
+			ret.entries = static_cast<uint32_t>(entries.size());
+			ret.loadedFromDisk = loadedFromDisk;
+			ret.reflectMS = static_cast<double>(reflectNS) / 1000000.0;
+			ret.cachedMS = static_cast<double>(cachedNS) / 1000000.0;
+			return ret;
+		}
+		void PrintStats() {
+			const Stats stats = GetStats();
+			printf("shader reflection cache[%s] - %u entries, hits:misses - %u:%u, reflecting - %.3f ms (%.3f avg), from cache - %.3f ms (%.3f avg)\n",
+				stats.loadedFromDisk ? "warm" : "cold",
+				stats.entries, stats.hits, stats.misses,
+				stats.reflectMS, stats.misses > 0 ? stats.reflectMS / stats.misses : 0.0,
+				stats.cachedMS, stats.hits > 0 ? stats.cachedMS / stats.hits : 0.0
+			);
+		}
+	} //namespace ShaderReflection
+} //namespace EWE
@@ -0,0 +1,225 @@
+#include "EWGraphics/Vulkan/SubmissionThread.h"
+
+namespace EWE {
+
+	std::array<SubmissionThread*, Queue::_count> SubmissionThread::perQueue{ nullptr, nullptr, nullptr, nullptr };
+
+	void SubmissionThread::Initialize() {
+		for (uint8_t i = 0; i < Queue::_count; i++) {
+			if (!VK::Object->queueEnabled[i]) {
+				continue;
+			}
+			//queues that share a VkQueue need to share a thread
+			for (uint8_t j = 0; j < i; j++) {
+				if ((perQueue[j] != nullptr) && (VK::Object->queues[j] == VK::Object->queues[i])) {
+					perQueue[i] = perQueue[j];
+					break;
+				}
+			}
+			if (perQueue[i] == nullptr) {
+				perQueue[i] = Construct<SubmissionThread>(static_cast<Queue::Enum>(i));
+			}
+		}
+		//present is always done from the graphics thread, the existing sync assumes present follows graphics in order
+		perQueue[Queue::present] = perQueue[Queue::graphics];
+	}
+	void SubmissionThread::Destroy() {
+		for (uint8_t i = 0; i < Queue::_count; i++) {
+			SubmissionThread* subThread = perQueue[i];
+			if (subThread == nullptr) {
+				continue;
+			}
+			for (uint8_t j = i; j < Queue::_count; j++) {
+				if (perQueue[j] == subThread) {
+					perQueue[j] = nullptr;
+				}
+			}
+#if EWE_DEBUG
+			subThread->PrintStats();
+#endif
+			Deconstruct(subThread);
+		}
+	}
+
+	SubmissionThread::SubmissionThread(Queue::Enum queue) : queue{ queue } {
+		for (uint32_t i = 0; i < ringSize; i++) {
+			ring[i].sequence.store(i, std::memory_order_relaxed);
+		}
+		thread = std::thread(&SubmissionThread::Run, this);
+	}
+	SubmissionThread::~SubmissionThread() {
+		running.store(false, std::memory_order_release);
+		depth.fetch_add(1, std::memory_order_release); //wakes the thread without a packet, anything left in the ring is submitted first
+		depth.notify_one();
+		thread.join();
+		depth.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	void SubmissionThread::Push(Packet const& packet) {
+		//depth is incremented before the packet lands, so it's never behind the ring
+		const uint32_t currentDepth = depth.fetch_add(1, std::memory_order_relaxed) + 1;
+		uint32_t prevMax = maxDepth.load(std::memory_order_relaxed);
+		while ((currentDepth > prevMax) && !maxDepth.compare_exchange_weak(prevMax, currentDepth, std::memory_order_relaxed)) {}
+
+		uint32_t pos = enqueuePos.load(std::memory_order_relaxed);
+		while (true) {
+			Cell& cell = ring[pos & (ringSize - 1)];
+			const uint32_t seq = cell.sequence.load(std::memory_order_acquire);
+			const int32_t diff = static_cast<int32_t>(seq - pos);
+			if (diff == 0) {
+				if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					cell.packet = packet;
+					cell.sequence.store(pos + 1, std::memory_order_release);
+					break;
+				}
+			}
+			else if (diff < 0) {
+				//ring is full, give the submission thread a moment
+				std::this_thread::sleep_for(std::chrono::microseconds(1));
+				pos = enqueuePos.load(std::memory_order_relaxed);
+			}
+			else {
+				pos = enqueuePos.load(std::memory_order_relaxed);
+			}
+		}
+		depth.notify_one();
+	}
+
+	bool SubmissionThread::TryPop(Packet& packet) {
+		Cell& cell = ring[dequeuePos & (ringSize - 1)];
+		const uint32_t seq = cell.sequence.load(std::memory_order_acquire);
+		if (static_cast<int32_t>(seq - (dequeuePos + 1)) < 0) {
+			return false;
+		}
+		packet = cell.packet;
+		cell.sequence.store(dequeuePos + ringSize, std::memory_order_release);
+		dequeuePos++;
+		depth.fetch_sub(1, std::memory_order_relaxed);
+		return true;
+	}
+
+	void SubmissionThread::RecordLatency(std::chrono::steady_clock::time_point pushTime, std::chrono::steady_clock::time_point now) {
+		const uint64_t latency = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - pushTime).count());
+		totalLatency.fetch_add(latency, std::memory_order_relaxed);
+		uint64_t prevMax = maxLatency.load(std::memory_order_relaxed);
+		while ((latency > prevMax) && !maxLatency.compare_exchange_weak(prevMax, latency, std::memory_order_relaxed)) {}
+	}
+
+	void SubmissionThread::Run() {
+		std::array<Packet, maxCoalesce> group{};
+		std::array<VkSubmitInfo, maxCoalesce> submitInfos{};
+		Packet next{};
+		bool hasNext = false;
+
+		while (true) {
+			if (!hasNext) {
+				hasNext = TryPop(next);
+			}
+			if (!hasNext) {
+				if (!running.load(std::memory_order_acquire)) {
+					return;
+				}
+				//depth can be ahead of the ring while a producer is mid push, this spins until it lands
+				depth.wait(0, std::memory_order_acquire);
+				continue;
+			}
+			hasNext = false;
+
+			if (next.isPresent) {
+				std::unique_lock<std::mutex> queueLock(VK::Object->GetQueueMutex(Queue::present));
+				*next.presentResult = vkQueuePresentKHR(VK::Object->queues[Queue::present], &next.presentInfo);
+				queueLock.unlock();
+				RecordLatency(next.pushTime, std::chrono::steady_clock::now());
+				packetCount.fetch_add(1, std::memory_order_relaxed);
+				next.submitted->store(true, std::memory_order_release);
+				next.submitted->notify_all();
+				continue;
+			}
+
+			uint32_t groupCount = 0;
+			group[groupCount++] = next;
+			//only the last packet in a group can have a fence
+			while ((group[groupCount - 1].fence == VK_NULL_HANDLE) && (groupCount < maxCoalesce)) {
+				if (!TryPop(next)) {
+					break;
+				}
+				if (next.isPresent) {
+					hasNext = true;
+					break;
+				}
+				group[groupCount++] = next;
+			}
+			for (uint32_t i = 0; i < groupCount; i++) {
+				submitInfos[i] = group[i].submitInfo;
+			}
+
+			{
+				std::unique_lock<std::mutex> queueLock(VK::Object->GetQueueMutex(queue));
+				EWE_VK(vkQueueSubmit, VK::Object->queues[queue], groupCount, submitInfos.data(), group[groupCount - 1].fence);
+			}
+			const auto now = std::chrono::steady_clock::now();
+			submitCallCount.fetch_add(1, std::memory_order_relaxed);
+			packetCount.fetch_add(groupCount, std::memory_order_relaxed);
+			for (uint32_t i = 0; i < groupCount; i++) {
+				RecordLatency(group[i].pushTime, now);
+				if (group[i].submitted != nullptr) {
+					group[i].submitted->store(true, std::memory_order_release);
+					group[i].submitted->notify_all();
+				}
+			}
+		}
+	}
+
+	void SubmissionThread::Submit(VkSubmitInfo const& submitInfo, VkFence fence, std::atomic<bool>* submitted) {
+		Packet packet{};
+		packet.submitInfo = submitInfo;
+		packet.fence = fence;
+		packet.isPresent = false;
+		packet.presentResult = nullptr;
+		packet.submitted = submitted;
+		packet.pushTime = std::chrono::steady_clock::now();
+		Push(packet);
+	}
+	void SubmissionThread::SubmitAndWait(VkSubmitInfo const& submitInfo, VkFence fence) {
+		std::atomic<bool> submitted{ false };
+		Submit(submitInfo, fence, &submitted);
+		submitted.wait(false, std::memory_order_acquire);
+	}
+	VkResult SubmissionThread::Present(VkPresentInfoKHR const& presentInfo) {
+		VkResult result = VK_SUCCESS;
+		std::atomic<bool> presented{ false };
+
+		Packet packet{};
+		packet.presentInfo = presentInfo;
+		packet.fence = VK_NULL_HANDLE;
+		packet.isPresent = true;
+		packet.presentResult = &result;
+		packet.submitted = &presented;
+		packet.pushTime = std::chrono::steady_clock::now();
+		Push(packet);
+
+		presented.wait(false, std::memory_order_acquire);
+		return result;
+	}
+
+	SubmissionThread::Stats SubmissionThread::GetStats() const {
+		Stats ret{};
+		ret.packets = packetCount.load(std::memory_order_relaxed);
+		ret.submitCalls = submitCallCount.load(std::memory_order_relaxed);
+		ret.totalLatencyNS = totalLatency.load(std::memory_order_relaxed);
+		ret.maxLatencyNS = maxLatency.load(std::memory_order_relaxed);
+		ret.maxQueueDepth = maxDepth.load(std::memory_order_relaxed);
+		ret.currentQueueDepth = depth.load(std::memory_order_relaxed);
+		return ret;
+	}
+	void SubmissionThread::PrintStats() const {
+		const Stats stats = GetStats();
+		const double averageUS = stats.packets > 0 ? (static_cast<double>(stats.totalLatencyNS) / static_cast<double>(stats.packets)) / 1000.0 : 0.0;
+		printf("submission thread[%u] - packets:submits - %llu:%llu, latency avg:max(us) - %.2f:%.2f, max queue depth - %u\n",
+			static_cast<uint32_t>(queue),
+			static_cast<unsigned long long>(stats.packets), static_cast<unsigned long long>(stats.submitCalls),
+			averageUS, static_cast<double>(stats.maxLatencyNS) / 1000.0,
+			stats.maxQueueDepth
+		);
+	}
+} //namespace EWE
@@ -8,8 +8,9 @@ namespace EWE {
 	SyncHub* SyncHub::syncHubSingleton{ nullptr };
 
 	SyncHub::SyncHub() :
-		qSyncPool{ 255 }, 
-		renderSyncData{}
+		qSyncPool{ QUEUE_SYNC_POOL_SIZE }, 
+		renderSyncData{},
+		uploadQueue{}
 	{
 #if EWE_DEBUG
 		printf("CONSTRUCTING SYNCHUB\n");
@@ -24,6 +25,7 @@ namespace EWE {
 #endif
 
 	void SyncHub::Initialize() {
+		SubmissionThread::Initialize();
 		syncHubSingleton = Construct<SyncHub>();
 		syncHubSingleton->CreateBuffers();
 	}
@@ -32,13 +34,15 @@ namespace EWE {
 #if DECONSTRUCTION_DEBUG
 		printf("beginniing synchub destroy \n");
 #endif
-		std::array<VkCommandBuffer, MAX_FRAMES_IN_FLIGHT> cmdBufs{
-			VK::Object->renderCommands[0].cmdBuf,
-			VK::Object->renderCommands[1].cmdBuf
-		};
+		//anything still in the submission rings is submitted before the threads join
+		SubmissionThread::Destroy();
+		EWE_VK(vkDeviceWaitIdle, VK::Object->vkDevice);
+
+		std::array<VkCommandBuffer, MAX_FRAMES_IN_FLIGHT> cmdBufs{};
 		for (uint8_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-			EWE_VK(vkFreeCommandBuffers, VK::Object->vkDevice, VK::Object->renderCmdPool, MAX_FRAMES_IN_FLIGHT, cmdBufs.data());
+			cmdBufs[i] = VK::Object->renderCommands[i].cmdBuf;
 		}
+		EWE_VK(vkFreeCommandBuffers, VK::Object->vkDevice, VK::Object->renderCmdPool, MAX_FRAMES_IN_FLIGHT, cmdBufs.data());
 
 		Deconstruct(syncHubSingleton);
 		syncHubSingleton = nullptr;
@@ -57,8 +61,10 @@ namespace EWE {
 		allocInfo.commandBufferCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
 		std::array<VkCommandBuffer, MAX_FRAMES_IN_FLIGHT> tempCmdBuf{};
 		EWE_VK(vkAllocateCommandBuffers, VK::Object->vkDevice, &allocInfo, &tempCmdBuf[0]);
-		VK::Object->renderCommands[0].cmdBuf = tempCmdBuf[0];
-		VK::Object->renderCommands[1].cmdBuf = tempCmdBuf[1];
+		//every slot is allocated, so the depth can change without reallocating
+		for (uint8_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+			VK::Object->renderCommands[i].cmdBuf = tempCmdBuf[i];
+		}
 	}
 
 	CommandBuffer& SyncHub::BeginSingleTimeCommandGraphics() {
@@ -116,10 +122,9 @@ namespace EWE {
 			fence.signalSemaphore = semaphore;
 			fence.gCommand = graphicsCommand;
 
-			VK::Object->queueMutex[Queue::graphics].lock();
-			EWE_VK(vkQueueSubmit, VK::Object->queues[Queue::graphics], 1, &submitInfo, fence.fence.vkFence);
+			//the frame submission is pushed to the same thread afterwards, so the signal is always submitted before the wait
+			SubmissionThread::Get(Queue::graphics)->Submit(submitInfo, fence.fence.vkFence);
 			renderSyncData.AddWaitSemaphore(semaphore, graphicsCommand.waitStage);
-			VK::Object->queueMutex[Queue::graphics].unlock();
 			fence.fence.submitted = true;
 		}
 		else {
@@ -140,10 +145,9 @@ namespace EWE {
 			graphicsSubmitInfo.pWaitDstStageMask = &waitStage;
 
 			Fence& graphicsFence = qSyncPool.GetFence();
-			VK::Object->queueMutex[Queue::graphics].lock();
-			EWE_VK(vkQueueSubmit, VK::Object->queues[Queue::graphics], 1, &graphicsSubmitInfo, graphicsFence.vkFence);
+			//waitStage is on the stack, but this doesn't return until the fence signals
+			SubmissionThread::Get(Queue::graphics)->Submit(graphicsSubmitInfo, graphicsFence.vkFence);
 			renderSyncData.AddWaitSemaphore(graphicsSemaphore, waitStage);
-			VK::Object->queueMutex[Queue::graphics].unlock();
 
 			graphicsFence.submitted = true;
 
@@ -199,9 +203,8 @@ namespace EWE {
 			transferSubmitInfo.signalSemaphoreCount = 0;
 		}
 
-		VK::Object->queueMutex[Queue::transfer].lock();
-		EWE_VK(vkQueueSubmit, VK::Object->queues[Queue::transfer], 1, &transferSubmitInfo, transferFence.vkFence);
-		VK::Object->queueMutex[Queue::transfer].unlock();
+		//the graphics submission below waits on the transfer semaphore, the signal needs to be submitted first
+		SubmissionThread::Get(Queue::transfer)->SubmitAndWait(transferSubmitInfo, transferFence.vkFence);
 
 #if DEBUGGING_FENCES
 		transferFence.fence.log.push_back("setting transfer fence to submitted");
@@ -259,10 +262,8 @@ namespace EWE {
 			graphicsSubmitInfo.pWaitDstStageMask = &waitStage;
 
 			Fence& graphicsFence = qSyncPool.GetFence();
-			VK::Object->queueMutex[Queue::graphics].lock();
-			EWE_VK(vkQueueSubmit, VK::Object->queues[Queue::graphics], 1, &graphicsSubmitInfo, graphicsFence.vkFence);
+			SubmissionThread::Get(Queue::graphics)->Submit(graphicsSubmitInfo, graphicsFence.vkFence);
 			renderSyncData.AddWaitSemaphore(graphicsSemaphore, waitStage);
-			VK::Object->queueMutex[Queue::graphics].unlock();
 
 			graphicsFence.submitted = true;
 #if DEBUGGING_FENCES
@@ -303,16 +304,29 @@ namespace EWE {
 		imagesInFlight[*imageIndex] = renderSyncData.inFlight[VK::Object->frameIndex];
 
 		renderSyncData.SetWaitData(submitInfo);
-
-		std::vector<VkSemaphore> signalSemaphores = renderSyncData.GetSignalData();
-		submitInfo.pSignalSemaphores = signalSemaphores.data();
-		submitInfo.signalSemaphoreCount = static_cast<uint32_t>(signalSemaphores.size());
+		renderSyncData.SetSignalData(submitInfo);
 
 		EWE_VK(vkResetFences, VK::Object->vkDevice, 1, &renderSyncData.inFlight[VK::Object->frameIndex]);
 
-		VK::Object->queueMutex[Queue::graphics].lock();
-		EWE_VK(vkQueueSubmit, VK::Object->queues[Queue::graphics], 1, &submitInfo, renderSyncData.inFlight[VK::Object->frameIndex]);
-		VK::Object->queueMutex[Queue::graphics].unlock();
+		//the wait and signal data is per-frame storage, it outlives the packet
+		SubmissionThread::Get(Queue::graphics)->Submit(submitInfo, renderSyncData.inFlight[VK::Object->frameIndex]);
+	}
+
+	void SyncHub::SetFramesInFlight(uint8_t framesInFlight) {
+		assert(VK::Object->CheckMainThread());
+		assert((framesInFlight >= 1) && (framesInFlight <= MAX_FRAMES_IN_FLIGHT));
+		if (framesInFlight == VK::Object->framesInFlight) {
+			return;
+		}
+		//every slot is drained, so the frame index can restart at 0 without reusing anything that's still in flight
+		EWE_VK(vkWaitForFences, VK::Object->vkDevice, MAX_FRAMES_IN_FLIGHT, renderSyncData.inFlight, VK_TRUE, UINT64_MAX);
+		renderSyncData.ReleasePreviousFrames();
+
+#if EWE_DEBUG
+		printf("frames in flight : %u -> %u\n", VK::Object->framesInFlight, framesInFlight);
+#endif
+		VK::Object->framesInFlight = framesInFlight;
+		VK::Object->frameIndex = 0;
 	}
 
 	VkResult SyncHub::PresentKHR(VkPresentInfoKHR& presentInfo) {
@@ -321,7 +335,6 @@ namespace EWE {
 
 		presentInfo.waitSemaphoreCount = 1;
 		presentInfo.pWaitSemaphores = &renderSyncData.renderFinishedSemaphore[VK::Object->frameIndex];
-		std::unique_lock<std::mutex> queueLock{VK::Object->queueMutex[Queue::graphics]};
-		return vkQueuePresentKHR(VK::Object->queues[Queue::present], &presentInfo);
+		return SubmissionThread::Get(Queue::present)->Present(presentInfo);
 	}
 }
\ No newline at end of file
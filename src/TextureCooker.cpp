@@ -0,0 +1,346 @@
+#include "EWGraphics/Texture/TextureCooker.h"
+
+#include "EWGraphics/Texture/KTX2.h"
+#include "EWGraphics/Texture/MipGenerator.h"
+#include "EWGraphics/Data/Hash.h"
+#include "EWGraphics/Data/AtomicFile.h"
+
+#include <stb/stb_image.h>
+#define STB_DXT_IMPLEMENTATION
+#include <stb/stb_dxt.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#ifndef TEXTURE_CACHE_DIRECTORY
+#define TEXTURE_CACHE_DIRECTORY "texture_cache/"
+#endif
+
+namespace EWE {
+	namespace TextureCooker {
+		//bump when the cooked output changes, every old entry misses after that
+		static constexpr uint32_t cookerVersion = 2;
+		static constexpr uint32_t stampMagic = 0x54435745; //EWCT
+
+		struct Stamp {
+			uint32_t magic;
+			uint32_t version;
+			uint64_t sourceSize;
+			int64_t sourceWriteTime;
+			uint64_t contentKey;
+		};
+
+		static std::atomic<bool> supported{ false };
+
+		static std::atomic<uint32_t> warmLoads{ 0 };
+		static std::atomic<uint64_t> warmLoadNS{ 0 };
+		static std::atomic<uint32_t> rehashedLoads{ 0 };
+		static std::atomic<uint64_t> rehashedLoadNS{ 0 };
+		static std::atomic<uint32_t> coldLoads{ 0 };
+		static std::atomic<uint64_t> coldLoadNS{ 0 };
+		static std::atomic<uint64_t> cookNS{ 0 };
+		static std::atomic<uint32_t> failures{ 0 };
+
+		void SetSupport(bool isSupported) {
+			supported = isSupported && TEXTURE_COOKING;
+		}
+		bool Enabled() {
+			return supported.load(std::memory_order_relaxed);
+		}
+
+		static uint64_t OptionsKey(Options const& options) {
+			const uint32_t packed = static_cast<uint32_t>(options.encoding) | (static_cast<uint32_t>(options.srgb) << 8) | (static_cast<uint32_t>(options.mipmap && MIPMAP_ENABLED) << 9);
+			uint64_t ret = Hash::FNV1a(&cookerVersion, sizeof(cookerVersion));
+			return Hash::FNV1a(&packed, sizeof(packed), ret);
+		}
+		static std::string ToHex(uint64_t value) {
+			static constexpr char digits[] = "0123456789abcdef";
+			std::string ret(16, '0');
+			for (int i = 15; i >= 0; i--) {
+				ret[i] = digits[value & 0xF];
+				value >>= 4;
+			}
+			return ret;
+		}
+
+		static std::string CookedPath(uint64_t contentKey) {
+			return std::string(TEXTURE_CACHE_DIRECTORY) + ToHex(contentKey) + ".ktx2";
+		}
+		static std::string StampPath(std::string const& sourcePath, Options const& options) {
+			return std::string(TEXTURE_CACHE_DIRECTORY) + "sources/" + ToHex(Hash::FNV1a(sourcePath.data(), sourcePath.size(), OptionsKey(options))) + ".stamp";
+		}
+
+		static bool ReadStamp(std::string const& path, Stamp& stamp) {
+			std::ifstream file{ path, std::ios::binary };
+			if (!file.is_open()) {
+				return false;
+			}
+			if (!file.read(reinterpret_cast<char*>(&stamp), sizeof(Stamp))) {
+				return false;
+			}
+			return (stamp.magic == stampMagic) && (stamp.version == cookerVersion);
+		}
+		static void WriteStamp(std::string const& path, Stamp const& stamp) {
+			//if this fails the stamp misses next time, and the source gets hashed again
+			AtomicWriteFile(path, { { &stamp, sizeof(Stamp) } });
+		}
+
+		static bool ReadFile(std::string const& path, std::vector<uint8_t>& out) {
+			std::ifstream file{ path, std::ios::binary | std::ios::ate };
+			if (!file.is_open()) {
+				return false;
+			}
+			const std::streamsize size = file.tellg();
+			if (size <= 0) {
+				return false;
+			}
+			out.resize(static_cast<std::size_t>(size));
+			file.seekg(0);
+			return static_cast<bool>(file.read(reinterpret_cast<char*>(out.data()), size));
+		}
+
+		static VkFormat GetFormat(Encoding encoding, bool srgb) {
+			switch (encoding) {
+				case Encoding::BC1: return srgb ? VK_FORMAT_BC1_RGB_SRGB_BLOCK : VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+				case Encoding::BC3: return srgb ? VK_FORMAT_BC3_SRGB_BLOCK : VK_FORMAT_BC3_UNORM_BLOCK;
+				case Encoding::BC4: return VK_FORMAT_BC4_UNORM_BLOCK;
+				case Encoding::BC5: return VK_FORMAT_BC5_UNORM_BLOCK;
+				default: EWE_UNREACHABLE;
+			}
+			return VK_FORMAT_UNDEFINED;
+		}
+
+		static void CompressLevel(const uint8_t* rgba, uint32_t width, uint32_t height, Encoding encoding, std::vector<uint8_t>& out) {
+			const uint32_t blockBytes = ((encoding == Encoding::BC1) || (encoding == Encoding::BC4)) ? 8 : 16;
+			const uint32_t blocksX = (width + 3) / 4;
+			const uint32_t blocksY = (height + 3) / 4;
+			out.resize(static_cast<std::size_t>(blocksX) * blocksY * blockBytes);
+
+			uint8_t blockRGBA[16 * 4];
+			uint8_t blockChannels[16 * 2];
+			uint8_t* dst = out.data();
+			for (uint32_t by = 0; by < blocksY; by++) {
+				for (uint32_t bx = 0; bx < blocksX; bx++) {
+					//blocks hanging off the edge repeat the last row/column
+					for (uint32_t ty = 0; ty < 4; ty++) {
+						const uint32_t y = std::min(by * 4 + ty, height - 1);
+						for (uint32_t tx = 0; tx < 4; tx++) {
+							const uint32_t x = std::min(bx * 4 + tx, width - 1);
+							memcpy(&blockRGBA[(ty * 4 + tx) * 4], &rgba[(static_cast<std::size_t>(y) * width + x) * 4], 4);
+						}
+					}
+					switch (encoding) {
+						case Encoding::BC1:
+							stb_compress_dxt_block(dst, blockRGBA, 0, STB_DXT_HIGHQUAL);
+							break;
+						case Encoding::BC3:
+							stb_compress_dxt_block(dst, blockRGBA, 1, STB_DXT_HIGHQUAL);
+							break;
+						case Encoding::BC4:
+							for (uint32_t i = 0; i < 16; i++) {
+								blockChannels[i] = blockRGBA[i * 4];
+							}
+							stb_compress_bc4_block(dst, blockChannels);
+							break;
+						case Encoding::BC5:
+							for (uint32_t i = 0; i < 16; i++) {
+								blockChannels[i * 2] = blockRGBA[i * 4];
+								blockChannels[i * 2 + 1] = blockRGBA[i * 4 + 1];
+							}
+							stb_compress_bc5_block(dst, blockChannels);
+							break;
+						default: EWE_UNREACHABLE;
+					}
+					dst += blockBytes;
+				}
+			}
+		}
+
+		static bool Cook(std::vector<uint8_t> const& sourceData, Options const& options, std::string const& cookedPath) {
+			int width, height, channels;
+			stbi_uc* decoded = stbi_load_from_memory(sourceData.data(), static_cast<int>(sourceData.size()), &width, &height, &channels, STBI_rgb_alpha);
+			if ((decoded == nullptr) || (width <= 0) || (height <= 0)) {
+				if (decoded != nullptr) {
+					stbi_image_free(decoded);
+				}
+				return false;
+			}
+			const std::size_t byteCount = static_cast<std::size_t>(width) * height * 4;
+
+			Encoding encoding = options.encoding;
+			if (encoding == Encoding::Auto) {
+				encoding = Encoding::BC1;
+				for (std::size_t i = 3; i < byteCount; i += 4) {
+					if (decoded[i] != 255) {
+						encoding = Encoding::BC3;
+						break;
+					}
+				}
+			}
+			const bool srgb = options.srgb && ((encoding == Encoding::BC1) || (encoding == Encoding::BC3));
+
+			uint32_t levelCount = 1;
+			if (options.mipmap && MIPMAP_ENABLED) {
+				levelCount = MipGenerator::LevelCount(static_cast<uint32_t>(width), static_cast<uint32_t>(height));
+			}
+			std::vector<MipGenerator::Level> mipLevels{};
+			std::vector<uint8_t> chain(MipGenerator::Layout(static_cast<uint32_t>(width), static_cast<uint32_t>(height), levelCount, mipLevels));
+			//offline, the sharper filter is worth it
+			MipGenerator::Options mipOptions{};
+			mipOptions.filter = MipGenerator::Filter::Kaiser;
+			mipOptions.srgb = srgb;
+			MipGenerator::Generate(decoded, static_cast<uint32_t>(width), static_cast<uint32_t>(height), levelCount, chain.data(), mipOptions);
+			stbi_image_free(decoded);
+
+			std::vector<std::vector<uint8_t>> levels(levelCount);
+			for (uint32_t level = 0; level < levelCount; level++) {
+				CompressLevel(chain.data() + mipLevels[level].offset, mipLevels[level].width, mipLevels[level].height, encoding, levels[level]);
+			}
+
+			//two sources with the same content can cook at once, each rename is whole and the last one wins
+			return KTX2::Write(cookedPath, GetFormat(encoding, srgb), static_cast<uint32_t>(width), static_cast<uint32_t>(height), levels);
+		}
+
+		Result GetCooked(std::string const& sourcePath, Options const& options, std::string& cookedPath) {
+			std::error_code ec;
+			const uint64_t sourceSize = static_cast<uint64_t>(std::filesystem::file_size(sourcePath, ec));
+			if (ec) {
+				failures.fetch_add(1, std::memory_order_relaxed);
+				return Result::Failed;
+			}
+			const int64_t sourceWriteTime = static_cast<int64_t>(std::filesystem::last_write_time(sourcePath, ec).time_since_epoch().count());
+			if (ec) {
+				failures.fetch_add(1, std::memory_order_relaxed);
+				return Result::Failed;
+			}
+
+			const std::string stampPath = StampPath(sourcePath, options);
+			Stamp stamp;
+			if (ReadStamp(stampPath, stamp) && (stamp.sourceSize == sourceSize) && (stamp.sourceWriteTime == sourceWriteTime)) {
+				std::string path = CookedPath(stamp.contentKey);
+				if (std::filesystem::exists(path, ec)) {
+					cookedPath = std::move(path);
+					return Result::Warm;
+				}
+			}
+
+			//the source changed, or was never cooked
+			std::vector<uint8_t> sourceData{};
+			if (!ReadFile(sourcePath, sourceData)) {
+				failures.fetch_add(1, std::memory_order_relaxed);
+				return Result::Failed;
+			}
+			const uint64_t contentKey = Hash::FNV1a(sourceData.data(), sourceData.size(), OptionsKey(options));
+			std::string path = CookedPath(contentKey);
+			Result result = Result::Rehashed;
+			if (!std::filesystem::exists(path, ec)) {
+				const auto cookStart = std::chrono::steady_clock::now();
+				if (!Cook(sourceData, options, path)) {
+					printf("failed to cook texture : %s\n", sourcePath.c_str());
+					failures.fetch_add(1, std::memory_order_relaxed);
+					return Result::Failed;
+				}
+				cookNS.fetch_add(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - cookStart).count()), std::memory_order_relaxed);
+				result = Result::Cooked;
+			}
+
+			stamp.magic = stampMagic;
+			stamp.version = cookerVersion;
+			stamp.sourceSize = sourceSize;
+			stamp.sourceWriteTime = sourceWriteTime;
+			stamp.contentKey = contentKey;
+			WriteStamp(stampPath, stamp);
+
+			cookedPath = std::move(path);
+			return result;
+		}
+
+		void Discard(std::string const& sourcePath, Options const& options, std::string const& cookedPath) {
+			printf("discarding cooked texture %s for %s\n", cookedPath.c_str(), sourcePath.c_str());
+			failures.fetch_add(1, std::memory_order_relaxed);
+			std::error_code ec;
+			std::filesystem::remove(cookedPath, ec);
+			std::filesystem::remove(StampPath(sourcePath, options), ec);
+		}
+
+		uint32_t CookDirectory(std::string const& directory, Options const& options) {
+			std::error_code ec;
+			if (!std::filesystem::is_directory(directory, ec)) {
+				printf("texture cook directory doesn't exist : %s\n", directory.c_str());
+				return 0;
+			}
+			uint32_t cooked = 0;
+			for (auto const& entry : std::filesystem::recursive_directory_iterator(directory, ec)) {
+				if (!entry.is_regular_file(ec)) {
+					continue;
+				}
+				std::string extension = entry.path().extension().string();
+				std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+				if ((extension != ".png") && (extension != ".jpg") && (extension != ".jpeg") && (extension != ".tga")) {
+					continue;
+				}
+				std::string cookedPath;
+				//the same path string Image_Manager will be handed, so the stamps line up
+				if (GetCooked(entry.path().generic_string(), options, cookedPath) == Result::Cooked) {
+					cooked++;
+				}
+			}
+			return cooked;
+		}
+
+		void RecordLoad(Result result, std::chrono::steady_clock::duration duration) {
+			const uint64_t nanoseconds = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+			switch (result) {
+				case Result::Warm:
+					warmLoads.fetch_add(1, std::memory_order_relaxed);
+					warmLoadNS.fetch_add(nanoseconds, std::memory_order_relaxed);
+					break;
+				case Result::Rehashed:
+					rehashedLoads.fetch_add(1, std::memory_order_relaxed);
+					rehashedLoadNS.fetch_add(nanoseconds, std::memory_order_relaxed);
+					break;
+				case Result::Cooked:
+					coldLoads.fetch_add(1, std::memory_order_relaxed);
+					coldLoadNS.fetch_add(nanoseconds, std::memory_order_relaxed);
+					break;
+				case Result::Failed:
+					break;
+			}
+		}
+
+		Stats GetStats() {
+			Stats ret{};
+			ret.warmLoads = warmLoads.load(std::memory_order_relaxed);
+			ret.warmLoadMS = static_cast<double>(warmLoadNS.load(std::memory_order_relaxed)) / 1000000.0;
+			ret.rehashedLoads = rehashedLoads.load(std::memory_order_relaxed);
+			ret.rehashedLoadMS = static_cast<double>(rehashedLoadNS.load(std::memory_order_relaxed)) / 1000000.0;
+			ret.coldLoads = coldLoads.load(std::memory_order_relaxed);
+			ret.coldLoadMS = static_cast<double>(coldLoadNS.load(std::memory_order_relaxed)) / 1000000.0;
+			ret.cookMS = static_cast<double>(cookNS.load(std::memory_order_relaxed)) / 1000000.0;
+			ret.failures = failures.load(std::memory_order_relaxed);
+			return ret;
+		}
+
+		void PrintStats() {
+			const Stats stats = GetStats();
+			const auto average = [](double total, uint32_t count) {
+				return count > 0 ? total / static_cast<double>(count) : 0.0;
+			};
+			printf("texture cooker - warm %u loads, %.3f ms avg : rehashed %u loads, %.3f ms avg : cold %u loads, %.3f ms avg (%.3f ms cooking) : %u failed\n",
+				stats.warmLoads, average(stats.warmLoadMS, stats.warmLoads),
+				stats.rehashedLoads, average(stats.rehashedLoadMS, stats.rehashedLoads),
+				stats.coldLoads, average(stats.coldLoadMS, stats.coldLoads), stats.cookMS,
+				stats.failures
+			);
+		}
+	} //namespace TextureCooker
+} //namespace EWE
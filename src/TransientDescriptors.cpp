@@ -0,0 +1,213 @@
+#include "EWGraphics/Vulkan/TransientDescriptors.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+
+namespace EWE {
+	namespace TransientDescriptors {
+		struct FrameChain {
+			std::vector<VkDescriptorPool> pools{};
+			uint32_t current{ 0 };
+			//the epoch the pools were last reset at
+			std::size_t epoch{ 0 };
+		};
+		//only touched by its own thread, besides Destroy
+		struct ThreadArena {
+			std::array<FrameChain, MAX_FRAMES_IN_FLIGHT> frames{};
+		};
+
+		//bumped by BeginFrame once the frame's fence has passed
+		static std::array<std::atomic<std::size_t>, MAX_FRAMES_IN_FLIGHT> frameEpochs{};
+
+		static std::mutex arenaMutex{};
+		static std::vector<ThreadArena*> arenas{};
+		//a thread's cached arena is stale after Destroy
+		static std::atomic<uint32_t> arenaGeneration{ 1 };
+
+		static std::atomic<uint32_t> frameAllocations{ 0 };
+		static std::atomic<uint32_t> framePoolsChained{ 0 };
+		static std::atomic<uint32_t> framePoolsCreated{ 0 };
+		static std::atomic<uint32_t> totalPools{ 0 };
+		static Stats lastFrame{};
+
+		static ThreadArena& GetArena() {
+			thread_local ThreadArena* arena{ nullptr };
+			thread_local uint32_t generation{ 0 };
+			const uint32_t currentGeneration = arenaGeneration.load(std::memory_order_acquire);
+			if ((arena == nullptr) || (generation != currentGeneration)) {
+				arena = Construct<ThreadArena>();
+				generation = currentGeneration;
+				std::unique_lock<std::mutex> lock{ arenaMutex };
+				arenas.push_back(arena);
+			}
+			return *arena;
+		}
+
+		//every descriptor type the engine creates layouts with, per set. roughly the same ratios as the global pool
+		struct PoolRatio {
+			VkDescriptorType type;
+			uint32_t perSet;
+		};
+		static constexpr std::array<PoolRatio, 11> poolRatios{
+			PoolRatio{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2 },
+			PoolRatio{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2 },
+			PoolRatio{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1 },
+			PoolRatio{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 1 },
+			PoolRatio{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4 },
+			PoolRatio{ VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 2 },
+			PoolRatio{ VK_DESCRIPTOR_TYPE_SAMPLER, 1 },
+			PoolRatio{ VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1 },
+			PoolRatio{ VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER, 1 },
+			PoolRatio{ VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER, 1 },
+			PoolRatio{ VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, 1 },
+		};
+		static std::size_t RatioIndex(VkDescriptorType type) {
+			for (std::size_t i = 0; i < poolRatios.size(); i++) {
+				if (poolRatios[i].type == type) {
+					return i;
+				}
+			}
+			return poolRatios.size();
+		}
+
+		//pools are reset as a whole, they can't hold update after bind sets, and they only have room for the types above
+		static void Validate(DescriptorSetLayout const& eDSL) {
+			if (eDSL.bindless || eDSL.descriptorBuffer) {
+				throw std::runtime_error("transient descriptor sets can't use a bindless or descriptor buffer layout");
+			}
+			for (auto flags : eDSL.bindingFlags) {
+				if (flags & VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT) {
+					throw std::runtime_error("transient descriptor sets can't use an update after bind layout");
+				}
+			}
+			for (auto const& binding : eDSL.bindings) {
+				if (RatioIndex(binding.descriptorType) == poolRatios.size()) {
+					printf("transient descriptor pools have no room for descriptor type %d\n", binding.descriptorType);
+					throw std::runtime_error("unsupported descriptor type for a transient descriptor set");
+				}
+			}
+		}
+
+		//fitLayout has to fit in the new pool while it's empty, a layout bigger than the usual ratios gets a pool sized for it
+		static VkDescriptorPool CreatePool(DescriptorSetLayout const& fitLayout) {
+			std::array<VkDescriptorPoolSize, poolRatios.size()> poolSizes{};
+			for (std::size_t i = 0; i < poolRatios.size(); i++) {
+				poolSizes[i].type = poolRatios[i].type;
+				poolSizes[i].descriptorCount = TRANSIENT_DESCRIPTOR_POOL_SETS * poolRatios[i].perSet;
+			}
+			std::array<uint32_t, poolRatios.size()> required{};
+			for (auto const& binding : fitLayout.bindings) {
+				required[RatioIndex(binding.descriptorType)] += binding.descriptorCount;
+			}
+			for (std::size_t i = 0; i < poolRatios.size(); i++) {
+				poolSizes[i].descriptorCount = std::max(poolSizes[i].descriptorCount, required[i]);
+			}
+			VkDescriptorPoolCreateInfo poolInfo{};
+			poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+			poolInfo.pNext = nullptr;
+			//no FREE_DESCRIPTOR_SET_BIT, the pool is only ever reset as a whole
+			poolInfo.flags = 0;
+			poolInfo.maxSets = TRANSIENT_DESCRIPTOR_POOL_SETS;
+			poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+			poolInfo.pPoolSizes = poolSizes.data();
+
+			VkDescriptorPool pool;
+			EWE_VK(vkCreateDescriptorPool, VK::Object->vkDevice, &poolInfo, nullptr, &pool);
+			framePoolsCreated.fetch_add(1, std::memory_order_relaxed);
+			totalPools.fetch_add(1, std::memory_order_relaxed);
+			return pool;
+		}
+
+		void BeginFrame() {
+			assert(VK::Object->CheckMainThread());
+			frameEpochs[VK::Object->frameIndex].fetch_add(1, std::memory_order_release);
+
+			lastFrame.allocations = frameAllocations.exchange(0, std::memory_order_relaxed);
+			lastFrame.poolsChained = framePoolsChained.exchange(0, std::memory_order_relaxed);
+			lastFrame.poolsCreated = framePoolsCreated.exchange(0, std::memory_order_relaxed);
+		}
+
+		VkDescriptorSet Allocate(DescriptorSetLayout* eDSL) {
+			Validate(*eDSL);
+			FrameChain& chain = GetArena().frames[VK::Object->frameIndex];
+
+			const std::size_t epoch = frameEpochs[VK::Object->frameIndex].load(std::memory_order_acquire);
+			if (chain.epoch != epoch) {
+				//the GPU is done with everything allocated the last time this frame index was recorded
+				//pools past current weren't touched
+				const std::size_t usedPools = std::min<std::size_t>(chain.current + 1, chain.pools.size());
+				for (std::size_t i = 0; i < usedPools; i++) {
+					EWE_VK(vkResetDescriptorPool, VK::Object->vkDevice, chain.pools[i], 0);
+				}
+				chain.current = 0;
+				chain.epoch = epoch;
+			}
+			if (chain.pools.size() == 0) {
+				chain.pools.push_back(CreatePool(*eDSL));
+			}
+
+			VkDescriptorSetAllocateInfo allocInfo{};
+			allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+			allocInfo.pNext = nullptr;
+			allocInfo.descriptorSetCount = 1;
+			allocInfo.pSetLayouts = &eDSL->vkDSL;
+
+			VkDescriptorSet ret;
+			while (true) {
+				allocInfo.descriptorPool = chain.pools[chain.current];
+				const VkResult result = vkAllocateDescriptorSets(VK::Object->vkDevice, &allocInfo, &ret);
+				if (result == VK_SUCCESS) {
+					break;
+				}
+				if ((result != VK_ERROR_OUT_OF_POOL_MEMORY) && (result != VK_ERROR_FRAGMENTED_POOL)) {
+					EWE_VK_RESULT(result);
+				}
+				//full, move down the chain
+				framePoolsChained.fetch_add(1, std::memory_order_relaxed);
+				chain.current++;
+				if (chain.current == chain.pools.size()) {
+					chain.pools.push_back(CreatePool(*eDSL));
+					allocInfo.descriptorPool = chain.pools[chain.current];
+					//the new pool was sized to fit it
+					EWE_VK(vkAllocateDescriptorSets, VK::Object->vkDevice, &allocInfo, &ret);
+					break;
+				}
+			}
+			frameAllocations.fetch_add(1, std::memory_order_relaxed);
+			return ret;
+		}
+		void Destroy() {
+			assert(VK::Object->CheckMainThread());
+			std::unique_lock<std::mutex> lock{ arenaMutex };
+			for (auto* arena : arenas) {
+				for (auto& chain : arena->frames) {
+					for (auto pool : chain.pools) {
+						EWE_VK(vkDestroyDescriptorPool, VK::Object->vkDevice, pool, nullptr);
+					}
+				}
+				Deconstruct(arena);
+			}
+			arenas.clear();
+			totalPools = 0;
+			arenaGeneration.fetch_add(1, std::memory_order_release);
+		}
+
+		Stats GetStats() {
+			Stats ret = lastFrame;
+			ret.totalPools = totalPools.load(std::memory_order_relaxed);
+			std::unique_lock<std::mutex> lock{ arenaMutex };
+			ret.threads = static_cast<uint32_t>(arenas.size());
+			return ret;
+		}
+		void PrintStats() {
+			const Stats stats = GetStats();
+			printf("transient descriptors - last frame allocations:chained:created - %u:%u:%u, pools:threads - %u:%u\n",
+				stats.allocations, stats.poolsChained, stats.poolsCreated,
+				stats.totalPools, stats.threads
+			);
+		}
+	} //namespace TransientDescriptors
+} //namespace EWE
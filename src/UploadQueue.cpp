@@ -0,0 +1,358 @@
+#include "EWGraphics/Vulkan/UploadQueue.h"
+
+#include "EWGraphics/Vulkan/SubmissionThread.h"
+#include "EWGraphics/Vulkan/Device_Buffer.h"
+#include "EWGraphics/Texture/ImageFunctions.h"
+
+#include <algorithm>
+
+namespace EWE {
+
+	bool UploadToken::Poll() const {
+		return UploadQueue::Poll(*this);
+	}
+	void UploadToken::Wait() const {
+		UploadQueue::Wait(*this);
+	}
+
+	UploadQueue* UploadQueue::uploadQueuePtr{ nullptr };
+
+	UploadQueue::UploadQueue() :
+		usingTransferQueue{ VK::Object->queueEnabled[Queue::transfer] },
+		ownershipTransfer{ VK::Object->queueEnabled[Queue::transfer] && (VK::Object->queueIndex[Queue::transfer] != VK::Object->queueIndex[Queue::graphics]) }
+	{
+		assert(uploadQueuePtr == nullptr);
+		uploadQueuePtr = this;
+
+		VkCommandPoolCreateInfo poolInfo{};
+		poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		poolInfo.pNext = nullptr;
+		poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+		poolInfo.queueFamilyIndex = VK::Object->queueIndex[usingTransferQueue ? Queue::transfer : Queue::graphics];
+		EWE_VK(vkCreateCommandPool, VK::Object->vkDevice, &poolInfo, nullptr, &cmdPool);
+
+		std::array<VkCommandBuffer, batchCount> cmdBufs{};
+		VkCommandBufferAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		allocInfo.pNext = nullptr;
+		allocInfo.commandPool = cmdPool;
+		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		allocInfo.commandBufferCount = batchCount;
+		EWE_VK(vkAllocateCommandBuffers, VK::Object->vkDevice, &allocInfo, cmdBufs.data());
+
+		VkFenceCreateInfo fenceInfo{};
+		fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+		fenceInfo.pNext = nullptr;
+		fenceInfo.flags = 0;
+		VkSemaphoreCreateInfo semInfo{};
+		semInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+		semInfo.pNext = nullptr;
+		semInfo.flags = 0;
+
+		for (uint8_t i = 0; i < batchCount; i++) {
+			batches[i].cmdBuf = cmdBufs[i];
+			EWE_VK(vkCreateFence, VK::Object->vkDevice, &fenceInfo, nullptr, &batches[i].fence);
+			EWE_VK(vkCreateSemaphore, VK::Object->vkDevice, &semInfo, nullptr, &batches[i].semaphore.vkSemaphore);
+#if DEBUG_NAMING
+			std::string name = "upload batch[" + std::to_string(i) + ']';
+			DebugNaming::SetObjectName(batches[i].cmdBuf.cmdBuf, VK_OBJECT_TYPE_COMMAND_BUFFER, name.c_str());
+			DebugNaming::SetObjectName(batches[i].semaphore.vkSemaphore, VK_OBJECT_TYPE_SEMAPHORE, name.c_str());
+#endif
+		}
+	}
+
+	UploadQueue::~UploadQueue() {
+		//the device is expected to be idle here
+		for (auto& batch : batches) {
+			for (auto& sb : batch.stagingBuffers) {
+				sb->Free();
+				Deconstruct(sb);
+			}
+			EWE_VK(vkDestroyFence, VK::Object->vkDevice, batch.fence, nullptr);
+			EWE_VK(vkDestroySemaphore, VK::Object->vkDevice, batch.semaphore.vkSemaphore, nullptr);
+		}
+		for (auto& pending : pendingBuffers) {
+			pending.stagingBuffer->Free();
+			Deconstruct(pending.stagingBuffer);
+		}
+		for (auto& pending : pendingImages) {
+			pending.stagingBuffer->Free();
+			Deconstruct(pending.stagingBuffer);
+		}
+		EWE_VK(vkDestroyCommandPool, VK::Object->vkDevice, cmdPool, nullptr);
+		uploadQueuePtr = nullptr;
+	}
+
+	UploadToken UploadQueue::EnqueueBuffer(StagingBuffer* stagingBuffer, EWEBuffer& dstBuffer, VkDeviceSize size) {
+		std::unique_lock<std::mutex> uniq_lock(uploadQueuePtr->mut);
+		uploadQueuePtr->pendingBuffers.emplace_back(stagingBuffer, &dstBuffer, size);
+		return UploadToken{ uploadQueuePtr->openBatch };
+	}
+
+	UploadToken UploadQueue::EnqueueImage(StagingBuffer* stagingBuffer, ImageInfo& imageInfo, uint32_t width, uint32_t height, bool mipmapping) {
+		std::unique_lock<std::mutex> uniq_lock(uploadQueuePtr->mut);
+		uploadQueuePtr->pendingImages.emplace_back(stagingBuffer, &imageInfo, width, height, mipmapping && MIPMAP_ENABLED);
+		return UploadToken{ uploadQueuePtr->openBatch };
+	}
+	UploadToken UploadQueue::EnqueueImage(StagingBuffer* stagingBuffer, ImageInfo& imageInfo, std::vector<VkBufferImageCopy>&& regions) {
+		assert(regions.size() > 0);
+		std::unique_lock<std::mutex> uniq_lock(uploadQueuePtr->mut);
+		uploadQueuePtr->pendingImages.emplace_back(stagingBuffer, &imageInfo, imageInfo.width, imageInfo.height, false, std::move(regions));
+		return UploadToken{ uploadQueuePtr->openBatch };
+	}
+
+	void UploadQueue::Flush() {
+		std::unique_lock<std::mutex> uniq_lock(uploadQueuePtr->mut);
+		while (!uploadQueuePtr->FlushLocked()) {
+			//every batch is in flight, they're released as frames complete
+			uniq_lock.unlock();
+			std::this_thread::sleep_for(std::chrono::microseconds(1));
+			uniq_lock.lock();
+		}
+	}
+
+	void UploadQueue::Wait(UploadToken token) {
+		assert(!VK::Object->CheckMainThread() && "the main thread records the acquires, waiting on it from the main thread would never return");
+		if (Poll(token)) {
+			return;
+		}
+		uploadQueuePtr->mut.lock();
+		const bool needsFlush = token.batch == uploadQueuePtr->openBatch;
+		uploadQueuePtr->mut.unlock();
+		if (needsFlush) {
+			Flush();
+		}
+		while (!Poll(token)) {
+			std::this_thread::sleep_for(std::chrono::nanoseconds(1));
+		}
+	}
+
+	void UploadQueue::RetireBatches() {
+		for (auto& batch : batches) {
+			if (batch.submitted && (vkGetFenceStatus(VK::Object->vkDevice, batch.fence) == VK_SUCCESS)) {
+				EWE_VK(vkResetFences, VK::Object->vkDevice, 1, &batch.fence);
+				for (auto& sb : batch.stagingBuffers) {
+					sb->Free();
+					Deconstruct(sb);
+				}
+				batch.stagingBuffers.clear();
+				batch.cmdBuf.Reset();
+				batch.submitted = false;
+			}
+			if (batch.inUse && batch.acquired && batch.Idle()) {
+				batch.acquires.Clear();
+				batch.images.clear();
+				batch.acquired = false;
+				batch.inUse = false;
+			}
+		}
+	}
+
+	UploadQueue::Batch* UploadQueue::TryAcquireBatch() {
+		RetireBatches();
+		for (auto& batch : batches) {
+			if (!batch.inUse) {
+				batch.inUse = true;
+				return &batch;
+			}
+		}
+		return nullptr;
+	}
+
+	bool UploadQueue::FlushLocked() {
+		if ((pendingBuffers.size() == 0) && (pendingImages.size() == 0)) {
+			return true;
+		}
+		Batch* batch = TryAcquireBatch();
+		if (batch == nullptr) {
+			return false;
+		}
+		batch->id = openBatch++;
+		RecordBatch(*batch);
+
+		VkSubmitInfo submitInfo{};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.pNext = nullptr;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &batch->cmdBuf.cmdBuf;
+		submitInfo.waitSemaphoreCount = 0;
+		submitInfo.pWaitSemaphores = nullptr;
+		if (usingTransferQueue) {
+			batch->semaphore.BeginSignaling();
+			submitInfo.signalSemaphoreCount = 1;
+			submitInfo.pSignalSemaphores = &batch->semaphore.vkSemaphore;
+
+			//the acquire isn't recorded until this has actually been submitted, the frame can't wait on an unsubmitted signal
+			batch->packetSubmitted.store(false, std::memory_order_relaxed);
+			SubmissionThread::Get(Queue::transfer)->Submit(submitInfo, batch->fence, &batch->packetSubmitted);
+		}
+		else {
+			//same queue as the frame, the barriers recorded in the batch are enough
+			submitInfo.signalSemaphoreCount = 0;
+			submitInfo.pSignalSemaphores = nullptr;
+			SubmissionThread::Get(Queue::graphics)->Submit(submitInfo, batch->fence);
+			for (auto& image : batch->images) {
+				image.imageInfo->descriptorImageInfo.imageLayout = image.imageInfo->destinationImageLayout;
+			}
+			batch->acquired = true;
+			completedBatch.store(batch->id, std::memory_order_release);
+		}
+		batch->submitted = true;
+		return true;
+	}
+
+	static void RecordBarriers(CommandBuffer& cmdBuf, VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage, std::vector<VkBufferMemoryBarrier> const& bufferBarriers, std::vector<VkImageMemoryBarrier> const& imageBarriers) {
+		if ((bufferBarriers.size() == 0) && (imageBarriers.size() == 0)) {
+			return;
+		}
+		EWE_VK(vkCmdPipelineBarrier, cmdBuf,
+			srcStage, dstStage,
+			0,
+			0, nullptr,
+			static_cast<uint32_t>(bufferBarriers.size()), bufferBarriers.data(),
+			static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data()
+		);
+	}
+
+	//what the graphics queue is going to do with the uploaded resources
+	static constexpr ResourceUsage bufferReadUsage{ Queue::graphics, VK_IMAGE_LAYOUT_UNDEFINED, VK_ACCESS_MEMORY_READ_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT };
+	static constexpr ResourceUsage imageReadUsage{ Queue::graphics, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT };
+
+	void UploadQueue::RecordBatch(Batch& batch) {
+		batch.cmdBuf.BeginSingleTime();
+
+		const ResourceUsage transferWriteUsage{ usingTransferQueue ? Queue::transfer : Queue::graphics, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT };
+
+		//everything is fully overwritten, so the previous contents are discarded instead of transferred
+		{
+			std::vector<VkBufferMemoryBarrier> bufferBarriers{};
+			std::vector<VkImageMemoryBarrier> imageBarriers{};
+			VkPipelineStageFlags srcStage = 0;
+			for (auto& pending : pendingBuffers) {
+				const BufferTransition transition = ResourceTracker::Transition(*pending.dstBuffer, transferWriteUsage, true);
+				if (transition.acquire) {
+					bufferBarriers.push_back(transition.acquireBarrier);
+					srcStage |= transition.acquireSrcStage;
+				}
+			}
+			for (auto& pending : pendingImages) {
+				const ImageTransition transition = ResourceTracker::Transition(*pending.imageInfo, transferWriteUsage, true);
+				if (transition.acquire) {
+					imageBarriers.push_back(transition.acquireBarrier);
+					srcStage |= transition.acquireSrcStage;
+				}
+			}
+			RecordBarriers(batch.cmdBuf, srcStage, VK_PIPELINE_STAGE_TRANSFER_BIT, bufferBarriers, imageBarriers);
+		}
+
+		std::vector<VkBufferMemoryBarrier> bufferReleases{};
+		std::vector<VkImageMemoryBarrier> imageReleases{};
+		VkPipelineStageFlags releaseSrcStage = 0;
+		//without a transfer queue, the acquire half is on the same queue, and goes straight into the batch
+		PendingAcquires localAcquires{};
+
+		auto addTransition = [&](auto const& transition, auto& releases) {
+			if (transition.release) {
+				releases.push_back(transition.releaseBarrier);
+				releaseSrcStage |= transition.releaseSrcStage;
+			}
+			if (transition.acquire) {
+				(usingTransferQueue ? batch.acquires : localAcquires).Add(transition);
+			}
+		};
+
+		for (auto& pending : pendingBuffers) {
+			VK::CopyBuffer(batch.cmdBuf, pending.stagingBuffer->buffer, pending.dstBuffer->GetBuffer(), pending.size);
+			batch.stagingBuffers.push_back(pending.stagingBuffer);
+
+			addTransition(ResourceTracker::Transition(*pending.dstBuffer, bufferReadUsage), bufferReleases);
+		}
+		pendingBuffers.clear();
+
+		for (auto& pending : pendingImages) {
+			if (pending.regions.size() > 0) {
+				Image::CopyBufferToImage(batch.cmdBuf, pending.stagingBuffer->buffer, pending.imageInfo->image, pending.regions);
+			}
+			else {
+				Image::CopyBufferToImage(batch.cmdBuf, pending.stagingBuffer->buffer, pending.imageInfo->image, pending.width, pending.height, pending.imageInfo->arrayLayers);
+			}
+			batch.stagingBuffers.push_back(pending.stagingBuffer);
+
+			if (!pending.mipmapping) {
+				addTransition(ResourceTracker::Transition(*pending.imageInfo, imageReadUsage), imageReleases);
+			}
+			else if (!usingTransferQueue) {
+				Image::GenerateMipmaps(batch.cmdBuf, pending.imageInfo, Queue::graphics);
+				ResourceTracker::SetState(pending.imageInfo->state, imageReadUsage);
+			}
+			else if (ownershipTransfer) {
+				//GenerateMipmaps only takes mip 0 from the transfer family, it records the matching acquire itself
+				VkImageMemoryBarrier& release = imageReleases.emplace_back();
+				release.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+				release.pNext = nullptr;
+				release.image = pending.imageInfo->image;
+				release.srcQueueFamilyIndex = VK::Object->queueIndex[Queue::transfer];
+				release.dstQueueFamilyIndex = VK::Object->queueIndex[Queue::graphics];
+				release.subresourceRange = Image::CreateSubresourceRange(*pending.imageInfo);
+				release.subresourceRange.levelCount = 1;
+				release.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+				release.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+				release.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+				release.dstAccessMask = 0;
+				releaseSrcStage |= VK_PIPELINE_STAGE_TRANSFER_BIT;
+			}
+			batch.images.push_back(pending);
+		}
+		pendingImages.clear();
+
+		RecordBarriers(batch.cmdBuf, releaseSrcStage, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, bufferReleases, imageReleases);
+		RecordBarriers(batch.cmdBuf, localAcquires.srcStage, localAcquires.dstStage, localAcquires.buffers, localAcquires.images);
+
+		EWE_VK(vkEndCommandBuffer, batch.cmdBuf);
+	}
+
+	void UploadQueue::RecordAcquires(CommandBuffer& frameCmdBuf, RenderSyncData& renderSyncData) {
+		assert(VK::Object->CheckMainThread());
+
+		std::unique_lock<std::mutex> uniq_lock(mut);
+		//if every batch is in flight, the pending copies wait for the next frame
+		FlushLocked();
+		RetireBatches();
+
+		if (!usingTransferQueue) {
+			return;
+		}
+
+		std::vector<Batch*> toAcquire{};
+		for (auto& batch : batches) {
+			if (batch.inUse && !batch.acquired && batch.packetSubmitted.load(std::memory_order_acquire)) {
+				toAcquire.push_back(&batch);
+			}
+		}
+		if (toAcquire.size() == 0) {
+			return;
+		}
+		std::sort(toAcquire.begin(), toAcquire.end(), [](Batch* lh, Batch* rh) { return lh->id < rh->id; });
+
+		PendingAcquires acquires{};
+		for (auto& batch : toAcquire) {
+			acquires.Append(batch->acquires);
+			for (auto& image : batch->images) {
+				if (image.mipmapping) {
+					Image::GenerateMipmaps(frameCmdBuf, image.imageInfo, ownershipTransfer ? Queue::transfer : Queue::graphics);
+					ResourceTracker::SetState(image.imageInfo->state, imageReadUsage);
+				}
+			}
+			renderSyncData.AddWaitSemaphore(&batch->semaphore, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+		}
+		RecordBarriers(frameCmdBuf, acquires.srcStage, acquires.dstStage, acquires.buffers, acquires.images);
+
+		for (auto& batch : toAcquire) {
+			for (auto& image : batch->images) {
+				image.imageInfo->descriptorImageInfo.imageLayout = image.imageInfo->destinationImageLayout;
+			}
+			batch->acquired = true;
+		}
+		completedBatch.store(toAcquire.back()->id, std::memory_order_release);
+	}
+} //namespace EWE
@@ -0,0 +1,120 @@
+#include "TestCommon.h"
+
+#include "EWGraphics/Vulkan/DescriptorSetCache.h"
+#include "EWGraphics/Data/RetireQueue.h"
+
+using namespace EWE;
+
+//fake handles, the index never dereferences them
+static VkWriteDescriptorSet BufferWrite(uint32_t binding, VkDescriptorBufferInfo const* bufferInfo) {
+	VkWriteDescriptorSet write{};
+	write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	write.dstBinding = binding;
+	write.descriptorCount = 1;
+	write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	write.pBufferInfo = bufferInfo;
+	return write;
+}
+static VkWriteDescriptorSet ImageWrite(uint32_t binding, VkDescriptorImageInfo const* imageInfo) {
+	VkWriteDescriptorSet write{};
+	write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	write.dstBinding = binding;
+	write.descriptorCount = 1;
+	write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	write.pImageInfo = imageInfo;
+	return write;
+}
+
+static const VkDescriptorSetLayout layout = Test::MakeHandle<VkDescriptorSetLayout>(0x100);
+static const VkBuffer buffer = Test::MakeHandle<VkBuffer>(0x200);
+static const VkImageView view = Test::MakeHandle<VkImageView>(0x300);
+static const VkSampler sampler = Test::MakeHandle<VkSampler>(0x400);
+
+static void KeyIdentity() {
+	const VkDescriptorBufferInfo bufferInfo{ buffer, 0, 256 };
+	const VkDescriptorImageInfo imageInfo{ sampler, view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+	VkWriteDescriptorSet writes[2] = { BufferWrite(0, &bufferInfo), ImageWrite(1, &imageInfo) };
+
+	const auto key = DescriptorSetCache::MakeKey(layout, writes, 2);
+	EWE_CHECK(DescriptorSetCache::Cacheable(key));
+	//dstSet isn't part of it
+	writes[0].dstSet = Test::MakeHandle<VkDescriptorSet>(0x999);
+	EWE_CHECK(DescriptorSetCache::MakeKey(layout, writes, 2) == key);
+	//every resource, deduplicated, for eviction
+	EWE_CHECK(key.resources.size() == 4);
+
+	const VkDescriptorBufferInfo offsetInfo{ buffer, 256, 256 };
+	VkWriteDescriptorSet offsetWrites[2] = { BufferWrite(0, &offsetInfo), writes[1] };
+	EWE_CHECK(!(DescriptorSetCache::MakeKey(layout, offsetWrites, 2) == key));
+
+	const VkDescriptorImageInfo generalInfo{ sampler, view, VK_IMAGE_LAYOUT_GENERAL };
+	VkWriteDescriptorSet layoutWrites[2] = { writes[0], ImageWrite(1, &generalInfo) };
+	EWE_CHECK(!(DescriptorSetCache::MakeKey(layout, layoutWrites, 2) == key));
+
+	EWE_CHECK(!(DescriptorSetCache::MakeKey(Test::MakeHandle<VkDescriptorSetLayout>(0x101), writes, 2) == key));
+
+	//texel buffers aren't cached
+	VkWriteDescriptorSet texelWrite{};
+	texelWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	texelWrite.descriptorCount = 1;
+	texelWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+	EWE_CHECK(!DescriptorSetCache::Cacheable(DescriptorSetCache::MakeKey(layout, &texelWrite, 1)));
+}
+
+static void IndexEviction() {
+	DescriptorSetCache::Index index{};
+	const VkDescriptorBufferInfo bufferInfo{ buffer, 0, 256 };
+	const VkDescriptorImageInfo imageInfo{ sampler, view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+	const VkWriteDescriptorSet bufferOnly = BufferWrite(0, &bufferInfo);
+	const VkWriteDescriptorSet imageOnly = ImageWrite(0, &imageInfo);
+	const VkDescriptorSet bufferSet = Test::MakeHandle<VkDescriptorSet>(0x1000);
+	const VkDescriptorSet imageSet = Test::MakeHandle<VkDescriptorSet>(0x2000);
+
+	EWE_CHECK(index.Find(DescriptorSetCache::MakeKey(layout, &bufferOnly, 1)) == VK_NULL_HANDLE);
+	index.Insert(DescriptorSetCache::MakeKey(layout, &bufferOnly, 1), bufferSet);
+	index.Insert(DescriptorSetCache::MakeKey(layout, &imageOnly, 1), imageSet);
+	EWE_CHECK(index.Find(DescriptorSetCache::MakeKey(layout, &bufferOnly, 1)) == bufferSet);
+	EWE_CHECK(index.Find(DescriptorSetCache::MakeKey(layout, &imageOnly, 1)) == imageSet);
+	EWE_CHECK(index.hits == 2 && index.misses == 1);
+	EWE_CHECK(index.Live() == 2);
+
+	//only the set that referenced the view goes
+	const auto evicted = index.Evict(DescriptorSetCache::HandleBits(view));
+	EWE_CHECK(evicted.size() == 1 && evicted[0] == imageSet);
+	EWE_CHECK(index.Live() == 1);
+	EWE_CHECK(index.Find(DescriptorSetCache::MakeKey(layout, &imageOnly, 1)) == VK_NULL_HANDLE);
+	//the sampler's list lost the evicted set too
+	EWE_CHECK(index.Evict(DescriptorSetCache::HandleBits(sampler)).empty());
+
+	//the layout is referenced by everything
+	const auto byLayout = index.Evict(DescriptorSetCache::HandleBits(layout));
+	EWE_CHECK(byLayout.size() == 1 && byLayout[0] == bufferSet);
+	EWE_CHECK(index.Live() == 0);
+	EWE_CHECK(index.evictions == 2);
+}
+
+//the same delay rule every deferred deletion uses
+static void RetireQueueDelay() {
+	RetireQueue<uint32_t> queue{ 2 };
+	queue.Push(1, 5);
+	queue.Push(2, 6);
+	std::vector<uint32_t> released{};
+	auto release = [&released](uint32_t object) { released.push_back(object); };
+
+	EWE_CHECK(queue.Collect(7, release) == 0);
+	EWE_CHECK(queue.Collect(8, release) == 1);
+	EWE_CHECK(released.size() == 1 && released[0] == 1);
+	EWE_CHECK(queue.Size() == 1);
+
+	queue.Push(3, 100);
+	queue.Flush(release);
+	EWE_CHECK(queue.Empty());
+	EWE_CHECK(released.size() == 3);
+}
+
+int main() {
+	KeyIdentity();
+	IndexEviction();
+	RetireQueueDelay();
+	return Test::Finish("DescriptorSetCacheTests");
+}
@@ -0,0 +1,87 @@
+#include "TestCommon.h"
+
+#include "EWGraphics/Vulkan/Descriptors.h"
+
+#include <cstdio>
+
+using namespace EWE;
+
+//the CPU side of one set update, both ways. building the VkWriteDescriptorSet vector the way EWEDescriptorWriter does,
+//against packing the template's data from it. the driver's half of either call needs a device, it isn't timed here
+
+using TemplateData = DescriptorSetLayout::TemplateData;
+
+static constexpr uint32_t updateCount = 2000000;
+
+struct Layout {
+	const char* name;
+	std::vector<VkDescriptorType> types;
+};
+
+static void Run(Layout const& layout) {
+	const std::size_t bindingCount = layout.types.size();
+	std::vector<VkDescriptorBufferInfo> bufferInfos(bindingCount);
+	std::vector<VkDescriptorImageInfo> imageInfos(bindingCount);
+	for (std::size_t i = 0; i < bindingCount; i++) {
+		bufferInfos[i] = VkDescriptorBufferInfo{ Test::MakeHandle<VkBuffer>(0x100 + i), 0, 256 };
+		imageInfos[i] = VkDescriptorImageInfo{ Test::MakeHandle<VkSampler>(0x200 + i), Test::MakeHandle<VkImageView>(0x300 + i), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+	}
+	auto isBuffer = [](VkDescriptorType type) {
+		return (type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER) || (type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)
+			|| (type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC) || (type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC);
+	};
+
+	std::vector<VkWriteDescriptorSet> writes{};
+	writes.reserve(bindingCount);
+	auto buildWrites = [&](uint32_t update) {
+		writes.clear();
+		for (std::size_t i = 0; i < bindingCount; i++) {
+			VkWriteDescriptorSet write{};
+			write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			write.pNext = nullptr;
+			write.dstSet = Test::MakeHandle<VkDescriptorSet>(0x1000 + (update & 0xFF));
+			write.dstBinding = static_cast<uint32_t>(i);
+			write.descriptorCount = 1;
+			write.descriptorType = layout.types[i];
+			if (isBuffer(layout.types[i])) {
+				write.pBufferInfo = &bufferInfos[i];
+			}
+			else {
+				write.pImageInfo = &imageInfos[i];
+			}
+			writes.push_back(write);
+		}
+	};
+
+	uint64_t writeSum = 0;
+	const double writesMS = Test::TimeMS([&] {
+		for (uint32_t update = 0; update < updateCount; update++) {
+			buildWrites(update);
+			writeSum += writes.back().dstBinding;
+		}
+	});
+
+	buildWrites(0);
+	TemplateData data[16];
+	uint64_t packSum = 0;
+	const double packMS = Test::TimeMS([&] {
+		for (uint32_t update = 0; update < updateCount; update++) {
+			DescriptorSetLayout::PackTemplateData(writes, data);
+			packSum += data[update % bindingCount].buffer.range;
+		}
+	});
+	Test::KeepAlive(writeSum + packSum);
+
+	printf("%s, %zu bindings - build writes %.1f ns (%zu bytes), pack template data %.1f ns (%zu bytes)\n",
+		layout.name, bindingCount,
+		writesMS * 1000000.0 / updateCount, sizeof(VkWriteDescriptorSet) * bindingCount,
+		packMS * 1000000.0 / updateCount, sizeof(TemplateData) * bindingCount
+	);
+}
+
+int main() {
+	Run(Layout{ "camera", { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER } });
+	Run(Layout{ "material", { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER } });
+	Run(Layout{ "skinned", { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER } });
+	return 0;
+}
@@ -0,0 +1,68 @@
+#include "TestCommon.h"
+
+#include "EWGraphics/Vulkan/Descriptors.h"
+
+using namespace EWE;
+
+using TemplateData = DescriptorSetLayout::TemplateData;
+
+static VkDescriptorSetLayoutBinding Binding(uint32_t binding, VkDescriptorType type, uint32_t count = 1) {
+	return VkDescriptorSetLayoutBinding{ binding, type, count, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr };
+}
+
+static void Entries() {
+	const std::vector<VkDescriptorSetLayoutBinding> bindings{
+		Binding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER),
+		Binding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER),
+		Binding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC),
+	};
+	std::vector<VkDescriptorUpdateTemplateEntry> entries{};
+	EWE_CHECK(DescriptorSetLayout::BuildTemplateEntries(bindings, entries));
+	EWE_CHECK(entries.size() == bindings.size());
+	for (std::size_t i = 0; i < entries.size(); i++) {
+		EWE_CHECK(entries[i].dstBinding == i);
+		EWE_CHECK(entries[i].descriptorType == bindings[i].descriptorType);
+		EWE_CHECK(entries[i].descriptorCount == 1);
+		EWE_CHECK(entries[i].offset == i * sizeof(TemplateData));
+		EWE_CHECK(entries[i].stride == sizeof(TemplateData));
+	}
+}
+
+//these keep using vkUpdateDescriptorSets
+static void Rejected() {
+	std::vector<VkDescriptorUpdateTemplateEntry> entries{};
+	EWE_CHECK(!DescriptorSetLayout::BuildTemplateEntries({ Binding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4) }, entries));
+	EWE_CHECK(!DescriptorSetLayout::BuildTemplateEntries({ Binding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER), Binding(2, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER) }, entries));
+	EWE_CHECK(!DescriptorSetLayout::BuildTemplateEntries({ Binding(0, VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER) }, entries));
+}
+
+static void Packing() {
+	const VkDescriptorBufferInfo bufferInfo{ Test::MakeHandle<VkBuffer>(0x10), 64, 128 };
+	const VkDescriptorImageInfo imageInfo{ Test::MakeHandle<VkSampler>(0x20), Test::MakeHandle<VkImageView>(0x30), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+	std::vector<VkWriteDescriptorSet> writes(2);
+	writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	writes[0].dstBinding = 0;
+	writes[0].descriptorCount = 1;
+	writes[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	writes[0].pBufferInfo = &bufferInfo;
+	writes[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	writes[1].dstBinding = 1;
+	writes[1].descriptorCount = 1;
+	writes[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	writes[1].pImageInfo = &imageInfo;
+
+	TemplateData data[2]{};
+	DescriptorSetLayout::PackTemplateData(writes, data);
+	EWE_CHECK(data[0].buffer.buffer == bufferInfo.buffer);
+	EWE_CHECK(data[0].buffer.offset == 64 && data[0].buffer.range == 128);
+	EWE_CHECK(data[1].image.sampler == imageInfo.sampler);
+	EWE_CHECK(data[1].image.imageView == imageInfo.imageView);
+	EWE_CHECK(data[1].image.imageLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+}
+
+int main() {
+	Entries();
+	Rejected();
+	Packing();
+	return Test::Finish("DescriptorTemplateTests");
+}
@@ -0,0 +1,80 @@
+#include "TestCommon.h"
+
+#include "EWGraphics/Data/FlatRegistry.h"
+
+#include <algorithm>
+
+using namespace EWE;
+
+using Registry = FlatRegistry<uint32_t, int, 64>;
+
+static void InsertGet() {
+	Registry registry{};
+	EWE_CHECK(registry.Get(3) == nullptr);
+	EWE_CHECK(!registry.Contains(3));
+	//past the capacity is never live
+	EWE_CHECK(!registry.Contains(64));
+	EWE_CHECK(registry.Get(1000) == nullptr);
+
+	const uint32_t generation = registry.Insert(3, 30);
+	EWE_CHECK(registry.Contains(3));
+	EWE_CHECK(registry.At(3) == 30);
+	EWE_CHECK(*registry.Get(3) == 30);
+	EWE_CHECK(registry.IsValid(3, generation));
+	EWE_CHECK(registry.LiveIDs().size() == 1);
+}
+
+static void Generations() {
+	Registry registry{};
+	const uint32_t first = registry.Insert(5, 1);
+	EWE_CHECK(registry.Erase(5));
+	EWE_CHECK(!registry.Erase(5));
+	EWE_CHECK(!registry.IsValid(5, first));
+	EWE_CHECK(registry.Get(5) == nullptr);
+
+	const uint32_t second = registry.Insert(5, 2);
+	EWE_CHECK(second != first);
+	EWE_CHECK(registry.IsValid(5, second));
+	EWE_CHECK(!registry.IsValid(5, first));
+	EWE_CHECK(registry.At(5) == 2);
+}
+
+//erasing from the middle keeps the packed list exact
+static void LiveIDs() {
+	Registry registry{};
+	for (uint32_t id = 0; id < 10; id++) {
+		registry.Insert(id * 3, static_cast<int>(id));
+	}
+	registry.Erase(0);
+	registry.Erase(12);
+	registry.Erase(27);
+	auto live = registry.LiveIDs();
+	std::sort(live.begin(), live.end());
+	EWE_CHECK((live == std::vector<uint32_t>{ 3, 6, 9, 15, 18, 21, 24 }));
+
+	//the moved IDs still erase correctly
+	for (uint32_t id : live) {
+		EWE_CHECK(registry.Erase(id));
+	}
+	EWE_CHECK(registry.LiveIDs().empty());
+}
+
+static void Clear() {
+	Registry registry{};
+	const uint32_t generation = registry.Insert(1, 1);
+	registry.Insert(2, 2);
+	registry.Clear();
+	EWE_CHECK(registry.LiveIDs().empty());
+	EWE_CHECK(!registry.Contains(1) && !registry.Contains(2));
+	EWE_CHECK(!registry.IsValid(1, generation));
+	registry.Insert(1, 3);
+	EWE_CHECK(registry.At(1) == 3);
+}
+
+int main() {
+	InsertGet();
+	Generations();
+	LiveIDs();
+	Clear();
+	return Test::Finish("FlatRegistryTests");
+}
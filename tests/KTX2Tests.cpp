@@ -0,0 +1,128 @@
+#include "TestCommon.h"
+
+#include "EWGraphics/Texture/KTX2.h"
+
+#include <algorithm>
+#include <filesystem>
+
+using namespace EWE;
+
+static void Put32(std::vector<uint8_t>& out, uint32_t value) {
+	for (uint32_t i = 0; i < 4; i++) {
+		out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+	}
+}
+static void Put64(std::vector<uint8_t>& out, uint64_t value) {
+	for (uint32_t i = 0; i < 8; i++) {
+		out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+	}
+}
+
+//a 2D block compressed file with no dfd or key/value data, levels stored back to back after the index
+static std::vector<uint8_t> MakeFile(VkFormat format, uint32_t width, uint32_t height, uint32_t levelCount, uint32_t blockBytes, uint32_t supercompression = 0) {
+	std::vector<uint8_t> file{ 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+	Put32(file, static_cast<uint32_t>(format));
+	Put32(file, 1); //type size
+	Put32(file, width);
+	Put32(file, height);
+	Put32(file, 0); //depth
+	Put32(file, 0); //layers
+	Put32(file, 1); //faces
+	Put32(file, levelCount);
+	Put32(file, supercompression);
+	for (uint32_t i = 0; i < 4; i++) {
+		Put32(file, 0); //dfd and kvd offset/size
+	}
+	Put64(file, 0); //sgd
+	Put64(file, 0);
+
+	std::vector<uint64_t> sizes{};
+	for (uint32_t i = 0; i < levelCount; i++) {
+		const uint32_t levelWidth = std::max(width >> i, 1u);
+		const uint32_t levelHeight = std::max(height >> i, 1u);
+		sizes.push_back(static_cast<uint64_t>((levelWidth + 3) / 4) * ((levelHeight + 3) / 4) * blockBytes);
+	}
+	uint64_t offset = 80 + 24 * levelCount;
+	for (uint32_t i = 0; i < levelCount; i++) {
+		Put64(file, offset);
+		Put64(file, sizes[i]);
+		Put64(file, sizes[i]);
+		offset += sizes[i];
+	}
+	for (uint32_t i = 0; i < levelCount; i++) {
+		file.insert(file.end(), static_cast<std::size_t>(sizes[i]), static_cast<uint8_t>(i + 1));
+	}
+	return file;
+}
+
+static void ParseSuccess() {
+	KTX2::Texture texture{};
+	EWE_CHECK(KTX2::Parse(MakeFile(VK_FORMAT_BC7_SRGB_BLOCK, 256, 128, 9, 16), texture) == KTX2::ParseResult::Success);
+	EWE_CHECK(texture.format == VK_FORMAT_BC7_SRGB_BLOCK);
+	EWE_CHECK(texture.width == 256 && texture.height == 128);
+	EWE_CHECK(texture.levels.size() == 9);
+	EWE_CHECK(texture.levels[0].width == 256 && texture.levels[0].height == 128);
+	EWE_CHECK(texture.levels[8].width == 1 && texture.levels[8].height == 1);
+	EWE_CHECK(texture.levels[1].size == (128 / 4) * (64 / 4) * 16);
+
+	std::vector<uint64_t> packedOffsets{};
+	const uint64_t total = KTX2::PackLevels(texture, packedOffsets);
+	EWE_CHECK(packedOffsets.size() == texture.levels.size());
+	for (std::size_t i = 0; i < packedOffsets.size(); i++) {
+		EWE_CHECK(packedOffsets[i] % KTX2::LEVEL_ALIGNMENT == 0);
+	}
+	EWE_CHECK(total >= packedOffsets.back() + texture.levels.back().size);
+}
+
+static void ParseFailures() {
+	KTX2::Texture texture{};
+	//a 256x128 chain has 9 levels
+	EWE_CHECK(KTX2::Parse(MakeFile(VK_FORMAT_BC7_SRGB_BLOCK, 256, 128, 10, 16), texture) == KTX2::ParseResult::Malformed);
+	EWE_CHECK(KTX2::Parse(MakeFile(VK_FORMAT_BC1_RGB_UNORM_BLOCK, 64, 64, 7, 8, 1), texture) == KTX2::ParseResult::Unsupported);
+
+	auto truncated = MakeFile(VK_FORMAT_BC1_RGB_UNORM_BLOCK, 64, 64, 7, 8);
+	truncated.pop_back();
+	EWE_CHECK(KTX2::Parse(std::move(truncated), texture) == KTX2::ParseResult::Truncated);
+
+	auto badIdentifier = MakeFile(VK_FORMAT_BC1_RGB_UNORM_BLOCK, 64, 64, 7, 8);
+	badIdentifier[1] = 'X';
+	EWE_CHECK(KTX2::Parse(std::move(badIdentifier), texture) == KTX2::ParseResult::BadIdentifier);
+
+	EWE_CHECK(KTX2::Parse(std::vector<uint8_t>(12, 0), texture) != KTX2::ParseResult::Success);
+}
+
+static void Paths() {
+	EWE_CHECK(KTX2::IsKTX2Path("textures/albedo.ktx2"));
+	EWE_CHECK(!KTX2::IsKTX2Path("textures/albedo.png"));
+	EWE_CHECK(!KTX2::IsKTX2Path("ktx2"));
+}
+
+static void WriteRoundTrip() {
+	const std::string path = "ktx2_round_trip.ktx2";
+	std::vector<std::vector<uint8_t>> levels{};
+	for (uint32_t size = 16, i = 0; size >= 4; size /= 2, i++) {
+		levels.emplace_back(static_cast<std::size_t>((size / 4) * (size / 4) * 8), static_cast<uint8_t>(0x10 + i));
+	}
+	EWE_CHECK(KTX2::Write(path, VK_FORMAT_BC1_RGBA_UNORM_BLOCK, 16, 16, levels));
+
+	KTX2::Texture texture{};
+	EWE_CHECK(KTX2::Load(path, texture) == KTX2::ParseResult::Success);
+	EWE_CHECK(texture.format == VK_FORMAT_BC1_RGBA_UNORM_BLOCK);
+	EWE_CHECK(texture.levels.size() == levels.size());
+	for (std::size_t i = 0; (i < levels.size()) && (i < texture.levels.size()); i++) {
+		EWE_CHECK(texture.levels[i].size == levels[i].size());
+		EWE_CHECK(std::equal(levels[i].begin(), levels[i].end(), texture.data.begin() + static_cast<std::ptrdiff_t>(texture.levels[i].offset)));
+	}
+
+	//the format has no dfd here
+	EWE_CHECK(!KTX2::Write(path, VK_FORMAT_BC7_SRGB_BLOCK, 16, 16, levels));
+	std::filesystem::remove(path);
+}
+
+int main() {
+	ParseSuccess();
+	ParseFailures();
+	Paths();
+	WriteRoundTrip();
+	return Test::Finish("KTX2Tests");
+}
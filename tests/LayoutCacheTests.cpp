@@ -0,0 +1,70 @@
+#include "TestCommon.h"
+
+#include "EWGraphics/Vulkan/LayoutCache.h"
+
+using namespace EWE;
+
+static std::vector<VkDescriptorSetLayoutBinding> MakeBindings() {
+	return {
+		VkDescriptorSetLayoutBinding{ 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, nullptr },
+		VkDescriptorSetLayoutBinding{ 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr },
+	};
+}
+
+static void DSLKeying() {
+	const auto bindings = MakeBindings();
+	const std::vector<VkDescriptorBindingFlags> noFlags{};
+	const std::vector<VkDescriptorBindingFlags> zeroFlags(bindings.size(), 0);
+
+	//a caller that doesn't pass flags shares the layout with one that passes zeros
+	EWE_CHECK(LayoutCache::HashDSL(bindings, noFlags) == LayoutCache::HashDSL(bindings, zeroFlags));
+	EWE_CHECK(LayoutCache::SameDSL(bindings, noFlags, bindings, zeroFlags));
+
+	auto stages = bindings;
+	stages[1].stageFlags |= VK_SHADER_STAGE_VERTEX_BIT;
+	EWE_CHECK(!LayoutCache::SameDSL(bindings, noFlags, stages, noFlags));
+	EWE_CHECK(LayoutCache::HashDSL(bindings, noFlags) != LayoutCache::HashDSL(stages, noFlags));
+
+	auto count = bindings;
+	count[1].descriptorCount = 8;
+	EWE_CHECK(!LayoutCache::SameDSL(bindings, noFlags, count, noFlags));
+
+	auto type = bindings;
+	type[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+	EWE_CHECK(!LayoutCache::SameDSL(bindings, noFlags, type, noFlags));
+
+	std::vector<VkDescriptorBindingFlags> partiallyBound(bindings.size(), 0);
+	partiallyBound[1] = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT;
+	EWE_CHECK(!LayoutCache::SameDSL(bindings, noFlags, bindings, partiallyBound));
+	EWE_CHECK(LayoutCache::HashDSL(bindings, noFlags) != LayoutCache::HashDSL(bindings, partiallyBound));
+
+	const std::vector<VkDescriptorSetLayoutBinding> fewer{ bindings[0] };
+	EWE_CHECK(!LayoutCache::SameDSL(bindings, noFlags, fewer, noFlags));
+}
+
+static void PipeLayoutKeying() {
+	const std::vector<VkDescriptorSetLayout> setLayouts{ Test::MakeHandle<VkDescriptorSetLayout>(0x10), Test::MakeHandle<VkDescriptorSetLayout>(0x20) };
+	const std::vector<VkPushConstantRange> pushRanges{
+		VkPushConstantRange{ VK_SHADER_STAGE_VERTEX_BIT, 0, 64 },
+		VkPushConstantRange{ VK_SHADER_STAGE_FRAGMENT_BIT, 64, 16 },
+	};
+	EWE_CHECK(LayoutCache::SamePipeLayout(setLayouts, pushRanges, setLayouts, pushRanges));
+	EWE_CHECK(LayoutCache::HashPipeLayout(setLayouts, pushRanges) == LayoutCache::HashPipeLayout(setLayouts, pushRanges));
+
+	const std::vector<VkDescriptorSetLayout> swapped{ setLayouts[1], setLayouts[0] };
+	EWE_CHECK(!LayoutCache::SamePipeLayout(setLayouts, pushRanges, swapped, pushRanges));
+	EWE_CHECK(LayoutCache::HashPipeLayout(setLayouts, pushRanges) != LayoutCache::HashPipeLayout(swapped, pushRanges));
+
+	auto resized = pushRanges;
+	resized[1].size = 32;
+	EWE_CHECK(!LayoutCache::SamePipeLayout(setLayouts, pushRanges, setLayouts, resized));
+	EWE_CHECK(LayoutCache::HashPipeLayout(setLayouts, pushRanges) != LayoutCache::HashPipeLayout(setLayouts, resized));
+
+	EWE_CHECK(!LayoutCache::SamePipeLayout(setLayouts, pushRanges, setLayouts, {}));
+}
+
+int main() {
+	DSLKeying();
+	PipeLayoutKeying();
+	return Test::Finish("LayoutCacheTests");
+}
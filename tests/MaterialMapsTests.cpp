@@ -0,0 +1,60 @@
+#include "TestCommon.h"
+
+#include "EWGraphics/Texture/Material_Textures.h"
+
+#include <filesystem>
+#include <fstream>
+
+using namespace EWE;
+
+//TEXTURE_DIR is relative to the working directory, the files are made under it
+static const std::filesystem::path materialDir{ "textures/material_maps_test" };
+
+static void Touch(std::string const& filename) {
+	std::ofstream{ materialDir / filename } << "x";
+}
+
+static void FindsMapsInAttributeOrder() {
+	Touch("brickDiffuse.png");
+	Touch("brickalbedo.jpg"); //Diffuse is probed first
+	Touch("brickNormal.tga");
+	Touch("brickrough.png");
+	Touch("brickunrelated.png");
+	Touch("stoneDiffuse.png");
+	Material_Image::ClearDirectoryIndex();
+
+	const auto maps = Material_Image::FindMaps("material_maps_test/brick");
+	EWE_CHECK(maps.flags == (Material::Flags::Texture::Albedo | Material::Flags::Texture::Rough | Material::Flags::Texture::Normal));
+	EWE_CHECK(maps.paths.size() == 3);
+	if (maps.paths.size() == 3) {
+		EWE_CHECK(maps.paths[0] == "textures/material_maps_test/brickDiffuse.png");
+		EWE_CHECK(maps.paths[1] == "textures/material_maps_test/brickrough.png");
+		EWE_CHECK(maps.paths[2] == "textures/material_maps_test/brickNormal.tga");
+	}
+
+	//the prefix has to match in full
+	const auto stone = Material_Image::FindMaps("material_maps_test/stone");
+	EWE_CHECK(stone.flags == Material::Flags::Texture::Albedo);
+	EWE_CHECK(Material_Image::FindMaps("material_maps_test/bric").flags == 0);
+}
+
+//the scan is cached until it's cleared
+static void IndexIsCached() {
+	const uint16_t before = Material_Image::FindMaps("material_maps_test/brick").flags;
+	Touch("brickao.png");
+	EWE_CHECK(Material_Image::FindMaps("material_maps_test/brick").flags == before);
+
+	Material_Image::ClearDirectoryIndex();
+	EWE_CHECK(Material_Image::FindMaps("material_maps_test/brick").flags == (before | Material::Flags::Texture::AO));
+}
+
+int main() {
+	std::filesystem::remove_all(materialDir);
+	std::filesystem::create_directories(materialDir);
+
+	FindsMapsInAttributeOrder();
+	IndexIsCached();
+
+	std::filesystem::remove_all(materialDir);
+	return Test::Finish("MaterialMapsTests");
+}
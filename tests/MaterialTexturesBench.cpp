@@ -0,0 +1,130 @@
+#include "TestCommon.h"
+
+#include "EWGraphics/Texture/Material_Textures.h"
+#include "EWGraphics/Data/ThreadPool.h"
+
+#include "stb/stb_image.h"
+
+#include <array>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+using namespace EWE;
+
+//TEXTURE_DIR is relative to the working directory, the files are made under it
+static const std::filesystem::path materialDir{ "textures/material_bench" };
+
+static constexpr uint32_t materialCount = 32;
+static constexpr uint32_t mapSize = 512;
+//one suffix per attribute, each a few probes into its list so the old path pays for the misses
+static const std::array<std::string, 4> mapSuffixes{ "albedo.png", "Roughness.jpg", "normal.tga", "AmbientOcclusion.tga" };
+
+//uncompressed 32 bit tga, stb decodes it whatever the extension says
+static void WriteMap(std::filesystem::path const& path, uint32_t seed) {
+	std::vector<uint8_t> file(18 + static_cast<std::size_t>(mapSize) * mapSize * 4);
+	file[2] = 2;
+	file[12] = mapSize & 0xFF;
+	file[13] = mapSize >> 8;
+	file[14] = mapSize & 0xFF;
+	file[15] = mapSize >> 8;
+	file[16] = 32;
+	file[17] = 8;
+	for (std::size_t i = 18; i < file.size(); i++) {
+		file[i] = static_cast<uint8_t>(((i + seed) * 2654435761u) >> 24);
+	}
+	std::ofstream{ path, std::ios::binary }.write(reinterpret_cast<const char*>(file.data()), static_cast<std::streamsize>(file.size()));
+}
+
+static std::string MaterialName(uint32_t index) {
+	return "mat" + std::to_string(index) + "_";
+}
+
+//what CreateMaterialImage did before the index, an exists() per suffix and extension, then one stbi_load after another
+static std::vector<PixelPeek> SerialLoad(std::string const& texPath) {
+	const std::array<std::vector<std::string>, Material::Attributes::Texture::SIZE> matImgTypes = {
+		std::vector<std::string>{"bump", "height"},
+		std::vector<std::string>{"Diffuse", "albedo", "diffuse", "Albedo", "BaseColor", "Base_Color"},
+		std::vector<std::string>{"metallic", "metal", "Metallic", "Metal"},
+		std::vector<std::string>{"roughness", "rough", "Rough", "Roughness"},
+		std::vector<std::string>{"Normal", "normal" },
+		std::vector<std::string>{"ao", "ambientOcclusion", "AO", "AmbientOcclusion", "Ao"},
+	};
+	std::vector<std::string> paths{};
+	for (auto const& suffixes : matImgTypes) {
+		bool found = false;
+		for (std::size_t j = 0; (j < suffixes.size()) && !found; j++) {
+			for (auto const& extension : { ".png", ".jpg", ".tga" }) {
+				const std::string path = "textures/" + texPath + suffixes[j] + extension;
+				if (std::filesystem::exists(path)) {
+					paths.push_back(path);
+					found = true;
+					break;
+				}
+			}
+		}
+	}
+	std::vector<PixelPeek> pixelPeeks{};
+	for (auto const& path : paths) {
+		pixelPeeks.emplace_back(path);
+	}
+	return pixelPeeks;
+}
+
+static std::vector<PixelPeek> IndexedLoad(std::string const& texPath) {
+	return Material_Image::DecodeMaps(std::move(Material_Image::FindMaps(texPath).paths));
+}
+
+template<typename Load>
+static double TimeAll(Load&& load) {
+	uint64_t mapCount = 0;
+	const double ms = Test::TimeMS([&] {
+		for (uint32_t i = 0; i < materialCount; i++) {
+			std::vector<PixelPeek> pixelPeeks = load("material_bench/" + MaterialName(i));
+			mapCount += pixelPeeks.size();
+			for (auto& peek : pixelPeeks) {
+				Test::KeepAlive(static_cast<const uint8_t*>(peek.pixels)[0]);
+				stbi_image_free(peek.pixels);
+			}
+		}
+	});
+	if (mapCount != materialCount * mapSuffixes.size()) {
+		printf("expected %zu maps, loaded %llu\n", materialCount * mapSuffixes.size(), static_cast<unsigned long long>(mapCount));
+	}
+	return ms;
+}
+
+//N materials of 4 maps each, the serial probe and decode against the directory index and the pool decode
+int main() {
+	ThreadPool::Construct();
+
+	std::filesystem::remove_all(materialDir);
+	std::filesystem::create_directories(materialDir);
+	for (uint32_t i = 0; i < materialCount; i++) {
+		for (uint32_t map = 0; map < mapSuffixes.size(); map++) {
+			WriteMap(materialDir / (MaterialName(i) + mapSuffixes[map]), i * 4 + map);
+		}
+	}
+
+	//first pass pulls the files into the page cache, so neither side pays for the disk
+	TimeAll(SerialLoad);
+
+	static constexpr uint32_t iterations = 4;
+	double serialMS = 0.0;
+	double coldIndexMS = 0.0;
+	double warmIndexMS = 0.0;
+	for (uint32_t i = 0; i < iterations; i++) {
+		serialMS += TimeAll(SerialLoad);
+		Material_Image::ClearDirectoryIndex();
+		coldIndexMS += TimeAll(IndexedLoad);
+		warmIndexMS += TimeAll(IndexedLoad);
+	}
+	printf("%u materials, %zu %ux%u maps each, %zu pool threads\n", materialCount, mapSuffixes.size(), mapSize, mapSize, ThreadPool::GetThreadCount());
+	printf("serial exists + decode - %.2f ms\n", serialMS / iterations);
+	printf("index scan + pool decode - %.2f ms\n", coldIndexMS / iterations);
+	printf("cached index + pool decode - %.2f ms\n", warmIndexMS / iterations);
+
+	std::filesystem::remove_all(materialDir);
+	ThreadPool::Deconstruct();
+	return 0;
+}
@@ -0,0 +1,49 @@
+#include "TestCommon.h"
+
+#include "EWGraphics/Texture/MipGenerator.h"
+#include "EWGraphics/Data/ThreadPool.h"
+
+#include <cstdio>
+
+using namespace EWE;
+
+//full chains for a 2048x2048 texture, both filters, with and without coverage preservation
+int main() {
+	ThreadPool::Construct();
+
+	const uint32_t width = 2048;
+	const uint32_t height = 2048;
+	std::vector<uint8_t> src(static_cast<std::size_t>(width) * height * 4);
+	for (std::size_t i = 0; i < src.size(); i++) {
+		src[i] = static_cast<uint8_t>((i * 2654435761u) >> 24);
+	}
+	const uint32_t levelCount = MipGenerator::LevelCount(width, height);
+	std::vector<MipGenerator::Level> levels{};
+	std::vector<uint8_t> chain(MipGenerator::Layout(width, height, levelCount, levels));
+
+	static constexpr uint32_t iterations = 8;
+	for (auto filter : { MipGenerator::Filter::Box, MipGenerator::Filter::Kaiser }) {
+		for (bool preserveCoverage : { false, true }) {
+			MipGenerator::Options options{};
+			options.filter = filter;
+			options.preserveAlphaCoverage = preserveCoverage;
+			//first run warms the pool and the pages
+			MipGenerator::Generate(src.data(), width, height, levelCount, chain.data(), options);
+			const double totalMS = Test::TimeMS([&] {
+				for (uint32_t i = 0; i < iterations; i++) {
+					MipGenerator::Generate(src.data(), width, height, levelCount, chain.data(), options);
+				}
+			});
+			Test::KeepAlive(chain[levels.back().offset]);
+			printf("%ux%u %s%s - %.2f ms per chain\n", width, height,
+				filter == MipGenerator::Filter::Box ? "box" : "kaiser",
+				preserveCoverage ? " with coverage" : "",
+				totalMS / iterations
+			);
+		}
+	}
+	MipGenerator::PrintStats();
+
+	ThreadPool::Deconstruct();
+	return 0;
+}
@@ -0,0 +1,168 @@
+#include "TestCommon.h"
+
+#include "EWGraphics/Texture/MipGenerator.h"
+#include "EWGraphics/Data/ThreadPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <utility>
+
+using namespace EWE;
+
+static float SRGBToLinear(uint8_t value) {
+	const float normalized = value / 255.f;
+	return normalized <= 0.04045f ? normalized / 12.92f : std::pow((normalized + 0.055f) / 1.055f, 2.4f);
+}
+static uint8_t LinearToSRGB(float value) {
+	value = std::clamp(value, 0.f, 1.f);
+	const float encoded = value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.f / 2.4f) - 0.055f;
+	return static_cast<uint8_t>(std::clamp(encoded * 255.f + 0.5f, 0.f, 255.f));
+}
+
+static std::vector<uint8_t> RandomImage(uint32_t width, uint32_t height) {
+	std::vector<uint8_t> image(static_cast<std::size_t>(width) * height * 4);
+	for (auto& byte : image) {
+		byte = static_cast<uint8_t>(rand() & 255);
+	}
+	return image;
+}
+
+static void LevelCount() {
+	EWE_CHECK(MipGenerator::LevelCount(1, 1) == 1);
+	EWE_CHECK(MipGenerator::LevelCount(2, 1) == 2);
+	EWE_CHECK(MipGenerator::LevelCount(256, 256) == 9);
+	EWE_CHECK(MipGenerator::LevelCount(300, 5) == 9);
+	EWE_CHECK(MipGenerator::LevelCount(1, 1024) == 11);
+}
+
+static void Layout() {
+	std::vector<MipGenerator::Level> levels{};
+	const uint64_t size = MipGenerator::Layout(37, 19, MipGenerator::LevelCount(37, 19), levels);
+	EWE_CHECK(levels.size() == 6);
+	uint64_t expectedOffset = 0;
+	for (auto const& level : levels) {
+		EWE_CHECK(level.offset == expectedOffset);
+		expectedOffset += static_cast<uint64_t>(level.width) * level.height * 4;
+	}
+	EWE_CHECK(size == expectedOffset);
+	EWE_CHECK(levels[1].width == 18 && levels[1].height == 9);
+	EWE_CHECK(levels.back().width == 1 && levels.back().height == 1);
+}
+
+//every level against a scalar 2x2 average of the stored level above it
+static void BoxMatchesReference() {
+	for (auto [width, height] : std::vector<std::pair<uint32_t, uint32_t>>{ { 1, 1 }, { 2, 1 }, { 1, 7 }, { 37, 19 }, { 64, 64 }, { 300, 5 } }) {
+		const auto src = RandomImage(width, height);
+		const uint32_t levelCount = MipGenerator::LevelCount(width, height);
+		std::vector<MipGenerator::Level> levels{};
+		const uint64_t size = MipGenerator::Layout(width, height, levelCount, levels);
+		//the tail catches writes past the chain
+		std::vector<uint8_t> chain(size + 64, 0xCD);
+		MipGenerator::Generate(src.data(), width, height, levelCount, chain.data(), MipGenerator::Options{});
+
+		EWE_CHECK(std::equal(src.begin(), src.end(), chain.begin()));
+		EWE_CHECK(std::all_of(chain.begin() + static_cast<std::ptrdiff_t>(size), chain.end(), [](uint8_t byte) { return byte == 0xCD; }));
+
+		int maxError = 0;
+		for (uint32_t level = 1; level < levelCount; level++) {
+			auto const& above = levels[level - 1];
+			auto const& current = levels[level];
+			for (uint32_t y = 0; y < current.height; y++) {
+				for (uint32_t x = 0; x < current.width; x++) {
+					const uint32_t xs[2] = { std::min(2 * x, above.width - 1), std::min(2 * x + 1, above.width - 1) };
+					const uint32_t ys[2] = { std::min(2 * y, above.height - 1), std::min(2 * y + 1, above.height - 1) };
+					for (uint32_t channel = 0; channel < 4; channel++) {
+						float sum = 0.f;
+						for (uint32_t sy : ys) {
+							for (uint32_t sx : xs) {
+								const uint8_t value = chain[above.offset + (sy * above.width + sx) * 4 + channel];
+								sum += channel == 3 ? value / 255.f : SRGBToLinear(value);
+							}
+						}
+						sum *= 0.25f;
+						const int reference = channel == 3 ? static_cast<int>(sum * 255.f + 0.5f) : LinearToSRGB(sum);
+						maxError = std::max(maxError, std::abs(reference - static_cast<int>(chain[current.offset + (y * current.width + x) * 4 + channel])));
+					}
+				}
+			}
+		}
+		//the SIMD path rounds slightly differently
+		EWE_CHECK(maxError <= 1);
+	}
+}
+
+//a flat image stays flat through the kaiser filter, the weights sum to 1
+static void KaiserPreservesConstant() {
+	const uint32_t width = 64;
+	const uint32_t height = 48;
+	std::vector<uint8_t> flat(width * height * 4);
+	for (uint32_t i = 0; i < width * height; i++) {
+		flat[i * 4 + 0] = 200;
+		flat[i * 4 + 1] = 10;
+		flat[i * 4 + 2] = 128;
+		flat[i * 4 + 3] = 77;
+	}
+	const uint32_t levelCount = MipGenerator::LevelCount(width, height);
+	std::vector<MipGenerator::Level> levels{};
+	std::vector<uint8_t> chain(MipGenerator::Layout(width, height, levelCount, levels));
+	MipGenerator::Options options{};
+	options.filter = MipGenerator::Filter::Kaiser;
+	MipGenerator::Generate(flat.data(), width, height, levelCount, chain.data(), options);
+
+	int maxError = 0;
+	for (std::size_t i = 0; i < chain.size(); i += 4) {
+		maxError = std::max({ maxError, std::abs(chain[i] - 200), std::abs(chain[i + 1] - 10), std::abs(chain[i + 2] - 128), std::abs(chain[i + 3] - 77) });
+	}
+	EWE_CHECK(maxError <= 1);
+}
+
+static float Coverage(std::vector<uint8_t> const& chain, MipGenerator::Level const& level, uint8_t cutoff) {
+	uint64_t passing = 0;
+	const uint64_t texelCount = static_cast<uint64_t>(level.width) * level.height;
+	for (uint64_t i = 0; i < texelCount; i++) {
+		passing += chain[level.offset + i * 4 + 3] >= cutoff;
+	}
+	return static_cast<float>(passing) / static_cast<float>(texelCount);
+}
+
+static void AlphaCoverage() {
+	const uint32_t width = 256;
+	const uint32_t height = 256;
+	//sparse opaque texels over noise below the cutoff, a box filter thins this out
+	std::vector<uint8_t> src(width * height * 4, 255);
+	for (uint32_t y = 0; y < height; y++) {
+		for (uint32_t x = 0; x < width; x++) {
+			src[(y * width + x) * 4 + 3] = ((x / 3 + y / 5) % 4 == 0) ? 220 : static_cast<uint8_t>(rand() % 100);
+		}
+	}
+	const uint32_t levelCount = MipGenerator::LevelCount(width, height);
+	std::vector<MipGenerator::Level> levels{};
+	std::vector<uint8_t> chain(MipGenerator::Layout(width, height, levelCount, levels));
+
+	MipGenerator::Options options{};
+	options.preserveAlphaCoverage = true;
+	MipGenerator::Generate(src.data(), width, height, levelCount, chain.data(), options);
+	const float baseCoverage = Coverage(chain, levels[0], 128);
+	//the small levels are too coarse to hit it exactly
+	for (uint32_t level = 1; level < 6; level++) {
+		EWE_CHECK(std::abs(Coverage(chain, levels[level], 128) - baseCoverage) < 0.05f);
+	}
+
+	options.preserveAlphaCoverage = false;
+	MipGenerator::Generate(src.data(), width, height, levelCount, chain.data(), options);
+	EWE_CHECK(Coverage(chain, levels[4], 128) < baseCoverage - 0.05f);
+}
+
+int main() {
+	ThreadPool::Construct();
+
+	LevelCount();
+	Layout();
+	BoxMatchesReference();
+	KaiserPreservesConstant();
+	AlphaCoverage();
+
+	ThreadPool::Deconstruct();
+	return Test::Finish("MipGeneratorTests");
+}
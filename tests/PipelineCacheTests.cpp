@@ -0,0 +1,128 @@
+#include "TestCommon.h"
+
+#include "EWGraphics/Vulkan/PipelineCache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+using namespace EWE;
+
+static const std::filesystem::path cachePath{ "pipeline_cache_test.bin" };
+
+static PipelineCache::DeviceIdentity MakeDevice() {
+	PipelineCache::DeviceIdentity device{};
+	device.vendorID = 0x10DE;
+	device.deviceID = 0x2684;
+	device.driverVersion = 0x89A4C000;
+	for (uint32_t i = 0; i < VK_UUID_SIZE; i++) {
+		device.pipelineCacheUUID[i] = static_cast<uint8_t>(i * 7 + 1);
+	}
+	return device;
+}
+
+//what vkGetPipelineCacheData would hand back, the vulkan header then the driver's payload
+static std::vector<uint8_t> MakeCacheData(PipelineCache::DeviceIdentity const& device) {
+	VkPipelineCacheHeaderVersionOne vkHeader{};
+	vkHeader.headerSize = sizeof(VkPipelineCacheHeaderVersionOne);
+	vkHeader.headerVersion = VK_PIPELINE_CACHE_HEADER_VERSION_ONE;
+	vkHeader.vendorID = device.vendorID;
+	vkHeader.deviceID = device.deviceID;
+	memcpy(vkHeader.pipelineCacheUUID, device.pipelineCacheUUID, VK_UUID_SIZE);
+
+	std::vector<uint8_t> data(sizeof(VkPipelineCacheHeaderVersionOne) + 256);
+	memcpy(data.data(), &vkHeader, sizeof(VkPipelineCacheHeaderVersionOne));
+	for (std::size_t i = sizeof(VkPipelineCacheHeaderVersionOne); i < data.size(); i++) {
+		data[i] = static_cast<uint8_t>(i * 31);
+	}
+	return data;
+}
+
+static std::vector<uint8_t> ReadBytes() {
+	std::ifstream inFile{ cachePath, std::ios::binary };
+	return std::vector<uint8_t>{ std::istreambuf_iterator<char>(inFile), std::istreambuf_iterator<char>() };
+}
+static void WriteBytes(std::vector<uint8_t> const& bytes) {
+	std::ofstream{ cachePath, std::ios::binary | std::ios::trunc }.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+}
+
+static void RoundTrip() {
+	const auto device = MakeDevice();
+	const auto data = MakeCacheData(device);
+	EWE_CHECK(PipelineCache::WriteFile(cachePath, device, data.data(), data.size()));
+	EWE_CHECK(PipelineCache::ReadValidatedFile(cachePath, device) == data);
+
+	//the file header is fixed size with no padding, then the data as is
+	const auto bytes = ReadBytes();
+	EWE_CHECK(bytes.size() == 56 + data.size());
+	EWE_CHECK(std::equal(data.begin(), data.end(), bytes.end() - static_cast<std::ptrdiff_t>(data.size())));
+
+	//no file is not an error, the cache starts cold
+	std::filesystem::remove(cachePath);
+	EWE_CHECK(PipelineCache::ReadValidatedFile(cachePath, device).empty());
+}
+
+static void Truncated() {
+	const auto device = MakeDevice();
+	const auto data = MakeCacheData(device);
+	EWE_CHECK(PipelineCache::WriteFile(cachePath, device, data.data(), data.size()));
+	const auto bytes = ReadBytes();
+
+	//short a byte of payload
+	WriteBytes(std::vector<uint8_t>(bytes.begin(), bytes.end() - 1));
+	EWE_CHECK(PipelineCache::ReadValidatedFile(cachePath, device).empty());
+	//cut inside the file header
+	WriteBytes(std::vector<uint8_t>(bytes.begin(), bytes.begin() + 20));
+	EWE_CHECK(PipelineCache::ReadValidatedFile(cachePath, device).empty());
+}
+
+static void WrongUUID() {
+	const auto device = MakeDevice();
+	const auto data = MakeCacheData(device);
+	EWE_CHECK(PipelineCache::WriteFile(cachePath, device, data.data(), data.size()));
+
+	auto otherDevice = device;
+	otherDevice.pipelineCacheUUID[VK_UUID_SIZE - 1] ^= 1;
+	EWE_CHECK(PipelineCache::ReadValidatedFile(cachePath, otherDevice).empty());
+
+	//the file header matches, the vulkan header inside the data doesn't
+	auto staleData = MakeCacheData(otherDevice);
+	EWE_CHECK(PipelineCache::WriteFile(cachePath, device, staleData.data(), staleData.size()));
+	EWE_CHECK(PipelineCache::ReadValidatedFile(cachePath, device).empty());
+}
+
+static void WrongDriverVersion() {
+	const auto device = MakeDevice();
+	const auto data = MakeCacheData(device);
+	EWE_CHECK(PipelineCache::WriteFile(cachePath, device, data.data(), data.size()));
+
+	//the vulkan header doesn't carry the driver version, only the file header catches an update
+	auto updated = device;
+	updated.driverVersion++;
+	EWE_CHECK(PipelineCache::ReadValidatedFile(cachePath, updated).empty());
+	EWE_CHECK(!PipelineCache::ReadValidatedFile(cachePath, device).empty());
+}
+
+static void FlippedPayloadByte() {
+	const auto device = MakeDevice();
+	const auto data = MakeCacheData(device);
+	EWE_CHECK(PipelineCache::WriteFile(cachePath, device, data.data(), data.size()));
+	auto bytes = ReadBytes();
+	bytes[bytes.size() - 10] ^= 0x40;
+	WriteBytes(bytes);
+	EWE_CHECK(PipelineCache::ReadValidatedFile(cachePath, device).empty());
+}
+
+int main() {
+	RoundTrip();
+	Truncated();
+	WrongUUID();
+	WrongDriverVersion();
+	FlippedPayloadByte();
+
+	std::filesystem::remove(cachePath);
+	return Test::Finish("PipelineCacheTests");
+}
@@ -0,0 +1,134 @@
+#include "TestCommon.h"
+
+#include "EWGraphics/Vulkan/PipelineLibrary.h"
+
+#include <algorithm>
+
+using namespace EWE;
+using PipelineLibrary::Part;
+
+static VkPipelineRenderingCreateInfo renderingInfo{};
+static const VkFormat colorFormat = VK_FORMAT_B8G8R8A8_SRGB;
+
+static VkPipelineShaderStageCreateInfo Stage(VkShaderStageFlagBits stage) {
+	VkPipelineShaderStageCreateInfo ret{};
+	ret.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	ret.stage = stage;
+	ret.pName = "main";
+	return ret;
+}
+
+struct Keys {
+	std::vector<uint8_t> bytes[Part::COUNT];
+};
+
+static Keys PackAll(PipelineConfigInfo const& configInfo, VkPipelineLayout vkLayout, PipelineLibrary::ModuleHashes const& moduleHashes) {
+	Keys ret{};
+	ret.bytes[Part::VertexInput] = PipelineLibrary::PackPart(Part::VertexInput, vkLayout, moduleHashes, configInfo, {});
+	ret.bytes[Part::PreRasterization] = PipelineLibrary::PackPart(Part::PreRasterization, vkLayout, moduleHashes, configInfo, { Stage(VK_SHADER_STAGE_VERTEX_BIT) });
+	ret.bytes[Part::FragmentShader] = PipelineLibrary::PackPart(Part::FragmentShader, vkLayout, moduleHashes, configInfo, { Stage(VK_SHADER_STAGE_FRAGMENT_BIT) });
+	ret.bytes[Part::FragmentOutput] = PipelineLibrary::PackPart(Part::FragmentOutput, vkLayout, moduleHashes, configInfo, {});
+	return ret;
+}
+
+//only the parts named in changed have a different key
+static bool OnlyChanged(Keys const& before, Keys const& after, std::initializer_list<Part> changed) {
+	for (uint8_t i = 0; i < Part::COUNT; i++) {
+		const bool expectChange = std::find(changed.begin(), changed.end(), static_cast<Part>(i)) != changed.end();
+		if ((before.bytes[i] != after.bytes[i]) != expectChange) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static PipelineLibrary::ModuleHashes DefaultHashes() {
+	PipelineLibrary::ModuleHashes ret{};
+	ret[ShaderStage::Vertex] = 0x1111;
+	ret[ShaderStage::Fragment] = 0x2222;
+	return ret;
+}
+
+static void Deterministic() {
+	PipelineConfigInfo configInfo{};
+	configInfo.SetToDefaults();
+	const Keys first = PackAll(configInfo, Test::MakeHandle<VkPipelineLayout>(0x10), DefaultHashes());
+	const Keys second = PackAll(configInfo, Test::MakeHandle<VkPipelineLayout>(0x10), DefaultHashes());
+	EWE_CHECK(OnlyChanged(first, second, {}));
+}
+
+//a permutation that changes one part's state reuses the other parts
+static void StateStaysInItsPart() {
+	PipelineConfigInfo configInfo{};
+	configInfo.SetToDefaults();
+	const VkPipelineLayout vkLayout = Test::MakeHandle<VkPipelineLayout>(0x10);
+	const Keys base = PackAll(configInfo, vkLayout, DefaultHashes());
+
+	configInfo.inputAssemblyInfo.topology = VK_PRIMITIVE_TOPOLOGY_LINE_LIST;
+	EWE_CHECK(OnlyChanged(base, PackAll(configInfo, vkLayout, DefaultHashes()), { Part::VertexInput }));
+	configInfo.inputAssemblyInfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+	configInfo.rasterizationInfo.cullMode = VK_CULL_MODE_BACK_BIT;
+	EWE_CHECK(OnlyChanged(base, PackAll(configInfo, vkLayout, DefaultHashes()), { Part::PreRasterization }));
+	configInfo.rasterizationInfo.cullMode = VK_CULL_MODE_NONE;
+
+	configInfo.depthStencilInfo.depthCompareOp = VK_COMPARE_OP_GREATER;
+	EWE_CHECK(OnlyChanged(base, PackAll(configInfo, vkLayout, DefaultHashes()), { Part::FragmentShader }));
+	configInfo.depthStencilInfo.depthCompareOp = VK_COMPARE_OP_LESS;
+
+	configInfo.EnableAlphaBlending();
+	EWE_CHECK(OnlyChanged(base, PackAll(configInfo, vkLayout, DefaultHashes()), { Part::FragmentOutput }));
+	configInfo.SetToDefaults();
+
+	//multisample state is in both fragment parts
+	configInfo.multisampleInfo.alphaToCoverageEnable = VK_TRUE;
+	EWE_CHECK(OnlyChanged(base, PackAll(configInfo, vkLayout, DefaultHashes()), { Part::FragmentShader, Part::FragmentOutput }));
+	configInfo.multisampleInfo.alphaToCoverageEnable = VK_FALSE;
+
+	//dynamic state has to match across every part
+	configInfo.dynamicStateEnables.push_back(VK_DYNAMIC_STATE_LINE_WIDTH);
+	EWE_CHECK(OnlyChanged(base, PackAll(configInfo, vkLayout, DefaultHashes()), { Part::VertexInput, Part::PreRasterization, Part::FragmentShader, Part::FragmentOutput }));
+}
+
+//the shader parts are keyed on the layout and their own shader
+static void ShadersAndLayout() {
+	PipelineConfigInfo configInfo{};
+	configInfo.SetToDefaults();
+	const VkPipelineLayout vkLayout = Test::MakeHandle<VkPipelineLayout>(0x10);
+	const Keys base = PackAll(configInfo, vkLayout, DefaultHashes());
+
+	auto hashes = DefaultHashes();
+	hashes[ShaderStage::Fragment] = 0x3333;
+	EWE_CHECK(OnlyChanged(base, PackAll(configInfo, vkLayout, hashes), { Part::FragmentShader }));
+
+	hashes = DefaultHashes();
+	hashes[ShaderStage::Vertex] = 0x4444;
+	EWE_CHECK(OnlyChanged(base, PackAll(configInfo, vkLayout, hashes), { Part::PreRasterization }));
+
+	EWE_CHECK(OnlyChanged(base, PackAll(configInfo, Test::MakeHandle<VkPipelineLayout>(0x20), DefaultHashes()), { Part::PreRasterization, Part::FragmentShader }));
+}
+
+static void AttachmentFormats() {
+	PipelineConfigInfo configInfo{};
+	configInfo.SetToDefaults();
+	const VkPipelineLayout vkLayout = Test::MakeHandle<VkPipelineLayout>(0x10);
+	const Keys base = PackAll(configInfo, vkLayout, DefaultHashes());
+
+	const VkFormat otherFormat = VK_FORMAT_R16G16B16A16_SFLOAT;
+	configInfo.pipelineRenderingInfo.pColorAttachmentFormats = &otherFormat;
+	EWE_CHECK(OnlyChanged(base, PackAll(configInfo, vkLayout, DefaultHashes()), { Part::FragmentOutput }));
+}
+
+int main() {
+	renderingInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
+	renderingInfo.colorAttachmentCount = 1;
+	renderingInfo.pColorAttachmentFormats = &colorFormat;
+	renderingInfo.depthAttachmentFormat = VK_FORMAT_D32_SFLOAT;
+	PipelineConfigInfo::pipelineRenderingInfoStatic = &renderingInfo;
+
+	Deterministic();
+	StateStaysInItsPart();
+	ShadersAndLayout();
+	AttachmentFormats();
+	return Test::Finish("PipelineLibraryTests");
+}
@@ -0,0 +1,54 @@
+#include "TestCommon.h"
+
+#include "EWGraphics/Data/FlatRegistry.h"
+
+#include <cstdio>
+#include <unordered_map>
+
+using namespace EWE;
+
+//the pipeline registry's lookup against the unordered_map it replaced
+//the IDs are an enum's worth of pipelines, looked up in a draw order that repeats
+
+static constexpr uint32_t pipelineCount = 256;
+static constexpr uint32_t lookupCount = 10000000;
+
+struct FakePipeline {
+	uint64_t payload;
+};
+
+static FlatRegistry<uint32_t, FakePipeline*, 4096> registry{};
+
+int main() {
+	std::vector<FakePipeline> pipelines(pipelineCount);
+	std::unordered_map<uint32_t, FakePipeline*> map{};
+	for (uint32_t i = 0; i < pipelineCount; i++) {
+		pipelines[i].payload = i;
+		registry.Insert(i, &pipelines[i]);
+		map.emplace(i, &pipelines[i]);
+	}
+	//not sequential, draws jump between pipelines
+	std::vector<uint32_t> order(4096);
+	for (std::size_t i = 0; i < order.size(); i++) {
+		order[i] = static_cast<uint32_t>((i * 2654435761u) >> 7) % pipelineCount;
+	}
+
+	uint64_t flatSum = 0;
+	const double flatMS = Test::TimeMS([&] {
+		for (uint32_t i = 0; i < lookupCount; i++) {
+			flatSum += registry.At(order[i % order.size()])->payload;
+		}
+	});
+	uint64_t mapSum = 0;
+	const double mapMS = Test::TimeMS([&] {
+		for (uint32_t i = 0; i < lookupCount; i++) {
+			mapSum += map.at(order[i % order.size()])->payload;
+		}
+	});
+	Test::KeepAlive(flatSum + mapSum);
+
+	printf("%u lookups over %u pipelines\n", lookupCount, pipelineCount);
+	printf("flat registry - %.2f ms (%.2f ns per lookup)\n", flatMS, flatMS * 1000000.0 / lookupCount);
+	printf("unordered_map - %.2f ms (%.2f ns per lookup)\n", mapMS, mapMS * 1000000.0 / lookupCount);
+	return flatSum == mapSum ? 0 : 1;
+}
@@ -0,0 +1,81 @@
+#include "TestCommon.h"
+
+#include "EWGraphics/Data/RangeAllocator.h"
+
+using namespace EWE;
+
+static void FirstFit() {
+	RangeAllocator ranges{ 2 };
+	ranges.Reset(256);
+	EWE_CHECK(ranges.Allocate(64) == 0);
+	EWE_CHECK(ranges.Allocate(32) == 64);
+	EWE_CHECK(ranges.Allocate(160) == 96);
+	//exactly full, the last range is gone
+	EWE_CHECK(ranges.FreeRangeCount() == 0);
+	EWE_CHECK(ranges.Allocate(1) == RangeAllocator::INVALID_OFFSET);
+	EWE_CHECK(ranges.LiveCount() == 3);
+	EWE_CHECK(ranges.LiveBytes() == 256);
+}
+
+//a freed range stays out until more than retireDelay frames have passed
+static void RetireDelay() {
+	RangeAllocator ranges{ 2 };
+	ranges.Reset(128);
+	const uint64_t first = ranges.Allocate(64);
+	ranges.Allocate(64);
+	ranges.Free(first, 64, 10);
+	EWE_CHECK(ranges.LiveCount() == 1);
+	EWE_CHECK(ranges.LiveBytes() == 64);
+	EWE_CHECK(ranges.RetiringCount() == 1);
+
+	EWE_CHECK(ranges.Collect(11) == 0);
+	EWE_CHECK(ranges.Collect(12) == 0);
+	EWE_CHECK(ranges.Allocate(64) == RangeAllocator::INVALID_OFFSET);
+
+	EWE_CHECK(ranges.Collect(13) == 1);
+	EWE_CHECK(ranges.RetiringCount() == 0);
+	EWE_CHECK(ranges.Allocate(64) == first);
+}
+
+//neighbours are merged, so a freed heap can hand out one big range again
+static void Coalesce() {
+	RangeAllocator ranges{ 0 };
+	ranges.Reset(256);
+	uint64_t offsets[4];
+	for (auto& offset : offsets) {
+		offset = ranges.Allocate(64);
+	}
+	//freed out of order, with one left live in the middle
+	ranges.Free(offsets[2], 64, 0);
+	ranges.Free(offsets[0], 64, 0);
+	ranges.Free(offsets[3], 64, 0);
+	EWE_CHECK(ranges.Collect(1) == 3);
+	EWE_CHECK(ranges.FreeRangeCount() == 2);
+	EWE_CHECK(ranges.Allocate(128) == 128);
+	ranges.Free(128, 128, 1);
+
+	ranges.Free(offsets[1], 64, 1);
+	ranges.Collect(2);
+	EWE_CHECK(ranges.FreeRangeCount() == 1);
+	EWE_CHECK(ranges.LiveCount() == 0);
+	EWE_CHECK(ranges.Allocate(256) == 0);
+}
+
+//reset drops everything, including what's still retiring
+static void Reset() {
+	RangeAllocator ranges{ 4 };
+	ranges.Reset(64);
+	ranges.Free(ranges.Allocate(32), 32, 0);
+	ranges.Reset(64);
+	EWE_CHECK(ranges.RetiringCount() == 0);
+	EWE_CHECK(ranges.LiveCount() == 0);
+	EWE_CHECK(ranges.Allocate(64) == 0);
+}
+
+int main() {
+	FirstFit();
+	RetireDelay();
+	Coalesce();
+	Reset();
+	return Test::Finish("RangeAllocatorTests");
+}
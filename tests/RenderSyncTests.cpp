@@ -0,0 +1,90 @@
+#include "TestCommon.h"
+
+#include "EWGraphics/Vulkan/QueueSyncPool.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+using namespace EWE;
+
+//every allocation in the process goes through here
+static std::atomic<uint64_t> allocationCount{ 0 };
+
+void* operator new(std::size_t size) {
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+	if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+		return ptr;
+	}
+	throw std::bad_alloc{};
+}
+void operator delete(void* ptr) noexcept {
+	std::free(ptr);
+}
+void operator delete(void* ptr, std::size_t) noexcept {
+	std::free(ptr);
+}
+
+static constexpr uint32_t semaphoresPerFrame = 16;
+//a semaphore is waiting until its frame slot comes back around, one more group than slots keeps them apart
+static constexpr uint32_t groupCount = MAX_FRAMES_IN_FLIGHT + 1;
+
+//too big for the stack
+static RenderSemaphoreLists lists{};
+static Semaphore waitSemaphores[groupCount][semaphoresPerFrame]{};
+static Semaphore signalSemaphores[groupCount][semaphoresPerFrame]{};
+
+static void RunFrame(uint32_t frame) {
+	const uint32_t group = frame % groupCount;
+	const uint8_t frameIndex = static_cast<uint8_t>(frame % MAX_FRAMES_IN_FLIGHT);
+	for (uint32_t i = 0; i < semaphoresPerFrame; i++) {
+		lists.AddWaitSemaphore(&waitSemaphores[group][i], VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+		lists.AddSignalSemaphore(&signalSemaphores[group][i]);
+	}
+
+	VkSubmitInfo submitInfo{};
+	lists.SetWaitData(submitInfo, frameIndex, Test::MakeHandle<VkSemaphore>(0xA0 + frameIndex));
+	lists.SetSignalData(submitInfo, frameIndex, Test::MakeHandle<VkSemaphore>(0xB0 + frameIndex));
+
+	EWE_CHECK(submitInfo.waitSemaphoreCount == semaphoresPerFrame + 1);
+	EWE_CHECK(submitInfo.signalSemaphoreCount == semaphoresPerFrame + 1);
+	EWE_CHECK(submitInfo.pWaitSemaphores[0] == waitSemaphores[group][0].vkSemaphore);
+	//the frame's own semaphore goes last
+	EWE_CHECK(submitInfo.pWaitSemaphores[semaphoresPerFrame] == Test::MakeHandle<VkSemaphore>(0xA0 + frameIndex));
+	EWE_CHECK(submitInfo.pWaitDstStageMask[semaphoresPerFrame] == VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+	EWE_CHECK(submitInfo.pSignalSemaphores[semaphoresPerFrame] == Test::MakeHandle<VkSemaphore>(0xB0 + frameIndex));
+	EWE_CHECK(lists.waitData.count == 0 && lists.signalData.count == 0);
+}
+
+static void SteadyStateDoesNotAllocate() {
+	for (uint32_t group = 0; group < groupCount; group++) {
+		for (uint32_t i = 0; i < semaphoresPerFrame; i++) {
+			waitSemaphores[group][i].vkSemaphore = Test::MakeHandle<VkSemaphore>(0x1000 + group * semaphoresPerFrame + i);
+			signalSemaphores[group][i].vkSemaphore = Test::MakeHandle<VkSemaphore>(0x2000 + group * semaphoresPerFrame + i);
+		}
+	}
+	//a full cycle first, anything lazily set up is done after this
+	uint32_t frame = 0;
+	for (; frame < groupCount * MAX_FRAMES_IN_FLIGHT; frame++) {
+		RunFrame(frame);
+	}
+
+	const uint64_t before = allocationCount.load();
+	for (; frame < 1000; frame++) {
+		RunFrame(frame);
+	}
+	const uint64_t allocations = allocationCount.load() - before;
+	EWE_CHECK(allocations == 0);
+
+	lists.ReleasePreviousFrames();
+	for (uint32_t group = 0; group < groupCount; group++) {
+		for (uint32_t i = 0; i < semaphoresPerFrame; i++) {
+			EWE_CHECK(!waitSemaphores[group][i].waiting);
+		}
+	}
+}
+
+int main() {
+	SteadyStateDoesNotAllocate();
+	return Test::Finish("RenderSyncTests");
+}
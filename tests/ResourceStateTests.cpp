@@ -0,0 +1,185 @@
+#include "TestCommon.h"
+
+#include "EWGraphics/Vulkan/ResourceState.h"
+
+using namespace EWE;
+
+//families are passed in directly, no device
+static constexpr uint32_t graphicsFamily = 0;
+static constexpr uint32_t transferFamily = 2;
+
+static VkImageMemoryBarrier ImageBarrier() {
+	VkImageMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.subresourceRange = VkImageSubresourceRange{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+	return barrier;
+}
+static VkBufferMemoryBarrier BufferBarrier() {
+	VkBufferMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	barrier.size = VK_WHOLE_SIZE;
+	return barrier;
+}
+
+static const ResourceUsage transferWrite{ Queue::transfer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT };
+static const ResourceUsage fragmentRead{ Queue::graphics, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT };
+static const ResourceUsage vertexRead{ Queue::graphics, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT };
+static const ResourceUsage computeWrite{ Queue::graphics, VK_IMAGE_LAYOUT_GENERAL, VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT };
+
+static void BufferFirstUse() {
+	ResourceState state{};
+	auto transition = ResourceTracker::ComputeTransition(state, transferWrite, transferFamily, false, BufferBarrier());
+	//nothing owns the contents, and a buffer has no layout
+	EWE_CHECK(transition.Empty());
+	EWE_CHECK(state.queueFamily == transferFamily);
+	EWE_CHECK(state.access == VK_ACCESS_TRANSFER_WRITE_BIT);
+}
+
+static void ImageFirstUse() {
+	ResourceState state{};
+	auto transition = ResourceTracker::ComputeTransition(state, transferWrite, transferFamily, false, ImageBarrier());
+	EWE_CHECK(!transition.release && transition.acquire);
+	EWE_CHECK(transition.acquireBarrier.oldLayout == VK_IMAGE_LAYOUT_UNDEFINED);
+	EWE_CHECK(transition.acquireBarrier.newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+	EWE_CHECK(transition.acquireBarrier.srcQueueFamilyIndex == VK_QUEUE_FAMILY_IGNORED);
+	EWE_CHECK(transition.acquireBarrier.srcAccessMask == 0);
+	EWE_CHECK(transition.acquireSrcStage == VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+	EWE_CHECK(transition.acquireDstStage == VK_PIPELINE_STAGE_TRANSFER_BIT);
+}
+
+//repeated reads record nothing, but a later write has to wait on every reader
+static void ReadAfterRead() {
+	ResourceState state{};
+	ResourceTracker::SetState(state, fragmentRead, graphicsFamily);
+	EWE_CHECK(ResourceTracker::ComputeTransition(state, fragmentRead, graphicsFamily, false, ImageBarrier()).Empty());
+	EWE_CHECK(ResourceTracker::ComputeTransition(state, vertexRead, graphicsFamily, false, ImageBarrier()).Empty());
+	EWE_CHECK(state.stage == (VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT));
+	EWE_CHECK(state.access == VK_ACCESS_SHADER_READ_BIT);
+
+	auto transition = ResourceTracker::ComputeTransition(state, computeWrite, graphicsFamily, false, ImageBarrier());
+	EWE_CHECK(!transition.release && transition.acquire);
+	EWE_CHECK(transition.acquireSrcStage == (VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT));
+	//reads don't need to be made available
+	EWE_CHECK(transition.acquireBarrier.srcAccessMask == 0);
+	EWE_CHECK(transition.acquireBarrier.oldLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	EWE_CHECK(transition.acquireBarrier.newLayout == VK_IMAGE_LAYOUT_GENERAL);
+}
+
+static void WriteAfterReadBuffer() {
+	ResourceState state{};
+	ResourceTracker::SetState(state, fragmentRead, graphicsFamily);
+	auto transition = ResourceTracker::ComputeTransition(state, computeWrite, graphicsFamily, false, BufferBarrier());
+	EWE_CHECK(transition.acquire && !transition.release);
+	EWE_CHECK(transition.acquireSrcStage == VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+	EWE_CHECK(transition.acquireDstStage == VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+	EWE_CHECK(transition.acquireBarrier.dstAccessMask == VK_ACCESS_SHADER_WRITE_BIT);
+}
+
+static void ReadAfterWriteSameFamily() {
+	ResourceState state{};
+	ResourceTracker::SetState(state, computeWrite, graphicsFamily);
+	const ResourceUsage generalRead{ Queue::graphics, VK_IMAGE_LAYOUT_GENERAL, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT };
+	auto transition = ResourceTracker::ComputeTransition(state, generalRead, graphicsFamily, false, ImageBarrier());
+	//no layout change, the hazard alone needs the barrier
+	EWE_CHECK(transition.acquire && !transition.release);
+	EWE_CHECK(transition.acquireBarrier.srcAccessMask == VK_ACCESS_SHADER_WRITE_BIT);
+	EWE_CHECK(transition.acquireSrcStage == VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+	EWE_CHECK(transition.acquireBarrier.oldLayout == transition.acquireBarrier.newLayout);
+}
+
+static void FamilyChange() {
+	ResourceState state{};
+	ResourceTracker::SetState(state, transferWrite, transferFamily);
+	auto transition = ResourceTracker::ComputeTransition(state, fragmentRead, graphicsFamily, false, ImageBarrier());
+	EWE_CHECK(transition.release && transition.acquire);
+
+	EWE_CHECK(transition.releaseBarrier.srcQueueFamilyIndex == transferFamily);
+	EWE_CHECK(transition.releaseBarrier.dstQueueFamilyIndex == graphicsFamily);
+	EWE_CHECK(transition.releaseBarrier.srcAccessMask == VK_ACCESS_TRANSFER_WRITE_BIT);
+	EWE_CHECK(transition.releaseBarrier.dstAccessMask == 0);
+	EWE_CHECK(transition.releaseSrcStage == VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+	//both halves carry the same families and layouts
+	EWE_CHECK(transition.acquireBarrier.srcQueueFamilyIndex == transferFamily);
+	EWE_CHECK(transition.acquireBarrier.dstQueueFamilyIndex == graphicsFamily);
+	EWE_CHECK(transition.releaseBarrier.oldLayout == transition.acquireBarrier.oldLayout);
+	EWE_CHECK(transition.releaseBarrier.newLayout == transition.acquireBarrier.newLayout);
+	EWE_CHECK(transition.acquireBarrier.newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	EWE_CHECK(transition.acquireBarrier.srcAccessMask == 0);
+	EWE_CHECK(transition.acquireBarrier.dstAccessMask == VK_ACCESS_SHADER_READ_BIT);
+	EWE_CHECK(transition.acquireSrcStage == VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+	EWE_CHECK(transition.acquireDstStage == VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+	EWE_CHECK(state.queueFamily == graphicsFamily);
+	EWE_CHECK(state.layout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+}
+
+//the contents are about to be overwritten, there's nothing to transfer
+static void DiscardSkipsTransfer() {
+	ResourceState state{};
+	ResourceTracker::SetState(state, fragmentRead, graphicsFamily);
+	auto transition = ResourceTracker::ComputeTransition(state, transferWrite, transferFamily, true, ImageBarrier());
+	EWE_CHECK(!transition.release && transition.acquire);
+	EWE_CHECK(transition.acquireBarrier.srcQueueFamilyIndex == VK_QUEUE_FAMILY_IGNORED);
+	EWE_CHECK(transition.acquireBarrier.dstQueueFamilyIndex == VK_QUEUE_FAMILY_IGNORED);
+	EWE_CHECK(transition.acquireBarrier.oldLayout == VK_IMAGE_LAYOUT_UNDEFINED);
+	EWE_CHECK(state.queueFamily == transferFamily);
+
+	//a buffer changing family with discard needs nothing at all
+	ResourceState bufferState{};
+	ResourceTracker::SetState(bufferState, fragmentRead, graphicsFamily);
+	EWE_CHECK(ResourceTracker::ComputeTransition(bufferState, transferWrite, transferFamily, true, BufferBarrier()).Empty());
+}
+
+static void SetState() {
+	ResourceState state{};
+	ResourceTracker::SetState(state, transferWrite, transferFamily);
+	EWE_CHECK(state.queueFamily == transferFamily);
+	EWE_CHECK(state.layout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+	EWE_CHECK(state.access == VK_ACCESS_TRANSFER_WRITE_BIT);
+	EWE_CHECK(state.stage == VK_PIPELINE_STAGE_TRANSFER_BIT);
+}
+
+//an upload batch is recycled once the frame that acquired it is done, its next acquires can't include the old ones
+static void ReusedAcquires() {
+	PendingAcquires acquires{};
+	ResourceState first{};
+	ResourceTracker::SetState(first, transferWrite, transferFamily);
+	acquires.Add(ResourceTracker::ComputeTransition(first, fragmentRead, graphicsFamily, false, ImageBarrier()));
+	ResourceState buffer{};
+	ResourceTracker::SetState(buffer, transferWrite, transferFamily);
+	acquires.Add(ResourceTracker::ComputeTransition(buffer, vertexRead, graphicsFamily, false, BufferBarrier()));
+	EWE_CHECK(acquires.images.size() == 1 && acquires.buffers.size() == 1);
+	EWE_CHECK(acquires.dstStage == (VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT));
+
+	acquires.Clear();
+	EWE_CHECK(acquires.Empty());
+	EWE_CHECK(acquires.srcStage == 0 && acquires.dstStage == 0);
+
+	ResourceState second{};
+	ResourceTracker::SetState(second, transferWrite, transferFamily);
+	const ResourceUsage computeRead{ Queue::graphics, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT };
+	acquires.Add(ResourceTracker::ComputeTransition(second, computeRead, graphicsFamily, false, ImageBarrier()));
+	EWE_CHECK(acquires.images.size() == 1 && acquires.buffers.size() == 0);
+	EWE_CHECK(acquires.images[0].oldLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+	EWE_CHECK(acquires.dstStage == VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+	//batches acquired in the same frame are merged
+	PendingAcquires frame{};
+	frame.Append(acquires);
+	frame.Append(acquires);
+	EWE_CHECK(frame.images.size() == 2 && frame.dstStage == VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+}
+
+int main() {
+	BufferFirstUse();
+	ImageFirstUse();
+	ReadAfterRead();
+	WriteAfterReadBuffer();
+	ReadAfterWriteSameFamily();
+	FamilyChange();
+	DiscardSkipsTransfer();
+	SetState();
+	ReusedAcquires();
+	return Test::Finish("ResourceStateTests");
+}
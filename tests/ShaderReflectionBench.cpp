@@ -0,0 +1,51 @@
+#include "TestCommon.h"
+
+#include "EWGraphics/Vulkan/ShaderReflection.h"
+#include "EWGraphics/resources/LoadingVert.h"
+#include "EWGraphics/resources/LoadingFrag.h"
+
+#include <cstdio>
+
+using namespace EWE;
+
+//what loading a shader costs without the cache (SPIRV-Cross) and with it (hash the module, copy the entry out)
+//over the loading screen shaders, the only SPIR-V the library carries
+
+static constexpr uint32_t iterations = 2000;
+
+static void Run(const char* name, bin2cpp::File const& file) {
+	const void* data = file.getBuffer();
+	const std::size_t dataSize = file.getSize();
+
+	//fills the cache, and gets the disk load out of the timing
+	const uint64_t hash = ShaderReflection::Hash(data, dataSize);
+	ShaderReflection::Data warm{};
+	if (!ShaderReflection::Find(hash, warm)) {
+		ShaderReflection::Insert(hash, ShaderReflection::Reflect(data, dataSize));
+	}
+
+	uint64_t reflectSum = 0;
+	const double reflectMS = Test::TimeMS([&] {
+		for (uint32_t i = 0; i < iterations; i++) {
+			reflectSum += ShaderReflection::Reflect(data, dataSize).sets.size();
+		}
+	});
+	uint64_t hitSum = 0;
+	const double hitMS = Test::TimeMS([&] {
+		for (uint32_t i = 0; i < iterations; i++) {
+			ShaderReflection::Data found{};
+			hitSum += ShaderReflection::Find(ShaderReflection::Hash(data, dataSize), found) ? found.sets.size() : 0;
+		}
+	});
+	Test::KeepAlive(reflectSum + hitSum);
+
+	printf("%s (%zu bytes) - SPIRV-Cross %.2f us, cache hit %.2f us, %.1fx\n", name, dataSize,
+		reflectMS * 1000.0 / iterations, hitMS * 1000.0 / iterations, reflectMS / hitMS
+	);
+}
+
+int main() {
+	Run("LoadingVert", bin2cpp::getLoadingVertFile());
+	Run("LoadingFrag", bin2cpp::getLoadingFragFile());
+	return 0;
+}
@@ -0,0 +1,199 @@
+#include "TestCommon.h"
+
+#include "EWGraphics/Vulkan/ShaderReflection.h"
+#include "EWGraphics/resources/LoadingVert.h"
+#include "EWGraphics/resources/LoadingFrag.h"
+
+#include <filesystem>
+#include <vector>
+
+using namespace EWE;
+
+//stands in for a module, only the bytes matter to the cache
+static std::vector<uint32_t> MakeModule(uint32_t seed, std::size_t wordCount) {
+	std::vector<uint32_t> words(wordCount);
+	words[0] = 0x07230203; //SPIR-V magic
+	for (std::size_t i = 1; i < wordCount; i++) {
+		words[i] = seed * 2654435761u + static_cast<uint32_t>(i);
+	}
+	return words;
+}
+
+static void HashDeterminism() {
+	const auto module = MakeModule(1, 64);
+	const uint64_t hash = ShaderReflection::Hash(module.data(), module.size() * sizeof(uint32_t));
+	EWE_CHECK(hash == ShaderReflection::Hash(module.data(), module.size() * sizeof(uint32_t)));
+
+	auto edited = module;
+	edited[40] ^= 1;
+	EWE_CHECK(hash != ShaderReflection::Hash(edited.data(), edited.size() * sizeof(uint32_t)));
+
+	//a shorter module with the same prefix is a different key
+	EWE_CHECK(hash != ShaderReflection::Hash(module.data(), (module.size() - 1) * sizeof(uint32_t)));
+}
+
+static ShaderReflection::Data MakeData() {
+	ShaderReflection::Data data{};
+	data.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+	data.pushRange = VkPushConstantRange{ VK_SHADER_STAGE_FRAGMENT_BIT, 0, 16 };
+	auto& set = data.sets.emplace_back();
+	set.set = 0;
+	set.bindings.push_back(VkDescriptorSetLayoutBinding{ 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr });
+	set.bindings.push_back(VkDescriptorSetLayoutBinding{ 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr });
+	set.bindingFlags.resize(set.bindings.size(), 0);
+	return data;
+}
+
+static void FindInsert() {
+	const auto module = MakeModule(2, 128);
+	const uint64_t hash = ShaderReflection::Hash(module.data(), module.size() * sizeof(uint32_t));
+
+	const auto before = ShaderReflection::GetStats();
+	ShaderReflection::Data found{};
+	EWE_CHECK(!ShaderReflection::Find(hash, found));
+
+	ShaderReflection::Insert(hash, MakeData());
+	EWE_CHECK(ShaderReflection::Find(hash, found));
+	EWE_CHECK(found.stage == VK_SHADER_STAGE_FRAGMENT_BIT);
+	EWE_CHECK(found.pushRange.size == 16);
+	EWE_CHECK(found.sets.size() == 1);
+	EWE_CHECK(found.sets[0].bindings.size() == 2);
+	EWE_CHECK(found.sets[0].bindings[1].descriptorType == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
+
+	const auto after = ShaderReflection::GetStats();
+	EWE_CHECK(after.misses == before.misses + 1);
+	EWE_CHECK(after.hits == before.hits + 1);
+	EWE_CHECK(after.entries == before.entries + 1);
+}
+
+static void DynamicOverride() {
+	const auto module = MakeModule(3, 96);
+	const uint64_t hash = ShaderReflection::Hash(module.data(), module.size() * sizeof(uint32_t));
+	auto data = MakeData();
+	auto& storageSet = data.sets.emplace_back();
+	storageSet.set = 1;
+	storageSet.bindings.push_back(VkDescriptorSetLayoutBinding{ 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr });
+	storageSet.bindings.push_back(VkDescriptorSetLayoutBinding{ 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr });
+	storageSet.bindingFlags.resize(storageSet.bindings.size(), 0);
+	ShaderReflection::Insert(hash, data);
+
+	ShaderReflection::SetDynamicBuffer(0, 0);
+	ShaderReflection::SetDynamicBuffer(1, 0);
+	//marking twice is fine
+	ShaderReflection::SetDynamicBuffer(1, 0);
+
+	ShaderReflection::Data found{};
+	EWE_CHECK(ShaderReflection::Find(hash, found));
+	auto sets = found.sets;
+	ShaderReflection::ApplyOverrides(sets);
+	EWE_CHECK(sets[0].bindings[0].descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC);
+	EWE_CHECK(sets[0].bindings[1].descriptorType == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
+	EWE_CHECK(sets[1].bindings[0].descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC);
+	//same binding number, different set
+	EWE_CHECK(sets[1].bindings[1].descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+
+	//the cached entry keeps the reflected type
+	ShaderReflection::Data again{};
+	EWE_CHECK(ShaderReflection::Find(hash, again));
+	EWE_CHECK(again.sets[0].bindings[0].descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+	EWE_CHECK(again.sets[1].bindings[0].descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+}
+
+static bool SameBinding(VkDescriptorSetLayoutBinding const& binding, uint32_t index, VkDescriptorType type, uint32_t count, VkShaderStageFlags stageFlags) {
+	return (binding.binding == index) && (binding.descriptorType == type) && (binding.descriptorCount == count) && (binding.stageFlags == stageFlags) && (binding.pImmutableSamplers == nullptr);
+}
+
+//the loading screen shaders are embedded in the library. LeafBO is a buffer block, so it reflects as a storage buffer
+static void ReflectLoadingShaders() {
+	auto const& vertFile = bin2cpp::getLoadingVertFile();
+	const auto vert = ShaderReflection::Reflect(vertFile.getBuffer(), vertFile.getSize());
+	EWE_CHECK(vert.stage == VK_SHADER_STAGE_VERTEX_BIT);
+	EWE_CHECK(vert.pushRange.size == 0);
+	EWE_CHECK(vert.sets.size() == 1);
+	if (vert.sets.size() == 1) {
+		auto const& set = vert.sets[0];
+		EWE_CHECK(set.set == 0);
+		EWE_CHECK(set.bindings.size() == 1 && set.bindingFlags.size() == 1);
+		if (set.bindings.size() == 1) {
+			EWE_CHECK(SameBinding(set.bindings[0], 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT));
+			EWE_CHECK(set.bindingFlags[0] == 0);
+		}
+	}
+
+	auto const& fragFile = bin2cpp::getLoadingFragFile();
+	const auto frag = ShaderReflection::Reflect(fragFile.getBuffer(), fragFile.getSize());
+	EWE_CHECK(frag.stage == VK_SHADER_STAGE_FRAGMENT_BIT);
+	EWE_CHECK(frag.pushRange.size == 0);
+	EWE_CHECK(frag.sets.size() == 1);
+	if (frag.sets.size() == 1) {
+		auto const& set = frag.sets[0];
+		EWE_CHECK(set.set == 0);
+		EWE_CHECK(set.bindings.size() == 2 && set.bindingFlags.size() == 2);
+		if (set.bindings.size() == 2) {
+			EWE_CHECK(SameBinding(set.bindings[0], 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT));
+			EWE_CHECK(SameBinding(set.bindings[1], 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT));
+			EWE_CHECK(set.bindingFlags[0] == 0 && set.bindingFlags[1] == 0);
+		}
+	}
+
+	//both stages read LeafBO
+	std::vector<ShaderReflection::SetBindings> stageSets = vert.sets;
+	stageSets.insert(stageSets.end(), frag.sets.begin(), frag.sets.end());
+	const auto merged = ShaderReflection::MergeSets(stageSets);
+	EWE_CHECK(merged.size() == 1);
+	if ((merged.size() == 1) && (merged[0].bindings.size() == 2)) {
+		EWE_CHECK(SameBinding(merged[0].bindings[0], 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT));
+		EWE_CHECK(SameBinding(merged[0].bindings[1], 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT));
+		EWE_CHECK(merged[0].bindingFlags.size() == 2 && merged[0].bindingFlags[0] == 0 && merged[0].bindingFlags[1] == 0);
+	}
+	else {
+		EWE_CHECK(false);
+	}
+}
+
+//counts take the largest declaration, flags are ORed, sets stay apart and come out sorted
+static void MergeSets() {
+	constexpr VkDescriptorBindingFlags variableFlags = VK_DESCRIPTOR_BINDING_VARIABLE_DESCRIPTOR_COUNT_BIT | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT;
+	std::vector<ShaderReflection::SetBindings> stageSets{
+		ShaderReflection::SetBindings{ 1, { VkDescriptorSetLayoutBinding{ 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4, VK_SHADER_STAGE_VERTEX_BIT, nullptr } }, { 0 } },
+		ShaderReflection::SetBindings{ 0, { VkDescriptorSetLayoutBinding{ 2, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, nullptr } }, {} },
+		ShaderReflection::SetBindings{ 1, { VkDescriptorSetLayoutBinding{ 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 16, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr } }, { variableFlags } },
+		ShaderReflection::SetBindings{ 0, { VkDescriptorSetLayoutBinding{ 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr } }, { 0 } },
+	};
+	const auto merged = ShaderReflection::MergeSets(stageSets);
+	EWE_CHECK(merged.size() == 2);
+	if (merged.size() != 2) {
+		return;
+	}
+	EWE_CHECK(merged[0].set == 0 && merged[1].set == 1);
+	EWE_CHECK(merged[0].bindings.size() == 2 && merged[0].bindingFlags.size() == 2);
+	if (merged[0].bindings.size() == 2) {
+		EWE_CHECK(SameBinding(merged[0].bindings[0], 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT));
+		EWE_CHECK(SameBinding(merged[0].bindings[1], 2, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT));
+	}
+	EWE_CHECK(merged[1].bindings.size() == 1 && merged[1].bindingFlags.size() == 1);
+	if (merged[1].bindings.size() == 1) {
+		EWE_CHECK(SameBinding(merged[1].bindings[0], 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 16, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT));
+		EWE_CHECK(merged[1].bindingFlags[0] == variableFlags);
+	}
+}
+
+static void SaveWritesFile() {
+	EWE_CHECK(ShaderReflection::Save());
+#if SHADER_REFLECTION_DISK_CACHE
+	EWE_CHECK(std::filesystem::exists("shader_reflection.bin"));
+#endif
+}
+
+int main() {
+	//the cache loads from the working directory on the first Find, a previous run would turn the misses into hits
+	std::filesystem::remove("shader_reflection.bin");
+
+	HashDeterminism();
+	FindInsert();
+	DynamicOverride();
+	ReflectLoadingShaders();
+	MergeSets();
+	SaveWritesFile();
+	return Test::Finish("ShaderReflectionTests");
+}
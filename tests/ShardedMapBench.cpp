@@ -0,0 +1,62 @@
+#include "TestCommon.h"
+
+#include "EWGraphics/Data/ShardedMap.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace EWE;
+
+//lookups from many threads at once, the sharded map against one mutex over an unordered_map
+//what the image registries looked like before they were sharded
+
+static constexpr uint32_t keyCount = 4096;
+static constexpr uint32_t lookupsPerThread = 2000000;
+
+template<typename Lookup>
+static double RunThreads(uint32_t threadCount, Lookup&& lookup) {
+	return Test::TimeMS([&] {
+		std::vector<std::thread> threads{};
+		for (uint32_t thread = 0; thread < threadCount; thread++) {
+			threads.emplace_back([&lookup, thread] {
+				uint64_t sum = 0;
+				for (uint32_t i = 0; i < lookupsPerThread; i++) {
+					sum += lookup(static_cast<uint32_t>((i + thread * 7919) * 2654435761u) % keyCount);
+				}
+				Test::KeepAlive(sum);
+			});
+		}
+		for (auto& thread : threads) {
+			thread.join();
+		}
+	});
+}
+
+int main() {
+	ShardedMap<uint32_t, uint64_t> sharded{};
+	std::unordered_map<uint32_t, uint64_t> locked{};
+	std::mutex lockedMutex{};
+	for (uint32_t i = 0; i < keyCount; i++) {
+		sharded.Insert(i, i);
+		locked.emplace(i, i);
+	}
+
+	const uint32_t maxThreads = std::max(1u, std::thread::hardware_concurrency());
+	for (uint32_t threadCount = 1; threadCount <= maxThreads; threadCount *= 2) {
+		const double shardedMS = RunThreads(threadCount, [&sharded](uint32_t key) {
+			uint64_t value = 0;
+			sharded.Find(key, value);
+			return value;
+		});
+		const double lockedMS = RunThreads(threadCount, [&](uint32_t key) {
+			std::lock_guard<std::mutex> lock{ lockedMutex };
+			return locked.find(key)->second;
+		});
+		printf("%2u threads, %u lookups each - sharded %.2f ms, single mutex %.2f ms\n", threadCount, lookupsPerThread, shardedMS, lockedMS);
+	}
+	return 0;
+}
@@ -0,0 +1,134 @@
+#include "TestCommon.h"
+
+#include "EWGraphics/Data/ShardedMap.h"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace EWE;
+
+static constexpr uint32_t threadCount = 8;
+
+template<typename Func>
+static void RunThreads(Func&& func) {
+	std::vector<std::thread> threads{};
+	for (uint32_t i = 0; i < threadCount; i++) {
+		threads.emplace_back(func, i);
+	}
+	for (auto& thread : threads) {
+		thread.join();
+	}
+}
+
+static void Basics() {
+	ShardedMap<uint32_t, std::string> map{};
+	std::string value{};
+	EWE_CHECK(!map.Find(1, value));
+	EWE_CHECK(map.Insert(1, "one"));
+	//the existing value is kept
+	EWE_CHECK(!map.Insert(1, "uno"));
+	EWE_CHECK(map.Find(1, value) && value == "one");
+	EWE_CHECK(map.Contains(1));
+
+	EWE_CHECK(map.Modify(1, [](std::string& existing) { existing += "!"; }));
+	EWE_CHECK(!map.Modify(2, [](std::string&) {}));
+	EWE_CHECK(map.Find(1, value) && value == "one!");
+
+	EWE_CHECK(map.Erase(1));
+	EWE_CHECK(!map.Erase(1));
+	EWE_CHECK(map.Size() == 0);
+
+	for (uint32_t i = 0; i < 100; i++) {
+		map.Insert(i, std::to_string(i));
+	}
+	uint32_t visited = 0;
+	map.ForEach([&visited](uint32_t const& key, std::string& entry) { visited += (entry == std::to_string(key)) ? 1 : 0; });
+	EWE_CHECK(visited == 100);
+	map.Clear();
+	EWE_CHECK(map.Size() == 0);
+}
+
+//every thread asks for the same keys at once, each key is made exactly once and everyone gets the same value
+static void FindOrInsertSingleFlight() {
+	static constexpr uint32_t keyCount = 512;
+	ShardedMap<uint32_t, uint32_t> map{};
+	std::atomic<uint32_t> makeCount{ 0 };
+	std::vector<std::vector<uint32_t>> seen(threadCount, std::vector<uint32_t>(keyCount));
+
+	RunThreads([&](uint32_t thread) {
+		for (uint32_t key = 0; key < keyCount; key++) {
+			seen[thread][key] = map.FindOrInsert(key, [&] {
+				makeCount.fetch_add(1);
+				return key * 10;
+			});
+		}
+	});
+	EWE_CHECK(makeCount.load() == keyCount);
+	EWE_CHECK(map.Size() == keyCount);
+	for (uint32_t thread = 1; thread < threadCount; thread++) {
+		EWE_CHECK(seen[thread] == seen[0]);
+	}
+	EWE_CHECK(seen[0][keyCount - 1] == (keyCount - 1) * 10);
+}
+
+//inserts, finds, modifies and erases from every thread, each thread owning a range of keys
+static void Stress() {
+	static constexpr uint32_t keysPerThread = 2000;
+	ShardedMap<uint32_t, uint32_t> map{};
+	std::atomic<uint32_t> wrongValues{ 0 };
+
+	RunThreads([&](uint32_t thread) {
+		const uint32_t base = thread * keysPerThread;
+		for (uint32_t i = 0; i < keysPerThread; i++) {
+			map.Insert(base + i, base + i);
+		}
+		for (uint32_t i = 0; i < keysPerThread; i++) {
+			uint32_t value = 0;
+			if (!map.Find(base + i, value) || (value != base + i)) {
+				wrongValues++;
+			}
+			map.Modify(base + i, [](uint32_t& existing) { existing++; });
+		}
+		//the odd keys go
+		for (uint32_t i = 1; i < keysPerThread; i += 2) {
+			map.Erase(base + i);
+		}
+	});
+	EWE_CHECK(wrongValues.load() == 0);
+	EWE_CHECK(map.Size() == threadCount * keysPerThread / 2);
+
+	uint32_t wrongAfter = 0;
+	map.ForEach([&wrongAfter](uint32_t const& key, uint32_t& value) {
+		wrongAfter += ((key % 2 == 0) && (value == key + 1)) ? 0 : 1;
+	});
+	EWE_CHECK(wrongAfter == 0);
+}
+
+//every thread bumps the same counters
+static void ModifyIsExclusive() {
+	static constexpr uint32_t counterCount = 4;
+	static constexpr uint32_t increments = 20000;
+	ShardedMap<uint32_t, uint64_t> map{};
+	for (uint32_t i = 0; i < counterCount; i++) {
+		map.Insert(i, 0);
+	}
+	RunThreads([&](uint32_t) {
+		for (uint32_t i = 0; i < increments; i++) {
+			map.Modify(i % counterCount, [](uint64_t& counter) { counter++; });
+		}
+	});
+	for (uint32_t i = 0; i < counterCount; i++) {
+		uint64_t value = 0;
+		EWE_CHECK(map.Find(i, value) && value == threadCount * increments / counterCount);
+	}
+}
+
+int main() {
+	Basics();
+	FindOrInsertSingleFlight();
+	Stress();
+	ModifyIsExclusive();
+	return Test::Finish("ShardedMapTests");
+}
@@ -0,0 +1,63 @@
+#include "TestCommon.h"
+
+#include "EWGraphics/Data/SlotAllocator.h"
+
+#include <algorithm>
+
+using namespace EWE;
+
+static void AllocateToCapacity() {
+	SlotAllocator slots{ 4, 2 };
+	for (uint32_t i = 0; i < 4; i++) {
+		EWE_CHECK(slots.Allocate() == i);
+	}
+	EWE_CHECK(slots.Allocate() == SlotAllocator::INVALID_SLOT);
+	EWE_CHECK(slots.LiveCount() == 4);
+	EWE_CHECK(slots.HighWater() == 4);
+}
+
+//a freed slot stays out until more than retireDelay frames have passed
+static void RetireDelay() {
+	SlotAllocator slots{ 2, 2 };
+	const uint32_t first = slots.Allocate();
+	slots.Allocate();
+	slots.Free(first, 10);
+	EWE_CHECK(slots.LiveCount() == 1);
+	EWE_CHECK(slots.RetiringCount() == 1);
+
+	EWE_CHECK(slots.Collect(11) == 0);
+	EWE_CHECK(slots.Collect(12) == 0);
+	EWE_CHECK(slots.Allocate() == SlotAllocator::INVALID_SLOT);
+
+	EWE_CHECK(slots.Collect(13) == 1);
+	EWE_CHECK(slots.RetiringCount() == 0);
+	EWE_CHECK(slots.Allocate() == first);
+	EWE_CHECK(slots.HighWater() == 2);
+}
+
+//the free list is used before the high water mark grows
+static void Reuse() {
+	SlotAllocator slots{ 64, 0 };
+	std::vector<uint32_t> held{};
+	for (uint32_t i = 0; i < 16; i++) {
+		held.push_back(slots.Allocate());
+	}
+	for (uint32_t frame = 0; frame < 100; frame++) {
+		const uint32_t slot = held[frame % held.size()];
+		slots.Free(slot, frame);
+		slots.Collect(frame + 1);
+		held[frame % held.size()] = slots.Allocate();
+	}
+	EWE_CHECK(slots.HighWater() == 16);
+	EWE_CHECK(slots.LiveCount() == 16);
+
+	std::sort(held.begin(), held.end());
+	EWE_CHECK(std::adjacent_find(held.begin(), held.end()) == held.end());
+}
+
+int main() {
+	AllocateToCapacity();
+	RetireDelay();
+	Reuse();
+	return Test::Finish("SlotAllocatorTests");
+}
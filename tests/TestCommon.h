@@ -0,0 +1,58 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <type_traits>
+
+/*
+* no framework. a test is a function that CHECKs, main calls them and returns Finish() for ctest
+	a failed check prints and counts, the rest of the test keeps going
+	benchmarks time a lambda with TimeMS, and fold their results into KeepAlive so the optimizer can't drop the work
+*/
+
+namespace EWE {
+	namespace Test {
+		inline int failures = 0;
+
+		inline int Finish(const char* name) {
+			if (failures == 0) {
+				printf("%s - passed\n", name);
+				return 0;
+			}
+			printf("%s - %d checks failed\n", name, failures);
+			return 1;
+		}
+
+		template<typename Func>
+		double TimeMS(Func&& func) {
+			const auto start = std::chrono::steady_clock::now();
+			func();
+			return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		}
+
+		//fake vulkan handles, for code that only stores and compares them. non dispatchable handles are pointers on 64 bit
+		template<typename Handle>
+		Handle MakeHandle(uint64_t bits) {
+			if constexpr (std::is_pointer_v<Handle>) {
+				return reinterpret_cast<Handle>(static_cast<uintptr_t>(bits));
+			}
+			else {
+				return static_cast<Handle>(bits);
+			}
+		}
+
+		inline volatile uint64_t sink = 0;
+		inline void KeepAlive(uint64_t value) {
+			sink = sink + value;
+		}
+	} //namespace Test
+} //namespace EWE
+
+#define EWE_CHECK(condition) \
+	do { \
+		if (!(condition)) { \
+			printf("%s:%d - check failed : %s\n", __FILE__, __LINE__, #condition); \
+			EWE::Test::failures++; \
+		} \
+	} while (0)